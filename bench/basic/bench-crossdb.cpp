@@ -0,0 +1,129 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <crossdb.hpp>
+
+#define BENCH_DBNAME	"CrossDB++"
+#define TEST_NAME(i) 	i?"Typed":"Row"
+int LKUP_COUNT = 10000000;
+
+using namespace std;
+
+#include "bench.h"
+
+static crossdb::connection	*s_pConn;
+
+// SQL test uses untyped rows, statement is cached by SQL to compare row access only
+static unordered_map<const char*, crossdb::statement>	s_stmt_cache;
+
+static crossdb::statement& bench_stmt (const char *sql)
+{
+	auto iter = s_stmt_cache.find (sql);
+	if (iter == s_stmt_cache.end()) {
+		iter = s_stmt_cache.emplace (sql, s_pConn->prepare (sql)).first;
+	}
+	return iter->second;
+}
+
+void* bench_open (const char *db)
+{
+	try {
+		s_pConn = new crossdb::connection (db);
+	} catch (const crossdb::error &e) {
+		printf ("Can't open connection: %s\n", e.what());
+		return NULL;
+	}
+	return s_pConn;
+}
+
+void bench_close (void *pConn)
+{
+	s_stmt_cache.clear ();
+	delete s_pConn;
+}
+
+bool bench_sql (void *pConn, const char *sql)
+{
+	// DROP/CREATE TABLE invalidates prepared statements
+	s_stmt_cache.clear ();
+	try {
+		s_pConn->exec (sql);
+	} catch (const crossdb::error &e) {
+		printf ("Can't exec '%s': %s\n", sql, e.what());
+		return false;
+	}
+	return true;
+}
+
+
+/************************************************
+		Row: xdb_column_* call per cell
+ ************************************************/
+
+bool bench_sql_insert (void *pConn, const char *sql, int id, string &name, int age, string &cls, int score)
+{
+	return 1 == bench_stmt(sql).exec (id, name, age, cls, score).affected_rows();
+}
+
+bool bench_sql_get_byid (void *pConn, const char *sql, int id, stu_callback callback, void *pArg)
+{
+	crossdb::result res = bench_stmt(sql).exec (id);
+	auto row = res.fetch ();
+	if (row) {
+		string name (row->get_str (1)), cls (row->get_str (3));
+		callback (pArg, row->get_int (0), name, row->get_int (2), cls, row->get_int (4));
+	}
+	return row.has_value();
+}
+
+bool bench_sql_updAge_byid (void *pConn, const char *sql, int id, int age)
+{
+	return 1 == bench_stmt(sql).exec (age, id).affected_rows();
+}
+
+bool bench_sql_del_byid (void *pConn, const char *sql, int id)
+{
+	return 1 == bench_stmt(sql).exec (id).affected_rows();
+}
+
+
+/************************************************
+		Typed: compile-time column types
+ ************************************************/
+
+void* bench_stmt_prepare (void *pConn, const char *sql)
+{
+	return new crossdb::statement (s_pConn->prepare (sql));
+}
+
+void bench_stmt_close (void *pStmt)
+{
+	delete (crossdb::statement*)pStmt;
+}
+
+bool bench_stmt_insert (void *pStmt, int id, string &name, int age, string &cls, int score)
+{
+	return 1 == ((crossdb::statement*)pStmt)->exec (id, name, age, cls, score).affected_rows();
+}
+
+bool bench_stmt_get_byid (void *pStmt, int id, stu_callback callback, void *pArg)
+{
+	auto res = ((crossdb::statement*)pStmt)->query<int, string_view, int, string_view, int> (id);
+	auto row = res.fetch ();
+	if (row) {
+		auto [sid, sname, age, scls, score] = *row;
+		string name (sname), cls (scls);
+		callback (pArg, sid, name, age, cls, score);
+	}
+	return row.has_value();
+}
+
+bool bench_stmt_updAge_byid (void *pStmt, int id, int age)
+{
+	return 1 == ((crossdb::statement*)pStmt)->exec (age, id).affected_rows();
+}
+
+bool bench_stmt_del_byid (void *pStmt, int id)
+{
+	return 1 == ((crossdb::statement*)pStmt)->exec (id).affected_rows();
+}
@@ -0,0 +1,147 @@
+#include <crossdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+static uint64_t timestamp_us ()
+{
+	struct timeval tv; gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// Multiplicative scramble is 1:1 on 32 bits, so keys of id >= row count always miss
+static uint32_t bench_key (uint32_t id, bool bSeq)
+{
+	return bSeq ? id : id * 2654435761U;
+}
+
+// Index files are mapped at full size, so file size is index memory
+static uint64_t index_bytes (const char *db)
+{
+	char path[1024];
+	uint64_t bytes = 0;
+	DIR *pDir = opendir (db);
+	for (struct dirent *pEnt; pDir && (NULL != (pEnt = readdir (pDir))); ) {
+		if ('T' != pEnt->d_name[0]) {
+			continue;
+		}
+		snprintf (path, sizeof(path), "%s/%s", db, pEnt->d_name);
+		DIR *pTblDir = opendir (path);
+		for (struct dirent *pFile; pTblDir && (NULL != (pFile = readdir (pTblDir))); ) {
+			struct stat st;
+			snprintf (path, sizeof(path), "%s/%s/%s", db, pEnt->d_name, pFile->d_name);
+			if (('I' == pFile->d_name[0]) && (0 == stat (path, &st))) {
+				bytes += st.st_size;
+			}
+		}
+		if (pTblDir) {
+			closedir (pTblDir);
+		}
+	}
+	if (pDir) {
+		closedir (pDir);
+	}
+	return bytes;
+}
+
+static void bench_lookup (xdb_conn_t *pConn, const char *name, int base, int row_count, int lookup_count, bool bSeq)
+{
+	int found = 0;
+	xdb_stmt_t *pStmt = xdb_stmt_prepare (pConn, "SELECT id FROM t WHERE k=?");
+	XDB_CHECK (NULL != pStmt, printf ("Can't prepare lookup\n"); return;);
+	srand (2);
+	uint64_t ts = timestamp_us ();
+	for (int i = 0; i < lookup_count; ++i) {
+		xdb_res_t *pRes = xdb_stmt_bexec (pStmt, bench_key (base + rand() % row_count, bSeq));
+		found += (NULL != xdb_fetch_row (pRes));
+		xdb_free_result (pRes);
+	}
+	ts = timestamp_us () - ts;
+	printf ("  %-18s %8d lookups %8d found  %6"PRIu64" ns/lookup\n", name, lookup_count, found, ts * 1000 / lookup_count);
+	xdb_stmt_close (pStmt);
+}
+
+static void bench_index (const char *db, const char *type, const char *opt, int row_count, int lookup_count, bool bSeq)
+{
+	xdb_conn_t	*pConn = xdb_open (db);
+	XDB_CHECK (NULL != pConn, printf ("Can't open database %s\n", db); return;);
+
+	xdb_exec (pConn, "DROP TABLE IF EXISTS t");
+	xdb_res_t *pRes = xdb_pexec (pConn, "CREATE TABLE t (id INT, k INT, KEY USING %s (k)%s)", type, opt);
+	XDB_RESCHK (pRes, printf ("Can't create table t USING %s%s\n", type, opt); goto exit;);
+
+	xdb_stmt_t *pStmt = xdb_stmt_prepare (pConn, "INSERT INTO t VALUES (?,?)");
+	XDB_CHECK (NULL != pStmt, printf ("Can't prepare insert\n"); goto exit;);
+	uint64_t ts = timestamp_us ();
+	for (int i = 0; i < row_count; ++i) {
+		if (0 == i % 10000) {
+			xdb_begin (pConn);
+		}
+		xdb_stmt_bexec (pStmt, i, bench_key (i, bSeq));
+		if ((9999 == i % 10000) || (i == row_count - 1)) {
+			xdb_commit (pConn);
+		}
+	}
+	ts = timestamp_us () - ts;
+	xdb_stmt_close (pStmt);
+	xdb_exec (pConn, "FLUSH");
+
+	uint64_t bytes = index_bytes (db);
+	printf ("USING %s%s\n", type, opt);
+	printf ("  %-18s %8d rows    %6"PRIu64" ns/row  %6.1f bytes/row\n", "INSERT", row_count, ts * 1000 / row_count, (double)bytes / row_count);
+
+	bench_lookup (pConn, "Hit", 0, row_count, lookup_count, bSeq);
+	bench_lookup (pConn, "Miss", row_count, row_count, lookup_count, bSeq);
+
+	xdb_exec (pConn, "DROP TABLE t");
+
+exit:
+	xdb_close (pConn);
+}
+
+int main (int argc, char **argv)
+{
+	int			ch, row_count = 1000000, lookup_count = 1000000;
+	bool		bSeq = false;
+	const char	*db = "/tmp/xdb-bench-hash";
+
+	while ((ch = getopt(argc, argv, "n:l:d:sh")) != -1) {
+		switch (ch) {
+		case 'h':
+			printf ("Usage:\n");
+			printf ("  -h                        show this help\n");
+			printf ("  -n <row count>            default 1000000\n");
+			printf ("  -l <lookup count>         hit and miss lookups each, default 1000000\n");
+			printf ("  -d <db path>              default /tmp/xdb-bench-hash\n");
+			printf ("  -s                        sequential keys, default random\n");
+			return -1;
+		case 'n':
+			row_count = atoi (optarg);
+			break;
+		case 'l':
+			lookup_count = atoi (optarg);
+			break;
+		case 'd':
+			db = optarg;
+			break;
+		case 's':
+			bSeq = true;
+			break;
+		}
+	}
+	if ((row_count <= 0) || (lookup_count <= 0)) {
+		printf ("Invalid parameter\n");
+		return -1;
+	}
+
+	bench_index (db, "HASH", "", row_count, lookup_count, bSeq);
+	bench_index (db, "HASH", " BLOOM", row_count, lookup_count, bSeq);
+	bench_index (db, "HASH2", "", row_count, lookup_count, bSeq);
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include <crossdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+static uint64_t timestamp_us ()
+{
+	struct timeval tv; gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// Route table like mix: mostly /24, some /16-/23, few /8-/15
+static int route_mask ()
+{
+	int r = rand() % 10;
+	return r < 6 ? 24 : (r < 9 ? 16 + rand() % 8 : 8 + rand() % 8);
+}
+
+// Longest prefix of each lookup, index returns it first, scan returns all matched prefixes
+static void bench_lookup (xdb_conn_t *pConn, const char *name, const char *sql, int lookup_count, bool bScan)
+{
+	int found = 0;
+	srand (2);
+	uint64_t ts = timestamp_us ();
+	for (int i = 0; i < lookup_count; ++i) {
+		uint32_t addr = (uint32_t)rand() << 1 ^ rand();
+		xdb_res_t *pRes = xdb_pexec (pConn, sql, addr>>24, (addr>>16)&0xFF, (addr>>8)&0xFF, addr&0xFF);
+		XDB_RESCHK (pRes, printf ("Can't lookup: %s\n", xdb_errmsg(pRes)); return;);
+		int mask = -1;
+		for (xdb_row_t *pRow; NULL != (pRow = xdb_fetch_row (pRes)); ) {
+			const xdb_inet_t *pInet = xdb_column_inet (pRes, pRow, 0);
+			if (pInet->mask > mask) {
+				mask = pInet->mask;
+			}
+			if (!bScan) {
+				break;
+			}
+		}
+		found += (mask >= 0);
+		xdb_free_result (pRes);
+	}
+	ts = timestamp_us () - ts;
+	printf ("%-24s %8d lookups  %8d found  %10"PRIu64" ns/lookup\n", name, lookup_count, found, ts * 1000 / lookup_count);
+}
+
+int main (int argc, char **argv)
+{
+	int		ch, route_count = 1000000, lookup_count = 100000, scan_count = 100;
+
+	while ((ch = getopt(argc, argv, "n:l:s:h")) != -1) {
+		switch (ch) {
+		case 'h':
+			printf ("Usage:\n");
+			printf ("  -h                        show this help\n");
+			printf ("  -n <route count>          default 1000000\n");
+			printf ("  -l <lookup count>         LPM index lookups, default 100000\n");
+			printf ("  -s <scan count>           full scan lookups, default 100\n");
+			return -1;
+		case 'n':
+			route_count = atoi (optarg);
+			break;
+		case 'l':
+			lookup_count = atoi (optarg);
+			break;
+		case 's':
+			scan_count = atoi (optarg);
+			break;
+		}
+	}
+	if ((route_count <= 0) || (lookup_count <= 0) || (scan_count <= 0)) {
+		printf ("Invalid parameter\n");
+		return -1;
+	}
+
+	xdb_conn_t	*pConn = xdb_open (":memory:");
+	XDB_CHECK (NULL != pConn, printf ("Can't open database\n"); return -1;);
+
+	xdb_res_t *pRes = xdb_exec (pConn, "CREATE TABLE route (prefix INET, nexthop INET, metric INT)");
+	XDB_RESCHK (pRes, printf ("Can't create table route\n"); goto exit;);
+
+	srand (1);
+	uint64_t ts = timestamp_us ();
+	for (int i = 0; i < route_count; ++i) {
+		uint32_t addr = (uint32_t)rand() << 1 ^ rand();
+		int mask = route_mask ();
+		addr &= ~0U << (32 - mask);
+		xdb_pexec (pConn, "INSERT INTO route VALUES ('%u.%u.%u.%u/%d', '192.168.%d.%d', %d)",
+					addr>>24, (addr>>16)&0xFF, (addr>>8)&0xFF, addr&0xFF, mask, (i>>8)&0xFF, i&0xFF, i);
+	}
+	ts = timestamp_us () - ts;
+	printf ("%-24s %8d routes   %10"PRIu64" ns/route\n", "INSERT", route_count, ts * 1000 / route_count);
+
+	bench_lookup (pConn, "Full scan", "SELECT prefix FROM route WHERE prefix >>= '%u.%u.%u.%u'", scan_count, true);
+
+	ts = timestamp_us ();
+	pRes = xdb_exec (pConn, "CREATE INDEX idx_prefix ON route USING LPM (prefix)");
+	XDB_RESCHK (pRes, printf ("Can't create LPM index\n"); goto exit;);
+	ts = timestamp_us () - ts;
+	printf ("%-24s %8d routes   %10"PRIu64" ns/route\n", "CREATE INDEX USING LPM", route_count, ts * 1000 / route_count);
+
+	bench_lookup (pConn, "LPM index", "SELECT prefix FROM route WHERE prefix >>= '%u.%u.%u.%u' LIMIT 1", lookup_count, false);
+	bench_lookup (pConn, "LPM index, all prefixes", "SELECT prefix FROM route WHERE prefix >>= '%u.%u.%u.%u'", lookup_count, true);
+
+exit:
+	xdb_close (pConn);
+
+	return 0;
+}
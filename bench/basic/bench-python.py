@@ -0,0 +1,66 @@
+# Python connector fetch benchmark: row-at-a-time fetchone vs batched fetchall/fetchcolumns
+import getopt
+import sys
+import time
+
+sys.path.insert (0, '../../connector/python')
+import crossdb
+
+def bench_fetch (cursor, name, fetch, row_count):
+	cursor.execute ("SELECT * FROM student")
+	ts = time.time ()
+	count = fetch (cursor)
+	ts = time.time () - ts
+	if count != row_count:
+		print ("%s fetched %d rows != %d" % (name, count, row_count))
+	print ("%-28s %10d rows/sec" % (name, int(count / ts)))
+
+def fetch_one (cursor):
+	count = 0
+	while cursor.fetchone () != None:
+		count += 1
+	return count
+
+def fetch_all (cursor):
+	return len (cursor.fetchall ())
+
+def fetch_columns (cursor):
+	count = 0
+	while True:
+		cols = cursor.fetchcolumns (65536, buffers=True)
+		if not cols:
+			return count
+		count += len (cols[0][0])
+
+def fetch_arrow (cursor):
+	return cursor.fetch_arrow ().num_rows
+
+if __name__ == '__main__':
+	row_count = 1000000
+	opts, args = getopt.getopt (sys.argv[1:], "n:h")
+	for opt, arg in opts:
+		if opt == '-h':
+			print ("Usage:")
+			print ("  -h                        show this help")
+			print ("  -n <row count>            default 1000000")
+			sys.exit (0)
+		elif opt == '-n':
+			row_count = int (arg)
+
+	conn = crossdb.connect (database=":memory:")
+	cursor = conn.cursor ()
+	cursor.execute ("CREATE TABLE student (id INT PRIMARY KEY, name CHAR(16), age INT, class CHAR(16), score INT)")
+	cursor.execute ("BEGIN")
+	for id in range (row_count):
+		cursor.execute ("INSERT INTO student (id,name,age,class,score) VALUES (%d,'jack%d',%d,'class%d',%d)" % (id, id, 10+id%10, id%3, 90+id%10))
+	cursor.execute ("COMMIT")
+
+	bench_fetch (cursor, "fetchone", fetch_one, row_count)
+	bench_fetch (cursor, "fetchall", fetch_all, row_count)
+	bench_fetch (cursor, "fetchcolumns buffers", fetch_columns, row_count)
+	try:
+		import pyarrow
+		bench_fetch (cursor, "fetch_arrow", fetch_arrow, row_count)
+	except ImportError:
+		pass
+	cursor.close ()
@@ -0,0 +1,138 @@
+#include <crossdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define BENCH_DBPATH	"bench_recovery"
+
+static bool s_quiet = false;
+
+#define bench_print(fmt...)	\
+	if (!s_quiet) {	\
+		printf (fmt);	\
+	}
+
+static uint64_t timestamp_us ()
+{
+	struct timeval tv; gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// Populate tables and exit without flush, the WAL is left for recovery
+static int bench_crash (int tbl_count, int row_count, int trans_rows)
+{
+	xdb_conn_t	*pConn = xdb_open (BENCH_DBPATH);
+	XDB_CHECK (NULL != pConn, printf ("Can't open database %s\n", BENCH_DBPATH); return -1;);
+
+	for (int t = 0; t < tbl_count; ++t) {
+		xdb_res_t *pRes = xdb_pexec (pConn, "CREATE TABLE IF NOT EXISTS student%d (id INT PRIMARY KEY, name CHAR(16), age INT, class CHAR(16), score INT, INDEX (name))", t);
+		XDB_RESCHK (pRes, printf ("Can't create table student%d\n", t); return -1;);
+	}
+
+	// Interleave tables inside each commit, like a real workload
+	uint64_t ts = timestamp_us ();
+	for (int id = 0; id < row_count; id += trans_rows) {
+		xdb_begin (pConn);
+		for (int i = id; (i < id + trans_rows) && (i < row_count); ++i) {
+			for (int t = 0; t < tbl_count; ++t) {
+				xdb_pexec (pConn, "INSERT INTO student%d (id,name,age,class,score) VALUES (%d,'name-%d',%d,'class-%d',%d)",
+							t, i, i%100, 10+i%3, i%10, 90+i%10);
+			}
+			if (i % 5 == 4) {
+				for (int t = 0; t < tbl_count; ++t) {
+					xdb_pexec (pConn, "DELETE FROM student%d WHERE id=%d", t, i - 2);
+				}
+			}
+		}
+		xdb_commit (pConn);
+	}
+	ts = timestamp_us () - ts;
+	bench_print ("Insert %d rows into %d tables use time %"PRIu64"us\n", row_count, tbl_count, ts);
+
+	// simulate crash: no close, no flush
+	fflush (stdout);
+	_exit (0);
+}
+
+int main (int argc, char **argv)
+{
+	int		ch, tbl_count = 8, row_count = 100000, trans_rows = 1000;
+
+	while ((ch = getopt(argc, argv, "n:t:b:qh")) != -1) {
+		switch (ch) {
+		case 'h':
+			printf ("Usage:\n");
+			printf ("  -h                        show this help\n");
+			printf ("  -n <row count>            rows per table, default 100000\n");
+			printf ("  -t <table count>          default 8\n");
+			printf ("  -b <trans rows>           rows per transaction, default 1000\n");
+			printf ("  -q                        quite mode\n");
+			return -1;
+		case 'n':
+			row_count = atoi (optarg);
+			break;
+		case 't':
+			tbl_count = atoi (optarg);
+			break;
+		case 'b':
+			trans_rows = atoi (optarg);
+			break;
+		case 'q':
+			s_quiet = true;
+			break;
+		}
+	}
+	if ((row_count <= 0) || (tbl_count <= 0) || (trans_rows <= 0)) {
+		printf ("Invalid parameter\n");
+		return -1;
+	}
+
+	if (system ("rm -rf "BENCH_DBPATH) != 0) {
+		printf ("Can't remove %s\n", BENCH_DBPATH);
+		return -1;
+	}
+
+	// fork before crossdb is initialized, child is the crashed process
+	pid_t pid = fork ();
+	if (0 == pid) {
+		return bench_crash (tbl_count, row_count, trans_rows);
+	}
+	int status;
+	waitpid (pid, &status, 0);
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+		printf ("Populate process failed, status 0x%x\n", status);
+		return -1;
+	}
+
+	// open may repair already depends on host uptime, so count both
+	uint64_t ts = timestamp_us ();
+	xdb_conn_t	*pConn = xdb_open (BENCH_DBPATH);
+	XDB_CHECK (NULL != pConn, printf ("Can't open database %s\n", BENCH_DBPATH); return -1;);
+	xdb_res_t *pRes = xdb_exec (pConn, "REPAIR");
+	ts = timestamp_us () - ts;
+	XDB_RESCHK (pRes, printf ("Can't repair database\n"); goto exit;);
+
+	int expect = row_count - row_count/5;
+	for (int t = 0; t < tbl_count; ++t) {
+		pRes = xdb_pexec (pConn, "SELECT COUNT(*) FROM student%d", t);
+		xdb_row_t *pRow = xdb_fetch_row (pRes);
+		int count = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+		xdb_free_result (pRes);
+		if (count != expect) {
+			printf ("Table student%d recovered %d rows != %d\n", t, count, expect);
+		}
+	}
+
+	printf ("Recover %d tables x %d rows use time %"PRIu64"us\n", tbl_count, row_count, ts);
+
+exit:
+	xdb_exec (pConn, "DROP DATABASE "BENCH_DBPATH);
+	xdb_close (pConn);
+
+	return 0;
+}
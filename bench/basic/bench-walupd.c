@@ -0,0 +1,93 @@
+// include source to read WAL commit size directly
+#include "../../src/crossdb.c"
+#include <sys/time.h>
+
+#define BENCH_DBPATH	"bench_walupd"
+
+static uint64_t timestamp_us ()
+{
+	struct timeval tv; gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static uint64_t bench_wal_size (xdb_conn_t *pConn)
+{
+	return XDB_WAL_PTR(pConn->pCurDbm->pWalm)->commit_size;
+}
+
+// Update one field of each row and report WAL bytes per updated row
+static void bench_update (xdb_conn_t *pConn, const char *name, const char *sql, int row_count, int loop)
+{
+	uint64_t wal_size = bench_wal_size (pConn);
+	uint64_t ts = timestamp_us ();
+	for (int l = 0; l < loop; ++l) {
+		for (int id = 0; id < row_count; ++id) {
+			xdb_res_t *pRes = xdb_pexec (pConn, sql, l, id);
+			XDB_RESCHK (pRes, printf ("Can't update: %s\n", xdb_errmsg(pRes)); return;);
+		}
+	}
+	ts = timestamp_us () - ts;
+	wal_size = bench_wal_size (pConn) - wal_size;
+	int count = row_count * loop;
+	printf ("%-32s %8d updates  %6"PRIu64" WAL bytes/update  %6"PRIu64" ns/update\n", name, count, wal_size / count, ts * 1000 / count);
+}
+
+int main (int argc, char **argv)
+{
+	int		ch, row_count = 1000, loop = 10;
+
+	while ((ch = getopt(argc, argv, "n:l:h")) != -1) {
+		switch (ch) {
+		case 'h':
+			printf ("Usage:\n");
+			printf ("  -h                        show this help\n");
+			printf ("  -n <row count>            default 1000\n");
+			printf ("  -l <loop>                 update rounds, default 10\n");
+			return -1;
+		case 'n':
+			row_count = atoi (optarg);
+			break;
+		case 'l':
+			loop = atoi (optarg);
+			break;
+		}
+	}
+	if ((row_count <= 0) || (loop <= 0)) {
+		printf ("Invalid parameter\n");
+		return -1;
+	}
+
+	if (system ("rm -rf "BENCH_DBPATH) != 0) {
+		printf ("Can't remove %s\n", BENCH_DBPATH);
+		return -1;
+	}
+	xdb_conn_t	*pConn = xdb_open (BENCH_DBPATH);
+	XDB_CHECK (NULL != pConn, printf ("Can't open database %s\n", BENCH_DBPATH); return -1;);
+
+	// keep every record in WAL during the run
+	xdb_res_t *pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=0, CHECKPOINT_WAL_SIZE=0, CHECKPOINT_DIRTY_SIZE=0");
+	XDB_RESCHK (pRes, printf ("Can't disable checkpoint\n"); goto exit;);
+
+	pRes = xdb_exec (pConn, "CREATE TABLE doc (id INT PRIMARY KEY, cnt INT, tag VARCHAR(64), body VARCHAR(4096))");
+	XDB_RESCHK (pRes, printf ("Can't create table doc\n"); goto exit;);
+	pRes = xdb_exec (pConn, "CREATE TABLE stat (id INT PRIMARY KEY, cnt INT, name CHAR(64), score INT, class CHAR(64))");
+	XDB_RESCHK (pRes, printf ("Can't create table stat\n"); goto exit;);
+
+	char body[1025];
+	memset (body, 'x', sizeof(body) - 1);
+	body[sizeof(body) - 1] = '\0';
+	for (int id = 0; id < row_count; ++id) {
+		xdb_pexec (pConn, "INSERT INTO doc VALUES (%d, 0, 'tag-%d', '%s')", id, id, body);
+		xdb_pexec (pConn, "INSERT INTO stat VALUES (%d, 0, 'name-%d', 0, 'class-%d')", id, id, id);
+	}
+
+	bench_update (pConn, "counter, 1KB VARCHAR row",	"UPDATE doc SET cnt=%d WHERE id=%d", row_count, loop);
+	bench_update (pConn, "short VARCHAR, 1KB VARCHAR row",	"UPDATE doc SET tag='tag-%d' WHERE id=%d", row_count, loop);
+	bench_update (pConn, "counter, fixed row",			"UPDATE stat SET cnt=%d WHERE id=%d", row_count, loop);
+
+exit:
+	xdb_exec (pConn, "DROP DATABASE "BENCH_DBPATH);
+	xdb_close (pConn);
+
+	return 0;
+}
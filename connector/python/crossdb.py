@@ -26,9 +26,45 @@ class CrossDbType(object):
 	XDB_TYPE_SMALLINT	= 2
 	XDB_TYPE_INT		= 3
 	XDB_TYPE_BIGINT	 = 4
+	XDB_TYPE_UTINYINT	= 5
+	XDB_TYPE_USMALLINT	= 6
+	XDB_TYPE_UINT		= 7
+	XDB_TYPE_UBIGINT	= 8
 	XDB_TYPE_FLOAT	   	= 9
 	XDB_TYPE_DOUBLE	 = 10
+	XDB_TYPE_TIMESTAMP	= 11
 	XDB_TYPE_CHAR		= 12
+	XDB_TYPE_BINARY		= 13
+	XDB_TYPE_VCHAR		= 14
+	XDB_TYPE_VBINARY	= 15
+	XDB_TYPE_BOOL		= 16
+	XDB_TYPE_INET		= 17
+	XDB_TYPE_MAC		= 18
+	XDB_TYPE_JSON		= 19
+
+	# ctypes of fixed size columns in xdb_fetch_cols buffers
+	CTYPE = {
+		XDB_TYPE_TINYINT:	ctypes.c_int8,
+		XDB_TYPE_SMALLINT:	ctypes.c_int16,
+		XDB_TYPE_INT:		ctypes.c_int32,
+		XDB_TYPE_BIGINT:	ctypes.c_int64,
+		XDB_TYPE_UTINYINT:	ctypes.c_uint8,
+		XDB_TYPE_USMALLINT:	ctypes.c_uint16,
+		XDB_TYPE_UINT:		ctypes.c_uint32,
+		XDB_TYPE_UBIGINT:	ctypes.c_uint64,
+		XDB_TYPE_FLOAT:		ctypes.c_float,
+		XDB_TYPE_DOUBLE:	ctypes.c_double,
+		XDB_TYPE_TIMESTAMP:	ctypes.c_int64,
+		XDB_TYPE_BOOL:		ctypes.c_bool,
+		XDB_TYPE_INET:		ctypes.c_uint8 * 18,
+		XDB_TYPE_MAC:		ctypes.c_uint8 * 6,
+	}
+	STRING = (XDB_TYPE_CHAR, XDB_TYPE_VCHAR, XDB_TYPE_JSON)
+	BINARY = (XDB_TYPE_BINARY, XDB_TYPE_VBINARY)
+
+class CrossDbColBuf(ctypes.Structure):
+	_fields_ = [('pData', ctypes.c_void_p), ('pOffs', ctypes.c_void_p), ('pNull', ctypes.c_void_p),
+				('data_cap', ctypes.c_uint32), ('rsvd', ctypes.c_uint32)]
 
 class CrossDbInterface(object):
 	libCrossdb = load_crossdb()
@@ -40,6 +76,22 @@ class CrossDbInterface(object):
 	libCrossdb.xdb_fetch_row.argtypes = [ctypes.c_void_p]
 	libCrossdb.xdb_fetch_row.restype = ctypes.c_void_p
 	libCrossdb.xdb_free_result.argtypes = [ctypes.c_void_p]
+	libCrossdb.xdb_column_null.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16]
+	libCrossdb.xdb_column_null.restype = ctypes.c_bool
+	libCrossdb.xdb_column_int64.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16]
+	libCrossdb.xdb_column_int64.restype = ctypes.c_int64
+	libCrossdb.xdb_column_double.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16]
+	libCrossdb.xdb_column_double.restype = ctypes.c_double
+	libCrossdb.xdb_column_str2.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16, ctypes.POINTER(ctypes.c_int)]
+	libCrossdb.xdb_column_str2.restype = ctypes.c_void_p
+	libCrossdb.xdb_column_inet.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16]
+	libCrossdb.xdb_column_inet.restype = ctypes.c_void_p
+	libCrossdb.xdb_column_mac.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint16]
+	libCrossdb.xdb_column_mac.restype = ctypes.c_void_p
+	libCrossdb.xdb_fetch_cols.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_void_p]
+	libCrossdb.xdb_fetch_cols.restype = ctypes.c_int
+	libCrossdb.xdb_fetch_arrow.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_void_p, ctypes.c_void_p]
+	libCrossdb.xdb_fetch_arrow.restype = ctypes.c_int
 	libCrossdb.xdb_commit.argtypes = [ctypes.c_void_p]
 	libCrossdb.xdb_rollback.argtypes = [ctypes.c_void_p]
 
@@ -77,6 +129,8 @@ class CrossDbCursor(object):
 		self._hConn = hConn
 		self._libCrossdb = CrossDbInterface.libCrossdb
 		self._hResult = None
+		self._varCap = 1 << 20
+		self.arraysize = 1
 
 	def __del__(self):
 		self.close()
@@ -105,12 +159,12 @@ class CrossDbCursor(object):
 	def description(self):
 		self._description = []
 		if self._rowMeta > 0:
-			pColList = ctypes.cast(self._rowMeta + 16, ctypes.POINTER(ctypes.c_uint64))[0]
+			pColList = ctypes.cast(self._rowMeta + 8, ctypes.POINTER(ctypes.c_uint64))[0]
 			for i in range (self._fldCount):
 				pCol = ctypes.cast(pColList, ctypes.POINTER(ctypes.c_uint64))[i]
-				bytes = ctypes.cast(pCol + 10, ctypes.POINTER(ctypes.c_uint8))[0]
-				colName = ctypes.cast(pCol + 11, ctypes.POINTER(ctypes.c_char*bytes))[0].value
-				colType = ctypes.cast(pCol + 2, ctypes.POINTER(ctypes.c_int8))[0]
+				bytes = ctypes.cast(pCol + 15, ctypes.POINTER(ctypes.c_uint8))[0]
+				colName = ctypes.cast(pCol + 16, ctypes.POINTER(ctypes.c_char*bytes))[0].value
+				colType = ctypes.cast(pCol + 1, ctypes.POINTER(ctypes.c_int8))[0]
 				self._description.append ((colName, colType, None, None, None, None, False))		
 		return self._description
 
@@ -129,64 +183,139 @@ class CrossDbCursor(object):
 		self._fldCount = ctypes.cast(self._hResult + 12, ctypes.POINTER(ctypes.c_uint16))[0]
 		self._affectedRows = ctypes.cast(self._hResult + 3*8, ctypes.POINTER(ctypes.c_uint64))[0]
 		if self._rowMeta > 0:
-			pColList = ctypes.cast(self._rowMeta + 16, ctypes.POINTER(ctypes.c_uint64))[0]
+			pColList = ctypes.cast(self._rowMeta + 8, ctypes.POINTER(ctypes.c_uint64))[0]
 			self._fieldType = []
 			for i in range (self._fldCount):
 				pCol = ctypes.cast(pColList, ctypes.POINTER(ctypes.c_uint64))[i]
-				colType = ctypes.cast(pCol + 2, ctypes.POINTER(ctypes.c_int8))[0]
+				colType = ctypes.cast(pCol + 1, ctypes.POINTER(ctypes.c_int8))[0]
 				self._fieldType.append (colType)
 		else:
 			self._fieldType = None
 			self._hResult = None
 		return self._errno
 
+	# Fetch one row with one library call per column, use fetchmany/fetchall/fetchcolumns for many rows
 	def fetchone(self):
+		if self._hResult == None:
+			return None
 		row = []
 		xrow = self._libCrossdb.xdb_fetch_row(self._hResult)
 		if None == xrow:
 			return None
 		for i in range (self._fldCount):
-			field = ctypes.cast(xrow, ctypes.POINTER(ctypes.c_uint64))[i]
-			if None != field:
+			type = self._fieldType[i]
+			if self._libCrossdb.xdb_column_null(self._hResult, xrow, i):
+				row.append (None)
+			elif type in (CrossDbType.XDB_TYPE_FLOAT, CrossDbType.XDB_TYPE_DOUBLE):
+				row.append (self._libCrossdb.xdb_column_double(self._hResult, xrow, i))
+			elif type in CrossDbType.STRING or type in CrossDbType.BINARY:
+				slen = ctypes.c_int(0)
+				pStr = self._libCrossdb.xdb_column_str2(self._hResult, xrow, i, ctypes.byref(slen))
+				value = ctypes.string_at(pStr, slen.value) if pStr != None else b''
+				row.append (value.decode("utf-8") if type in CrossDbType.STRING else value)
+			elif CrossDbType.XDB_TYPE_INET == type:
+				row.append (ctypes.string_at(self._libCrossdb.xdb_column_inet(self._hResult, xrow, i), 18))
+			elif CrossDbType.XDB_TYPE_MAC == type:
+				row.append (ctypes.string_at(self._libCrossdb.xdb_column_mac(self._hResult, xrow, i), 6))
+			else:
+				value = self._libCrossdb.xdb_column_int64(self._hResult, xrow, i)
+				if CrossDbType.XDB_TYPE_BOOL == type:
+					value = bool(value)
+				elif CrossDbType.XDB_TYPE_UBIGINT == type:
+					value &= 0xffffffffffffffff
+				row.append (value)
+		return row
+
+	# Fetch up to size rows (0 means all) column-wise with one library call per batch.
+	# Return list of column values, [] if no more rows.
+	# buffers=True returns fixed size columns as (memoryview, nulls) pair for numpy.frombuffer,
+	# nulls is bytes with 1 for NULL row or None if no NULL, NULL row value is 0.
+	def fetchcolumns(self, size=65536, buffers=False):
+		if self._hResult == None:
+			return []
+		if size <= 0:
+			size = max (self._rowCount, 1)
+		while True:
+			cols = []
+			bufs = (CrossDbColBuf * self._fldCount)()
+			for i in range (self._fldCount):
 				type = self._fieldType[i]
-				if CrossDbType.XDB_TYPE_INT == type:
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_int32))[0]
-					row.append (value)
-				elif CrossDbType.XDB_TYPE_CHAR == type:
-					bytes = ctypes.cast(field-2, ctypes.POINTER(ctypes.c_uint16))[0]
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_char*bytes))[0].value
-					row.append (value)
-				elif CrossDbType.XDB_TYPE_SMALLINT == type:
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_int16))[0]
-					row.append (value)
-				elif CrossDbType.XDB_TYPE_TINYINT == type:
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_int8))[0]
-					row.append (value)
-				elif CrossDbType.XDB_TYPE_FLOAT == type:
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_float))[0]
-					row.append (value)
-				elif CrossDbType.XDB_TYPE_DOUBLE == type:
-					value = ctypes.cast(field, ctypes.POINTER(ctypes.c_double))[0]
-					row.append (value)
+				null = (ctypes.c_uint8 * size)()
+				if type in CrossDbType.CTYPE:
+					data = (CrossDbType.CTYPE[type] * size)()
+					offs = None
+				elif type in CrossDbType.STRING or type in CrossDbType.BINARY:
+					data = ctypes.create_string_buffer(self._varCap)
+					offs = (ctypes.c_uint32 * (size + 1))()
+					bufs[i].pOffs = ctypes.addressof(offs)
+					bufs[i].data_cap = self._varCap
+				else:
+					data = None
+					offs = None
+				if data != None:
+					bufs[i].pData = ctypes.addressof(data)
+					bufs[i].pNull = ctypes.addressof(null)
+				cols.append ((data, offs, null))
+			count = self._libCrossdb.xdb_fetch_cols(self._hResult, size, bufs)
+			if count != -10:	# XDB_E_MEMORY: one row is larger than var buffer
+				break
+			self._varCap *= 4
+		if count <= 0:
+			return []
+
+		result = []
+		for i in range (self._fldCount):
+			type = self._fieldType[i]
+			data, offs, null = cols[i]
+			nulls = ctypes.string_at(null, count)
+			if 1 not in nulls:
+				nulls = None
+			if data == None:
+				values = [None] * count
+			elif offs != None:
+				o = offs[:count + 1]
+				raw = ctypes.string_at(data, o[count])
+				if type in CrossDbType.STRING:
+					values = [raw[o[r]:o[r + 1]].decode("utf-8") for r in range (count)]
 				else:
-					print ("Unknow type: "+str(self._fieldType[i]))
+					values = [raw[o[r]:o[r + 1]] for r in range (count)]
+			elif buffers and type not in (CrossDbType.XDB_TYPE_INET, CrossDbType.XDB_TYPE_MAC):
+				result.append ((memoryview(data)[:count], nulls))
+				continue
+			elif type in (CrossDbType.XDB_TYPE_INET, CrossDbType.XDB_TYPE_MAC):
+				values = [bytes(v) for v in data[:count]]
 			else:
-				row.append (None)
-		return row
+				values = data[:count]
+			if nulls != None:
+				values = [None if n else v for v, n in zip (values, nulls)]
+			result.append (values)
+		return result
+
+	def fetchmany(self, size=None):
+		cols = self.fetchcolumns (size if size != None else self.arraysize)
+		return [list (row) for row in zip (*cols)]
 
 	def fetchall(self):
 		rows=[]
 		while True:
-			row = self.fetchone ()
-			if None == row:
+			batch = self.fetchmany (65536)
+			if not batch:
 				break;
-			rows.append (row)
+			rows.extend (batch)
 		return rows
 
-	def executemany(self, operation, seq_of_parameters):
-		pass
+	# Fetch remaining rows as pyarrow.RecordBatch by Arrow C Data Interface, pyarrow takes the buffers without copy
+	def fetch_arrow(self, max_rows=0):
+		import pyarrow
+		if self._hResult == None:
+			return None
+		schema = ctypes.create_string_buffer(72)	# struct ArrowSchema
+		array = ctypes.create_string_buffer(80)		# struct ArrowArray
+		if self._libCrossdb.xdb_fetch_arrow(self._hResult, max_rows, schema, array) != 0:
+			return None
+		return pyarrow.RecordBatch._import_from_c(ctypes.addressof(array), ctypes.addressof(schema))
 
-	def fetchmany(self):
+	def executemany(self, operation, seq_of_parameters):
 		pass
 
 	def commit(self):
@@ -1,5 +1,21 @@
 #include <crossdb.h>
 
+typedef struct {
+	int			id;
+	char		name[16];
+	int			age;
+	float		score;
+	const char	*info;
+} student_t;
+
+static const xdb_struct_field_t s_student_flds[] = {
+	XDB_STRUCT_FIELD(student_t, id,		XDB_TYPE_INT,	"id"),
+	XDB_STRUCT_FIELD(student_t, name,	XDB_TYPE_CHAR,	"name"),
+	XDB_STRUCT_FIELD(student_t, age,	XDB_TYPE_INT,	"age"),
+	XDB_STRUCT_FIELD(student_t, score,	XDB_TYPE_FLOAT,	"score"),
+	XDB_STRUCT_FIELD(student_t, info,	XDB_TYPE_VCHAR,	"info"),
+};
+
 int main (int argc, char **argv)
 {
 	xdb_res_t	*pRes;
@@ -138,6 +154,28 @@ int main (int argc, char **argv)
 	}
 	xdb_free_result (pRes);
 
+	// Struct mapping
+	printf ("\n=== Struct mapping\n");
+	student_t	students[8] = {{8, "Lily", 11, 93, "new student"}, {9, "Mike", 12, 88, NULL}};
+	xdb_stmt_t	*pStmt = xdb_stmt_prepare (pConn, "INSERT INTO student (id,name,age,score,info) VALUES (?,?,?,?,?)");
+	if (NULL != pStmt) {
+		xdb_stmt_map_struct (pStmt, s_student_flds, sizeof(s_student_flds)/sizeof(s_student_flds[0]), sizeof (student_t));
+		pRes = xdb_insert_struct (pStmt, students, 2);
+		printf ("  insert %d rows\n", xdb_affected_rows(pRes));
+		xdb_stmt_close (pStmt);
+	}
+	pStmt = xdb_stmt_prepare (pConn, "SELECT * FROM student WHERE age > ?");
+	if (NULL != pStmt) {
+		xdb_stmt_map_struct (pStmt, s_student_flds, sizeof(s_student_flds)/sizeof(s_student_flds[0]), sizeof (student_t));
+		pRes = xdb_stmt_bexec (pStmt, 10);
+		int count = xdb_fetch_structs (pRes, students, sizeof(students)/sizeof(students[0]));
+		for (int i = 0; i < count; ++i) {
+			printf ("  id=%d name='%s' age=%d score=%f info='%s'\n", students[i].id, students[i].name, students[i].age, students[i].score, students[i].info ? students[i].info : "");
+		}
+		xdb_free_result (pRes);
+		xdb_stmt_close (pStmt);
+	}
+
 	// Multi-Statements
 	printf ("\n=== Muti-Statements\n");
 	pRes = xdb_exec (pConn, "SELECT COUNT(*) FROM student; SELECT id,name FROM student WHERE id=2");
@@ -12,9 +12,12 @@
 #ifndef __CROSS_DB_H__
 #define __CROSS_DB_H__
 
+#ifndef _GNU_SOURCE
 #define _GNU_SOURCE
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
@@ -197,6 +200,21 @@ xdb_column_id (xdb_res_t *pRes, const char *name);
 xdb_row_t*
 xdb_fetch_row (xdb_res_t *pRes);
 
+/*
+ * Raw buffer of remaining rows for language bindings, rows are consumed and buffer is valid until xdb_free_result.
+ * Each row is uint32 row length (including the length itself) followed by row data.
+ */
+const void*
+xdb_fetch_rowbuf (xdb_res_t *pRes, uint64_t *pLen);
+
+/*
+ * Row data layout: pLayout[0] row size (VARCHAR data follows at row size + offset in column),
+ * pLayout[1] NULL bitmap offset (0 no bitmap, bit set means not NULL), pLayout[2 + i] column i offset.
+ * Return column count.
+ */
+int
+xdb_result_layout (xdb_res_t *pRes, int32_t *pLayout, int size);
+
 xdb_rowid
 xdb_row_count (xdb_res_t *pRes);
 
@@ -242,6 +260,28 @@ xdb_column_mac (xdb_res_t *pRes, xdb_row_t *pRow, uint16_t iCol);
 const xdb_inet_t*
 xdb_column_inet (xdb_res_t *pRes, xdb_row_t *pRow, uint16_t iCol);
 
+/*
+ * Column buffer for xdb_fetch_cols, one per result column, column is skipped if pData is NULL.
+ * Fixed size column: pData holds max_rows values of column C type (BOOL 1 byte, TIMESTAMP int64, INET/MAC raw).
+ * CHAR/BINARY/VARCHAR/VARBINARY/JSON: pData holds data_cap bytes, pOffs holds max_rows + 1 offsets.
+ * pNull is optional, 1 byte per row, 1 means NULL.
+ */
+typedef struct {
+	void		*pData;
+	uint32_t	*pOffs;
+	uint8_t		*pNull;
+	uint32_t	data_cap;
+	uint32_t	rsvd;
+} xdb_colbuf_t;
+
+/*
+ * Fetch up to max_rows rows (0 means all) into column buffers, fetched rows are consumed like xdb_fetch_row.
+ * Return fetched row count, 0 means no more rows, fewer rows are returned when var data buffer is full,
+ * -XDB_E_MEMORY if first row doesn't fit.
+ */
+int
+xdb_fetch_cols (xdb_res_t *pRes, uint32_t max_rows, xdb_colbuf_t *pBufs);
+
 #if 0
 const void*
 xdb_column_array (xdb_res_t *pRes, xdb_row_t *pRow, uint16_t iCol);
@@ -290,6 +330,55 @@ const xdb_inet_t*
 xdb_col_inet (xdb_res_t *pRes, xdb_row_t *pRow, const char *name);
 
 
+/**************************************
+ Arrow Export
+***************************************/
+
+// Apache Arrow C Data Interface, https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED	1
+#define ARROW_FLAG_NULLABLE				2
+#define ARROW_FLAG_MAP_KEYS_SORTED		4
+
+struct ArrowSchema {
+	const char			*format;
+	const char			*name;
+	const char			*metadata;
+	int64_t				flags;
+	int64_t				n_children;
+	struct ArrowSchema	**children;
+	struct ArrowSchema	*dictionary;
+	void				(*release)(struct ArrowSchema*);
+	void				*private_data;
+};
+
+struct ArrowArray {
+	int64_t				length;
+	int64_t				null_count;
+	int64_t				offset;
+	int64_t				n_buffers;
+	int64_t				n_children;
+	const void			**buffers;
+	struct ArrowArray	**children;
+	struct ArrowArray	*dictionary;
+	void				(*release)(struct ArrowArray*);
+	void				*private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/*
+ * Export next rows of result as one Arrow struct array, each column is a child array.
+ * max_rows 0 means all remaining rows, exported rows are consumed like xdb_fetch_row.
+ * pSchema can be NULL. Caller owns the exported structs and calls their release.
+ * Returns XDB_OK, pArray->length is 0 when no more rows.
+ */
+xdb_ret
+xdb_fetch_arrow (xdb_res_t *pRes, uint32_t max_rows, struct ArrowSchema *pSchema, struct ArrowArray *pArray);
+
+
 /**************************************
  Prepared Statment
 ***************************************/
@@ -351,6 +440,52 @@ xdb_stmt_vbexec_cb (xdb_stmt_t *pStmt, xdb_row_callback callback, void *pArg, va
 #endif
 
 
+/**************************************
+ Struct Mapping
+***************************************/
+
+/*
+ * C struct field mapped to column by name, use XDB_STRUCT_FIELD to fill.
+ * type is C field type: integer types, BOOL, TIMESTAMP, FLOAT and DOUBLE are native C values,
+ * CHAR is NUL-terminated char array, BINARY is byte array (zero padded on fetch),
+ * VCHAR is const char* (points into result row on fetch, valid until xdb_free_result),
+ * INET and MAC are xdb_inet_t and xdb_mac_t. NULL column is fetched as zero.
+ * Use XDB_STRUCT_NULL to map a bool null indicator of column: true inserts NULL, fetch sets it when NULL.
+ */
+typedef struct {
+	const char	*col_name;
+	uint16_t	type;		// xdb_type_t of C field
+	uint16_t	len;		// C field size
+	uint32_t	off;		// C field offset
+} xdb_struct_field_t;
+
+#define XDB_STRUCT_FIELD(stype, member, ftype, name)	\
+	{name, ftype, sizeof(((stype*)0)->member), offsetof(stype, member)}
+
+#define XDB_STRUCT_NULL(stype, member, name)	\
+	XDB_STRUCT_FIELD(stype, member, XDB_TYPE_NULL, name)
+
+/*
+ * Compile struct mapping once for prepared SELECT (result columns) or INSERT/REPLACE (bind parameters).
+ * size is sizeof struct, mapping is freed with statement. Remapping doesn't affect results already
+ * returned, they keep their mapping until xdb_free_result, but must be freed before statement is closed.
+ */
+xdb_ret
+xdb_stmt_map_struct (xdb_stmt_t *pStmt, const xdb_struct_field_t *pFields, int count, uint32_t size);
+
+// Bind and insert count structs with mapped INSERT/REPLACE statement, affected_rows is total
+xdb_res_t*
+xdb_insert_struct (xdb_stmt_t *pStmt, const void *pStructs, int count);
+
+// Fetch next row of mapped SELECT statement, return 1 fetched, 0 no more rows, < 0 error
+int
+xdb_fetch_struct (xdb_res_t *pRes, void *pStruct);
+
+// Fetch up to count rows into struct array, return fetched row count or < 0 error
+int
+xdb_fetch_structs (xdb_res_t *pRes, void *pStructs, int count);
+
+
 /**************************************
  Transaction
 ***************************************/
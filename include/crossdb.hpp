@@ -0,0 +1,437 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * Header-only C++17 API over crossdb.h
+ *
+ *	crossdb::connection conn (":memory:");
+ *	auto stmt = conn.prepare ("SELECT id,name,score FROM student WHERE id=?");
+ *	for (auto [id, name, score] : stmt.query<int, std::string_view, double> (1)) {
+ *		...
+ *	}
+ *
+ * Connection, statement and result own their handles and are move-only.
+ * Typed queries check column types once per statement and then read cells
+ * straight from the result row, std::string_view points into the result and
+ * is valid until the result is destroyed.
+ */
+
+#ifndef __CROSS_DB_HPP__
+#define __CROSS_DB_HPP__
+
+#include <crossdb.h>
+
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace crossdb {
+
+class error : public std::runtime_error {
+public:
+	error (int code, const std::string &msg) : std::runtime_error (msg), code_ (code) {}
+	int code () const noexcept { return code_; }
+private:
+	int		code_;
+};
+
+
+/******************************************************************************
+	Column Reader
+******************************************************************************/
+
+namespace detail {
+
+// layout of typed result: row size, NULL bitmap offset, column offsets, column types
+struct layout {
+	std::vector<int32_t>	info;
+	const std::type_info	*pTypes = nullptr;	// checked std::tuple<Ts...>
+};
+
+enum { ROW_SIZE = 0, NULL_OFF = 1, COL_OFF = 2 };
+
+template <typename T>
+struct column;
+
+template <typename T, xdb_type_t... Types>
+struct fixed_column {
+	static bool check (xdb_type_t type) { return ((type == Types) || ...); }
+	static T read (xdb_res_t *, const uint8_t *pRow, const int32_t *pInfo, int, int i) {
+		T val;
+		memcpy (&val, pRow + pInfo[COL_OFF + i], sizeof (T));
+		return val;
+	}
+};
+
+template <> struct column<bool>		: fixed_column<bool, XDB_TYPE_BOOL> {};
+template <> struct column<int8_t>	: fixed_column<int8_t, XDB_TYPE_TINYINT, XDB_TYPE_BOOL> {};
+template <> struct column<uint8_t>	: fixed_column<uint8_t, XDB_TYPE_UTINYINT> {};
+template <> struct column<int16_t>	: fixed_column<int16_t, XDB_TYPE_SMALLINT> {};
+template <> struct column<uint16_t>	: fixed_column<uint16_t, XDB_TYPE_USMALLINT> {};
+template <> struct column<int32_t>	: fixed_column<int32_t, XDB_TYPE_INT> {};
+template <> struct column<uint32_t>	: fixed_column<uint32_t, XDB_TYPE_UINT> {};
+template <> struct column<int64_t>	: fixed_column<int64_t, XDB_TYPE_BIGINT, XDB_TYPE_TIMESTAMP> {};
+template <> struct column<uint64_t>	: fixed_column<uint64_t, XDB_TYPE_UBIGINT> {};
+template <> struct column<float>	: fixed_column<float, XDB_TYPE_FLOAT> {};
+template <> struct column<double>	: fixed_column<double, XDB_TYPE_DOUBLE> {};
+
+template <>
+struct column<std::string_view> {
+	static bool check (xdb_type_t type) {
+		return (XDB_TYPE_CHAR == type) || (XDB_TYPE_BINARY == type) || (XDB_TYPE_VCHAR == type)
+				|| (XDB_TYPE_VBINARY == type) || (XDB_TYPE_JSON == type);
+	}
+	static std::string_view read (xdb_res_t *pRes, const uint8_t *pRow, const int32_t *pInfo, int col_count, int i) {
+		// CHAR/BINARY: uint16 length before value
+		if (pInfo[COL_OFF + col_count + i] <= XDB_TYPE_BINARY) {
+			uint16_t len;
+			memcpy (&len, pRow + pInfo[COL_OFF + i] - 2, sizeof (len));
+			return std::string_view ((const char*)pRow + pInfo[COL_OFF + i], len);
+		}
+		int len = 0;
+		const char *pStr = xdb_column_str2 (pRes, (xdb_row_t*)pRow, i, &len);
+		return (nullptr != pStr) ? std::string_view (pStr, len) : std::string_view ();
+	}
+};
+
+template <>
+struct column<std::string> {
+	static bool check (xdb_type_t type) { return column<std::string_view>::check (type); }
+	static std::string read (xdb_res_t *pRes, const uint8_t *pRow, const int32_t *pInfo, int col_count, int i) {
+		return std::string (column<std::string_view>::read (pRes, pRow, pInfo, col_count, i));
+	}
+};
+
+template <typename T>
+struct column<std::optional<T>> {
+	static bool check (xdb_type_t type) { return column<T>::check (type); }
+	static std::optional<T> read (xdb_res_t *pRes, const uint8_t *pRow, const int32_t *pInfo, int col_count, int i) {
+		return column<T>::read (pRes, pRow, pInfo, col_count, i);
+	}
+};
+
+// NULL reads as T{}, which is empty for std::optional
+template <typename T>
+inline T read_cell (xdb_res_t *pRes, const uint8_t *pRow, const int32_t *pInfo, int col_count, int i)
+{
+	int32_t null_off = pInfo[NULL_OFF];
+	if ((0 != null_off) && !(pRow[null_off + (i >> 3)] & (1 << (i & 7)))) {
+		return T{};
+	}
+	return column<T>::read (pRes, pRow, pInfo, col_count, i);
+}
+
+template <typename... Ts, size_t... Is>
+inline std::tuple<Ts...> read_row (xdb_res_t *pRes, const uint8_t *pRow, const int32_t *pInfo, int col_count, std::index_sequence<Is...>)
+{
+	return std::tuple<Ts...> (read_cell<Ts> (pRes, pRow, pInfo, col_count, (int)Is)...);
+}
+
+template <typename... Ts, size_t... Is>
+inline void check_types (xdb_res_t *pRes, std::index_sequence<Is...>)
+{
+	bool ok[] = {true, column<Ts>::check (xdb_column_type (pRes, (uint16_t)Is))...};
+	for (size_t i = 0; i < sizeof...(Ts); ++i) {
+		if (!ok[i + 1]) {
+			throw error (XDB_E_PARAM, std::string ("column '") + xdb_column_name (pRes, (uint16_t)i)
+							+ "' type " + xdb_type2str (xdb_column_type (pRes, (uint16_t)i)) + " doesn't match");
+		}
+	}
+}
+
+// check column count and types of result against Ts, layout is reused while Ts don't change
+template <typename... Ts>
+inline void check_layout (xdb_res_t *pRes, layout &lay)
+{
+	if (lay.pTypes == &typeid (std::tuple<Ts...>)) {
+		return;
+	}
+	int col_count = xdb_column_count (pRes);
+	if (col_count < (int)sizeof...(Ts)) {
+		throw error (XDB_E_PARAM, "query returns " + std::to_string (col_count) + " columns < " + std::to_string (sizeof...(Ts)));
+	}
+	check_types<Ts...> (pRes, std::index_sequence_for<Ts...>{});
+	lay.info.resize (COL_OFF + col_count * 2);
+	xdb_result_layout (pRes, lay.info.data(), COL_OFF + col_count);
+	for (int i = 0; i < col_count; ++i) {
+		lay.info[COL_OFF + col_count + i] = xdb_column_type (pRes, (uint16_t)i);
+	}
+	lay.pTypes = &typeid (std::tuple<Ts...>);
+}
+
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, bool val)			{ return xdb_bind_int (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, int32_t val)		{ return xdb_bind_int (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, uint32_t val)		{ return xdb_bind_uint (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, int64_t val)		{ return xdb_bind_int64 (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, uint64_t val)		{ return xdb_bind_uint64 (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, double val)		{ return xdb_bind_double (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, std::string_view val)	{ return xdb_bind_str2 (pStmt, id, val.data(), (int)val.size()); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, const char *val)	{ return xdb_bind_str (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, const std::string &val)	{ return xdb_bind_str2 (pStmt, id, val.data(), (int)val.size()); }
+
+template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && (sizeof(T) < 4)>>
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, T val)				{ return xdb_bind_int (pStmt, id, val); }
+inline xdb_ret bind (xdb_stmt_t *pStmt, uint16_t id, float val)			{ return xdb_bind_double (pStmt, id, val); }
+
+} // namespace detail
+
+
+/******************************************************************************
+	Result
+******************************************************************************/
+
+class row {
+public:
+	row (xdb_res_t *pRes, xdb_row_t *pRow) : pRes_ (pRes), pRow_ (pRow) {}
+
+	bool		is_null (uint16_t i) const			{ return xdb_column_null (pRes_, pRow_, i); }
+	int64_t		get_int64 (uint16_t i) const		{ return xdb_column_int64 (pRes_, pRow_, i); }
+	int			get_int (uint16_t i) const			{ return xdb_column_int (pRes_, pRow_, i); }
+	double		get_double (uint16_t i) const		{ return xdb_column_double (pRes_, pRow_, i); }
+	bool		get_bool (uint16_t i) const			{ return xdb_column_bool (pRes_, pRow_, i); }
+	std::string_view get_str (uint16_t i) const {
+		int len = 0;
+		const char *pStr = xdb_column_str2 (pRes_, pRow_, i, &len);
+		return (nullptr != pStr) ? std::string_view (pStr, len) : std::string_view ();
+	}
+	xdb_row_t*	handle () const						{ return pRow_; }
+
+private:
+	xdb_res_t	*pRes_;
+	xdb_row_t	*pRow_;
+};
+
+// Move-only result, rows are fetched once by iteration
+class result {
+public:
+	result () = default;
+	explicit result (xdb_res_t *pRes) : pRes_ (pRes) {
+		if ((nullptr != pRes_) && (XDB_OK != xdb_errcode (pRes_))) {
+			error err (xdb_errcode (pRes_), xdb_errmsg (pRes_));
+			xdb_free_result (pRes_);
+			throw err;
+		}
+	}
+	~result () { xdb_free_result (pRes_); }
+	result (result &&other) noexcept : pRes_ (std::exchange (other.pRes_, nullptr)) {}
+	result& operator= (result &&other) noexcept {
+		if (this != &other) {
+			xdb_free_result (pRes_);
+			pRes_ = std::exchange (other.pRes_, nullptr);
+		}
+		return *this;
+	}
+	result (const result&) = delete;
+	result& operator= (const result&) = delete;
+
+	xdb_rowid	affected_rows () const	{ return xdb_affected_rows (pRes_); }
+	xdb_rowid	row_count () const		{ return xdb_row_count (pRes_); }
+	int			column_count () const	{ return xdb_column_count (pRes_); }
+	const char*	column_name (uint16_t i) const	{ return xdb_column_name (pRes_, i); }
+	xdb_type_t	column_type (uint16_t i) const	{ return xdb_column_type (pRes_, i); }
+	xdb_res_t*	handle () const			{ return pRes_; }
+
+	std::optional<row> fetch () {
+		xdb_row_t *pRow = xdb_fetch_row (pRes_);
+		return (nullptr != pRow) ? std::optional<row> (row (pRes_, pRow)) : std::nullopt;
+	}
+
+	class iterator {
+	public:
+		iterator (xdb_res_t *pRes) : pRes_ (pRes), pRow_ (pRes ? xdb_fetch_row (pRes) : nullptr) {}
+		row			operator* () const { return row (pRes_, pRow_); }
+		iterator&	operator++ () { pRow_ = xdb_fetch_row (pRes_); return *this; }
+		bool		operator!= (const iterator &other) const { return pRow_ != other.pRow_; }
+	private:
+		xdb_res_t	*pRes_;
+		xdb_row_t	*pRow_;
+	};
+	iterator begin () { return iterator (pRes_); }
+	iterator end () { return iterator (nullptr); }
+
+protected:
+	xdb_res_t	*pRes_ = nullptr;
+};
+
+// Move-only result with compile-time column types, rows are std::tuple<Ts...>
+// Result of prepared statement must not outlive the statement
+template <typename... Ts>
+class typed_result : public result {
+public:
+	typed_result (result &&res, const int32_t *pInfo) : result (std::move (res)), pInfo_ (pInfo) {}
+	typed_result (result &&res, std::vector<int32_t> &&info) : result (std::move (res)), info_ (std::move (info)), pInfo_ (info_.data()) {}
+
+	std::optional<std::tuple<Ts...>> fetch () {
+		xdb_row_t *pRow = xdb_fetch_row (pRes_);
+		if (nullptr == pRow) {
+			return std::nullopt;
+		}
+		return detail::read_row<Ts...> (pRes_, (const uint8_t*)pRow, pInfo_, column_count(), std::index_sequence_for<Ts...>{});
+	}
+
+	class iterator {
+	public:
+		iterator (xdb_res_t *pRes, const int32_t *pInfo)
+			: pRes_ (pRes), pInfo_ (pInfo), pRow_ (pRes ? xdb_fetch_row (pRes) : nullptr), col_count_ (pRes ? xdb_column_count (pRes) : 0) {}
+		std::tuple<Ts...> operator* () const {
+			return detail::read_row<Ts...> (pRes_, (const uint8_t*)pRow_, pInfo_, col_count_, std::index_sequence_for<Ts...>{});
+		}
+		iterator&	operator++ () { pRow_ = xdb_fetch_row (pRes_); return *this; }
+		bool		operator!= (const iterator &other) const { return pRow_ != other.pRow_; }
+	private:
+		xdb_res_t		*pRes_;
+		const int32_t	*pInfo_;
+		xdb_row_t		*pRow_;
+		int				col_count_;
+	};
+	iterator begin () { return iterator (pRes_, pInfo_); }
+	iterator end () { return iterator (nullptr, nullptr); }
+
+private:
+	std::vector<int32_t>	info_;	// own layout if not from statement, moved vector keeps its data
+	const int32_t			*pInfo_;
+};
+
+
+/******************************************************************************
+	Statement
+******************************************************************************/
+
+class statement {
+public:
+	statement () = default;
+	explicit statement (xdb_stmt_t *pStmt) : pStmt_ (pStmt) {}
+	~statement () { close (); }
+	statement (statement &&other) noexcept : pStmt_ (std::exchange (other.pStmt_, nullptr)), lay_ (std::move (other.lay_)) {}
+	statement& operator= (statement &&other) noexcept {
+		if (this != &other) {
+			close ();
+			pStmt_ = std::exchange (other.pStmt_, nullptr);
+			lay_ = std::move (other.lay_);
+		}
+		return *this;
+	}
+	statement (const statement&) = delete;
+	statement& operator= (const statement&) = delete;
+
+	void close () {
+		if (nullptr != pStmt_) {
+			xdb_stmt_close (pStmt_);
+			pStmt_ = nullptr;
+		}
+	}
+
+	// bind parameters by position and execute
+	template <typename... Args>
+	result exec (const Args&... args) {
+		bind_all (std::index_sequence_for<Args...>{}, args...);
+		return result (xdb_stmt_exec (pStmt_));
+	}
+
+	// column types are checked on first query and cached for this statement
+	template <typename... Ts, typename... Args>
+	typed_result<Ts...> query (const Args&... args) {
+		result res = exec (args...);
+		if (nullptr != res.handle()) {
+			detail::check_layout<Ts...> (res.handle(), lay_);
+		}
+		return typed_result<Ts...> (std::move (res), lay_.info.data());
+	}
+
+	xdb_stmt_t* handle () const { return pStmt_; }
+
+private:
+	template <size_t... Is, typename... Args>
+	void bind_all (std::index_sequence<Is...>, const Args&... args) {
+		xdb_ret rc[] = {XDB_OK, detail::bind (pStmt_, (uint16_t)(Is + 1), args)...};
+		for (size_t i = 1; i < sizeof (rc) / sizeof (rc[0]); ++i) {
+			if (XDB_OK != rc[i]) {
+				throw error (-rc[i], "Can't bind parameter " + std::to_string (i));
+			}
+		}
+	}
+
+	xdb_stmt_t		*pStmt_ = nullptr;
+	detail::layout	lay_;
+};
+
+
+/******************************************************************************
+	Connection
+******************************************************************************/
+
+class connection {
+public:
+	explicit connection (const char *path) : pConn_ (xdb_open (path)) {
+		if (nullptr == pConn_) {
+			throw error (XDB_ERROR, std::string ("Can't open ") + path);
+		}
+	}
+	~connection () {
+		if (nullptr != pConn_) {
+			xdb_close (pConn_);
+		}
+	}
+	connection (connection &&other) noexcept : pConn_ (std::exchange (other.pConn_, nullptr)) {}
+	connection& operator= (connection &&other) noexcept {
+		if (this != &other) {
+			if (nullptr != pConn_) {
+				xdb_close (pConn_);
+			}
+			pConn_ = std::exchange (other.pConn_, nullptr);
+		}
+		return *this;
+	}
+	connection (const connection&) = delete;
+	connection& operator= (const connection&) = delete;
+
+	result exec (const char *sql) { return result (xdb_exec (pConn_, sql)); }
+	result exec (const std::string &sql) { return result (xdb_exec2 (pConn_, sql.data(), (int)sql.size())); }
+
+	// column types are checked for each call, prepare statement to check once
+	template <typename... Ts>
+	typed_result<Ts...> query (const char *sql) {
+		result			res = exec (sql);
+		detail::layout	lay;
+		if (nullptr != res.handle()) {
+			detail::check_layout<Ts...> (res.handle(), lay);
+		}
+		return typed_result<Ts...> (std::move (res), std::move (lay.info));
+	}
+
+	statement prepare (const char *sql) {
+		xdb_stmt_t *pStmt = xdb_stmt_prepare (pConn_, sql);
+		if (nullptr == pStmt) {
+			throw error (XDB_E_STMT, std::string ("Can't prepare '") + sql + "'");
+		}
+		return statement (pStmt);
+	}
+
+	void begin () { xdb_begin (pConn_); }
+	void commit () { xdb_commit (pConn_); }
+	void rollback () { xdb_rollback (pConn_); }
+
+	xdb_conn_t* handle () const { return pConn_; }
+
+private:
+	xdb_conn_t		*pConn_;
+};
+
+} // namespace crossdb
+
+#endif // __CROSS_DB_HPP__
@@ -61,7 +61,7 @@ JNIEXPORT jint JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnInt
         (JNIEnv *env, jclass clazz,  jlong res, jlong row, jint colNum){
     xdb_res_t	*pRes = reinterpret_cast<xdb_res_t *>(res);
     xdb_row_t	*pRow = reinterpret_cast<xdb_row_t *>(row);
-    return xdb_column_int (pRes->col_meta, pRow, colNum);
+    return xdb_column_int (pRes, pRow, colNum);
 }
 
 
@@ -69,7 +69,7 @@ JNIEXPORT jstring JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnStr
         (JNIEnv *env, jclass clazz,  jlong res, jlong row, jint colNum){
     xdb_res_t	*pRes = reinterpret_cast<xdb_res_t *>(res);
     xdb_row_t	*pRow = reinterpret_cast<xdb_row_t *>(row);
-    return (env)->NewStringUTF(xdb_column_str(pRes->col_meta, pRow, colNum));
+    return (env)->NewStringUTF(xdb_column_str(pRes, pRow, colNum));
 }
 
 
@@ -77,7 +77,158 @@ JNIEXPORT jfloat JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnFloa
         (JNIEnv *env, jclass clazz,  jlong res, jlong row, jint colNum){
     xdb_res_t	*pRes = reinterpret_cast<xdb_res_t *>(res);
     xdb_row_t	*pRow = reinterpret_cast<xdb_row_t *>(row);
-    return  xdb_column_float(pRes->col_meta, pRow, colNum);
+    return  xdb_column_float(pRes, pRow, colNum);
+}
+
+
+JNIEXPORT void JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniFreeResult
+        (JNIEnv *env, jclass clazz,  jlong res){
+    xdb_free_result(reinterpret_cast<xdb_res_t *>(res));
+}
+
+
+// Remaining rows as direct ByteBuffer in native byte order, valid until jniFreeResult
+JNIEXPORT jobject JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniFetchRowBuffer
+        (JNIEnv *env, jclass clazz,  jlong res){
+    xdb_res_t	*pRes = reinterpret_cast<xdb_res_t *>(res);
+    uint64_t    len;
+    const void  *pBuf = xdb_fetch_rowbuf (pRes, &len);
+    if (NULL == pBuf) {
+        return NULL;
+    }
+    return env->NewDirectByteBuffer(const_cast<void *>(pBuf), len);
+}
+
+
+// {col_count, row_size, null_off, col_type[0], col_off[0], col_type[1], col_off[1], ...}
+JNIEXPORT jintArray JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniResultLayout
+        (JNIEnv *env, jclass clazz,  jlong res){
+    xdb_res_t	*pRes = reinterpret_cast<xdb_res_t *>(res);
+    int         col_count = xdb_column_count (pRes);
+    if (col_count <= 0) {
+        return NULL;
+    }
+    jint        *pLayout = new jint[3 + col_count * 2];
+    int32_t     *pOff = new int32_t[2 + col_count];
+    xdb_result_layout (pRes, pOff, 2 + col_count);
+    pLayout[0] = col_count;
+    pLayout[1] = pOff[0];
+    pLayout[2] = pOff[1];
+    for (int i = 0; i < col_count; ++i) {
+        pLayout[3 + i * 2] = xdb_column_type (pRes, i);
+        pLayout[4 + i * 2] = pOff[2 + i];
+    }
+    jintArray layout = env->NewIntArray(3 + col_count * 2);
+    env->SetIntArrayRegion(layout, 0, 3 + col_count * 2, pLayout);
+    delete[] pOff;
+    delete[] pLayout;
+    return layout;
+}
+
+
+JNIEXPORT jstring JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnName
+        (JNIEnv *env, jclass clazz,  jlong res, jint colNum){
+    return (env)->NewStringUTF(xdb_column_name(reinterpret_cast<xdb_res_t *>(res), colNum));
+}
+
+
+JNIEXPORT jlong JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtPrepare
+        (JNIEnv *env, jclass clazz, jlong conn, jstring sql){
+    const char *c_sql = env->GetStringUTFChars(sql, NULL);
+    xdb_stmt_t  *pStmt = xdb_stmt_prepare (reinterpret_cast<xdb_conn_t *>(conn), c_sql);
+    env->ReleaseStringUTFChars(sql, c_sql);
+    return reinterpret_cast<jlong>(pStmt);
+}
+
+
+// Return error message if parameter arrays don't cover every row or a string is null, else NULL
+static const char *
+jniBatchCheck (JNIEnv *env, jint rows, jint para_count, const jbyte *pTypes,
+               jlongArray longs, jdoubleArray doubles, jobjectArray strs){
+    jlong total = (jlong)rows * para_count;
+    for (jint p = 0; p < para_count; ++p) {
+        jarray arr = ('D' == pTypes[p]) ? (jarray)doubles : ('S' == pTypes[p]) ? (jarray)strs : (jarray)longs;
+        if ((NULL == arr) || (env->GetArrayLength(arr) < total)) {
+            return "parameter array is null or shorter than rows * types.length";
+        }
+    }
+    for (jlong idx = 0; idx < total; ++idx) {
+        if ('S' == pTypes[idx % para_count]) {
+            jobject str = env->GetObjectArrayElement(strs, (jsize)idx);
+            if (NULL == str) {
+                return "null string parameter, NULL can't be bound";
+            }
+            env->DeleteLocalRef(str);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Execute prepared statement once per parameter row in one JNI call.
+ * Parameter p of row r is at index r * types.length + p of the array selected by types[p]:
+ * 'J' longs, 'D' doubles, 'S' strings. Return total affected rows or negative error code.
+ * Parameters are checked before any row is executed, bad ones throw IllegalArgumentException.
+ */
+JNIEXPORT jlong JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtExecBatch
+        (JNIEnv *env, jclass clazz, jlong stmt, jint rows, jbyteArray types,
+         jlongArray longs, jdoubleArray doubles, jobjectArray strs){
+    xdb_stmt_t  *pStmt = reinterpret_cast<xdb_stmt_t *>(stmt);
+    if ((NULL == types) || (rows < 0)) {
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "types is null or rows is negative");
+        return -XDB_E_PARAM;
+    }
+    jint        para_count = env->GetArrayLength(types);
+    jbyte       *pTypes = env->GetByteArrayElements(types, NULL);
+    const char  *err = jniBatchCheck (env, rows, para_count, pTypes, longs, doubles, strs);
+    if (NULL != err) {
+        env->ReleaseByteArrayElements(types, pTypes, JNI_ABORT);
+        env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), err);
+        return -XDB_E_PARAM;
+    }
+    jlong       *pLongs = (NULL != longs) ? env->GetLongArrayElements(longs, NULL) : NULL;
+    jdouble     *pDoubles = (NULL != doubles) ? env->GetDoubleArrayElements(doubles, NULL) : NULL;
+    jlong       affected = 0;
+
+    for (jint r = 0; r < rows; ++r) {
+        for (jint p = 0; p < para_count; ++p) {
+            jint idx = r * para_count + p;
+            if ('D' == pTypes[p]) {
+                xdb_bind_double (pStmt, p + 1, pDoubles[idx]);
+            } else if ('S' == pTypes[p]) {
+                jstring str = (jstring)env->GetObjectArrayElement(strs, idx);
+                const char *c_str = env->GetStringUTFChars(str, NULL);
+                xdb_bind_str2 (pStmt, p + 1, c_str, env->GetStringUTFLength(str));
+                env->ReleaseStringUTFChars(str, c_str);
+                env->DeleteLocalRef(str);
+            } else {
+                xdb_bind_int64 (pStmt, p + 1, pLongs[idx]);
+            }
+        }
+        xdb_res_t *pRes = xdb_stmt_exec (pStmt);
+        if (xdb_errcode (pRes) != XDB_OK) {
+            affected = -xdb_errcode (pRes);
+            xdb_free_result (pRes);
+            break;
+        }
+        affected += xdb_affected_rows (pRes);
+        xdb_free_result (pRes);
+    }
+
+    env->ReleaseByteArrayElements(types, pTypes, JNI_ABORT);
+    if (NULL != pLongs) {
+        env->ReleaseLongArrayElements(longs, pLongs, JNI_ABORT);
+    }
+    if (NULL != pDoubles) {
+        env->ReleaseDoubleArrayElements(doubles, pDoubles, JNI_ABORT);
+    }
+    return affected;
+}
+
+
+JNIEXPORT void JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtClose
+        (JNIEnv *env, jclass clazz, jlong stmt){
+    xdb_stmt_close(reinterpret_cast<xdb_stmt_t *>(stmt));
 }
 
 
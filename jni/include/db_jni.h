@@ -79,6 +79,62 @@ JNIEXPORT jstring JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnStr
 JNIEXPORT jfloat JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnFloat
         (JNIEnv *, jclass, jlong, jlong, jint);
 
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniFreeResult
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniFreeResult
+        (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniFetchRowBuffer
+ * Signature: (J)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniFetchRowBuffer
+        (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniResultLayout
+ * Signature: (J)[I
+ */
+JNIEXPORT jintArray JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniResultLayout
+        (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniColumnName
+ * Signature: (JI)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniColumnName
+        (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniStmtPrepare
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtPrepare
+        (JNIEnv *, jclass, jlong, jstring);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniStmtExecBatch
+ * Signature: (JI[B[J[D[Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtExecBatch
+        (JNIEnv *, jclass, jlong, jint, jbyteArray, jlongArray, jdoubleArray, jobjectArray);
+
+/*
+ * Class:     com_open_crossdb_jni_core_CrossDBJNI
+ * Method:    jniStmtClose
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_open_crossdb_jni_core_CrossDBJNI_jniStmtClose
+        (JNIEnv *, jclass, jlong);
+
 /*
  * Class:     com_open_crossdb_jni_core_CrossDBJNI
  * Method:    jniClose
@@ -0,0 +1,159 @@
+package com.open.crossdb.jni.bench;
+
+import com.open.crossdb.jni.core.CrossDBJNI;
+import com.open.crossdb.jni.core.RowBuffer;
+
+/**
+ * JMH-style microbenchmark of JNI access paths: warmup then measured iterations of fixed time,
+ * report ops/sec mean and stddev.
+ *   java -Djava.library.path=<lib dir> -cp <classes> com.open.crossdb.jni.bench.CrossDBJNIBench [rows]
+ */
+public class CrossDBJNIBench {
+    private static final int WARMUP_ITERS = 3;
+    private static final int MEASURE_ITERS = 5;
+    private static final long ITER_NS = 1_000_000_000L;
+    private static final int BATCH_ROWS = 1000;
+
+    private static long conn;
+    private static int rowCount = 100000;
+    private static int nextId;
+    private static long sink;
+
+    interface Op {
+        // return operations done by one call
+        int run();
+    }
+
+    private static void bench(String name, Op op) {
+        double[] rates = new double[MEASURE_ITERS];
+        for (int iter = -WARMUP_ITERS; iter < MEASURE_ITERS; ++iter) {
+            long ops = 0, start = System.nanoTime(), now;
+            do {
+                ops += op.run();
+                now = System.nanoTime();
+            } while (now - start < ITER_NS);
+            if (iter >= 0) {
+                rates[iter] = ops * 1e9 / (now - start);
+            }
+        }
+        double mean = 0, var = 0;
+        for (double r : rates) {
+            mean += r / MEASURE_ITERS;
+        }
+        for (double r : rates) {
+            var += (r - mean) * (r - mean) / MEASURE_ITERS;
+        }
+        System.out.printf("%-36s %12.0f ops/s  +- %.0f%n", name, mean, Math.sqrt(var));
+    }
+
+    private static String pointQuery() {
+        nextId = (nextId + 7919) % rowCount;
+        return "SELECT * FROM student WHERE id=" + nextId;
+    }
+
+    // one JNI call per column
+    private static int pointPerColumn() {
+        long res = CrossDBJNI.jniXdbExec(conn, pointQuery());
+        long row = CrossDBJNI.jniFetchRow(res);
+        if (row != 0) {
+            sink += CrossDBJNI.jniColumnInt(res, row, 0) + CrossDBJNI.jniColumnStr(res, row, 1).length()
+                    + CrossDBJNI.jniColumnInt(res, row, 2) + CrossDBJNI.jniColumnStr(res, row, 3).length()
+                    + CrossDBJNI.jniColumnInt(res, row, 4);
+        }
+        CrossDBJNI.jniFreeResult(res);
+        return 1;
+    }
+
+    // row decoded from direct ByteBuffer
+    private static int pointRowBuffer() {
+        long res = CrossDBJNI.jniXdbExec(conn, pointQuery());
+        RowBuffer rows = new RowBuffer(res);
+        if (rows.next()) {
+            sink += rows.getInt(0) + rows.getString(1).length() + rows.getInt(2)
+                    + rows.getString(3).length() + rows.getInt(4);
+        }
+        CrossDBJNI.jniFreeResult(res);
+        return 1;
+    }
+
+    private static int scanPerColumn() {
+        long res = CrossDBJNI.jniXdbExec(conn, "SELECT * FROM student");
+        int count = 0;
+        for (long row; (row = CrossDBJNI.jniFetchRow(res)) != 0; ++count) {
+            sink += CrossDBJNI.jniColumnInt(res, row, 0) + CrossDBJNI.jniColumnInt(res, row, 4);
+        }
+        CrossDBJNI.jniFreeResult(res);
+        return count;
+    }
+
+    private static int scanRowBuffer() {
+        long res = CrossDBJNI.jniXdbExec(conn, "SELECT * FROM student");
+        RowBuffer rows = new RowBuffer(res);
+        int count = 0;
+        for (; rows.next(); ++count) {
+            sink += rows.getInt(0) + rows.getInt(4);
+        }
+        CrossDBJNI.jniFreeResult(res);
+        return count;
+    }
+
+    private static int updateExec() {
+        nextId = (nextId + 7919) % rowCount;
+        long res = CrossDBJNI.jniXdbExec(conn, "UPDATE student SET score=" + (nextId % 100) + " WHERE id=" + nextId);
+        CrossDBJNI.jniFreeResult(res);
+        return 1;
+    }
+
+    private static long updStmt;
+    private static final byte[] updTypes = {'J', 'J'};
+    private static final long[] updParas = new long[BATCH_ROWS * 2];
+
+    private static int updateBatch() {
+        for (int r = 0; r < BATCH_ROWS; ++r) {
+            nextId = (nextId + 7919) % rowCount;
+            updParas[r * 2] = nextId % 100;
+            updParas[r * 2 + 1] = nextId;
+        }
+        CrossDBJNI.jniStmtExecBatch(updStmt, BATCH_ROWS, updTypes, updParas, null, null);
+        return BATCH_ROWS;
+    }
+
+    public static void main(String[] args) {
+        if (args.length > 0) {
+            rowCount = Integer.parseInt(args[0]);
+        }
+        conn = CrossDBJNI.jniOpenDB(":memory:");
+        CrossDBJNI.jniFreeResult(CrossDBJNI.jniXdbExec(conn,
+                "CREATE TABLE student (id INT PRIMARY KEY, name CHAR(16), age INT, class CHAR(16), score INT)"));
+
+        long insStmt = CrossDBJNI.jniStmtPrepare(conn, "INSERT INTO student (id,name,age,class,score) VALUES (?,?,?,?,?)");
+        byte[] insTypes = {'J', 'S', 'J', 'S', 'J'};
+        long[] longs = new long[rowCount * 5];
+        String[] strs = new String[rowCount * 5];
+        for (int id = 0; id < rowCount; ++id) {
+            longs[id * 5] = id;
+            strs[id * 5 + 1] = "jack" + id;
+            longs[id * 5 + 2] = 10 + id % 10;
+            strs[id * 5 + 3] = "class" + id % 3;
+            longs[id * 5 + 4] = 90 + id % 10;
+        }
+        CrossDBJNI.jniBegin(conn);
+        long inserted = CrossDBJNI.jniStmtExecBatch(insStmt, rowCount, insTypes, longs, null, strs);
+        CrossDBJNI.jniCommit(conn);
+        CrossDBJNI.jniStmtClose(insStmt);
+        System.out.printf("Insert %d rows%n", inserted);
+
+        updStmt = CrossDBJNI.jniStmtPrepare(conn, "UPDATE student SET score=? WHERE id=?");
+
+        bench("point query, JNI per column", CrossDBJNIBench::pointPerColumn);
+        bench("point query, ByteBuffer rows", CrossDBJNIBench::pointRowBuffer);
+        bench("scan rows, JNI per column", CrossDBJNIBench::scanPerColumn);
+        bench("scan rows, ByteBuffer rows", CrossDBJNIBench::scanRowBuffer);
+        bench("update, exec per row", CrossDBJNIBench::updateExec);
+        bench("update, prepared batch", CrossDBJNIBench::updateBatch);
+
+        CrossDBJNI.jniStmtClose(updStmt);
+        CrossDBJNI.jniClose(conn);
+        System.out.println(sink == 42 ? "" : "done");
+    }
+}
@@ -0,0 +1,47 @@
+package com.open.crossdb.jni.core;
+
+import java.nio.ByteBuffer;
+
+// Native methods of db_jni.cpp, include/db_jni.h is generated from this class by javac -h
+public class CrossDBJNI {
+    static {
+        System.loadLibrary("crossdbjni-win64");
+    }
+
+    public static native long jniOpenDB(String path);
+
+    public static native int jniBegin(long conn);
+
+    public static native int jniCommit(long conn);
+
+    public static native int jniRollback(long conn);
+
+    public static native long jniXdbExec(long conn, String sql);
+
+    public static native long jniFetchRow(long res);
+
+    public static native int jniColumnInt(long res, long row, int colNum);
+
+    public static native String jniColumnStr(long res, long row, int colNum);
+
+    public static native float jniColumnFloat(long res, long row, int colNum);
+
+    public static native void jniFreeResult(long res);
+
+    // Remaining rows of result in native byte order, valid until jniFreeResult, decode with RowBuffer
+    public static native ByteBuffer jniFetchRowBuffer(long res);
+
+    // {col_count, row_size, null_off, col_type[0], col_off[0], col_type[1], col_off[1], ...}
+    public static native int[] jniResultLayout(long res);
+
+    public static native String jniColumnName(long res, int colNum);
+
+    public static native long jniStmtPrepare(long conn, String sql);
+
+    // Parameter p of row r is at index r * types.length + p of longs ('J'), doubles ('D') or strs ('S')
+    public static native long jniStmtExecBatch(long stmt, int rows, byte[] types, long[] longs, double[] doubles, String[] strs);
+
+    public static native void jniStmtClose(long stmt);
+
+    public static native int jniClose(long conn);
+}
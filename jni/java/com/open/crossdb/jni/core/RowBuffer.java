@@ -0,0 +1,161 @@
+package com.open.crossdb.jni.core;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Decode result rows from the native row buffer without JNI call per column.
+ * Fetches all remaining rows of result, the buffer is valid until jniFreeResult.
+ */
+public final class RowBuffer {
+    public static final int XDB_TYPE_TINYINT   = 1;
+    public static final int XDB_TYPE_SMALLINT  = 2;
+    public static final int XDB_TYPE_INT       = 3;
+    public static final int XDB_TYPE_BIGINT    = 4;
+    public static final int XDB_TYPE_UTINYINT  = 5;
+    public static final int XDB_TYPE_USMALLINT = 6;
+    public static final int XDB_TYPE_UINT      = 7;
+    public static final int XDB_TYPE_UBIGINT   = 8;
+    public static final int XDB_TYPE_FLOAT     = 9;
+    public static final int XDB_TYPE_DOUBLE    = 10;
+    public static final int XDB_TYPE_TIMESTAMP = 11;
+    public static final int XDB_TYPE_CHAR      = 12;
+    public static final int XDB_TYPE_BINARY    = 13;
+    public static final int XDB_TYPE_VCHAR     = 14;
+    public static final int XDB_TYPE_VBINARY   = 15;
+    public static final int XDB_TYPE_BOOL      = 16;
+    public static final int XDB_TYPE_JSON      = 19;
+
+    private final ByteBuffer buf;
+    private final int colCount;
+    private final int rowSize;
+    private final int nullOff;
+    private final int[] types;
+    private final int[] offs;
+    private int rowPos = -1;
+    private int nextPos = 0;
+
+    public RowBuffer(long res) {
+        int[] layout = CrossDBJNI.jniResultLayout(res);
+        ByteBuffer rows = CrossDBJNI.jniFetchRowBuffer(res);
+        buf = (rows != null ? rows : ByteBuffer.allocateDirect(0)).order(ByteOrder.nativeOrder());
+        colCount = (layout != null) ? layout[0] : 0;
+        rowSize = (layout != null) ? layout[1] : 0;
+        nullOff = (layout != null) ? layout[2] : 0;
+        types = new int[colCount];
+        offs = new int[colCount];
+        for (int i = 0; i < colCount; ++i) {
+            types[i] = layout[3 + i * 2];
+            offs[i] = layout[4 + i * 2];
+        }
+    }
+
+    public int columnCount() {
+        return colCount;
+    }
+
+    public int columnType(int col) {
+        return types[col];
+    }
+
+    // Move to next row, each row is int row length (including itself) followed by row data
+    public boolean next() {
+        if (nextPos >= buf.limit()) {
+            return false;
+        }
+        rowPos = nextPos + 4;
+        nextPos += buf.getInt(nextPos);
+        return true;
+    }
+
+    public boolean isNull(int col) {
+        if (0 == nullOff) {
+            return false;
+        }
+        return (buf.get(rowPos + nullOff + (col >> 3)) & (1 << (col & 7))) == 0;
+    }
+
+    public long getLong(int col) {
+        int pos = rowPos + offs[col];
+        switch (types[col]) {
+        case XDB_TYPE_BOOL:
+        case XDB_TYPE_TINYINT:
+            return buf.get(pos);
+        case XDB_TYPE_UTINYINT:
+            return buf.get(pos) & 0xff;
+        case XDB_TYPE_SMALLINT:
+            return buf.getShort(pos);
+        case XDB_TYPE_USMALLINT:
+            return buf.getShort(pos) & 0xffff;
+        case XDB_TYPE_INT:
+            return buf.getInt(pos);
+        case XDB_TYPE_UINT:
+            return buf.getInt(pos) & 0xffffffffL;
+        case XDB_TYPE_BIGINT:
+        case XDB_TYPE_UBIGINT:
+        case XDB_TYPE_TIMESTAMP:
+            return buf.getLong(pos);
+        case XDB_TYPE_FLOAT:
+        case XDB_TYPE_DOUBLE:
+            return (long)getDouble(col);
+        default:
+            return 0;
+        }
+    }
+
+    public int getInt(int col) {
+        return (int)getLong(col);
+    }
+
+    public boolean getBoolean(int col) {
+        return getLong(col) != 0;
+    }
+
+    public double getDouble(int col) {
+        int pos = rowPos + offs[col];
+        switch (types[col]) {
+        case XDB_TYPE_FLOAT:
+            return buf.getFloat(pos);
+        case XDB_TYPE_DOUBLE:
+            return buf.getDouble(pos);
+        default:
+            return getLong(col);
+        }
+    }
+
+    public float getFloat(int col) {
+        return (float)getDouble(col);
+    }
+
+    // CHAR/BINARY: uint16 length before value; VARCHAR/VARBINARY/JSON: int offset to length + value after fixed row
+    public byte[] getBytes(int col) {
+        int pos = rowPos + offs[col];
+        switch (types[col]) {
+        case XDB_TYPE_CHAR:
+        case XDB_TYPE_BINARY:
+            break;
+        case XDB_TYPE_VCHAR:
+        case XDB_TYPE_VBINARY:
+        case XDB_TYPE_JSON:
+            int voff = buf.getInt(pos);
+            if (0 == voff) {
+                return null;
+            }
+            pos = rowPos + rowSize + voff;
+            break;
+        default:
+            return null;
+        }
+        byte[] val = new byte[buf.getShort(pos - 2) & 0xffff];
+        ByteBuffer dup = buf.duplicate();
+        dup.position(pos);
+        dup.get(val);
+        return val;
+    }
+
+    public String getString(int col) {
+        byte[] val = getBytes(col);
+        return (val != null) ? new String(val, StandardCharsets.UTF_8) : null;
+    }
+}
@@ -0,0 +1,84 @@
+package com.open.crossdb.jni.test;
+
+import com.open.crossdb.jni.core.CrossDBJNI;
+import com.open.crossdb.jni.core.RowBuffer;
+
+/**
+ * Smoke test of JNI entry points: open, exec, query, prepared batch and its argument checks.
+ * Exits with non-zero status on first failure.
+ *   java -Djava.library.path=<lib dir> -cp <classes> com.open.crossdb.jni.test.CrossDBJNITest
+ */
+public class CrossDBJNITest {
+    private static long conn;
+
+    private static void check(boolean ok, String what) {
+        if (!ok) {
+            System.out.println("FAIL: " + what);
+            System.exit(1);
+        }
+        System.out.println("OK:   " + what);
+    }
+
+    private static void exec(String sql) {
+        CrossDBJNI.jniFreeResult(CrossDBJNI.jniXdbExec(conn, sql));
+    }
+
+    private static int count(String where) {
+        long res = CrossDBJNI.jniXdbExec(conn, "SELECT COUNT(*) FROM student" + where);
+        long row = CrossDBJNI.jniFetchRow(res);
+        int cnt = (row != 0) ? CrossDBJNI.jniColumnInt(res, row, 0) : -1;
+        CrossDBJNI.jniFreeResult(res);
+        return cnt;
+    }
+
+    private static boolean batchThrows(long stmt, int rows, byte[] types, long[] longs, String[] strs) {
+        try {
+            CrossDBJNI.jniStmtExecBatch(stmt, rows, types, longs, null, strs);
+        } catch (IllegalArgumentException e) {
+            return true;
+        }
+        return false;
+    }
+
+    public static void main(String[] args) {
+        conn = CrossDBJNI.jniOpenDB(":memory:");
+        check(conn != 0 && conn != -1, "open");
+
+        exec("CREATE TABLE student (id INT PRIMARY KEY, name CHAR(16), age INT, score FLOAT)");
+        exec("INSERT INTO student VALUES (1, 'jack', 10, 90.5), (2, 'rose', 11, 95)");
+        check(count("") == 2, "exec");
+
+        long res = CrossDBJNI.jniXdbExec(conn, "SELECT * FROM student WHERE id=2");
+        long row = CrossDBJNI.jniFetchRow(res);
+        check(row != 0 && "name".equals(CrossDBJNI.jniColumnName(res, 1)), "query row");
+        check("rose".equals(CrossDBJNI.jniColumnStr(res, row, 1)) && CrossDBJNI.jniColumnInt(res, row, 2) == 11
+                && CrossDBJNI.jniColumnFloat(res, row, 3) == 95f, "query columns");
+        check(CrossDBJNI.jniFetchRow(res) == 0, "query end");
+        CrossDBJNI.jniFreeResult(res);
+
+        res = CrossDBJNI.jniXdbExec(conn, "SELECT id,name FROM student");
+        RowBuffer rows = new RowBuffer(res);
+        int sum = 0;
+        while (rows.next()) {
+            sum += rows.getInt(0) + rows.getString(1).length();
+        }
+        CrossDBJNI.jniFreeResult(res);
+        check(sum == 1 + 4 + 2 + 4, "row buffer");
+
+        long stmt = CrossDBJNI.jniStmtPrepare(conn, "INSERT INTO student (id,name,age) VALUES (?,?,?)");
+        byte[] types = {'J', 'S', 'J'};
+        long[] longs = {3, 0, 12, 4, 0, 13};
+        String[] strs = {null, "tom", null, null, "wendy", null};
+        check(CrossDBJNI.jniStmtExecBatch(stmt, 2, types, longs, null, strs) == 2 && count(" WHERE age>=12") == 2, "batch");
+
+        // bad arguments are rejected before any row is executed
+        long[] longs2 = {5, 0, 14, 6, 0, 15};
+        String[] strs2 = {null, "mike", null, null, null, null};
+        check(batchThrows(stmt, 2, types, longs2, strs2) && count("") == 4, "batch null string");
+        check(batchThrows(stmt, 2, types, longs2, null) && count("") == 4, "batch null array");
+        check(batchThrows(stmt, 3, types, longs2, strs2) && count("") == 4, "batch short array");
+        CrossDBJNI.jniStmtClose(stmt);
+
+        CrossDBJNI.jniClose(conn);
+    }
+}
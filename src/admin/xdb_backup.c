@@ -58,7 +58,7 @@ xdb_row2sql (xdb_res_t *pRes, xdb_row_t *pRow, const char *tbl_name, char *buf,
 		case XDB_TYPE_JSON:
 			str = xdb_column_str2 (pRes, pRow, i, &slen);
 			*(buf + len++) = '\'';
-			len += xdb_str_escape (buf+len, str, len);
+			len += xdb_str_escape (buf+len, str, slen);
 			*(buf + len++) = '\'';
 			*(buf + len++) = ',';
 			break;
@@ -102,6 +102,8 @@ xdb_res2sql (FILE *pFile, xdb_res_t *pRes, const char *tbl_name, char *buf, int
 	xdb_row_t	*pRow;
 	while (NULL != (pRow = xdb_fetch_row (pRes))) {
 		int len = xdb_row2sql (pRes, pRow, tbl_name, buf, size);
+		// one statement per line for SOURCE, drop the '\0'
+		buf[len - 1] = '\n';
 		fwrite (buf, 1, len, pFile);
 	}
 	return XDB_OK;
@@ -158,13 +160,225 @@ error:
 	return rc;
 }
 
+/*
+ * SOURCE FAST: consecutive dump rows of one table are merged into multi-row INSERT batches,
+ * a round of batches is parsed and inserted by worker connections in parallel.
+ * Other statements are barriers and run in order on the caller connection.
+ * Table created empty by the dump is bulk loaded: no WAL, indexes are built once at end and then checkpointed.
+ */
+#define XDB_SOURCE_BATCH_ROWS	1000	// INSERT parser takes less than XDB_MAX_COLUMN rows
+#define XDB_SOURCE_BATCH_SIZE	(256*1024)
+
+typedef struct {
+	char			*sql;		// INSERT INTO tbl VALUES (...),(...)
+	int				len;
+	int				cap;
+	int				row_count;
+	int				row_off[XDB_SOURCE_BATCH_ROWS];	// row_off[0] is also prefix length
+	uint64_t		lineno[XDB_SOURCE_BATCH_ROWS];
+} xdb_srcbatch_t;
+
+typedef struct {
+	xdb_conn_t		*pConn;
+	xdb_conn_t		*pConns[XDB_SOURCE_THREADS];
+	xdb_srcbatch_t	batch[XDB_SOURCE_THREADS];
+	int				count;		// closed batches, batch[count] is being filled
+	xdb_tblm_t		*pBulkTblm;
+} xdb_source_t;
+
+XDB_STATIC void 
+xdb_source_job (int id, void *pArg)
+{
+	xdb_source_t	*pSrc = pArg;
+	xdb_srcbatch_t	*pBatch = &pSrc->batch[id];
+	xdb_conn_t		*pConn = pSrc->pConns[id];
+	int				prefix = pBatch->row_off[0];
+
+	xdb_res_t *pRes = xdb_exec2 (pConn, pBatch->sql, pBatch->len);
+	if (xdb_likely (0 == pRes->errcode)) {
+		return;
+	}
+
+	char *sql = (0 == pRes->affected_rows) ? xdb_malloc (pBatch->len + 1) : NULL;
+	if (NULL == sql) {
+		xdb_errlog ("%"PRIu64"-%"PRIu64": '%.*s' ERROR %d : %s\n", pBatch->lineno[0], pBatch->lineno[pBatch->row_count-1], 
+					prefix, pBatch->sql, pRes->errcode, xdb_errmsg(pRes));
+		return;
+	}
+
+	// nothing inserted, run each row alone to find bad lines like plain SOURCE
+	memcpy (sql, pBatch->sql, prefix);
+	for (int i = 0; i < pBatch->row_count; ++i) {
+		int end = (i + 1 < pBatch->row_count) ? pBatch->row_off[i+1] - 1 : pBatch->len;
+		int len = prefix + end - pBatch->row_off[i];
+		memcpy (sql + prefix, pBatch->sql + pBatch->row_off[i], end - pBatch->row_off[i]);
+		sql[len] = '\0';
+		pRes = xdb_exec2 (pConn, sql, len);
+		if (pRes->errcode != 0) {
+			xdb_errlog ("%"PRIu64": '%s' ERROR %d : %s\n", pBatch->lineno[i], sql, pRes->errcode, xdb_errmsg(pRes));
+		}
+	}
+	xdb_free (sql);
+}
+
+XDB_STATIC void 
+xdb_source_run (xdb_source_t *pSrc)
+{
+	if ((pSrc->count < XDB_SOURCE_THREADS) && (pSrc->batch[pSrc->count].row_count > 0)) {
+		pSrc->count++;
+	}
+	if (0 == pSrc->count) {
+		return;
+	}
+
+	int count = 0;
+	for (; count < pSrc->count; ++count) {
+		if (NULL == pSrc->pConns[count]) {
+			pSrc->pConns[count] = xdb_open (NULL);
+			if (NULL == pSrc->pConns[count]) {
+				break;
+			}
+		}
+		pSrc->pConns[count]->pCurDbm = pSrc->pConn->pCurDbm;
+		xdb_strcpy (pSrc->pConns[count]->cur_db, pSrc->pConn->cur_db);
+	}
+	// no connection, run left batches on caller connection
+	for (int i = count; i < pSrc->count; ++i) {
+		pSrc->pConns[i] = pSrc->pConn;
+		xdb_source_job (i, pSrc);
+		pSrc->pConns[i] = NULL;
+	}
+	xdb_run_jobs (count, XDB_SOURCE_THREADS, xdb_source_job, pSrc);
+
+	for (int i = 0; i < pSrc->count; ++i) {
+		pSrc->batch[i].row_count = 0;
+		pSrc->batch[i].len = 0;
+	}
+	pSrc->count = 0;
+}
+
+// run pending batches and finish bulk table before other statement
+XDB_STATIC void 
+xdb_source_sync (xdb_source_t *pSrc)
+{
+	xdb_source_run (pSrc);
+
+	if (NULL != pSrc->pBulkTblm) {
+		xdb_tblm_t *pTblm = pSrc->pBulkTblm;
+		pSrc->pBulkTblm = NULL;
+		xdb_bulkload_end (pSrc->pConn, pTblm);
+		// rows are not in WAL, checkpoint to persist them
+		xdb_flush_db (pTblm->pDbm, 0);
+	}
+}
+
+// dump row form: INSERT INTO tbl VALUES (...)
+XDB_STATIC bool 
+xdb_source_insert (xdb_source_t *pSrc, const char *sql, int len, uint64_t lineno)
+{
+	if (strncmp (sql, "INSERT INTO ", 12)) {
+		return false;
+	}
+	const char *vals = strstr (sql + 12, " VALUES (");
+	if (NULL == vals) {
+		return false;
+	}
+	int prefix = vals + 8 - sql;
+
+	xdb_srcbatch_t *pBatch = &pSrc->batch[pSrc->count];
+	if ((pBatch->row_count > 0) && ((pBatch->row_off[0] != prefix) || memcmp (pBatch->sql, sql, prefix) || 
+			(pBatch->row_count >= XDB_SOURCE_BATCH_ROWS) || (pBatch->len + len - prefix >= XDB_SOURCE_BATCH_SIZE))) {
+		if (++pSrc->count >= XDB_SOURCE_THREADS) {
+			xdb_source_run (pSrc);
+		}
+		pBatch = &pSrc->batch[pSrc->count];
+	}
+
+	int need = pBatch->len + len + 2;
+	if (need > pBatch->cap) {
+		int cap = (need > XDB_SOURCE_BATCH_SIZE) ? need : XDB_SOURCE_BATCH_SIZE + 1024;
+		char *pBuf = xdb_realloc (pBatch->sql, cap);
+		if (NULL == pBuf) {
+			return false;
+		}
+		pBatch->sql = pBuf;
+		pBatch->cap = cap;
+	}
+
+	if (0 == pBatch->row_count) {
+		memcpy (pBatch->sql, sql, prefix);
+		pBatch->len = prefix;
+	} else {
+		pBatch->sql[pBatch->len++] = ',';
+	}
+	pBatch->row_off[pBatch->row_count] = pBatch->len;
+	pBatch->lineno[pBatch->row_count++] = lineno;
+	memcpy (pBatch->sql + pBatch->len, sql + prefix, len - prefix);
+	pBatch->len += len - prefix;
+	pBatch->sql[pBatch->len] = '\0';
+
+	return true;
+}
+
+// get table name of CREATE TABLE [IF NOT EXISTS] name
+XDB_STATIC bool 
+xdb_source_newtbl (const char *sql, char *tbl_name)
+{
+	if (strncasecmp (sql, "CREATE TABLE ", 13)) {
+		return false;
+	}
+	for (sql += 13; ' ' == *sql; ++sql)
+		;
+	if (!strncasecmp (sql, "IF NOT EXISTS ", 14)) {
+		for (sql += 14; ' ' == *sql; ++sql)
+			;
+	}
+	int len = 0;
+	for (; (len < XDB_NAME_LEN) && (isalnum(sql[len]) || ('_' == sql[len])); ++len) {
+		tbl_name[len] = sql[len];
+	}
+	tbl_name[len] = '\0';
+	return (len > 0) && (len < XDB_NAME_LEN);
+}
+
+XDB_STATIC void 
+xdb_source_bulk (xdb_source_t *pSrc, const char *tbl_name)
+{
+	xdb_conn_t *pConn = pSrc->pConn;
+	if (NULL == pConn->pCurDbm) {
+		return;
+	}
+	xdb_tblm_t *pTblm = xdb_find_table (pConn->pCurDbm, tbl_name);
+	if ((NULL == pTblm) || (XDB_STG_MAXID(&pTblm->stg_mgr) > 0) || (XDB_OBJM_COUNT(pTblm->fkey_objm) > 0)) {
+		return;
+	}
+	pTblm->bBulkLoad = true;
+	pSrc->pBulkTblm = pTblm;
+}
+
+XDB_STATIC void 
+xdb_source_free (xdb_source_t *pSrc)
+{
+	if (NULL == pSrc) {
+		return;
+	}
+	xdb_source_sync (pSrc);
+	for (int i = 0; i < XDB_SOURCE_THREADS; ++i) {
+		xdb_close (pSrc->pConns[i]);
+		xdb_free (pSrc->batch[i].sql);
+	}
+	xdb_free (pSrc);
+}
+
 XDB_STATIC int 
-xdb_source (xdb_conn_t* pConn, const char *file)
+xdb_source (xdb_conn_t* pConn, const char *file, bool bFast)
 {
 	int 		rc = -1, offset = 0;
 	char 		*sql, *sql_buf = NULL;
 	FILE 		*pFile = fopen (file, "rt");
 	uint64_t	lineno = 0;
+	xdb_source_t	*pSrc = NULL;
+	char		tbl_name[XDB_NAME_LEN + 1];
 
 	char path[XDB_PATH_LEN], cwd[XDB_PATH_LEN];
 	xdb_strcpy (path, file);
@@ -182,6 +396,12 @@ xdb_source (xdb_conn_t* pConn, const char *file)
 	sql_buf = xdb_malloc (XDB_MAX_SQL_BUF);
 	XDB_EXPECT (NULL != sql_buf, XDB_E_NOTFOUND, "Can't malloc memory");
 
+	if (bFast) {
+		pSrc = xdb_calloc (sizeof (*pSrc));
+		XDB_EXPECT (NULL != pSrc, XDB_E_MEMORY, "Can't malloc memory");
+		pSrc->pConn = pConn;
+	}
+
     while ((sql = fgets(sql_buf+offset, XDB_MAX_SQL_BUF-offset, pFile))) {
 		lineno++;
 		int len = strlen (sql);
@@ -201,14 +421,26 @@ xdb_source (xdb_conn_t* pConn, const char *file)
 		offset = 0;
 		sql_buf[len-1] = '\0';
 
+		bool bNewTbl = false;
+		if (NULL != pSrc) {
+			if (xdb_source_insert (pSrc, sql_buf, len - 1, lineno)) {
+				continue;
+			}
+			xdb_source_sync (pSrc);
+			bNewTbl = xdb_source_newtbl (sql_buf, tbl_name);
+		}
+
 		xdb_res_t *pRes = xdb_exec (pConn, sql_buf);
 		if (pRes->errcode != 0) {
 			xdb_errlog ("%"PRIu64": '%s' ERROR %d : %s\n", lineno, sql_buf, pRes->errcode, xdb_errmsg(pRes));
+		} else if (bNewTbl) {
+			xdb_source_bulk (pSrc, tbl_name);
 		}
 	}
 
 	rc = XDB_OK;
 error:
+	xdb_source_free (pSrc);
 	if (NULL != dir) {
 		xdb_chdir (cwd, NULL);
 	}
@@ -216,3 +448,342 @@ error:
 	xdb_free (sql_buf);
 	return rc;
 }
+
+#define XDB_BKUP_MANIFEST	"xdb.bkp"
+
+// backup is a fuzzy copy, it's opened like a crashed DB: WAL is replayed, tables are repaired
+XDB_STATIC void 
+xdb_bkup_patch_db (void *buf, size_t len)
+{
+	xdb_db_t *pDb = buf;
+	if (len >= sizeof (*pDb)) {
+		pDb->flush_time = 0;
+		pDb->lastchg_id = pDb->flush_id + 1;
+	}
+}
+
+XDB_STATIC void 
+xdb_bkup_patch_tbl (void *buf, size_t len)
+{
+	xdb_tbl_t *pTbl = buf;
+	if ((len >= sizeof (*pTbl)) && (pTbl->lastchg_id == pTbl->flush_id)) {
+		pTbl->lastchg_id++;
+	}
+}
+
+// index may be copied in the middle of change, so rebuild it
+XDB_STATIC void 
+xdb_bkup_patch_idx (void *buf, size_t len)
+{
+	if (len >= sizeof (xdb_stghdr_t)) {
+		((xdb_stghdr_t*)buf)->flush_id = 0;
+	}
+}
+
+// remove files which are not in src any more, like dropped tables and indexes
+XDB_STATIC void 
+xdb_bkup_clean (const char *src, const char *dst)
+{
+	DIR				*dir = opendir (dst);
+	struct dirent	*entry;
+	char			spath[XDB_PATH_LEN * 2 + 32], dpath[XDB_PATH_LEN * 2 + 32];
+	struct stat		st;
+
+	if (NULL == dir) {
+		return;
+	}
+	while ((entry = readdir(dir)) != NULL) {
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..") || !strcmp(entry->d_name, XDB_BKUP_MANIFEST)) {
+			continue;
+		}
+		// never remove by truncated path
+		if (!xdb_path_join (spath, sizeof(spath), src, entry->d_name) || !xdb_path_join (dpath, sizeof(dpath), dst, entry->d_name)) {
+			continue;
+		}
+		if (xdb_fexist (spath) || (stat (dpath, &st) < 0)) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			xdb_rmdir (dpath);
+		} else {
+			remove (dpath);
+		}
+	}
+	closedir (dir);
+}
+
+// copy table dir recursively, return bytes written or -1
+XDB_STATIC int64_t 
+xdb_bkup_dir (const char *src, const char *dst)
+{
+	DIR				*dir = opendir (src);
+	struct dirent	*entry;
+	char			spath[XDB_PATH_LEN * 2 + 32], dpath[XDB_PATH_LEN * 2 + 32];
+	struct stat		st;
+	int64_t			bytes = 0, n;
+
+	if (NULL == dir) {
+		xdb_errlog ("opendir %s error %s\n", src, strerror(errno));
+		return -1;
+	}
+	xdb_mkdir (dst);
+
+	while ((bytes >= 0) && (entry = readdir(dir)) != NULL) {
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+			continue;
+		}
+		if (!xdb_path_join (spath, sizeof(spath), src, entry->d_name) || !xdb_path_join (dpath, sizeof(dpath), dst, entry->d_name)) {
+			bytes = -1;
+			break;
+		}
+		if (stat (spath, &st) < 0) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			n = xdb_bkup_dir (spath, dpath);
+		} else {
+			const char *ext = strrchr (entry->d_name, '.');
+			void (*patch)(void *buf, size_t len) = NULL;
+			if (!strcmp (entry->d_name, "xdb.dat")) {
+				patch = xdb_bkup_patch_tbl;
+			} else if ((NULL != ext) && !strcmp (ext, ".idx")) {
+				patch = xdb_bkup_patch_idx;
+			}
+			n = xdb_fcopy_diff (spath, dpath, patch);
+		}
+		bytes = (n < 0) ? -1 : bytes + n;
+	}
+	closedir (dir);
+
+	if (bytes >= 0) {
+		xdb_bkup_clean (src, dst);
+	}
+	return bytes;
+}
+
+static inline uint64_t 
+xdb_bkup_chgid (xdb_tblm_t *pTblm)
+{
+	xdb_rdlock_tblstg (pTblm);
+	uint64_t chg_id = XDB_TBLPTR(pTblm)->lastchg_id;
+	xdb_rdunlock_tblstg (pTblm);
+	return chg_id;
+}
+
+/*
+ * Online physical backup. DB lock pins the checkpoint, so WAL is neither switched nor recycled 
+ * while table files are copied. Writers go on, WAL is copied at last and covers their changes.
+ * Incremental backup skips tables not changed since last backup in dir, other files are 
+ * compared and only changed chunks are written.
+ */
+XDB_STATIC int 
+xdb_backup (xdb_conn_t* pConn, xdb_dbm_t *pDbm, const char *dir, bool bIncr)
+{
+	int			rc = -1, tbl_count = 0, skip_count = 0;
+	int64_t		bytes = 0, n;
+	bool		bLock = false;
+	char		src[XDB_PATH_LEN * 2 + 32], dst[XDB_PATH_LEN * 2 + 32], line[XDB_NAME_LEN + 64];
+	uint64_t	*pPrev = NULL, *pCur = NULL, commit_id;
+	void		*pXql = NULL, *pOldXql = NULL;
+	char		*buf = NULL;
+	xdb_size	xql_len = 0, old_len = 0;
+	FILE		*pFile = NULL;
+
+	XDB_EXPECT (!pDbm->bMemory, XDB_E_PARAM, "Can't backup memory database '%s'", XDB_OBJ_NAME(pDbm));
+	XDB_EXPECT (strlen (dir) < XDB_PATH_LEN, XDB_E_PARAM, "Too long path");
+	xdb_mkdir (dir);
+	XDB_EXPECT (xdb_fexist (dir), XDB_E_FILE, "Can't create backup dir '%s'", dir);
+
+	pPrev = xdb_calloc (2 * (XDB_MAX_TBL + 1) * sizeof (uint64_t));
+	XDB_EXPECT (NULL != pPrev, XDB_E_MEMORY, "Can't alloc memory");
+	pCur = pPrev + XDB_MAX_TBL + 1;
+
+	// previous backup must be complete and of same DB, unfinished backup has no manifest
+	char header[XDB_NAME_LEN + 32];
+	xdb_sprintf (header, "-- CrossDB Backup: %s\n", XDB_OBJ_NAME(pDbm));
+	xdb_sprintf (dst, "%s/"XDB_BKUP_MANIFEST, dir);
+	pFile = fopen (dst, "rt");
+	if (NULL != pFile) {
+		if (bIncr && (NULL != fgets (line, sizeof(line), pFile)) && !strcmp (line, header)) {
+			uint32_t	id;
+			uint64_t	chg_id;
+			while (NULL != fgets (line, sizeof(line), pFile)) {
+				if ((2 == sscanf (line, "T%u %"SCNu64, &id, &chg_id)) && (id <= XDB_MAX_TBL)) {
+					pPrev[id] = chg_id;
+				}
+			}
+		}
+		xdb_fclose (pFile);
+		remove (dst);
+	}
+
+	xdb_flush_db (pDbm, 0);
+
+	// pin checkpoint, WAL switch and DDL wait till done
+	xdb_wrlock_db (pDbm);
+	bLock = true;
+
+	// table id may be reused after DDL, then copy all
+	xdb_sprintf (src, "%s/xdb.xql", pDbm->db_path);
+	xdb_sprintf (dst, "%s/xdb.xql", dir);
+	pXql	= xdb_fread_all (src, &xql_len);
+	pOldXql = xdb_fread_all (dst, &old_len);
+	if ((NULL == pXql) || (NULL == pOldXql) || (xql_len != old_len) || memcmp (pXql, pOldXql, xql_len)) {
+		memset (pPrev, 0, (XDB_MAX_TBL + 1) * sizeof (uint64_t));
+	}
+	if (NULL != pXql) {
+		n = xdb_fcopy_diff (src, dst, NULL);
+		XDB_EXPECT (n >= 0, XDB_E_FILE, "Can't backup '%s' to '%s'", src, dst);
+		bytes += n;
+	}
+
+	int count = XDB_OBJM_MAX(pDbm->db_objm);
+	for (int i = 0; i < count; ++i) {
+		xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
+		if ((NULL == pTblm) || pTblm->bMemory) {
+			continue;
+		}
+		int id = XDB_OBJ_ID(pTblm);
+		uint64_t chg_id = xdb_bkup_chgid (pTblm);
+		xdb_sprintf (src, "%s/T%06d", pDbm->db_path, id);
+		xdb_sprintf (dst, "%s/T%06d", dir, id);
+		if ((0 != chg_id) && (pPrev[id] == chg_id) && xdb_fexist (dst)) {
+			pCur[id] = chg_id;
+			skip_count++;
+			continue;
+		}
+		n = xdb_bkup_dir (src, dst);
+		XDB_EXPECT (n >= 0, XDB_E_FILE, "Can't backup table '%s' to '%s'", XDB_OBJ_NAME(pTblm), dst);
+		bytes += n;
+		tbl_count++;
+		// changed during copy, copy again next time
+		pCur[id] = (xdb_bkup_chgid (pTblm) == chg_id) ? chg_id : 0;
+	}
+	xdb_bkup_clean (pDbm->db_path, dir);
+
+	xdb_sprintf (src, "%s/xdb.db", pDbm->db_path);
+	xdb_sprintf (dst, "%s/xdb.db", dir);
+	n = xdb_fcopy_diff (src, dst, xdb_bkup_patch_db);
+	XDB_EXPECT (n >= 0, XDB_E_FILE, "Can't backup '%s' to '%s'", src, dst);
+	bytes += n;
+
+	// WAL is copied at last, so it has all commits which may reach copied tables
+	xdb_wal_rdlock (pDbm);
+	commit_id = XDB_WAL_PTR(pDbm->pWalm)->commit_id;
+	xdb_wal_rdunlock (pDbm);
+	for (int i = 0; i < 2; ++i) {
+		xdb_sprintf (src, "%s/xdb%d.wal", pDbm->db_path, i);
+		xdb_sprintf (dst, "%s/xdb%d.wal", dir, i);
+		n = xdb_fcopy_diff (src, dst, NULL);
+		XDB_EXPECT (n >= 0, XDB_E_FILE, "Can't backup '%s' to '%s'", src, dst);
+		bytes += n;
+	}
+
+	xdb_wrunlock_db (pDbm);
+	bLock = false;
+
+	// manifest marks backup complete
+	buf = xdb_malloc ((XDB_MAX_TBL + 4) * 48);
+	XDB_EXPECT (NULL != buf, XDB_E_MEMORY, "Can't alloc memory");
+	int len = sprintf (buf, "%s-- Commit: %"PRIu64"\n", header, commit_id);
+	for (int id = 0; id <= XDB_MAX_TBL; ++id) {
+		if (0 != pCur[id]) {
+			len += sprintf (buf + len, "T%06d %"PRIu64"\n", id, pCur[id]);
+		}
+	}
+	xdb_sprintf (src, "%s/"XDB_BKUP_MANIFEST".tmp", dir);
+	xdb_sprintf (dst, "%s/"XDB_BKUP_MANIFEST, dir);
+	XDB_EXPECT ((0 == xdb_fwrite_sync (src, buf, len)) && (0 == rename (src, dst)), XDB_E_FILE, "Can't write backup manifest '%s'", dst);
+
+	pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Backup database '%s' at commit %"PRIu64", copy %d tables, skip %d tables, write %"PRId64" bytes", 
+									XDB_OBJ_NAME(pDbm), commit_id, tbl_count, skip_count, bytes);
+	pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	rc = XDB_OK;
+
+error:
+	if (bLock) {
+		xdb_wrunlock_db (pDbm);
+	}
+	xdb_free (pPrev);
+	xdb_free (pXql);
+	xdb_free (pOldXql);
+	xdb_free (buf);
+	return rc;
+}
+
+/*
+ * Copy physical backup to database dir, open it and replay archived WAL up to target.
+ * DDL is not in WAL, so backup must have the schema of the archived segments.
+ * Without archive, backup is only recovered with its own WAL.
+ */
+XDB_STATIC int 
+xdb_restore (xdb_stmt_backup_t *pStmt)
+{
+	xdb_conn_t	*pConn = pStmt->pConn;
+	char		db_path[XDB_PATH_LEN + XDB_NAME_LEN + 2], archive[XDB_PATH_LEN * 2 + 2], path[XDB_PATH_LEN * 2 + 16];
+	char		name[XDB_NAME_LEN + 1];
+	const char	*db_name = strrchr (pStmt->db_name, '/');
+	// statement and SQL buffer are reused by OPEN below
+	xdb_walrange_t range = {.until_cid = pStmt->until_cid, .until_ts = pStmt->until_ts};
+
+	if (NULL == db_name) {
+		db_name = strrchr (pStmt->db_name, '\\');
+	}
+	if (NULL == db_name) {
+		db_name = pStmt->db_name;
+		if (*s_xdb_datadir) {
+			xdb_sprintf (db_path, "%s/%s", s_xdb_datadir, db_name);
+		} else {
+			xdb_strcpy (db_path, db_name);
+		}
+	} else {
+		XDB_EXPECT_RETE (0 == pConn->sockfd, XDB_E_AUTH, "Can't restore database '%s' with path, not allowed in server mode", db_name);
+		db_name++;
+		xdb_strcpy (db_path, pStmt->db_name);
+	}
+
+	XDB_EXPECT_RETE (strlen (db_name) <= XDB_NAME_LEN, XDB_E_PARAM, "Database name '%s' is too long", db_name);
+	xdb_strcpy (name, db_name);
+	db_name = name;
+
+	XDB_EXPECT_RETE (NULL == xdb_find_db (db_name), XDB_E_EXISTS, "Can't restore database '%s', database is open", db_name);
+	xdb_sprintf (path, "%s/xdb.db", db_path);
+	XDB_EXPECT_RETE (!xdb_fexist (path), XDB_E_EXISTS, "Can't restore database '%s', database exists", db_name);
+	xdb_sprintf (path, "%s/xdb.db", pStmt->file);
+	XDB_EXPECT_RETE (xdb_fexist (path), XDB_E_NOTFOUND, "Can't restore database '%s', '%s' is not a database backup", db_name, pStmt->file);
+
+	archive[0] = '\0';
+	if (NULL != pStmt->archive) {
+		xdb_strcpy (archive, pStmt->archive);
+	} else if (*s_xdb_wal_archive) {
+		xdb_sprintf (archive, "%s/%s", s_xdb_wal_archive, db_name);
+	} else {
+		XDB_EXPECT_RETE (!range.until_cid && !range.until_ts, XDB_E_PARAM, "Miss WAL ARCHIVE dir");
+	}
+
+	xdb_print ("=== Begin Restore Database %s ===\n", db_name);
+
+	XDB_EXPECT_RETE (0 == xdb_copydir (pStmt->file, db_path), XDB_E_FILE, "Can't copy backup '%s' to '%s'", pStmt->file, db_path);
+
+	xdb_res_t *pRes = xdb_pexec (pConn, "OPEN DATABASE '%s'", db_path);
+	XDB_EXPECT_RETE (XDB_OK == pRes->errcode, pRes->errcode, "Can't open restored database '%s'", db_path);
+	xdb_dbm_t *pDbm = xdb_find_db (db_name);
+	XDB_EXPECT_RETE (NULL != pDbm, XDB_E_NOTFOUND, "Can't open restored database '%s'", db_path);
+
+	int rc = XDB_OK;
+	if (*archive) {
+		rc = xdb_wal_restore (pConn, pDbm, archive, &range);
+	} else {
+		// not repaired by open in CLI
+		if (XDB_DBPTR(pDbm)->lastchg_id != XDB_DBPTR(pDbm)->flush_id) {
+			xdb_repair_db (pDbm, 0);
+		}
+		pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Restore database '%s' to commit %"PRIu64, 
+										db_name, XDB_WAL_PTR(pDbm->pWalm)->commit_id);
+		pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	}
+
+	xdb_print ("=== End Restore Database %s ===\n", db_name);
+
+	return rc;
+}
@@ -13,9 +13,15 @@
 #define __CROSS_BACKUP_H__
 
 XDB_STATIC int 
-xdb_source (xdb_conn_t* pConn, const char *file);
+xdb_source (xdb_conn_t* pConn, const char *file, bool bFast);
 
 XDB_STATIC int 
 xdb_dump (xdb_conn_t* pConn, xdb_dbm_t *pDbm, const char *file, bool bNoDrop, bool bNoCreate, bool bNoData);
 
+XDB_STATIC int 
+xdb_restore (xdb_stmt_backup_t *pStmt);
+
+XDB_STATIC int 
+xdb_backup (xdb_conn_t* pConn, xdb_dbm_t *pDbm, const char *dir, bool bIncr);
+
 #endif // __CROSS_BACKUP_H__
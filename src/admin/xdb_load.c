@@ -0,0 +1,840 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * LOAD DATA reads the file in rounds, each round is split at record boundary into pieces.
+ * Pieces are parsed by worker threads straight into insert row layout,
+ * then rows are inserted in batches, each batch under one table lock and commit.
+ * Empty table is bulk loaded: no WAL, indexes are built once at end and then checkpointed.
+ *
+ * CSV: one row per line, fields in table column order. Quoted field may have "" and newline,
+ * unquoted empty field or \N is NULL, BINARY is hex string and empty one is written as "".
+ *
+ * Row file (FORMAT BINARY): xdb_rowfile_hdr_t, column types, then records.
+ * Record: uint32 length of rest, NULL bitmap, non-NULL values in column order.
+ * Fixed value is stored in native format, string and binary are uint32 length, data and '\0'.
+ */
+
+#define XDB_LOAD_CHUNK			(4*1024*1024)	// max bytes parsed by one thread in a round
+#define XDB_LOAD_MIN_PIECE		(64*1024)
+#define XDB_LOAD_BATCH			8192			// rows inserted under one lock and commit
+
+#define XDB_ROWFILE_MAGIC		"XDBROWS"
+#define XDB_ROWFILE_VER			1
+
+typedef struct {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	fld_count;
+	// uint8_t	fld_type[fld_count];
+} xdb_rowfile_hdr_t;
+
+typedef struct {
+	xdb_conn_t		*pConn;
+	char			*pBuf;		// records of this piece, CSV is unescaped in place
+	size_t			len;
+	uint64_t		lineno;		// first line of CSV or record number of row file
+	void			*pRowsBuf;
+	uint64_t		row_count;
+	uint64_t		err_count;
+	uint64_t		err_line;	// first bad row of this job, 0 none
+	const char		*err_msg;
+} xdb_loadjob_t;
+
+typedef struct {
+	xdb_tblm_t		*pTblm;
+	const char		*file;
+	bool			bBinary;
+	char			delim;
+	int				row_len;
+	xdb_loadjob_t	jobs[XDB_LOAD_THREADS];
+} xdb_load_t;
+
+static inline void
+xdb_load_rowinit (xdb_tblm_t *pTblm, void *pRow)
+{
+	memset (pRow, 0, pTblm->row_size);
+	memset (pRow + pTblm->null_off, 0xFF, pTblm->null_bytes);
+	if (pTblm->vfld_count > 0) {
+		memset (pRow + pTblm->row_size, 0, pTblm->vfld_count * sizeof (xdb_str_t));
+	}
+	*((uint8_t*)pRow + pTblm->vtype_off) = XDB_VTYPE_PTR;
+}
+
+// whole val must be decimal integer in [min, max]
+static inline const char*
+xdb_load_int (const char *val, int len, int64_t min, int64_t max, int64_t *pInt)
+{
+	char	*end;
+
+	errno = 0;
+	*pInt = strtoll (val, &end, 10);
+	if ((0 == len) || (end != val + len)) {
+		return "Expect number";
+	}
+	return ((ERANGE == errno) || (*pInt < min) || (*pInt > max)) ? "Number out of range" : NULL;
+}
+
+// val is '\0' terminated and can be modified
+XDB_STATIC const char*
+xdb_load_setfld (xdb_tblm_t *pTblm, xdb_field_t *pField, void *pRow, char *val, int len)
+{
+	void		*pVal = pRow + pField->fld_off;
+	char		*end;
+	const char	*err;
+	int64_t		ival;
+	double		dval;
+	xdb_str_t	*pStr;
+
+	switch (pField->fld_type) {
+	case XDB_TYPE_BOOL:
+		if (!strcasecmp (val, "true") || !strcmp (val, "1")) {
+			*(int8_t*)pVal = 1;
+		} else if (!strcasecmp (val, "false") || !strcmp (val, "0")) {
+			*(int8_t*)pVal = 0;
+		} else {
+			return "Expect TRUE/FALSE";
+		}
+		break;
+	case XDB_TYPE_TINYINT:
+		err = xdb_load_int (val, len, INT8_MIN, INT8_MAX, &ival);
+		*(int8_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_UTINYINT:
+		err = xdb_load_int (val, len, 0, UINT8_MAX, &ival);
+		*(uint8_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_SMALLINT:
+		err = xdb_load_int (val, len, INT16_MIN, INT16_MAX, &ival);
+		*(int16_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_USMALLINT:
+		err = xdb_load_int (val, len, 0, UINT16_MAX, &ival);
+		*(uint16_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_INT:
+		err = xdb_load_int (val, len, INT32_MIN, INT32_MAX, &ival);
+		*(int32_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_UINT:
+		err = xdb_load_int (val, len, 0, UINT32_MAX, &ival);
+		*(uint32_t*)pVal = ival;
+		return err;
+	case XDB_TYPE_BIGINT:
+		return xdb_load_int (val, len, INT64_MIN, INT64_MAX, (int64_t*)pVal);
+	case XDB_TYPE_UBIGINT:
+		errno = 0;
+		*(uint64_t*)pVal = strtoull (val, &end, 10);
+		if ((0 == len) || (end != val + len)) {
+			return "Expect number";
+		}
+		// strtoull wraps negative number
+		return ((ERANGE == errno) || (NULL != memchr (val, '-', len))) ? "Number out of range" : NULL;
+	case XDB_TYPE_TIMESTAMP:
+		// number is microseconds, else date time string
+		if ((0 == len) || ('-' == val[0]) || (strspn (val, "0123456789") == len)) {
+			return xdb_load_int (val, len, INT64_MIN, INT64_MAX, (int64_t*)pVal);
+		}
+		if (!isdigit ((uint8_t)val[0])) {
+			return "Invalid timestamp";
+		}
+		*(int64_t*)pVal = xdb_timestamp_scanf (val);
+		return NULL;
+	case XDB_TYPE_FLOAT:
+	case XDB_TYPE_DOUBLE:
+		errno = 0;
+		dval = strtod (val, &end);
+		if ((0 == len) || (end != val + len)) {
+			return "Expect number";
+		}
+		// underflow to 0 or denormal is fine
+		if (((ERANGE == errno) && (fabs (dval) > 1.0)) || 
+			((XDB_TYPE_FLOAT == pField->fld_type) && isfinite (dval) && (fabs (dval) > FLT_MAX))) {
+			return "Number out of range";
+		}
+		if (XDB_TYPE_FLOAT == pField->fld_type) {
+			*(float*)pVal = dval;
+		} else {
+			*(double*)pVal = dval;
+		}
+		return NULL;
+	case XDB_TYPE_BINARY:
+	case XDB_TYPE_VBINARY:
+		if (len & 1) {
+			return "Invalid hex string";
+		}
+		for (int i = 0; i < len; i += 2) {
+			int hex1 = s_xdb_str_2_hex[(uint8_t)val[i]], hex2 = s_xdb_str_2_hex[(uint8_t)val[i+1]];
+			if ((hex1 < 0) || (hex2 < 0)) {
+				return "Invalid hex string";
+			}
+			val[i>>1] = (hex1<<4) | hex2;
+		}
+		len >>= 1;
+		val[len] = '\0';
+		// fall through
+	case XDB_TYPE_CHAR:
+	case XDB_TYPE_VCHAR:
+	case XDB_TYPE_JSON:
+		if (len > pField->fld_len) {
+			return "Too long string";
+		}
+		if (s_xdb_vdat[pField->fld_type]) {
+			pStr = (xdb_str_t*)(pRow + pTblm->row_size) + pField->fld_vid;
+			pStr->str = val;
+			pStr->len = len;
+		} else {
+			*(uint16_t*)(pVal - 2) = len;
+			memcpy (pVal, val, len + 1);
+		}
+		return NULL;
+	case XDB_TYPE_INET:
+		return xdb_inet_scanf (pVal, val) ? NULL : "Invalid IP Addr";
+	case XDB_TYPE_MAC:
+		return xdb_mac_scanf (pVal, val) ? NULL : "Invalid MAC Addr";
+	default:
+		return "Unsupported type";
+	}
+
+	return NULL;
+}
+
+// every CSV piece ends with '\n', so the byte after a field can be overwritten by '\0'
+XDB_STATIC const char*
+xdb_load_csv_row (xdb_load_t *pLoad, void *pRow, char **ppCur, char *pEnd, uint64_t *pLineno)
+{
+	xdb_tblm_t	*pTblm = pLoad->pTblm;
+	char		*p = *ppCur, ch;
+	const char	*err = NULL;
+	int			fld_id = 0;
+
+	xdb_load_rowinit (pTblm, pRow);
+
+	for (;; ++fld_id) {
+		char	*val = p;
+		int		len;
+		bool	bNull = false;
+
+		if ('"' == *p) {
+			char *dst = val;
+			for (++p; p < pEnd; *dst++ = *p++) {
+				if ('"' == *p) {
+					if ('"' != *++p) {
+						break;
+					}
+				} else if ('\n' == *p) {
+					(*pLineno)++;
+				}
+			}
+			if (p >= pEnd) {
+				// quote in unquoted field fooled the splitter
+				err = (NULL != err) ? err : "Unterminated quoted field";
+				p = pEnd - 1;
+			}
+			len = dst - val;
+		} else {
+			while ((pLoad->delim != *p) && ('\n' != *p)) {
+				++p;
+			}
+			len = p - val;
+			bNull = (0 == len) || ((2 == len) && ('\\' == val[0]) && ('N' == val[1]));
+		}
+		if (('\r' == *p) && ('\n' == p[1])) {
+			p++;
+		} else if ((len > 0) && ('\r' == val[len-1]) && ('\n' == *p)) {
+			len--;
+		}
+		ch = *p++;
+		val[len] = '\0';
+
+		if (NULL != err) {
+		} else if (fld_id >= pTblm->fld_count) {
+			err = "Too many columns";
+		} else if (bNull) {
+			XDB_SET_NULL ((uint8_t*)pRow + pTblm->null_off, fld_id);
+		} else {
+			err = xdb_load_setfld (pTblm, &pTblm->pFields[fld_id], pRow, val, len);
+		}
+
+		if ('\n' == ch) {
+			break;
+		} else if (pLoad->delim != ch) {
+			err = (NULL != err) ? err : "Miss delimiter after quoted field";
+			// skip rest of line
+			for (p--; '\n' != *p; ++p)
+				;
+		}
+	}
+	(*pLineno)++;
+	*ppCur = p;
+
+	if ((NULL == err) && (fld_id + 1 < pTblm->fld_count)) {
+		err = "Too few columns";
+	}
+	return err;
+}
+
+// splitter guarantees the whole record is in piece
+XDB_STATIC const char*
+xdb_load_bin_row (xdb_load_t *pLoad, void *pRow, char **ppCur)
+{
+	xdb_tblm_t	*pTblm = pLoad->pTblm;
+	uint8_t		*p = (uint8_t*)*ppCur, *pNull, *pRecEnd;
+	uint32_t	len;
+
+	memcpy (&len, p, sizeof (len));
+	pNull = p + sizeof (len);
+	pRecEnd = pNull + len;
+	*ppCur = (char*)pRecEnd;
+	p = pNull + ((pTblm->fld_count + 7) >> 3);
+	if (p > pRecEnd) {
+		return "Truncated record";
+	}
+
+	xdb_load_rowinit (pTblm, pRow);
+
+	for (int i = 0; i < pTblm->fld_count; ++i) {
+		xdb_field_t *pField = &pTblm->pFields[i];
+		void 		*pVal = pRow + pField->fld_off;
+		if (pNull[i>>3] & (1<<(i&7))) {
+			XDB_SET_NULL ((uint8_t*)pRow + pTblm->null_off, i);
+			continue;
+		}
+		switch (pField->fld_type) {
+		case XDB_TYPE_CHAR:
+		case XDB_TYPE_BINARY:
+		case XDB_TYPE_VCHAR:
+		case XDB_TYPE_VBINARY:
+		case XDB_TYPE_JSON:
+			if (p + sizeof (len) > pRecEnd) {
+				return "Truncated record";
+			}
+			memcpy (&len, p, sizeof (len));
+			p += sizeof (len);
+			if ((len > pRecEnd - p - 1) || ('\0' != p[len])) {
+				return "Truncated record";
+			}
+			if (len > pField->fld_len) {
+				return "Too long string";
+			}
+			if (s_xdb_vdat[pField->fld_type]) {
+				xdb_str_t *pStr = (xdb_str_t*)(pRow + pTblm->row_size) + pField->fld_vid;
+				pStr->str = (char*)p;
+				pStr->len = len;
+			} else {
+				*(uint16_t*)(pVal - 2) = len;
+				memcpy (pVal, p, len + 1);
+			}
+			p += len + 1;
+			break;
+		default:
+			if (p + s_xdb_type_len[pField->fld_type] > pRecEnd) {
+				return "Truncated record";
+			}
+			memcpy (pVal, p, s_xdb_type_len[pField->fld_type]);
+			p += s_xdb_type_len[pField->fld_type];
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+XDB_STATIC void
+xdb_load_insert (xdb_load_t *pLoad, xdb_loadjob_t *pJob, int count)
+{
+	xdb_conn_t	*pConn = pJob->pConn;
+	xdb_tblm_t	*pTblm = pLoad->pTblm;
+
+	xdb_begin (pConn);
+	xdb_wrlock_table (pConn, pTblm);
+	xdb_wrlock_tblstg (pTblm);
+	xdb_mark_dirty (pTblm);
+
+	for (int i = 0; i < count; ++i) {
+		if (xdb_row_insert (pConn, pTblm, pJob->pRowsBuf + (size_t)i * pLoad->row_len, false) > 0) {
+			pJob->row_count++;
+		} else {
+			pJob->err_count++;
+		}
+	}
+
+	xdb_wrunlock_tblstg (pTblm);
+	xdb_commit (pConn);
+}
+
+XDB_STATIC void
+xdb_load_job (int id, void *pArg)
+{
+	xdb_load_t		*pLoad = pArg;
+	xdb_loadjob_t	*pJob = &pLoad->jobs[id];
+	char			*p = pJob->pBuf, *pEnd = pJob->pBuf + pJob->len;
+	uint64_t		lineno = pJob->lineno;
+	int				count = 0;
+
+	while (p < pEnd) {
+		if (!pLoad->bBinary && (('\n' == *p) || (('\r' == *p) && ('\n' == p[1])))) {
+			// skip empty line
+			p += ('\n' == *p) ? 1 : 2;
+			lineno++;
+			continue;
+		}
+		if (count >= XDB_LOAD_BATCH) {
+			xdb_load_insert (pLoad, pJob, count);
+			count = 0;
+		}
+		void		*pRow = pJob->pRowsBuf + (size_t)count * pLoad->row_len;
+		uint64_t	line = lineno;
+		const char	*err;
+		if (pLoad->bBinary) {
+			err = xdb_load_bin_row (pLoad, pRow, &p);
+			lineno++;
+		} else {
+			err = xdb_load_csv_row (pLoad, pRow, &p, pEnd, &lineno);
+		}
+		if (xdb_likely (NULL == err)) {
+			count++;
+		} else {
+			pJob->err_count++;
+			if (0 == pJob->err_line) {
+				pJob->err_line = line;
+				pJob->err_msg = err;
+			}
+			xdb_errlog ("%s:%"PRIu64": %s\n", pLoad->file, line, err);
+		}
+	}
+
+	if (count > 0) {
+		xdb_load_insert (pLoad, pJob, count);
+	}
+}
+
+// return length of complete records from pBuf, add lines or records to *pLines
+XDB_STATIC size_t
+xdb_load_split (xdb_load_t *pLoad, const char *pBuf, size_t len, size_t min_len, uint64_t *pLines)
+{
+	size_t		end = 0, pos = 0;
+	uint64_t	lines = 0;
+
+	if (pLoad->bBinary) {
+		uint32_t rec_len;
+		while ((end < min_len) && (pos + sizeof (rec_len) <= len)) {
+			memcpy (&rec_len, pBuf + pos, sizeof (rec_len));
+			if (pos + sizeof (rec_len) + rec_len > len) {
+				break;
+			}
+			end = pos += sizeof (rec_len) + rec_len;
+			lines++;
+		}
+	} else {
+		bool 		bQuote = false;
+		uint64_t	nl_count = 0;
+		for (; (end < min_len) && (pos < len); ++pos) {
+			if ('"' == pBuf[pos]) {
+				bQuote = !bQuote;
+			} else if ('\n' == pBuf[pos]) {
+				nl_count++;
+				if (!bQuote) {
+					end = pos + 1;
+					lines = nl_count;
+				}
+			}
+		}
+	}
+
+	*pLines += lines;
+	return end;
+}
+
+XDB_STATIC int
+xdb_load_header (xdb_conn_t *pConn, xdb_load_t *pLoad, FILE *pFile)
+{
+	xdb_tblm_t			*pTblm = pLoad->pTblm;
+	xdb_rowfile_hdr_t	hdr;
+	uint8_t				fld_type[XDB_MAX_COLUMN];
+
+	XDB_EXPECT ((fread (&hdr, sizeof (hdr), 1, pFile) == 1) && !memcmp (hdr.magic, XDB_ROWFILE_MAGIC, sizeof (hdr.magic)),
+				XDB_E_STMT, "'%s' is not row file", pLoad->file);
+	XDB_EXPECT (XDB_ROWFILE_VER == hdr.version, XDB_E_STMT, "Unsupported row file version %u", hdr.version);
+	XDB_EXPECT ((hdr.fld_count == pTblm->fld_count) && (fread (fld_type, 1, hdr.fld_count, pFile) == hdr.fld_count),
+				XDB_E_STMT, "Row file has %u columns, table '%s' has %d", hdr.fld_count, XDB_OBJ_NAME(pTblm), pTblm->fld_count);
+	for (int i = 0; i < pTblm->fld_count; ++i) {
+		XDB_EXPECT (fld_type[i] == pTblm->pFields[i].fld_type, XDB_E_STMT, "Column %d type %s doesn't match %s of table '%s'",
+					i + 1, xdb_type2str (fld_type[i]), xdb_type2str (pTblm->pFields[i].fld_type), XDB_OBJ_NAME(pTblm));
+	}
+	return XDB_OK;
+
+error:
+	return -XDB_E_STMT;
+}
+
+XDB_STATIC int
+xdb_load_data (xdb_stmt_load_t *pStmt)
+{
+	int				rc = -1, count = 0;
+	xdb_conn_t		*pConn = pStmt->pConn;
+	xdb_tblm_t		*pTblm = pStmt->pTblm;
+	xdb_load_t		*pLoad = NULL;
+	char			*pBuf = NULL;
+	size_t			buf_cap = XDB_LOAD_THREADS * XDB_LOAD_CHUNK, data_len = 0;
+	uint64_t		lineno = 1, row_count = 0, err_count = 0, err_line = 0;
+	const char		*err_msg = NULL;
+	bool			bBulk = false, bEof = false;
+	FILE			*pFile = fopen (pStmt->file, "rb");
+
+	XDB_EXPECT (NULL != pFile, XDB_E_NOTFOUND, "Can't open '%s', file doesn't exist", pStmt->file);
+
+	pLoad = xdb_calloc (sizeof (*pLoad));
+	XDB_EXPECT (NULL != pLoad, XDB_E_MEMORY, "Can't malloc memory");
+	pLoad->pTblm	= pTblm;
+	pLoad->file		= pStmt->file;
+	pLoad->bBinary	= XDB_LOAD_BINARY == pStmt->format;
+	pLoad->delim	= pStmt->delim;
+	pLoad->row_len	= XDB_ALIGN4 (pTblm->row_size + pTblm->vfld_count * sizeof (xdb_str_t));
+
+	if (pLoad->bBinary) {
+		rc = xdb_load_header (pConn, pLoad, pFile);
+		if (rc < 0) {
+			goto error;
+		}
+		rc = -1;
+		lineno = 1;
+	} else {
+		for (uint32_t i = 0; i < pStmt->skip_lines; ++i) {
+			int ch;
+			while (((ch = fgetc (pFile)) != EOF) && ('\n' != ch))
+				;
+			lineno++;
+		}
+	}
+
+	// +1 for '\n' appended to last line
+	pBuf = xdb_malloc (buf_cap + 1);
+	XDB_EXPECT (NULL != pBuf, XDB_E_MEMORY, "Can't malloc memory");
+
+	if ((0 == XDB_STG_MAXID(&pTblm->stg_mgr)) && (0 == XDB_OBJM_COUNT(pTblm->fkey_objm)) && !pTblm->bBulkLoad) {
+		pTblm->bBulkLoad = bBulk = true;
+	}
+
+	while (!bEof || (data_len > 0)) {
+		if (!bEof) {
+			data_len += fread (pBuf + data_len, 1, buf_cap - data_len, pFile);
+			bEof = data_len < buf_cap;
+			if (bEof && !pLoad->bBinary && (data_len > 0) && ('\n' != pBuf[data_len - 1])) {
+				pBuf[data_len++] = '\n';
+			}
+		}
+
+		size_t piece = (data_len + XDB_LOAD_THREADS - 1) / XDB_LOAD_THREADS, pos = 0;
+		if (piece < XDB_LOAD_MIN_PIECE) {
+			piece = XDB_LOAD_MIN_PIECE;
+		}
+		for (count = 0; (count < XDB_LOAD_THREADS) && (pos < data_len); ++count) {
+			xdb_loadjob_t *pJob = &pLoad->jobs[count];
+			pJob->lineno = lineno;
+			pJob->pBuf = pBuf + pos;
+			pJob->len = xdb_load_split (pLoad, pJob->pBuf, data_len - pos, piece, &lineno);
+			if (0 == pJob->len) {
+				break;
+			}
+			pos += pJob->len;
+		}
+
+		if (0 == count) {
+			if (bEof) {
+				err_msg = "Incomplete record at end of file";
+				err_line = lineno;
+				xdb_errlog ("%s:%"PRIu64": %s\n", pLoad->file, lineno, err_msg);
+				err_count++;
+				break;
+			}
+			// record is longer than buffer
+			char *pNewBuf = xdb_realloc (pBuf, buf_cap * 2 + 1);
+			XDB_EXPECT (NULL != pNewBuf, XDB_E_MEMORY, "Can't malloc memory");
+			pBuf = pNewBuf;
+			buf_cap *= 2;
+			continue;
+		}
+
+		int conn_count = 0;
+		for (; conn_count < count; ++conn_count) {
+			xdb_loadjob_t *pJob = &pLoad->jobs[conn_count];
+			if (NULL == pJob->pRowsBuf) {
+				pJob->pRowsBuf = xdb_malloc ((size_t)XDB_LOAD_BATCH * pLoad->row_len);
+				XDB_EXPECT (NULL != pJob->pRowsBuf, XDB_E_MEMORY, "Can't malloc memory");
+			}
+			if (NULL == pJob->pConn) {
+				pJob->pConn = xdb_open (NULL);
+				XDB_EXPECT (NULL != pJob->pConn, XDB_E_MEMORY, "Can't open connection");
+			}
+		}
+		xdb_run_jobs (count, XDB_LOAD_THREADS, xdb_load_job, pLoad);
+
+		data_len -= pos;
+		memmove (pBuf, pBuf + pos, data_len);
+	}
+
+	for (int i = 0; i < XDB_LOAD_THREADS; ++i) {
+		row_count += pLoad->jobs[i].row_count;
+		err_count += pLoad->jobs[i].err_count;
+		if ((0 != pLoad->jobs[i].err_line) && ((0 == err_line) || (pLoad->jobs[i].err_line < err_line))) {
+			err_line = pLoad->jobs[i].err_line;
+			err_msg = pLoad->jobs[i].err_msg;
+		}
+	}
+	if (bBulk) {
+		bBulk = false;
+		xdb_rowid dup_count = xdb_bulkload_end (pConn, pTblm);
+		row_count -= dup_count;
+		err_count += dup_count;
+		// rows are not in WAL, checkpoint to persist them
+		xdb_flush_db (pTblm->pDbm, 0);
+	}
+
+	pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Load %"PRIu64" rows into table '%s', skip %"PRIu64" rows",
+									row_count, XDB_OBJ_NAME(pTblm), err_count);
+	if (0 != err_line) {
+		// line of CSV or record number of row file
+		pConn->conn_msg.len += sprintf (pConn->conn_msg.msg + pConn->conn_msg.len, ", first bad %s %"PRIu64": %s",
+										pLoad->bBinary ? "record" : "line", err_line, err_msg);
+	}
+	pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	rc = XDB_OK;
+
+error:
+	if (bBulk) {
+		xdb_bulkload_end (pConn, pTblm);
+		xdb_flush_db (pTblm->pDbm, 0);
+	}
+	if (NULL != pLoad) {
+		for (int i = 0; i < XDB_LOAD_THREADS; ++i) {
+			xdb_close (pLoad->jobs[i].pConn);
+			xdb_free (pLoad->jobs[i].pRowsBuf);
+		}
+		xdb_free (pLoad);
+	}
+	xdb_free (pBuf);
+	xdb_fclose (pFile);
+	return rc;
+}
+
+XDB_STATIC void
+xdb_dump_csvrow (FILE *pFile, xdb_res_t *pRes, xdb_row_t *pRow, int col_count, char delim)
+{
+	char		buf[128];
+	int			len;
+	const char	*str;
+	const uint8_t	*bin;
+
+	for (int i = 0; i < col_count; ++i) {
+		if (i > 0) {
+			fputc (delim, pFile);
+		}
+		if (xdb_column_null (pRes, pRow, i)) {
+			continue;
+		}
+		switch (xdb_column_type (pRes, i)) {
+		case XDB_TYPE_INT:
+		case XDB_TYPE_SMALLINT:
+		case XDB_TYPE_TINYINT:
+			fprintf (pFile, "%d", xdb_column_int (pRes, pRow, i));
+			break;
+		case XDB_TYPE_UINT:
+		case XDB_TYPE_USMALLINT:
+		case XDB_TYPE_UTINYINT:
+			fprintf (pFile, "%u", xdb_column_int (pRes, pRow, i));
+			break;
+		case XDB_TYPE_BOOL:
+			fputs (xdb_column_bool (pRes, pRow, i) ? "true" : "false", pFile);
+			break;
+		case XDB_TYPE_BIGINT:
+			fprintf (pFile, "%"PRIi64, xdb_column_int64 (pRes, pRow, i));
+			break;
+		case XDB_TYPE_UBIGINT:
+			fprintf (pFile, "%"PRIu64, xdb_column_int64 (pRes, pRow, i));
+			break;
+		case XDB_TYPE_TIMESTAMP:
+			len = xdb_timestamp_sprintf (xdb_column_int64 (pRes, pRow, i), buf, sizeof (buf));
+			fwrite (buf, 1, len, pFile);
+			break;
+		case XDB_TYPE_FLOAT:
+			fprintf (pFile, "%.9g", xdb_column_float (pRes, pRow, i));
+			break;
+		case XDB_TYPE_DOUBLE:
+			fprintf (pFile, "%.17g", xdb_column_double (pRes, pRow, i));
+			break;
+		case XDB_TYPE_CHAR:
+		case XDB_TYPE_VCHAR:
+		case XDB_TYPE_JSON:
+			str = xdb_column_str2 (pRes, pRow, i, &len);
+			fputc ('"', pFile);
+			for (const char *quote; (NULL != (quote = memchr (str, '"', len))); ) {
+				fwrite (str, 1, quote - str + 1, pFile);
+				fputc ('"', pFile);
+				len -= quote - str + 1;
+				str = quote + 1;
+			}
+			fwrite (str, 1, len, pFile);
+			fputc ('"', pFile);
+			break;
+		case XDB_TYPE_BINARY:
+		case XDB_TYPE_VBINARY:
+			bin = xdb_column_blob (pRes, pRow, i, &len);
+			if (0 == len) {
+				// unquoted empty field is NULL
+				fputs ("\"\"", pFile);
+			}
+			for (int h = 0; h < len; ++h) {
+				fwrite (s_xdb_hex_2_str[bin[h]], 1, 2, pFile);
+			}
+			break;
+		case XDB_TYPE_INET:
+			len = xdb_inet_sprintf (xdb_column_inet (pRes, pRow, i), buf, sizeof (buf));
+			fwrite (buf, 1, len, pFile);
+			break;
+		case XDB_TYPE_MAC:
+			len = xdb_mac_sprintf (xdb_column_mac (pRes, pRow, i), buf, sizeof (buf));
+			fwrite (buf, 1, len, pFile);
+			break;
+		default:
+			break;
+		}
+	}
+	fputc ('\n', pFile);
+}
+
+XDB_STATIC void
+xdb_dump_binrow (FILE *pFile, xdb_res_t *pRes, xdb_row_t *pRow, int col_count)
+{
+	uint8_t		nulls[XDB_MAX_COLUMN/8] = {0};
+	uint32_t	len = (col_count + 7) >> 3;
+	int			slen;
+	const void	*ptr;
+
+	for (int i = 0; i < col_count; ++i) {
+		xdb_type_t type = xdb_column_type (pRes, i);
+		if (xdb_column_null (pRes, pRow, i)) {
+			nulls[i>>3] |= 1 << (i&7);
+		} else if (s_xdb_vdat[type] || (XDB_TYPE_CHAR == type) || (XDB_TYPE_BINARY == type)) {
+			// blob works for all string types
+			xdb_column_blob (pRes, pRow, i, &slen);
+			len += sizeof (uint32_t) + slen + 1;
+		} else {
+			len += s_xdb_type_len[type];
+		}
+	}
+	fwrite (&len, sizeof (len), 1, pFile);
+	fwrite (nulls, 1, (col_count + 7) >> 3, pFile);
+
+	for (int i = 0; i < col_count; ++i) {
+		if (nulls[i>>3] & (1 << (i&7))) {
+			continue;
+		}
+		union {
+			int8_t		i8;
+			int16_t		i16;
+			int32_t		i32;
+			int64_t		i64;
+			float		f32;
+			double		f64;
+		} val;
+		xdb_type_t type = xdb_column_type (pRes, i);
+		switch (type) {
+		case XDB_TYPE_BOOL:
+		case XDB_TYPE_TINYINT:
+		case XDB_TYPE_UTINYINT:
+			val.i8 = xdb_column_int (pRes, pRow, i);
+			break;
+		case XDB_TYPE_SMALLINT:
+		case XDB_TYPE_USMALLINT:
+			val.i16 = xdb_column_int (pRes, pRow, i);
+			break;
+		case XDB_TYPE_INT:
+		case XDB_TYPE_UINT:
+			val.i32 = xdb_column_int (pRes, pRow, i);
+			break;
+		case XDB_TYPE_BIGINT:
+		case XDB_TYPE_UBIGINT:
+		case XDB_TYPE_TIMESTAMP:
+			val.i64 = xdb_column_int64 (pRes, pRow, i);
+			break;
+		case XDB_TYPE_FLOAT:
+			val.f32 = xdb_column_float (pRes, pRow, i);
+			break;
+		case XDB_TYPE_DOUBLE:
+			val.f64 = xdb_column_double (pRes, pRow, i);
+			break;
+		case XDB_TYPE_INET:
+			fwrite (xdb_column_inet (pRes, pRow, i), s_xdb_type_len[type], 1, pFile);
+			continue;
+		case XDB_TYPE_MAC:
+			fwrite (xdb_column_mac (pRes, pRow, i), s_xdb_type_len[type], 1, pFile);
+			continue;
+		default:
+			ptr = xdb_column_blob (pRes, pRow, i, &slen);
+			len = slen;
+			fwrite (&len, sizeof (len), 1, pFile);
+			fwrite (ptr, 1, len, pFile);
+			fputc ('\0', pFile);
+			continue;
+		}
+		fwrite (&val, s_xdb_type_len[type], 1, pFile);
+	}
+}
+
+XDB_STATIC int
+xdb_dump_table (xdb_stmt_load_t *pStmt)
+{
+	int 		rc = -1;
+	xdb_conn_t	*pConn = pStmt->pConn;
+	xdb_tblm_t	*pTblm = pStmt->pTblm;
+	bool		bBinary = XDB_LOAD_BINARY == pStmt->format;
+	char		delim = pStmt->delim;
+	uint64_t	count = 0;
+	xdb_res_t 	*pRes = NULL;
+	FILE 		*pFile = fopen (pStmt->file, bBinary ? "wb" : "wt");
+
+	XDB_EXPECT (NULL != pFile, XDB_E_NOTFOUND, "Can't open '%s'", pStmt->file);
+
+	if (bBinary) {
+		xdb_rowfile_hdr_t hdr = {.magic = XDB_ROWFILE_MAGIC, .version = XDB_ROWFILE_VER, .fld_count = pTblm->fld_count};
+		fwrite (&hdr, sizeof (hdr), 1, pFile);
+		for (int i = 0; i < pTblm->fld_count; ++i) {
+			fputc (pTblm->pFields[i].fld_type, pFile);
+		}
+	}
+
+	// statement is overwritten by query
+	pRes = xdb_pexec (pConn, "SELECT * FROM %s.%s", XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm));
+	XDB_EXPECT(pRes->errcode == XDB_OK, pRes->errcode, "%s", xdb_errmsg(pRes));
+
+	int col_count = xdb_column_count (pRes);
+	xdb_row_t *pRow;
+	while (NULL != (pRow = xdb_fetch_row (pRes))) {
+		if (bBinary) {
+			xdb_dump_binrow (pFile, pRes, pRow, col_count);
+		} else {
+			xdb_dump_csvrow (pFile, pRes, pRow, col_count, delim);
+		}
+		count++;
+	}
+	xdb_free_result (pRes);
+	pRes = NULL;
+
+	pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Dump %"PRIu64" rows of table '%s'", count, XDB_OBJ_NAME(pTblm));
+	pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	rc = XDB_OK;
+
+error:
+	xdb_free_result (pRes);
+	xdb_fclose (pFile);
+	return rc;
+}
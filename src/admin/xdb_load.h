@@ -0,0 +1,21 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+#ifndef __CROSS_LOAD_H__
+#define __CROSS_LOAD_H__
+
+XDB_STATIC int 
+xdb_load_data (xdb_stmt_load_t *pStmt);
+
+XDB_STATIC int 
+xdb_dump_table (xdb_stmt_load_t *pStmt);
+
+#endif // __CROSS_LOAD_H__
@@ -517,6 +517,7 @@ xdb_shell_completion_hook (char const *buf, crossline_completions_t *pCompletion
 		"CLOSE",
 		"DUMP",
 		"SOURCE",
+		"LOAD",
 		"SHELL",
 		"HELP",
 		NULL
@@ -540,8 +541,9 @@ xdb_shell_completion_hook (char const *buf, crossline_completions_t *pCompletion
 		"Config parameters",
 		"Open database",
 		"Close database",
-		"Dump database",
+		"Dump database or table",
 		"Load SQL file",
+		"Load CSV or binary row file into table",
 		"Enter interactive shell",
 		"Help",
 		NULL
@@ -0,0 +1,745 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * xdb_fetch_arrow gathers result rows into Arrow columnar buffers and hands them out
+ * by Arrow C Data Interface. Fixed columns are copied from col_off of each row,
+ * validity bitmap is from row NULL bitmap. COPY writes same buffers into Arrow IPC file.
+ *
+ * BOOL b, TINYINT..BIGINT c s i l, UNSIGNED C S I L, FLOAT f, DOUBLE g, TIMESTAMP tsu:UTC,
+ * CHAR VARCHAR JSON u, BINARY VARBINARY z, INET w:18 (xdb_inet_t), MAC w:6
+ */
+
+#define XDB_ARROW_BATCH		65536	// rows of one record batch in IPC file
+
+typedef enum {
+	XDB_ARROW_NONE,
+	XDB_ARROW_NULL,
+	XDB_ARROW_BOOL,
+	XDB_ARROW_FIXED,
+	XDB_ARROW_VAR,
+} xdb_arrow_kind_e;
+
+static const char *s_xdb_arrow_fmt[XDB_TYPE_MAX] = {
+	[XDB_TYPE_NULL     ] = "n",
+	[XDB_TYPE_BOOL	   ] = "b",
+	[XDB_TYPE_TINYINT  ] = "c",
+	[XDB_TYPE_SMALLINT ] = "s",
+	[XDB_TYPE_INT      ] = "i",
+	[XDB_TYPE_BIGINT   ] = "l",
+	[XDB_TYPE_UTINYINT ] = "C",
+	[XDB_TYPE_USMALLINT] = "S",
+	[XDB_TYPE_UINT     ] = "I",
+	[XDB_TYPE_UBIGINT  ] = "L",
+	[XDB_TYPE_FLOAT    ] = "f",
+	[XDB_TYPE_DOUBLE   ] = "g",
+	[XDB_TYPE_TIMESTAMP] = "tsu:UTC",
+	[XDB_TYPE_CHAR     ] = "u",
+	[XDB_TYPE_VCHAR    ] = "u",
+	[XDB_TYPE_JSON	   ] = "u",
+	[XDB_TYPE_BINARY   ] = "z",
+	[XDB_TYPE_VBINARY  ] = "z",
+	[XDB_TYPE_INET	   ] = "w:18",
+	[XDB_TYPE_MAC	   ] = "w:6",
+};
+
+static inline xdb_arrow_kind_e
+xdb_arrow_kind (int type)
+{
+	if ((type >= XDB_TYPE_MAX) || (NULL == s_xdb_arrow_fmt[type])) {
+		return XDB_ARROW_NONE;
+	}
+	switch (type) {
+	case XDB_TYPE_NULL:
+		return XDB_ARROW_NULL;
+	case XDB_TYPE_BOOL:
+		return XDB_ARROW_BOOL;
+	case XDB_TYPE_CHAR:
+	case XDB_TYPE_VCHAR:
+	case XDB_TYPE_JSON:
+	case XDB_TYPE_BINARY:
+	case XDB_TYPE_VBINARY:
+		return XDB_ARROW_VAR;
+	}
+	return XDB_ARROW_FIXED;
+}
+
+typedef struct {
+	const void			*pBufs[1];	// struct has no validity
+	struct ArrowArray	**ppChildren;
+	struct ArrowArray	children[];
+} xdb_arrow_batch_t;
+
+typedef struct {
+	struct ArrowSchema	**ppChildren;
+	struct ArrowSchema	children[];
+} xdb_arrow_struct_t;
+
+static void
+xdb_arrow_array_release (struct ArrowArray *pArray)
+{
+	for (int i = 0; i < pArray->n_children; ++i) {
+		struct ArrowArray *pChild = pArray->children[i];
+		if (NULL != pChild->release) {
+			pChild->release (pChild);
+		}
+	}
+	for (int i = 0; i < pArray->n_buffers; ++i) {
+		free ((void*)pArray->buffers[i]);
+	}
+	xdb_free (pArray->private_data);
+	pArray->release = NULL;
+}
+
+// parent owns buffer pointers, so child buffers are freed by child
+static void
+xdb_arrow_batch_release (struct ArrowArray *pArray)
+{
+	pArray->n_buffers = 0;
+	xdb_arrow_array_release (pArray);
+}
+
+static void
+xdb_arrow_schema_release (struct ArrowSchema *pSchema)
+{
+	for (int i = 0; i < pSchema->n_children; ++i) {
+		struct ArrowSchema *pChild = pSchema->children[i];
+		if (NULL != pChild->release) {
+			pChild->release (pChild);
+		}
+	}
+	xdb_free (pSchema->private_data);
+	pSchema->release = NULL;
+}
+
+XDB_STATIC int
+xdb_arrow_schema (xdb_meta_t *pMeta, struct ArrowSchema *pSchema)
+{
+	int			col_count = pMeta->col_count;
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+
+	xdb_arrow_struct_t *pStruct = xdb_calloc (sizeof (*pStruct) + col_count * (sizeof (struct ArrowSchema) + sizeof (void*)));
+	if (NULL == pStruct) {
+		return XDB_E_MEMORY;
+	}
+	pStruct->ppChildren = (void*)&pStruct->children[col_count];
+
+	memset (pSchema, 0, sizeof (*pSchema));
+	pSchema->format			= "+s";
+	pSchema->name			= "";
+	pSchema->n_children		= col_count;
+	pSchema->children		= pStruct->ppChildren;
+	pSchema->release		= xdb_arrow_schema_release;
+	pSchema->private_data	= pStruct;
+
+	for (int i = 0; i < col_count; ++i) {
+		struct ArrowSchema *pChild = pStruct->ppChildren[i] = &pStruct->children[i];
+		pChild->format			= s_xdb_arrow_fmt[pCols[i]->col_type];
+		pChild->flags			= ARROW_FLAG_NULLABLE;
+		pChild->release			= xdb_arrow_schema_release;
+		pChild->private_data	= xdb_strdup (pCols[i]->col_name, pCols[i]->col_nmlen);
+		pChild->name			= pChild->private_data;
+		if (NULL == pChild->name) {
+			pSchema->release (pSchema);
+			return XDB_E_MEMORY;
+		}
+	}
+
+	return XDB_OK;
+}
+
+xdb_ret
+xdb_fetch_arrow (xdb_res_t *pRes, uint32_t max_rows, struct ArrowSchema *pSchema, struct ArrowArray *pArray)
+{
+	if (xdb_unlikely ((NULL == pRes) || (NULL == pArray) || pRes->errcode || (0 == pRes->col_meta))) {
+		return XDB_E_PARAM;
+	}
+
+	xdb_meta_t	*pMeta = (xdb_meta_t*)pRes->col_meta;
+	int			col_count = pMeta->col_count;
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+	uint64_t	row_data = pRes->row_data, var_len[col_count];
+	int64_t		row_count = 0;
+	xdb_row_t	*pRow;
+	int			len;
+
+	for (int i = 0; i < col_count; ++i) {
+		if (XDB_ARROW_NONE == xdb_arrow_kind (pCols[i]->col_type)) {
+			return XDB_E_PARAM;
+		}
+		var_len[i] = 0;
+	}
+
+	// 1st pass: count rows and bytes of variable columns
+	while (((0 == max_rows) || (row_count < max_rows)) && (NULL != (pRow = xdb_fetch_row (pRes)))) {
+		row_count++;
+		for (int i = 0; i < col_count; ++i) {
+			if ((XDB_ARROW_VAR == xdb_arrow_kind (pCols[i]->col_type)) && !xdb_column_null (pRes, pRow, i)) {
+				len = 0;
+				xdb_column_str2 (pRes, pRow, i, &len);
+				var_len[i] += len;
+			}
+		}
+	}
+	pRes->row_data = row_data;
+
+	xdb_arrow_batch_t *pBatch = xdb_calloc (sizeof (*pBatch) + col_count * (sizeof (struct ArrowArray) + sizeof (void*)));
+	if (NULL == pBatch) {
+		return XDB_E_MEMORY;
+	}
+	pBatch->ppChildren = (void*)&pBatch->children[col_count];
+
+	memset (pArray, 0, sizeof (*pArray));
+	pArray->length			= row_count;
+	pArray->n_buffers		= 1;
+	pArray->buffers			= pBatch->pBufs;
+	pArray->n_children		= col_count;
+	pArray->children		= pBatch->ppChildren;
+	pArray->release			= xdb_arrow_batch_release;
+	pArray->private_data	= pBatch;
+
+	size_t	bmp_len = (row_count + 7) / 8 + 1;
+	bool	bNoMem = false;
+	for (int i = 0; i < col_count; ++i) {
+		struct ArrowArray *pChild = pBatch->ppChildren[i] = &pBatch->children[i];
+		xdb_arrow_kind_e kind = xdb_arrow_kind (pCols[i]->col_type);
+		pChild->length	= row_count;
+		pChild->release	= xdb_arrow_array_release;
+		if (XDB_ARROW_NULL == kind) {
+			pChild->null_count = row_count;
+			continue;
+		}
+		void **pBufs = xdb_calloc (3 * sizeof (void*));
+		if (NULL == pBufs) {
+			bNoMem = true;
+			break;
+		}
+		pChild->buffers			= (const void**)pBufs;
+		pChild->private_data	= pBufs;
+		pChild->n_buffers		= (XDB_ARROW_VAR == kind) ? 3 : 2;
+		if (0 != pMeta->null_off) {
+			bNoMem |= NULL == (pBufs[0] = xdb_calloc (bmp_len));
+		}
+		switch (kind) {
+		case XDB_ARROW_BOOL:
+			bNoMem |= NULL == (pBufs[1] = xdb_calloc (bmp_len));
+			break;
+		case XDB_ARROW_FIXED:
+			bNoMem |= NULL == (pBufs[1] = xdb_calloc (row_count * s_xdb_type_len[pCols[i]->col_type] + 1));
+			break;
+		default:
+			bNoMem |= NULL == (pBufs[1] = xdb_calloc ((row_count + 1) * sizeof (int32_t)));
+			bNoMem |= NULL == (pBufs[2] = xdb_malloc (var_len[i] + 1));
+			break;
+		}
+	}
+	if (xdb_unlikely (bNoMem)) {
+		pArray->release (pArray);
+		return XDB_E_MEMORY;
+	}
+
+	// 2nd pass: gather values row by row
+	for (int64_t r = 0; r < row_count; ++r) {
+		pRow = xdb_fetch_row (pRes);
+		uint8_t *pNull = pMeta->null_off ? pRow + pMeta->null_off : NULL;
+		for (int i = 0; i < col_count; ++i) {
+			struct ArrowArray	*pChild = &pBatch->children[i];
+			xdb_col_t			*pCol = pCols[i];
+			void 				**pBufs = (void**)pChild->buffers;
+			xdb_arrow_kind_e	kind = xdb_arrow_kind (pCol->col_type);
+			if (XDB_ARROW_NULL == kind) {
+				continue;
+			}
+			bool bNull = (NULL != pNull) && !XDB_IS_NOTNULL(pNull, i);
+			if (xdb_unlikely (bNull)) {
+				pChild->null_count++;
+			} else if (NULL != pBufs[0]) {
+				XDB_BMP_SET (pBufs[0], r);
+			}
+			switch (kind) {
+			case XDB_ARROW_BOOL:
+				if (!bNull && *(uint8_t*)(pRow + pCol->col_off)) {
+					XDB_BMP_SET (pBufs[1], r);
+				}
+				break;
+			case XDB_ARROW_FIXED:
+				if (!bNull) {
+					int width = s_xdb_type_len[pCol->col_type];
+					memcpy (pBufs[1] + r * width, pRow + pCol->col_off, width);
+				}
+				break;
+			default:
+				{
+					int32_t *pOff = pBufs[1];
+					len = 0;
+					const char *str = bNull ? NULL : xdb_column_str2 (pRes, pRow, i, &len);
+					if (NULL != str) {
+						memcpy (pBufs[2] + pOff[r], str, len);
+					} else {
+						len = 0;
+					}
+					pOff[r + 1] = pOff[r] + len;
+				}
+				break;
+			}
+		}
+	}
+
+	for (int i = 0; i < col_count; ++i) {
+		struct ArrowArray *pChild = &pBatch->children[i];
+		if ((pChild->n_buffers > 0) && (0 == pChild->null_count)) {
+			xdb_free (((void**)pChild->buffers)[0]);
+		}
+	}
+
+	if (NULL != pSchema) {
+		if (xdb_unlikely (XDB_OK != xdb_arrow_schema (pMeta, pSchema))) {
+			pArray->release (pArray);
+			return XDB_E_MEMORY;
+		}
+	}
+
+	return XDB_OK;
+}
+
+
+/******************************************************************************
+	Arrow IPC file
+
+	"ARROW1\0\0", Schema message, RecordBatch messages, EOS, Footer, int32 footer size, "ARROW1"
+	Message: int32 -1, int32 metadata size, flatbuffer Message, padding, body buffers
+******************************************************************************/
+
+// Flatbuffer is built forward, child objects follow parent so uoffset is positive.
+// Buffer grows as needed, if it can't then writes are dropped and bFail is checked when done.
+typedef struct {
+	uint8_t		*pBuf;
+	uint32_t	len;
+	uint32_t	cap;
+	bool		bFail;
+} xdb_fbb_t;
+
+typedef struct {
+	int64_t		offset;
+	int32_t		meta_len;
+	int32_t		pad;
+	int64_t		body_len;
+} xdb_arrow_block_t;
+
+enum {
+	XDB_FB_TYPE_NULL	= 1,
+	XDB_FB_TYPE_INT		= 2,
+	XDB_FB_TYPE_FLOAT	= 3,
+	XDB_FB_TYPE_BINARY	= 4,
+	XDB_FB_TYPE_UTF8	= 5,
+	XDB_FB_TYPE_BOOL	= 6,
+	XDB_FB_TYPE_TIMESTAMP	= 10,
+	XDB_FB_TYPE_FIXEDBIN	= 15,
+	XDB_FB_MSG_SCHEMA	= 1,
+	XDB_FB_MSG_BATCH	= 3,
+	XDB_FB_VERSION_V5	= 4,
+};
+
+#define XDB_FB_INIT_CAP		1024
+
+#define XDB_FB_SET(pFbb, off, type, val)	\
+	do {	\
+		if (xdb_likely (!(pFbb)->bFail)) {	\
+			*(type*)((pFbb)->pBuf + (off)) = (val);	\
+		}	\
+	} while (0)
+
+XDB_STATIC int
+xdb_fbb_init (xdb_fbb_t *pFbb)
+{
+	pFbb->cap	= XDB_FB_INIT_CAP;
+	pFbb->len	= 4;	// root uoffset
+	pFbb->bFail	= false;
+	// +8 for padding to 8 when written
+	pFbb->pBuf	= xdb_calloc (pFbb->cap + 8);
+	return (NULL != pFbb->pBuf) ? XDB_OK : XDB_E_MEMORY;
+}
+
+// absent fields and padding must be 0, so grown part is cleared
+XDB_STATIC uint32_t
+xdb_fbb_alloc (xdb_fbb_t *pFbb, uint32_t size, uint32_t align)
+{
+	uint32_t off = (pFbb->len + align - 1) & ~(align - 1);
+	if (xdb_unlikely (pFbb->bFail)) {
+		return 0;
+	}
+	if (xdb_unlikely ((uint64_t)off + size > pFbb->cap)) {
+		uint64_t cap = (uint64_t)pFbb->cap * 2;
+		while (cap < (uint64_t)off + size) {
+			cap *= 2;
+		}
+		uint8_t *pBuf = (cap < UINT32_MAX - 8) ? xdb_realloc (pFbb->pBuf, cap + 8) : NULL;
+		if (xdb_unlikely (NULL == pBuf)) {
+			pFbb->bFail = true;
+			return 0;
+		}
+		memset (pBuf + pFbb->cap + 8, 0, cap - pFbb->cap);
+		pFbb->pBuf	= pBuf;
+		pFbb->cap	= cap;
+	}
+	pFbb->len = off + size;
+	return off;
+}
+
+static inline void
+xdb_fbb_copy (xdb_fbb_t *pFbb, uint32_t off, const void *pData, uint32_t len)
+{
+	if (xdb_likely (!pFbb->bFail)) {
+		memcpy (pFbb->pBuf + off, pData, len);
+	}
+}
+
+static inline void
+xdb_fbb_setoff (xdb_fbb_t *pFbb, uint32_t slot, uint32_t target)
+{
+	XDB_FB_SET (pFbb, slot, uint32_t, target - slot);
+}
+
+// fld_size 0 means field is absent, field offsets are returned in pFldOff
+XDB_STATIC uint32_t
+xdb_fbb_table (xdb_fbb_t *pFbb, int fld_count, const uint8_t *fld_size, uint32_t *pFldOff)
+{
+	uint32_t vt = xdb_fbb_alloc (pFbb, 4 + 2 * fld_count, 2);
+	uint32_t tbl = xdb_fbb_alloc (pFbb, 4, 8);
+	for (int i = 0; i < fld_count; ++i) {
+		if (fld_size[i]) {
+			pFldOff[i] = xdb_fbb_alloc (pFbb, fld_size[i], fld_size[i]);
+			XDB_FB_SET (pFbb, vt + 4 + 2 * i, uint16_t, pFldOff[i] - tbl);
+		}
+	}
+	XDB_FB_SET (pFbb, vt, uint16_t, 4 + 2 * fld_count);
+	XDB_FB_SET (pFbb, vt + 2, uint16_t, pFbb->len - tbl);
+	XDB_FB_SET (pFbb, tbl, int32_t, tbl - vt);
+	return tbl;
+}
+
+// return offset of vector length, elements follow
+XDB_STATIC uint32_t
+xdb_fbb_vector (xdb_fbb_t *pFbb, uint32_t count, uint32_t elem_size, uint32_t align)
+{
+	pFbb->len = ((pFbb->len + 4 + align - 1) & ~(align - 1)) - 4;
+	uint32_t off = xdb_fbb_alloc (pFbb, 4 + count * elem_size, 4);
+	XDB_FB_SET (pFbb, off, uint32_t, count);
+	return off;
+}
+
+XDB_STATIC uint32_t
+xdb_fbb_string (xdb_fbb_t *pFbb, const char *str, int len)
+{
+	// length excludes NUL terminator
+	uint32_t off = xdb_fbb_vector (pFbb, len + 1, 1, 4);
+	XDB_FB_SET (pFbb, off, uint32_t, len);
+	xdb_fbb_copy (pFbb, off + 4, str, len);
+	return off;
+}
+
+XDB_STATIC uint32_t
+xdb_arrow_fb_field (xdb_fbb_t *pFbb, xdb_col_t *pCol)
+{
+	// name, nullable, type_type, type, dictionary, children
+	static const uint8_t fld_size[] = {4, 1, 1, 4, 0, 4};
+	uint32_t fld_off[6], off[2];
+	uint32_t field = xdb_fbb_table (pFbb, 6, fld_size, fld_off);
+	uint32_t type, type_type;
+
+	xdb_fbb_setoff (pFbb, fld_off[0], xdb_fbb_string (pFbb, pCol->col_name, pCol->col_nmlen));
+	XDB_FB_SET (pFbb, fld_off[1], uint8_t, 1);
+
+	switch (pCol->col_type) {
+	case XDB_TYPE_NULL:
+		type = xdb_fbb_table (pFbb, 0, NULL, NULL);
+		type_type = XDB_FB_TYPE_NULL;
+		break;
+	case XDB_TYPE_BOOL:
+		type = xdb_fbb_table (pFbb, 0, NULL, NULL);
+		type_type = XDB_FB_TYPE_BOOL;
+		break;
+	case XDB_TYPE_CHAR:
+	case XDB_TYPE_VCHAR:
+	case XDB_TYPE_JSON:
+		type = xdb_fbb_table (pFbb, 0, NULL, NULL);
+		type_type = XDB_FB_TYPE_UTF8;
+		break;
+	case XDB_TYPE_BINARY:
+	case XDB_TYPE_VBINARY:
+		type = xdb_fbb_table (pFbb, 0, NULL, NULL);
+		type_type = XDB_FB_TYPE_BINARY;
+		break;
+	case XDB_TYPE_FLOAT:
+	case XDB_TYPE_DOUBLE:
+		// precision: SINGLE 1, DOUBLE 2
+		type = xdb_fbb_table (pFbb, 1, (uint8_t[]){2}, off);
+		XDB_FB_SET (pFbb, off[0], int16_t, (XDB_TYPE_FLOAT == pCol->col_type) ? 1 : 2);
+		type_type = XDB_FB_TYPE_FLOAT;
+		break;
+	case XDB_TYPE_TIMESTAMP:
+		// unit MICROSECOND 2, timezone
+		type = xdb_fbb_table (pFbb, 2, (uint8_t[]){2, 4}, off);
+		XDB_FB_SET (pFbb, off[0], int16_t, 2);
+		xdb_fbb_setoff (pFbb, off[1], xdb_fbb_string (pFbb, "UTC", 3));
+		type_type = XDB_FB_TYPE_TIMESTAMP;
+		break;
+	case XDB_TYPE_INET:
+	case XDB_TYPE_MAC:
+		// byteWidth
+		type = xdb_fbb_table (pFbb, 1, (uint8_t[]){4}, off);
+		XDB_FB_SET (pFbb, off[0], int32_t, s_xdb_type_len[pCol->col_type]);
+		type_type = XDB_FB_TYPE_FIXEDBIN;
+		break;
+	default:
+		// bitWidth, is_signed
+		type = xdb_fbb_table (pFbb, 2, (uint8_t[]){4, 1}, off);
+		XDB_FB_SET (pFbb, off[0], int32_t, s_xdb_type_len[pCol->col_type] * 8);
+		XDB_FB_SET (pFbb, off[1], uint8_t, pCol->col_type <= XDB_TYPE_BIGINT);
+		type_type = XDB_FB_TYPE_INT;
+		break;
+	}
+	XDB_FB_SET (pFbb, fld_off[2], uint8_t, type_type);
+	xdb_fbb_setoff (pFbb, fld_off[3], type);
+	xdb_fbb_setoff (pFbb, fld_off[5], xdb_fbb_vector (pFbb, 0, 4, 4));
+
+	return field;
+}
+
+XDB_STATIC uint32_t
+xdb_arrow_fb_schema (xdb_fbb_t *pFbb, xdb_meta_t *pMeta)
+{
+	// endianness (Little 0), fields
+	uint32_t	fld_off[2];
+	uint32_t	schema = xdb_fbb_table (pFbb, 2, (uint8_t[]){2, 4}, fld_off);
+	uint32_t	fields = xdb_fbb_vector (pFbb, pMeta->col_count, 4, 4);
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+
+	xdb_fbb_setoff (pFbb, fld_off[1], fields);
+	for (int i = 0; i < pMeta->col_count; ++i) {
+		xdb_fbb_setoff (pFbb, fields + 4 + 4 * i, xdb_arrow_fb_field (pFbb, pCols[i]));
+	}
+	return schema;
+}
+
+// message: header_type, header, bodyLength
+XDB_STATIC uint32_t
+xdb_arrow_fb_msg (xdb_fbb_t *pFbb, int header_type, int64_t body_len, uint32_t *pHdrOff)
+{
+	// version, header_type, header, bodyLength
+	uint32_t fld_off[4];
+	uint32_t msg = xdb_fbb_table (pFbb, 4, (uint8_t[]){2, 1, 4, 8}, fld_off);
+	XDB_FB_SET (pFbb, fld_off[0], int16_t, XDB_FB_VERSION_V5);
+	XDB_FB_SET (pFbb, fld_off[1], uint8_t, header_type);
+	XDB_FB_SET (pFbb, fld_off[3], int64_t, body_len);
+	xdb_fbb_setoff (pFbb, 0, msg);
+	*pHdrOff = fld_off[2];
+	return msg;
+}
+
+// write message prefix and flatbuffer padded to 8, return metadata length
+XDB_STATIC uint32_t
+xdb_arrow_write_msg (FILE *pFile, xdb_fbb_t *pFbb)
+{
+	uint32_t meta_len = XDB_ALIGN8(pFbb->len);
+	int32_t prefix[2] = {-1, meta_len};
+	fwrite (prefix, sizeof (prefix), 1, pFile);
+	fwrite (pFbb->pBuf, meta_len, 1, pFile);
+	return meta_len + sizeof (prefix);
+}
+
+typedef struct {
+	int64_t		offset;
+	int64_t		length;
+} xdb_arrow_buf_t;
+
+XDB_STATIC int
+xdb_arrow_write_batch (FILE *pFile, xdb_meta_t *pMeta, struct ArrowArray *pArray, xdb_arrow_block_t *pBlock)
+{
+	int				col_count = pMeta->col_count;
+	xdb_col_t		**pCols = (xdb_col_t**)pMeta->col_list;
+	int64_t			row_count = pArray->length, body_len = 0;
+	int				buf_count = 0;
+	xdb_fbb_t		fbb;
+	static const uint8_t	s_zero[8];
+
+	xdb_arrow_buf_t	*bufs = xdb_malloc (col_count * 3 * (sizeof (xdb_arrow_buf_t) + sizeof (void*)));
+	if (NULL == bufs) {
+		return XDB_E_MEMORY;
+	}
+	const void		**pBufs = (const void**)&bufs[col_count * 3];
+
+	for (int i = 0; i < col_count; ++i) {
+		struct ArrowArray *pChild = pArray->children[i];
+		for (int b = 0; b < pChild->n_buffers; ++b) {
+			int64_t len;
+			if (0 == b) {
+				len = (NULL != pChild->buffers[0]) ? (row_count + 7) / 8 : 0;
+			} else if (1 == b) {
+				len = (XDB_ARROW_BOOL == xdb_arrow_kind (pCols[i]->col_type)) ? (row_count + 7) / 8 :
+						(XDB_ARROW_VAR == xdb_arrow_kind (pCols[i]->col_type)) ? (row_count + 1) * 4 : row_count * s_xdb_type_len[pCols[i]->col_type];
+			} else {
+				len = ((int32_t*)pChild->buffers[1])[row_count];
+			}
+			pBufs[buf_count] = pChild->buffers[b];
+			bufs[buf_count].offset = body_len;
+			bufs[buf_count++].length = len;
+			body_len += XDB_ALIGN8(len);
+		}
+	}
+
+	if (XDB_OK != xdb_fbb_init (&fbb)) {
+		xdb_free (bufs);
+		return XDB_E_MEMORY;
+	}
+	uint32_t hdr_off, fld_off[3];
+	xdb_arrow_fb_msg (&fbb, XDB_FB_MSG_BATCH, body_len, &hdr_off);
+	// length, nodes, buffers
+	uint32_t batch = xdb_fbb_table (&fbb, 3, (uint8_t[]){8, 4, 4}, fld_off);
+	xdb_fbb_setoff (&fbb, hdr_off, batch);
+	XDB_FB_SET (&fbb, fld_off[0], int64_t, row_count);
+	uint32_t nodes = xdb_fbb_vector (&fbb, col_count, 16, 8);
+	xdb_fbb_setoff (&fbb, fld_off[1], nodes);
+	for (int i = 0; i < col_count; ++i) {
+		int64_t node[2] = {row_count, pArray->children[i]->null_count};
+		xdb_fbb_copy (&fbb, nodes + 4 + 16 * i, node, 16);
+	}
+	uint32_t buffers = xdb_fbb_vector (&fbb, buf_count, 16, 8);
+	xdb_fbb_setoff (&fbb, fld_off[2], buffers);
+	xdb_fbb_copy (&fbb, buffers + 4, bufs, buf_count * 16);
+	if (xdb_unlikely (fbb.bFail)) {
+		xdb_free (fbb.pBuf);
+		xdb_free (bufs);
+		return XDB_E_MEMORY;
+	}
+
+	pBlock->meta_len = xdb_arrow_write_msg (pFile, &fbb);
+	pBlock->body_len = body_len;
+	xdb_free (fbb.pBuf);
+
+	for (int i = 0; i < buf_count; ++i) {
+		if (bufs[i].length > 0) {
+			fwrite (pBufs[i], bufs[i].length, 1, pFile);
+			fwrite (s_zero, XDB_ALIGN8(bufs[i].length) - bufs[i].length, 1, pFile);
+		}
+	}
+	xdb_free (bufs);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_copy_arrow (xdb_stmt_copy_t *pStmt)
+{
+	int 				rc = -1;
+	xdb_conn_t			*pConn = pStmt->pConn;
+	xdb_res_t 			*pRes = NULL;
+	xdb_fbb_t			fbb = {.pBuf = NULL};
+	xdb_arrow_block_t	*pBlocks = NULL;
+	int					blk_count = 0, blk_cap = 0;
+	uint64_t			row_count = 0, pos;
+	struct ArrowArray	array;
+	// statement and SQL buffer are overwritten by query
+	char				*query = xdb_strdup (pStmt->query, 0);
+	char				*file = xdb_strdup (pStmt->file, 0);
+	FILE 				*pFile = NULL;
+
+	XDB_EXPECT ((NULL != query) && (NULL != file), XDB_E_MEMORY, "Can't alloc memory");
+
+	pRes = xdb_exec (pConn, query);
+	if (xdb_unlikely (pRes->errcode != XDB_OK)) {
+		// keep error message of query
+		pRes = NULL;
+		goto error;
+	}
+	XDB_EXPECT (0 != pRes->col_meta, XDB_E_STMT, "COPY query doesn't return rows");
+
+	xdb_meta_t	*pMeta = (xdb_meta_t*)pRes->col_meta;
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+	for (int i = 0; i < pMeta->col_count; ++i) {
+		XDB_EXPECT (XDB_ARROW_NONE != xdb_arrow_kind (pCols[i]->col_type), XDB_E_STMT, "Can't export column '%s' type %s", pCols[i]->col_name, xdb_type2str(pCols[i]->col_type));
+	}
+
+	pFile = fopen (file, "wb");
+	XDB_EXPECT (NULL != pFile, XDB_E_FILE, "Can't open '%s'", file);
+
+	fwrite ("ARROW1\0\0", 8, 1, pFile);
+	pos = 8;
+
+	uint32_t hdr_off;
+	XDB_EXPECT (XDB_OK == xdb_fbb_init (&fbb), XDB_E_MEMORY, "Can't alloc memory");
+	xdb_arrow_fb_msg (&fbb, XDB_FB_MSG_SCHEMA, 0, &hdr_off);
+	xdb_fbb_setoff (&fbb, hdr_off, xdb_arrow_fb_schema (&fbb, pMeta));
+	XDB_EXPECT (!fbb.bFail, XDB_E_MEMORY, "Can't alloc memory");
+	pos += xdb_arrow_write_msg (pFile, &fbb);
+	xdb_free (fbb.pBuf);
+
+	while (1) {
+		XDB_EXPECT (XDB_OK == xdb_fetch_arrow (pRes, XDB_ARROW_BATCH, NULL, &array), XDB_E_MEMORY, "Can't alloc memory");
+		if (0 == array.length) {
+			array.release (&array);
+			break;
+		}
+		if (blk_count == blk_cap) {
+			blk_cap = blk_cap ? blk_cap * 2 : 16;
+			xdb_arrow_block_t *pNew = xdb_realloc (pBlocks, blk_cap * sizeof (*pBlocks));
+			if (NULL == pNew) {
+				array.release (&array);
+				XDB_EXPECT (0, XDB_E_MEMORY, "Can't alloc memory");
+			}
+			pBlocks = pNew;
+		}
+		xdb_arrow_block_t *pBlock = &pBlocks[blk_count++];
+		memset (pBlock, 0, sizeof (*pBlock));
+		pBlock->offset = pos;
+		int ret = xdb_arrow_write_batch (pFile, pMeta, &array, pBlock);
+		row_count += array.length;
+		array.release (&array);
+		XDB_EXPECT (XDB_OK == ret, XDB_E_MEMORY, "Can't alloc memory");
+		pos += pBlock->meta_len + pBlock->body_len;
+	}
+
+	// EOS
+	fwrite ((int32_t[]){-1, 0}, 8, 1, pFile);
+
+	// footer: version, schema, dictionaries, recordBatches
+	uint32_t fld_off[4];
+	XDB_EXPECT (XDB_OK == xdb_fbb_init (&fbb), XDB_E_MEMORY, "Can't alloc memory");
+	uint32_t footer = xdb_fbb_table (&fbb, 4, (uint8_t[]){2, 4, 0, 4}, fld_off);
+	xdb_fbb_setoff (&fbb, 0, footer);
+	XDB_FB_SET (&fbb, fld_off[0], int16_t, XDB_FB_VERSION_V5);
+	xdb_fbb_setoff (&fbb, fld_off[1], xdb_arrow_fb_schema (&fbb, pMeta));
+	uint32_t blocks = xdb_fbb_vector (&fbb, blk_count, 24, 8);
+	xdb_fbb_setoff (&fbb, fld_off[3], blocks);
+	if (blk_count > 0) {
+		xdb_fbb_copy (&fbb, blocks + 4, pBlocks, blk_count * 24);
+	}
+	XDB_EXPECT (!fbb.bFail, XDB_E_MEMORY, "Can't alloc memory");
+	int32_t footer_len = fbb.len;
+	fwrite (fbb.pBuf, footer_len, 1, pFile);
+	fwrite (&footer_len, 4, 1, pFile);
+	fwrite ("ARROW1", 6, 1, pFile);
+
+	XDB_EXPECT (0 == ferror (pFile), XDB_E_FILE, "Can't write '%s'", file);
+
+	pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Copy %"PRIu64" rows to '%s'", row_count, file);
+	pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	rc = XDB_OK;
+
+error:
+	xdb_free (fbb.pBuf);
+	xdb_free (pBlocks);
+	xdb_free_result (pRes);
+	xdb_fclose (pFile);
+	xdb_free (query);
+	xdb_free (file);
+	return rc;
+}
@@ -0,0 +1,421 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * Bitmap index for low cardinality columns: one rowid bitmap per distinct key.
+ * Files keep rowid -> key id and key list, bitmaps are rebuilt from them on open.
+ * Keys are searched linearly, so it's meant for few distinct values.
+ */
+
+#if XDB_LOG_FLAGS & XDB_LOG_IDX
+#define xdb_bmpidxlog(...)	xdb_print(__VA_ARGS__)
+#else
+#define xdb_bmpidxlog(...)
+#endif
+
+#define XDB_BMPIDX_WROW(rid)	xdb_stg_dirty (&pIdxm->stg_mgr, &pIdxm->pBmpHdr->row_key[(rid)-1], sizeof(uint32_t))
+#define XDB_BMPIDX_WKEY(pKey)	xdb_stg_dirty (&pIdxm->stg_mgr2, pKey, sizeof(xdb_bmpKey_t))
+
+XDB_STATIC xdb_rowid
+xdb_bmpidx_rowkey (xdb_idxm_t *pIdxm, void *pRow, uint32_t hash_val)
+{
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	xdb_bmpKey_t	*pBmpKey = pIdxm->pBmpKey;
+
+	for (xdb_rowid kid = 1; kid <= pIdxm->pBmpHdr->key_max; ++kid) {
+		xdb_bmpKey_t *pKey = &pBmpKey[kid];
+		if ((0 == pKey->rid) || (pKey->hash_val != hash_val)) {
+			continue;
+		}
+		if (xdb_row_isequal2 (pIdxm->pTblm, pRow, XDB_IDPTR(pStgMgr, pKey->rid), pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count)) {
+			return kid;
+		}
+	}
+	return 0;
+}
+
+XDB_STATIC xdb_rowid
+xdb_bmpidx_valkey (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	xdb_bmpKey_t	*pBmpKey = pIdxm->pBmpKey;
+	uint32_t		hash_val = xdb_val_hash (ppValues, pIdxm->fld_count);
+
+	for (xdb_rowid kid = 1; kid <= pIdxm->pBmpHdr->key_max; ++kid) {
+		xdb_bmpKey_t *pKey = &pBmpKey[kid];
+		if ((0 == pKey->rid) || (pKey->hash_val != hash_val)) {
+			continue;
+		}
+		if (xdb_row_isequal (pIdxm->pTblm, XDB_IDPTR(pStgMgr, pKey->rid), pIdxm->pFields, pIdxm->pExtract, ppValues, pIdxm->fld_count)) {
+			return kid;
+		}
+	}
+	return 0;
+}
+
+XDB_STATIC int
+xdb_bmpidx_keycap (xdb_idxm_t *pIdxm, xdb_rowid kid)
+{
+	if (kid > pIdxm->key_cap) {
+		if (xdb_stg_truncate (&pIdxm->stg_mgr2, pIdxm->key_cap<<1) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->key_cap = XDB_STG_CAP(&pIdxm->stg_mgr2);
+		pIdxm->pBmpKey = pIdxm->stg_mgr2.pBlkDat1;
+	}
+	if (kid > pIdxm->bmp_cap) {
+		xdb_rowid cap = pIdxm->key_cap;
+		xdb_bmp_t **ppKeyBmp = xdb_realloc (pIdxm->ppKeyBmp, (cap + 1) * sizeof (xdb_bmp_t*));
+		if (NULL == ppKeyBmp) {
+			return -XDB_E_MEMORY;
+		}
+		memset (&ppKeyBmp[pIdxm->bmp_cap + 1], 0, (cap - pIdxm->bmp_cap) * sizeof (xdb_bmp_t*));
+		pIdxm->ppKeyBmp = ppKeyBmp;
+		pIdxm->bmp_cap = cap;
+	}
+	if (NULL == pIdxm->ppKeyBmp[kid]) {
+		pIdxm->ppKeyBmp[kid] = xdb_malloc (sizeof (xdb_bmp_t));
+		if (NULL == pIdxm->ppKeyBmp[kid]) {
+			return -XDB_E_MEMORY;
+		}
+		xdb_bmp_init (pIdxm->ppKeyBmp[kid]);
+	}
+	return XDB_OK;
+}
+
+XDB_STATIC void
+xdb_bmpidx_keyfree (xdb_idxm_t *pIdxm, xdb_rowid kid)
+{
+	if ((kid <= pIdxm->bmp_cap) && (NULL != pIdxm->ppKeyBmp[kid])) {
+		xdb_bmp_free (pIdxm->ppKeyBmp[kid]);
+		xdb_free (pIdxm->ppKeyBmp[kid]);
+		pIdxm->ppKeyBmp[kid] = NULL;
+	}
+}
+
+XDB_STATIC int
+xdb_bmpidx_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRow)
+{
+	xdb_rowid	cap;
+
+	if (new_rid > pIdxm->node_cap) {
+		for (cap = pIdxm->node_cap; cap < new_rid; cap <<= 1)
+			;
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
+		pIdxm->pBmpHdr  = (xdb_bmpHdr_t*)pIdxm->stg_mgr.pStgHdr;
+	}
+
+	xdb_bmpHdr_t	*pBmpHdr = pIdxm->pBmpHdr;
+	if (xdb_unlikely (pBmpHdr->row_key[new_rid-1])) {
+		return XDB_OK;
+	}
+
+	uint32_t	hash_val = xdb_row_hash (pIdxm->pTblm, pRow, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+	xdb_rowid	kid = xdb_bmpidx_rowkey (pIdxm, pRow, hash_val);
+	if (0 == kid) {
+		// reuse freed key first
+		for (kid = 1; (kid <= pBmpHdr->key_max) && pIdxm->pBmpKey[kid].rid; ++kid)
+			;
+		if (xdb_bmpidx_keycap (pIdxm, kid) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		xdb_bmpKey_t *pKey = XDB_BMPIDX_WKEY (&pIdxm->pBmpKey[kid]);
+		pKey->rid		= new_rid;
+		pKey->row_count	= 0;
+		pKey->hash_val	= hash_val;
+		if (kid > pBmpHdr->key_max) {
+			pBmpHdr->key_max = kid;
+		}
+		pBmpHdr->node_count++;
+		xdb_bmpidxlog ("new key %d for rid %d hash %x\n", kid, new_rid, hash_val);
+	}
+
+	if (xdb_bmp_set (pIdxm->ppKeyBmp[kid], new_rid) < 0) {
+		return -XDB_E_MEMORY;
+	}
+	xdb_bmpKey_t *pKey = XDB_BMPIDX_WKEY (&pIdxm->pBmpKey[kid]);
+	pKey->row_count++;
+	XDB_BMPIDX_WROW (new_rid);
+	pBmpHdr->row_key[new_rid-1] = kid;
+	pBmpHdr->row_count++;
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_bmpidx_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
+{
+	xdb_bmpHdr_t	*pBmpHdr = pIdxm->pBmpHdr;
+
+	if (xdb_unlikely ((rid > pIdxm->node_cap) || (0 == pBmpHdr->row_key[rid-1]))) {
+		// not in index
+		return 0;
+	}
+
+	xdb_rowid		kid = pBmpHdr->row_key[rid-1];
+	xdb_bmpKey_t	*pKey = XDB_BMPIDX_WKEY (&pIdxm->pBmpKey[kid]);
+
+	XDB_BMPIDX_WROW (rid);
+	pBmpHdr->row_key[rid-1] = 0;
+	pBmpHdr->row_count--;
+	xdb_bmp_clr (pIdxm->ppKeyBmp[kid], rid);
+
+	if (0 == --pKey->row_count) {
+		xdb_bmpidxlog ("free key %d\n", kid);
+		pKey->rid = 0;
+		pBmpHdr->node_count--;
+		xdb_bmpidx_keyfree (pIdxm, kid);
+	} else if (pKey->rid == rid) {
+		// key value must be kept by a row still in index
+		uint32_t bit;
+		xdb_bmp_first (pIdxm->ppKeyBmp[kid], &bit);
+		pKey->rid = bit;
+	}
+
+	return 0;
+}
+
+XDB_STATIC int
+xdb_bmpidx_query_cb (uint32_t rid, void *pArg)
+{
+	xdb_bmpidx_query_t	*pQuery = pArg;
+	if (xdb_unlikely (pQuery->bFull)) {
+		return XDB_OK;
+	}
+	void *pRow = XDB_IDPTR(&pQuery->pTblm->stg_mgr, rid);
+	if (xdb_likely (xdb_row_valid (pQuery->pConn, pQuery->pTblm, pRow, rid))) {
+		if ((0 == pQuery->flt_count) || xdb_row_and_match (pQuery->pTblm, pRow, pQuery->pFilters, pQuery->flt_count)) {
+			if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pQuery->pRowSet, rid, pRow))) {
+				pQuery->bFull = true;
+			}
+		}
+	}
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_bmp_t*
+xdb_bmpidx_get (xdb_idxfilter_t *pIdxFilter)
+{
+	xdb_idxm_t	*pIdxm = pIdxFilter->pIdxm;
+
+	//affect multi-thead performance
+#if !defined (XDB_HPO)
+	pIdxm->pBmpHdr->query_times++;
+#endif
+
+	xdb_rowid kid = xdb_bmpidx_valkey (pIdxm, pIdxFilter->pIdxVals);
+	return kid ? pIdxm->ppKeyBmp[kid] : NULL;
+}
+
+XDB_STATIC xdb_rowid
+xdb_bmpidx_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pRowSet)
+{
+	xdb_bmp_t	*pKeyBmp = xdb_bmpidx_get (pIdxFilter);
+	if (NULL == pKeyBmp) {
+		return XDB_OK;
+	}
+
+	xdb_bmpidx_query_t query = {.pConn = pConn, .pTblm = pIdxFilter->pIdxm->pTblm, .pFilters = pIdxFilter->pIdxFlts,
+								.flt_count = pIdxFilter->idx_flt_cnt, .bFull = false, .pRowSet = pRowSet};
+	xdb_bmp_iterate (pKeyBmp, xdb_bmpidx_query_cb, &query);
+
+	return XDB_OK;
+}
+
+/*
+ * Driver key bitmap ANDed with bitmaps of all AND members, NE members are ANDed inverted.
+ * Return -1 if any index is not bitmap, else count of rowids, pCb is called for each if not NULL.
+ */
+XDB_STATIC int64_t
+xdb_bmpidx_and (xdb_singfilter_t *pSigFlt, xdb_bmp_cb pCb, void *pArg)
+{
+	xdb_bmp_t	*pAnds[XDB_MAX_AND_IDX], *pNots[XDB_MAX_AND_IDX];
+	int			and_cnt = 0, not_cnt = 0;
+
+	if (XDB_IDX_BITMAP != pSigFlt->pIdxFilter->pIdxm->idx_type) {
+		return -1;
+	}
+	for (int i = 0; i < pSigFlt->and_count; ++i) {
+		if (XDB_IDX_BITMAP != pSigFlt->pAndFilters[i].pIdxm->idx_type) {
+			return -1;
+		}
+	}
+
+	xdb_bmp_t *pKeyBmp = xdb_bmpidx_get (pSigFlt->pIdxFilter);
+	if (NULL == pKeyBmp) {
+		return 0;
+	}
+	for (int i = 0; i < pSigFlt->and_count; ++i) {
+		xdb_idxfilter_t *pIdxFilter = &pSigFlt->pAndFilters[i];
+		xdb_bmp_t *pBmp = xdb_bmpidx_get (pIdxFilter);
+		if (XDB_TOK_NE == pIdxFilter->match_opt) {
+			if (NULL != pBmp) {
+				pNots[not_cnt++] = pBmp;
+			}
+		} else if (NULL == pBmp) {
+			return 0;
+		} else {
+			pAnds[and_cnt++] = pBmp;
+		}
+	}
+
+	return xdb_bmp_and_iterate (pKeyBmp, pAnds, and_cnt, pNots, not_cnt, pCb, pArg);
+}
+
+XDB_STATIC xdb_rowid
+xdb_bmpidx_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
+{
+	uint32_t		hash_val = xdb_row_hash2 (pIdxm->pTblm, pRow2, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	xdb_bmpKey_t	*pBmpKey = pIdxm->pBmpKey;
+
+	for (xdb_rowid kid = 1; kid <= pIdxm->pBmpHdr->key_max; ++kid) {
+		xdb_bmpKey_t *pKey = &pBmpKey[kid];
+		if ((0 == pKey->rid) || (pKey->hash_val != hash_val)) {
+			continue;
+		}
+		if (!xdb_row_isequal2 (pIdxm->pTblm, XDB_IDPTR(pStgMgr, pKey->rid), pRow2, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count)) {
+			continue;
+		}
+		uint32_t bit;
+		if (xdb_bmp_first (pIdxm->ppKeyBmp[kid], &bit) && xdb_row_valid (pConn, pIdxm->pTblm, XDB_IDPTR(pStgMgr, bit), bit)) {
+			return bit;
+		}
+		return 0;
+	}
+
+	return 0;
+}
+
+XDB_STATIC void
+xdb_bmpidx_free (xdb_idxm_t *pIdxm)
+{
+	for (xdb_rowid kid = 1; kid <= pIdxm->bmp_cap; ++kid) {
+		xdb_bmpidx_keyfree (pIdxm, kid);
+	}
+	xdb_free (pIdxm->ppKeyBmp);
+	pIdxm->ppKeyBmp = NULL;
+	pIdxm->bmp_cap = 0;
+}
+
+XDB_STATIC int
+xdb_bmpidx_close (xdb_idxm_t *pIdxm)
+{
+	xdb_stg_close (&pIdxm->stg_mgr);
+	xdb_stg_close (&pIdxm->stg_mgr2);
+	xdb_bmpidx_free (pIdxm);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_bmpidx_drop (xdb_idxm_t *pIdxm)
+{
+	char path[XDB_PATH_LEN + 32];
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+	xdb_stg_drop (&pIdxm->stg_mgr, path);
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.bmp", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+	xdb_stg_drop (&pIdxm->stg_mgr2, path);
+
+	xdb_bmpidx_free (pIdxm);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_bmpidx_create (xdb_idxm_t *pIdxm)
+{
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+	char path[XDB_PATH_LEN + 32];
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+
+	xdb_stghdr_t stg_hdr = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC|XDB_STG_CLEAR, .blk_size = sizeof(uint32_t),
+							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_bmpHdr_t, row_key)};
+	pIdxm->stg_mgr.pOps = pTblm->stg_mgr.pOps;
+	pIdxm->stg_mgr.pStgHdr	= &stg_hdr;
+	int rc = xdb_stg_open (&pIdxm->stg_mgr, path, NULL, NULL);
+	if (rc != XDB_OK) {
+		xdb_errlog ("Failed to create index %s", XDB_OBJ_NAME(pIdxm));
+		return rc;
+	}
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.bmp", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+
+	xdb_stghdr_t stg_hdr2 = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC|XDB_STG_CLEAR, .blk_size = sizeof(xdb_bmpKey_t),
+							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_bmpKeyHdr_t, bmp_key)};
+	pIdxm->stg_mgr2.pOps = pTblm->stg_mgr.pOps;
+	pIdxm->stg_mgr2.pStgHdr	= &stg_hdr2;
+	rc = xdb_stg_open (&pIdxm->stg_mgr2, path, NULL, NULL);
+	if (rc != XDB_OK) {
+		xdb_errlog ("Failed to create index %s", XDB_OBJ_NAME(pIdxm));
+		return rc;
+	}
+
+	pIdxm->pBmpHdr	= (xdb_bmpHdr_t*)pIdxm->stg_mgr.pStgHdr;
+	pIdxm->node_cap	= XDB_STG_CAP(&pIdxm->stg_mgr);
+	pIdxm->pBmpKey	= pIdxm->stg_mgr2.pBlkDat1;
+	pIdxm->key_cap	= XDB_STG_CAP(&pIdxm->stg_mgr2);
+	pIdxm->ppKeyBmp	= NULL;
+	pIdxm->bmp_cap	= 0;
+
+	// bitmaps are not persisted, load them from rowid -> key map
+	xdb_bmpHdr_t *pBmpHdr = pIdxm->pBmpHdr;
+	for (xdb_rowid rid = 1; rid <= pIdxm->node_cap; ++rid) {
+		xdb_rowid kid = pBmpHdr->row_key[rid-1];
+		if (0 == kid) {
+			continue;
+		}
+		if ((kid > pIdxm->key_cap) || (xdb_bmpidx_keycap (pIdxm, kid) < 0)) {
+			return -XDB_E_MEMORY;
+		}
+		xdb_bmp_set (pIdxm->ppKeyBmp[kid], rid);
+	}
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_bmpidx_init (xdb_idxm_t *pIdxm)
+{
+	pIdxm->pBmpHdr->row_count	= 0;
+	pIdxm->pBmpHdr->node_count	= 0;
+	pIdxm->pBmpHdr->key_max		= 0;
+	memset (pIdxm->pBmpHdr->row_key, 0, sizeof(uint32_t) * pIdxm->node_cap);
+	memset (pIdxm->stg_mgr2.pBlkDat, 0, sizeof(xdb_bmpKey_t) * pIdxm->key_cap);
+	xdb_bmpidx_free (pIdxm);
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	xdb_stg_dirty_all (&pIdxm->stg_mgr2);
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_size
+xdb_bmpidx_sync (xdb_idxm_t *pIdxm)
+{
+	return xdb_stg_sync_dirty (&pIdxm->stg_mgr) + xdb_stg_sync_dirty (&pIdxm->stg_mgr2);
+}
+
+static xdb_idx_ops s_xdb_bmpidx_ops = {
+	.idx_add 	= xdb_bmpidx_add,
+	.idx_rem 	= xdb_bmpidx_rem,
+	.idx_query 	= xdb_bmpidx_query,
+	.idx_query2	= xdb_bmpidx_query2,
+	.idx_create = xdb_bmpidx_create,
+	.idx_drop 	= xdb_bmpidx_drop,
+	.idx_close 	= xdb_bmpidx_close,
+	.idx_init	= xdb_bmpidx_init,
+	.idx_sync	= xdb_bmpidx_sync,
+};
@@ -0,0 +1,56 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+#ifndef __XDB_BMPIDX_H__
+#define __XDB_BMPIDX_H__
+
+typedef struct {
+	xdb_rowid				rid;		// row holding the key value, 0 is free key
+	xdb_rowid				row_count;
+	uint32_t				hash_val;
+	uint32_t				rsvd;
+} xdb_bmpKey_t;
+
+typedef struct {
+	xdb_stghdr_t			blk_hdr;
+	uint64_t				query_times;
+	xdb_rowid 				row_count;
+	xdb_rowid 				node_count;	// live keys
+	xdb_rowid 				key_max;	// max key id ever used
+	uint32_t				rsvd[5];
+	uint32_t				row_key[];	// rowid -> key id, 0 is not indexed
+} xdb_bmpHdr_t;
+
+typedef struct {
+	xdb_stghdr_t			blk_hdr;
+	xdb_bmpKey_t			bmp_key[];
+} xdb_bmpKeyHdr_t;
+
+// rowids from bitmap are checked and added to pRowSet
+typedef struct {
+	xdb_conn_t				*pConn;
+	struct xdb_tblm_t		*pTblm;
+	xdb_filter_t			**pFilters;
+	int						flt_count;
+	bool					bFull;
+	xdb_rowset_t			*pRowSet;
+} xdb_bmpidx_query_t;
+
+XDB_STATIC int
+xdb_bmpidx_query_cb (uint32_t rid, void *pArg);
+
+XDB_STATIC xdb_bmp_t*
+xdb_bmpidx_get (xdb_idxfilter_t *pIdxFilter);
+
+XDB_STATIC int64_t
+xdb_bmpidx_and (xdb_singfilter_t *pSigFlt, xdb_bmp_cb pCb, void *pArg);
+
+#endif // __XDB_BMPIDX_H__
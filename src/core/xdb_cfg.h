@@ -25,12 +25,46 @@
 #define XDB_MAX_FKEY		16
 #define XDB_NAME_LEN		64
 #define XDB_MAX_MATCH_COL	64
+#define XDB_MAX_IDX_FILTER	8	 // partial index WHERE filters
+#define XDB_BLOOM_BITS		10	 // bits per key of HASH index Bloom filter
 #define XDB_MAX_ROWS		((1U<<31) - 1)
 #define XDB_MAX_SQL_BUF		(1024*1024)
 #define XDB_MAX_JOIN		8
 
 #define XDB_PATH_LEN		512
 
+#ifndef XDB_RECOVER_THREADS
+#define XDB_RECOVER_THREADS	16 // max threads to redo WAL and repair tables
+#endif
+
+#ifndef XDB_SOURCE_THREADS
+#define XDB_SOURCE_THREADS	8 // max threads to run INSERT batches of SOURCE FAST
+#endif
+
+#ifndef XDB_LOAD_THREADS
+#define XDB_LOAD_THREADS	8 // max threads to parse and insert rows of LOAD DATA
+#endif
+
+#ifndef XDB_SORT_THREADS
+#define XDB_SORT_THREADS	8 // max threads to sort keys of RBTREE bulk build
+#endif
+
+#ifndef XDB_WAL_DELTA
+#define XDB_WAL_DELTA		1 // log update as changed fields of old row instead of delete and new row
+#endif
+
+#define XDB_STG_PAGE_BITS	12 // dirty tracking page 4KB
+#define XDB_STG_SYNC_RANGES	64 // max ranges to msync per flush, else fsync whole file
+
+// checkpoint scheduler defaults, can be changed by SET CHECKPOINT_xxx
+#define XDB_CKPT_POLL		100 // ms to check triggers
+#define XDB_CKPT_PERIOD		1000 // ms, flush if oldest change is older
+#define XDB_CKPT_WAL_SIZE	(64*1024*1024) // flush if WAL grows over
+#define XDB_CKPT_DIRTY_SIZE	(64*1024*1024) // flush if dirty pages grow over
+#ifndef XDB_CKPT_THREADS
+#define XDB_CKPT_THREADS	4 // max threads to flush tables
+#endif
+
 #ifndef XDB_ENABLE_SERVER
 #define XDB_ENABLE_SERVER	1
 #endif
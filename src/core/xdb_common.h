@@ -237,6 +237,7 @@ typedef struct xdb_field_t {
 	uint8_t			fld_idxnum;
 	int8_t			idx_fid[XDB_MAX_MATCH_COL];
 	uint64_t		idx_bmp;
+	uint64_t		cov_bmp;	// indexes which store a copy of field
 } xdb_field_t;
 
 
@@ -69,6 +69,9 @@ xdb_close (xdb_conn_t* pConn)
 
 	xdb_trans_free (pConn);
 	xdb_rowset_free (&pConn->row_set);
+	if (NULL != pConn->pQueryRes) {
+		xdb_structmap_release (pConn->pQueryRes->pStructMap);
+	}
 	xdb_free (pConn->pQueryRes);
 	memset (pConn, 0, sizeof (*pConn));
 	xdb_free (pConn);
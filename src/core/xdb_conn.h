@@ -28,6 +28,7 @@ typedef struct xdb_queryRes_t {
 	uint64_t			buf_len;
 	uint64_t			buf_free; // if not -1 means but not freed yet
 	xdb_stmt_select_t	*pStmt;
+	struct xdb_structmap_t	*pStructMap;	// struct mapping of prepared SELECT
 	
 	xdb_objm_t			*pMetaHash;
 	xdb_conn_t			*pConn; // pConn must be before res
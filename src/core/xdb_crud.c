@@ -38,7 +38,7 @@ xdb_row_vdata_get_off (xdb_tblm_t *pTblm, const void *pRow, int voff)
 }
 
 static inline void*
-xdb_fld_vdata_get (xdb_field_t *pField, const void *pRow, int *pLen)
+xdb_fld_vdata_get (const xdb_field_t *pField, const void *pRow, int *pLen)
 {
 	uint8_t type;
 	xdb_rowid vid = xdb_row_vdata_info (pField->pTblm->row_size, pRow, &type);
@@ -102,6 +102,40 @@ xdb_fetch_row (xdb_res_t *pRes)
 }
 
 
+const void*
+xdb_fetch_rowbuf (xdb_res_t *pRes, uint64_t *pLen)
+{
+	*pLen = 0;
+	if (xdb_unlikely ((NULL == pRes) || pRes->errcode || (0 == pRes->col_meta))) {
+		return NULL;
+	}
+	xdb_rowdat_t *pRowBuf = (xdb_rowdat_t*)pRes->row_data;
+	while (((xdb_rowdat_t*)pRes->row_data)->len_type > 0) {
+		pRes->row_data += ((xdb_rowdat_t*)pRes->row_data)->len_type;
+	}
+	*pLen = (void*)pRes->row_data - (void*)pRowBuf;
+	return pRowBuf;
+}
+
+int
+xdb_result_layout (xdb_res_t *pRes, int32_t *pLayout, int size)
+{
+	if (xdb_unlikely ((NULL == pRes) || (0 == pRes->col_meta))) {
+		return -XDB_E_PARAM;
+	}
+	xdb_meta_t	*pMeta = (xdb_meta_t*)pRes->col_meta;
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+	if (xdb_unlikely (size < 2 + pMeta->col_count)) {
+		return -XDB_E_PARAM;
+	}
+	pLayout[0] = pMeta->row_size;
+	pLayout[1] = pMeta->null_off;
+	for (int i = 0; i < pMeta->col_count; ++i) {
+		pLayout[2 + i] = pCols[i]->col_off;
+	}
+	return pMeta->col_count;
+}
+
 int
 xdb_rewind_result (xdb_res_t *pRes)
 {
@@ -139,6 +173,8 @@ xdb_free_result (xdb_res_t* pRes)
 
 	if (&pQueryRes->res == pRes) {
 		pQueryRes->buf_free = -1LL;
+		xdb_structmap_release (pQueryRes->pStructMap);
+		pQueryRes->pStructMap = NULL;
 		if (pQueryRes->buf_len > 2*XDB_ROW_BUF_SIZE) {
 			if (NULL != pQueryRes->pStmt) {
 				xdb_stmt_free((xdb_stmt_t*)pQueryRes->pStmt);
@@ -158,6 +194,7 @@ xdb_free_result (xdb_res_t* pRes)
 		if (NULL != pQueryRes->pStmt) {
 			xdb_stmt_free((xdb_stmt_t*)pQueryRes->pStmt);
 		}
+		xdb_structmap_release (pQueryRes->pStructMap);
 		xdb_free (pQueryRes);
 	}
 
@@ -284,7 +321,7 @@ xdb_row_isequal2 (xdb_tblm_t *pTblm, void *pRowL, void *pRowR, xdb_field_t **ppF
 {
 	xdb_field_t **ppField = ppFields;
 	for (int i = 0; i < count; ++i, ++ppField) {
-		int lenL, lenR, voffL, voffR;
+		int lenL = 0, lenR = 0, voffL, voffR;
 		xdb_field_t *pField = *ppField;
 		void *pFldValL = pRowL + pField->fld_off;
 		void *pFldValR = pRowR + pField->fld_off;
@@ -328,12 +365,11 @@ xdb_row_isequal2 (xdb_tblm_t *pTblm, void *pRowL, void *pRowR, xdb_field_t **ppF
 
 		case XDB_TYPE_VCHAR:
 		case XDB_TYPE_JSON:
-			voffL = *(int32_t*)pFldValL;
-			if (0 == voffL) { return false; }
-			voffR = *(int32_t*)pFldValR;
-			if (0 == voffR) { return false; }
-			pFldValL = xdb_row_vdata_get (pTblm, pRowL) + 4 + voffL;
-			pFldValR = xdb_row_vdata_get (pTblm, pRowR) + 4 + voffR;
+			// right row may be update row with vdata pointers
+			pFldValL = xdb_fld_vdata_get (pField, pRowL, &lenL);
+			if (NULL == pFldValL) { return false; }
+			pFldValR = xdb_fld_vdata_get (pField, pRowR, &lenR);
+			if (NULL == pFldValR) { return false; }
 			// fall through
 		case XDB_TYPE_CHAR:
 			if (ppExtract[i] != NULL) {
@@ -355,14 +391,15 @@ xdb_row_isequal2 (xdb_tblm_t *pTblm, void *pRowL, void *pRowR, xdb_field_t **ppF
 				}
 				break;
 			}
-			lenL = *(uint16_t*)(pFldValL-2);
-			lenR = *(uint16_t*)(pFldValR-2);
+			if (XDB_TYPE_CHAR == pField->fld_type) {
+				lenL = *(uint16_t*)(pFldValL-2);
+				lenR = *(uint16_t*)(pFldValR-2);
+			}
 			if (lenL != lenR) {
 				return false;
 			}
-			//if (memcmp (pFldValL, pFldValR, lenL)) {
 			//if (strcasecmp (pFldValL, pFldValR)) {
-			if (strcmp (pFldValL, pFldValR)) {
+			if (memcmp (pFldValL, pFldValR, lenL)) {
 				return false;
 			}
 			break;
@@ -386,12 +423,12 @@ xdb_row_isequal2 (xdb_tblm_t *pTblm, void *pRowL, void *pRowR, xdb_field_t **ppF
 			}
 			break;
 		case XDB_TYPE_INET:
-			if (memcmp (pFldValL, pFldValL, ((xdb_inet_t*)pFldValL)->family == 4 ? 6 : 18)) {
+			if (memcmp (pFldValL, pFldValR, ((xdb_inet_t*)pFldValL)->family == 4 ? 6 : 18)) {
 				return false;
 			}
 			break;
 		case XDB_TYPE_MAC:
-			if (memcmp (pFldValL, pFldValL, 6)) {
+			if (memcmp (pFldValL, pFldValR, 6)) {
 				return false;
 			}
 			break;
@@ -414,6 +451,25 @@ xdb_inet_cmp (const xdb_inet_t* pInetL, const xdb_inet_t* pInetR)
 	return pInetL->mask - pInetR->mask;
 }
 
+// pNet prefix contains or equals pInet, host bits of pNet are ignored
+XDB_STATIC bool 
+xdb_inet_contain (const xdb_inet_t* pNet, const xdb_inet_t* pInet)
+{
+	int bits = (4 == pNet->family) ? 32 : 128;
+	if ((pNet->family != pInet->family) || (pNet->mask > pInet->mask)) {
+		return false;
+	}
+	bits = pNet->mask < bits ? pNet->mask : bits;
+	if (memcmp (pNet->addr, pInet->addr, bits >> 3)) {
+		return false;
+	}
+	if (bits & 7) {
+		uint8_t mask = 0xFF << (8 - (bits & 7));
+		return !((pNet->addr[bits >> 3] ^ pInet->addr[bits >> 3]) & mask);
+	}
+	return true;
+}
+
 XDB_STATIC int 
 xdb_row_cmp (xdb_tblm_t *pTblm, void *pRow, xdb_field_t **ppFields, xdb_value_t *ppValues[], int count)
 {
@@ -485,7 +541,7 @@ xdb_row_cmp (xdb_tblm_t *pTblm, void *pRow, xdb_field_t **ppFields, xdb_value_t
 		case XDB_TYPE_CHAR:
 			//if (memcmp (pFldVal, pValue->str.str, len)) {
 			//if ((cmp = strcasecmp (pFldVal, pValue->str.str))) {
-			if ((cmp = strcmp (pFldVal, pValue->str.str))) {
+			if ((cmp = strcmp (pValue->str.str, pFldVal))) {
 				return cmp;
 			}
 			break;
@@ -496,7 +552,7 @@ xdb_row_cmp (xdb_tblm_t *pTblm, void *pRow, xdb_field_t **ppFields, xdb_value_t
 			// fall through
 		case XDB_TYPE_BINARY:
 			len = *(uint16_t*)(pFldVal-2);
-			if ((cmp = memcmp (pFldVal, pValue->str.str, pValue->str.len >= len ? len : pValue->str.len))) {
+			if ((cmp = memcmp (pValue->str.str, pFldVal, pValue->str.len >= len ? len : pValue->str.len))) {
 				return cmp;
 			}
 			if ((cmp = pValue->str.len - len)) {
@@ -504,11 +560,12 @@ xdb_row_cmp (xdb_tblm_t *pTblm, void *pRow, xdb_field_t **ppFields, xdb_value_t
 			}
 			break;
 		case XDB_TYPE_INET:
-			if ((cmp = memcmp (pFldVal, &pValue->inet, (pValue->inet.family == 4) ? 6 : 18))) {
+			if ((cmp = xdb_inet_cmp (&pValue->inet, pFldVal))) {
 				return cmp;
 			}
+			break;
 		case XDB_TYPE_MAC:
-			if ((cmp = memcmp (pFldVal, &pValue->mac, 6))) {
+			if ((cmp = memcmp (&pValue->mac, pFldVal, 6))) {
 				return cmp;
 			}
 			break;
@@ -529,7 +586,7 @@ xdb_row_cmp2 (const void *pRowL, const void *pRowR, xdb_field_t **ppFields, char
 		const void *pRowValL = pRowL + pField->fld_off;
 		const void *pRowValR = pRowR + pField->fld_off;
 		uint32_t  zerobin = 0;
-		int	lenL, lenR;
+		int	lenL = 0, lenR = 0;
 		switch (pField->fld_type) {
 		case XDB_TYPE_INT:
 			if (*(int32_t*)pRowValL != *(int32_t*)pRowValR) {
@@ -599,8 +656,9 @@ xdb_row_cmp2 (const void *pRowL, const void *pRowR, xdb_field_t **ppFields, char
 			break;
 		case XDB_TYPE_VCHAR:
 		case XDB_TYPE_JSON:
-			pRowValL = xdb_row_vdata_get_off (pField->pTblm, pRowL, *(int32_t*)pRowValL);
-			pRowValR = xdb_row_vdata_get_off (pField->pTblm, pRowR, *(int32_t*)pRowValR);
+			// right row may be update row with vdata pointers
+			pRowValL = xdb_fld_vdata_get (pField, pRowL, &lenL);
+			pRowValR = xdb_fld_vdata_get (pField, pRowR, &lenR);
 			// TDB JSON
 			if (xdb_unlikely (NULL == pRowValL)) {
 				pRowValL = "";
@@ -638,16 +696,23 @@ xdb_row_cmp2 (const void *pRowL, const void *pRowR, xdb_field_t **ppFields, char
 				}
 			}
 
+			if (XDB_TYPE_CHAR == pField->fld_type) {
+				lenL = *(uint16_t*)(pRowValL-2);
+				lenR = *(uint16_t*)(pRowValR-2);
+			}
 			//cmp = strcasecmp (pRowValL, pRowValR);
-			cmp = strcmp (pRowValL, pRowValR);
+			cmp = memcmp (pRowValL, pRowValR, lenL>lenR?lenR:lenL);
 			if (cmp) {
 				*pCount = i;
 				return cmp;
+			} else if (lenL != lenR) {
+				*pCount = i;
+				return lenL - lenR;
 			}
 			break;
 		case XDB_TYPE_VBINARY:
-			pRowValL = xdb_row_vdata_get_off (pField->pTblm, pRowL, *(int32_t*)pRowValL);
-			pRowValR = xdb_row_vdata_get_off (pField->pTblm, pRowR, *(int32_t*)pRowValR);
+			pRowValL = xdb_fld_vdata_get (pField, pRowL, &lenL);
+			pRowValR = xdb_fld_vdata_get (pField, pRowR, &lenR);
 			if (xdb_unlikely (NULL == pRowValL)) {
 				pRowValL = (uint8_t*)&zerobin + 2;
 			}
@@ -656,8 +721,10 @@ xdb_row_cmp2 (const void *pRowL, const void *pRowR, xdb_field_t **ppFields, char
 			}
 			// fall through
 		case XDB_TYPE_BINARY:
-			lenL = *(uint16_t*)(pRowValL-2);
-			lenR = *(uint16_t*)(pRowValR-2);
+			if (XDB_TYPE_BINARY == pField->fld_type) {
+				lenL = *(uint16_t*)(pRowValL-2);
+				lenR = *(uint16_t*)(pRowValR-2);
+			}
 			cmp = memcmp (pRowValL, pRowValR, lenL>lenR?lenR:lenL);
 			if (cmp) {
 				*pCount = i;
@@ -838,7 +905,13 @@ xdb_row_and_match (xdb_tblm_t *pTblm, void *pRow, xdb_filter_t **pFilters, int c
 			if (xdb_unlikely (value.val_type != XDB_TYPE_INET)) {
 				return 0;
 			}
-			cmp = xdb_inet_cmp (&value.inet, &pValue->inet);
+			if (xdb_unlikely (XDB_TOK_SUPEQ == pFilter->cmp_op)) {
+				cmp = !xdb_inet_contain (&value.inet, &pValue->inet);
+			} else if (xdb_unlikely (XDB_TOK_SUBEQ == pFilter->cmp_op)) {
+				cmp = !xdb_inet_contain (&pValue->inet, &value.inet);
+			} else {
+				cmp = xdb_inet_cmp (&value.inet, &pValue->inet);
+			}
 			break;
 		case XDB_TYPE_MAC:
 			if (xdb_unlikely (value.val_type != XDB_TYPE_MAC)) {
@@ -861,6 +934,12 @@ xdb_row_and_match (xdb_tblm_t *pTblm, void *pRow, xdb_filter_t **pFilters, int c
 				return false;
 			}
 			break;
+		case XDB_TOK_SUPEQ: 
+		case XDB_TOK_SUBEQ: 
+			if (cmp) {
+				return false;
+			}
+			break;
 		case XDB_TOK_GE: 
 			if (cmp < 0) {
 				return false;
@@ -1005,8 +1084,12 @@ xdb_exp_eval (xdb_value_t *pResVal, xdb_exp_t *pExp, void *pRow)
 		xdb_row_getVal (pRow, pVal2);
 	}
 
+	// convert a copy, constant operand is reused by next row
+	xdb_value_t		val2;
 	if (xdb_unlikely (pVal->sup_type != pVal2->sup_type)) {
-		xdb_convert_val (pVal2, pVal->sup_type);
+		val2 = *pVal2;
+		xdb_convert_val (&val2, pVal->sup_type);
+		pVal2 = &val2;
 	}
 
 	pResVal->sup_type = pVal->sup_type;
@@ -1197,6 +1280,10 @@ xdb_row_set (xdb_tblm_t *pTblm, void *pRow, xdb_setfld_t set_flds[], int count)
 		pVal = xdb_exp_eval (&res_val, &pSetFld->exp, pRow);
 
 		if (xdb_unlikely (pField->sup_type != pVal->sup_type)) {
+			if (pVal != &res_val) {
+				res_val = *pVal;
+				pVal = &res_val;
+			}
 			xdb_convert_val (pVal, pField->sup_type);
 		}
 		xdb_col_set (pTblm, pRow, pField, pSetFld->exp.op_val[0].pExtract, pVal);
@@ -1302,7 +1389,7 @@ XDB_STATIC uint64_t
 xdb_row_hash2 (xdb_tblm_t *pTblm, void *pRow, xdb_field_t *pFields[], char *pExtract[], int count)
 {
 	uint64_t hashsum = 0, hash;
-	xdb_str_t *pVStr = pRow + pTblm->row_size, *pStr;
+	int len;
 
 	xdb_field_t **ppField = pFields;
 	for (int i = 0; i < count; ++i, ++ppField) {
@@ -1336,10 +1423,15 @@ xdb_row_hash2 (xdb_tblm_t *pTblm, void *pRow, xdb_field_t *pFields[], char *pExt
 
 		case XDB_TYPE_VCHAR:
 		case XDB_TYPE_JSON:
-			pStr = &pVStr[i];
-			if (pStr != NULL) {
+			// update row has vdata pointers
+			ptr = xdb_fld_vdata_get (pField, pRow, &len);
+			if (xdb_unlikely (NULL == ptr)) {
+				hash = 0;
+				break;
+			}
+			if (pExtract[i] != NULL) {
 				xdb_value_t value;
-				bool bOk = xdb_json_extract (pVStr[i].str, pExtract[i], &value);
+				bool bOk = xdb_json_extract (ptr, pExtract[i], &value);
 				if (bOk) {
 					if (XDB_TYPE_BIGINT == value.val_type) {
 						hash = value.ival;
@@ -1353,24 +1445,16 @@ xdb_row_hash2 (xdb_tblm_t *pTblm, void *pRow, xdb_field_t *pFields[], char *pExt
 				}
 				break;
 			}
-			if (xdb_unlikely (NULL != pStr->str)) {
-				hash = xdb_wyhash (pStr->str, pStr->len);
-				//hash = xdb_strcasehash (pStr->str, pStr->len);
-			} else {
-				hash = 0;
-			}
+			hash = xdb_wyhash (ptr, len);
+			//hash = xdb_strcasehash (ptr, len);
 			break;
 		case XDB_TYPE_CHAR:
 			hash = xdb_wyhash (ptr, *(uint16_t*)(ptr-2));
 			//hash = xdb_strcasehash (ptr, *(uint16_t*)(ptr-2));
 			break;
 		case XDB_TYPE_VBINARY:
-			pStr = &pVStr[i];
-			if (xdb_unlikely (NULL != pStr->str)) {
-				hash = xdb_wyhash (ptr, *(uint16_t*)(ptr-2));
-			} else {
-				hash = 0;
-			}
+			ptr = xdb_fld_vdata_get (pField, pRow, &len);
+			hash = xdb_likely (NULL != ptr) ? xdb_wyhash (ptr, len) : 0;
 			break;
 		case XDB_TYPE_BINARY:
 			hash = xdb_wyhash (ptr, *(uint16_t*)(ptr-2));
@@ -1432,6 +1516,375 @@ xdb_val_hash (xdb_value_t **ppValues, int count)
 	return hashsum;
 }
 
+/*
+ * Key ops of index: generic ones loop over fields and switch on type, 
+ * specialized ones are selected on index create or open for common key shapes.
+ * They must give same hash and order as generic ones, as index is persisted.
+ */
+
+XDB_STATIC uint64_t 
+xdb_key_hash_gen (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return xdb_row_hash (pIdxm->pTblm, pRow, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+}
+
+XDB_STATIC uint64_t 
+xdb_key_hash2_gen (xdb_idxm_t *pIdxm, void *pRow2)
+{
+	return xdb_row_hash2 (pIdxm->pTblm, pRow2, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_gen (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	return xdb_val_hash (ppValues, pIdxm->fld_count);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_gen (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return xdb_row_isequal (pIdxm->pTblm, pRow, pIdxm->pFields, pIdxm->pExtract, ppValues, pIdxm->fld_count);
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_gen (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	return xdb_row_isequal2 (pIdxm->pTblm, pRowL, pRowR, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+}
+
+XDB_STATIC int 
+xdb_key_cmp_gen (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	return xdb_row_cmp (pIdxm->pTblm, pRow, pIdxm->pFields, ppValues, count);
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_gen (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	return xdb_row_cmp3 (pRowL, pRowR, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+}
+
+static xdb_key_ops s_xdb_key_gen_ops = {
+	.key_hash	= xdb_key_hash_gen,
+	.key_hash2	= xdb_key_hash2_gen,
+	.val_hash	= xdb_key_vhash_gen,
+	.key_eq		= xdb_key_eq_gen,
+	.key_eq2	= xdb_key_eq2_gen,
+	.key_cmp	= xdb_key_cmp_gen,
+	.key_cmp2	= xdb_key_cmp2_gen
+};
+
+#define XDB_KEY_PTR(pRow, n)	((void*)(pRow) + pIdxm->pFields[n]->fld_off)
+
+// single INT
+
+XDB_STATIC uint64_t 
+xdb_key_hash_i32 (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return *(uint32_t*)XDB_KEY_PTR(pRow, 0);
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_i64 (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	return xdb_likely (XDB_TYPE_BIGINT == ppValues[0]->val_type) ? ppValues[0]->ival : xdb_val_hash (ppValues, 1);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_i32 (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return ppValues[0]->ival == *(int32_t*)XDB_KEY_PTR(pRow, 0);
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_i32 (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	return *(int32_t*)XDB_KEY_PTR(pRowL, 0) == *(int32_t*)XDB_KEY_PTR(pRowR, 0);
+}
+
+XDB_STATIC int 
+xdb_key_cmp_i32 (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	int64_t val = ppValues[0]->ival, key = *(int32_t*)XDB_KEY_PTR(pRow, 0);
+	return (val > key) - (val < key);
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_i32 (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	int32_t keyL = *(int32_t*)XDB_KEY_PTR(pRowL, 0), keyR = *(int32_t*)XDB_KEY_PTR(pRowR, 0);
+	return (keyL > keyR) - (keyL < keyR);
+}
+
+static xdb_key_ops s_xdb_key_i32_ops = {
+	.key_hash	= xdb_key_hash_i32,
+	.key_hash2	= xdb_key_hash_i32,
+	.val_hash	= xdb_key_vhash_i64,
+	.key_eq		= xdb_key_eq_i32,
+	.key_eq2	= xdb_key_eq2_i32,
+	.key_cmp	= xdb_key_cmp_i32,
+	.key_cmp2	= xdb_key_cmp2_i32
+};
+
+// single BIGINT or TIMESTAMP
+
+XDB_STATIC uint64_t 
+xdb_key_hash_i64 (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return *(uint64_t*)XDB_KEY_PTR(pRow, 0);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_i64 (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return ppValues[0]->ival == *(int64_t*)XDB_KEY_PTR(pRow, 0);
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_i64 (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	return *(int64_t*)XDB_KEY_PTR(pRowL, 0) == *(int64_t*)XDB_KEY_PTR(pRowR, 0);
+}
+
+XDB_STATIC int 
+xdb_key_cmp_i64 (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	int64_t val = ppValues[0]->ival, key = *(int64_t*)XDB_KEY_PTR(pRow, 0);
+	return (val > key) - (val < key);
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_i64 (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	int64_t keyL = *(int64_t*)XDB_KEY_PTR(pRowL, 0), keyR = *(int64_t*)XDB_KEY_PTR(pRowR, 0);
+	return (keyL > keyR) - (keyL < keyR);
+}
+
+static xdb_key_ops s_xdb_key_i64_ops = {
+	.key_hash	= xdb_key_hash_i64,
+	.key_hash2	= xdb_key_hash_i64,
+	.val_hash	= xdb_key_vhash_i64,
+	.key_eq		= xdb_key_eq_i64,
+	.key_eq2	= xdb_key_eq2_i64,
+	.key_cmp	= xdb_key_cmp_i64,
+	.key_cmp2	= xdb_key_cmp2_i64
+};
+
+// INT + INT
+
+XDB_STATIC uint64_t 
+xdb_key_hash_ii (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return (uint64_t)*(uint32_t*)XDB_KEY_PTR(pRow, 0) * XDB_HASH_COM_MUL + *(uint32_t*)XDB_KEY_PTR(pRow, 1);
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_ii (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	if (xdb_likely ((XDB_TYPE_BIGINT == ppValues[0]->val_type) && (XDB_TYPE_BIGINT == ppValues[1]->val_type))) {
+		return (uint64_t)ppValues[0]->ival * XDB_HASH_COM_MUL + ppValues[1]->ival;
+	}
+	return xdb_val_hash (ppValues, 2);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_ii (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return (ppValues[0]->ival == *(int32_t*)XDB_KEY_PTR(pRow, 0)) && (ppValues[1]->ival == *(int32_t*)XDB_KEY_PTR(pRow, 1));
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_ii (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	return (*(int32_t*)XDB_KEY_PTR(pRowL, 0) == *(int32_t*)XDB_KEY_PTR(pRowR, 0)) && 
+			(*(int32_t*)XDB_KEY_PTR(pRowL, 1) == *(int32_t*)XDB_KEY_PTR(pRowR, 1));
+}
+
+// range query may compare key prefix only
+XDB_STATIC int 
+xdb_key_cmp_ii (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	int64_t val = ppValues[0]->ival, key = *(int32_t*)XDB_KEY_PTR(pRow, 0);
+	if ((val != key) || (count < 2)) {
+		return (val > key) - (val < key);
+	}
+	val = ppValues[1]->ival;
+	key = *(int32_t*)XDB_KEY_PTR(pRow, 1);
+	return (val > key) - (val < key);
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_ii (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	int32_t keyL = *(int32_t*)XDB_KEY_PTR(pRowL, 0), keyR = *(int32_t*)XDB_KEY_PTR(pRowR, 0);
+	if (keyL == keyR) {
+		keyL = *(int32_t*)XDB_KEY_PTR(pRowL, 1);
+		keyR = *(int32_t*)XDB_KEY_PTR(pRowR, 1);
+	}
+	return (keyL > keyR) - (keyL < keyR);
+}
+
+static xdb_key_ops s_xdb_key_ii_ops = {
+	.key_hash	= xdb_key_hash_ii,
+	.key_hash2	= xdb_key_hash_ii,
+	.val_hash	= xdb_key_vhash_ii,
+	.key_eq		= xdb_key_eq_ii,
+	.key_eq2	= xdb_key_eq2_ii,
+	.key_cmp	= xdb_key_cmp_ii,
+	.key_cmp2	= xdb_key_cmp2_ii
+};
+
+// single CHAR(n)
+
+XDB_STATIC uint64_t 
+xdb_key_hash_str (xdb_idxm_t *pIdxm, void *pRow)
+{
+	void *ptr = XDB_KEY_PTR(pRow, 0);
+	return xdb_wyhash (ptr, *(uint16_t*)(ptr-2));
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_str (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	return xdb_likely (XDB_TYPE_CHAR == ppValues[0]->val_type) ? xdb_wyhash (ppValues[0]->str.str, ppValues[0]->str.len) : xdb_val_hash (ppValues, 1);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_str (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	void *ptr = XDB_KEY_PTR(pRow, 0);
+	return (*(uint16_t*)(ptr-2) == ppValues[0]->str.len) && !memcmp (ptr, ppValues[0]->str.str, ppValues[0]->str.len);
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_str (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	void *ptrL = XDB_KEY_PTR(pRowL, 0), *ptrR = XDB_KEY_PTR(pRowR, 0);
+	return (*(uint16_t*)(ptrL-2) == *(uint16_t*)(ptrR-2)) && !memcmp (ptrL, ptrR, *(uint16_t*)(ptrL-2));
+}
+
+XDB_STATIC int 
+xdb_key_cmp_str (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	return strcmp (ppValues[0]->str.str, XDB_KEY_PTR(pRow, 0));
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_str (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	return strcmp (XDB_KEY_PTR(pRowL, 0), XDB_KEY_PTR(pRowR, 0));
+}
+
+static xdb_key_ops s_xdb_key_str_ops = {
+	.key_hash	= xdb_key_hash_str,
+	.key_hash2	= xdb_key_hash_str,
+	.val_hash	= xdb_key_vhash_str,
+	.key_eq		= xdb_key_eq_str,
+	.key_eq2	= xdb_key_eq2_str,
+	.key_cmp	= xdb_key_cmp_str,
+	.key_cmp2	= xdb_key_cmp2_str
+};
+
+// single INET, IPv4 compares family, mask and 4B address
+
+#define XDB_INET_LEN(pInet)		((4 == ((xdb_inet_t*)(pInet))->family) ? 6 : 18)
+
+XDB_STATIC uint64_t 
+xdb_key_hash_inet (xdb_idxm_t *pIdxm, void *pRow)
+{
+	void *ptr = XDB_KEY_PTR(pRow, 0);
+	return xdb_wyhash (ptr, XDB_INET_LEN(ptr));
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_inet (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	return xdb_likely (XDB_TYPE_INET == ppValues[0]->val_type) ? xdb_wyhash (&ppValues[0]->inet, XDB_INET_LEN(&ppValues[0]->inet)) : xdb_val_hash (ppValues, 1);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_inet (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return !memcmp (XDB_KEY_PTR(pRow, 0), &ppValues[0]->inet, XDB_INET_LEN(&ppValues[0]->inet));
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_inet (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	void *ptrL = XDB_KEY_PTR(pRowL, 0);
+	return !memcmp (ptrL, XDB_KEY_PTR(pRowR, 0), XDB_INET_LEN(ptrL));
+}
+
+XDB_STATIC int 
+xdb_key_cmp_inet (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	return xdb_inet_cmp (&ppValues[0]->inet, XDB_KEY_PTR(pRow, 0));
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_inet (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	return xdb_inet_cmp (XDB_KEY_PTR(pRowL, 0), XDB_KEY_PTR(pRowR, 0));
+}
+
+static xdb_key_ops s_xdb_key_inet_ops = {
+	.key_hash	= xdb_key_hash_inet,
+	.key_hash2	= xdb_key_hash_inet,
+	.val_hash	= xdb_key_vhash_inet,
+	.key_eq		= xdb_key_eq_inet,
+	.key_eq2	= xdb_key_eq2_inet,
+	.key_cmp	= xdb_key_cmp_inet,
+	.key_cmp2	= xdb_key_cmp2_inet
+};
+
+// single MAC
+
+XDB_STATIC uint64_t 
+xdb_key_hash_mac (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return xdb_wyhash (XDB_KEY_PTR(pRow, 0), 6);
+}
+
+XDB_STATIC uint64_t 
+xdb_key_vhash_mac (xdb_idxm_t *pIdxm, xdb_value_t **ppValues)
+{
+	return xdb_likely (XDB_TYPE_MAC == ppValues[0]->val_type) ? xdb_wyhash (&ppValues[0]->mac, 6) : xdb_val_hash (ppValues, 1);
+}
+
+XDB_STATIC bool 
+xdb_key_eq_mac (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues)
+{
+	return !memcmp (XDB_KEY_PTR(pRow, 0), &ppValues[0]->mac, 6);
+}
+
+XDB_STATIC bool 
+xdb_key_eq2_mac (xdb_idxm_t *pIdxm, void *pRowL, void *pRowR)
+{
+	return !memcmp (XDB_KEY_PTR(pRowL, 0), XDB_KEY_PTR(pRowR, 0), 6);
+}
+
+XDB_STATIC int 
+xdb_key_cmp_mac (xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count)
+{
+	return memcmp (&ppValues[0]->mac, XDB_KEY_PTR(pRow, 0), 6);
+}
+
+XDB_STATIC int 
+xdb_key_cmp2_mac (xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR)
+{
+	return memcmp (XDB_KEY_PTR(pRowL, 0), XDB_KEY_PTR(pRowR, 0), 6);
+}
+
+static xdb_key_ops s_xdb_key_mac_ops = {
+	.key_hash	= xdb_key_hash_mac,
+	.key_hash2	= xdb_key_hash_mac,
+	.val_hash	= xdb_key_vhash_mac,
+	.key_eq		= xdb_key_eq_mac,
+	.key_eq2	= xdb_key_eq2_mac,
+	.key_cmp	= xdb_key_cmp_mac,
+	.key_cmp2	= xdb_key_cmp2_mac
+};
+
 #if 0
 XDB_STATIC xdb_ret
 xdb_row_setval (xdb_conn_t *pConn, xdb_field_t *pFld, void *pRow, const char *val, int len)
@@ -1832,7 +2285,9 @@ xdb_column_str2 (xdb_res_t *pRes, xdb_row_t *pRow, uint16_t iCol, int *pLen)
 				return (const char*)pVal;
 			}
 			if (XDB_VTYPE_OK(type)) {
-				return xdb_row_vdata_get (pTblm, pRow) + 4 + voff;
+				pVal = xdb_row_vdata_get (pTblm, pRow) + 4 + voff;
+				*pLen = *(uint16_t*)(pVal-2);
+				return (const char*)pVal;
 			}
 			if (XDB_VTYPE_PTR == type) {
 				xdb_field_t *pField = &pTblm->pFields[iCol];
@@ -1918,6 +2373,79 @@ xdb_column_str (xdb_res_t *pRes, xdb_row_t *pRow, uint16_t iCol)
 	return xdb_column_str2 (pRes, pRow, iCol, &len);
 }
 
+int
+xdb_fetch_cols (xdb_res_t *pRes, uint32_t max_rows, xdb_colbuf_t *pBufs)
+{
+	if (xdb_unlikely ((NULL == pRes) || (NULL == pBufs))) { return -XDB_E_PARAM; }
+	if (xdb_unlikely (pRes->errcode || (0 == pRes->col_meta))) {
+		return 0;
+	}
+	xdb_meta_t 	*pMeta = (xdb_meta_t*)pRes->col_meta;
+	xdb_col_t	**pCols = (xdb_col_t**)pMeta->col_list;
+	uint32_t	count = 0;
+
+	if (0 == max_rows) {
+		max_rows = XDB_MAX_ROWS;
+	}
+	for (int i = 0; i < pMeta->col_count; ++i) {
+		if (NULL != pBufs[i].pOffs) {
+			pBufs[i].pOffs[0] = 0;
+		}
+	}
+
+	for (; count < max_rows; ++count) {
+		xdb_rowdat_t *pCurRow = (xdb_rowdat_t*)pRes->row_data;
+		if (pCurRow->len_type <= 0) {
+			break;
+		}
+		void 	*pRow = pCurRow->rowdat;
+		uint8_t *pNull = pMeta->null_off ? (uint8_t*)(pRow + pMeta->null_off) : NULL;
+
+		for (int i = 0; i < pMeta->col_count; ++i) {
+			xdb_colbuf_t	*pBuf = &pBufs[i];
+			xdb_col_t		*pCol = pCols[i];
+			if (NULL == pBuf->pData) {
+				continue;
+			}
+			bool bNull = (NULL != pNull) && !XDB_IS_NOTNULL(pNull, i);
+			if (NULL != pBuf->pNull) {
+				pBuf->pNull[count] = bNull;
+			}
+			switch (pCol->col_type) {
+			case XDB_TYPE_CHAR:
+			case XDB_TYPE_BINARY:
+			case XDB_TYPE_VCHAR:
+			case XDB_TYPE_VBINARY:
+			case XDB_TYPE_JSON:
+				{
+					int len = 0;
+					const char *pStr = bNull ? NULL : xdb_column_str2 (pRes, pRow, i, &len);
+					uint32_t off = pBuf->pOffs[count];
+					if (NULL == pStr) {
+						len = 0;
+					}
+					if (xdb_unlikely (off + len > pBuf->data_cap)) {
+						// stop before this row, caller fetches it with next call or larger buffer
+						return (count > 0) ? count : -XDB_E_MEMORY;
+					}
+					memcpy (pBuf->pData + off, pStr, len);
+					pBuf->pOffs[count + 1] = off + len;
+				}
+				break;
+			default:
+				{
+					int len = s_xdb_type_len[pCol->col_type];
+					memcpy (pBuf->pData + count * len, pRow + pCol->col_off, len);
+				}
+				break;
+			}
+		}
+		pRes->row_data += pCurRow->len_type;
+	}
+
+	return count;
+}
+
 
 bool 
 xdb_col_null (xdb_res_t *pRes, xdb_row_t *pRow, const char *name)
@@ -2348,23 +2876,102 @@ xdb_sql_query2 (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowset_t *pRowSet, xdb
 }
 #endif
 
+// Rows of 1st index are intersected with rowid bitmap of each other index, then filtered
+XDB_STATIC int 
+xdb_sql_and_query (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowset_t *pRowSet, xdb_singfilter_t *pSigFlt)
+{
+	// all bitmap indexes, AND their bitmaps word by word
+	xdb_bmpidx_query_t query = {.pConn = pConn, .pTblm = pTblm, .pFilters = pSigFlt->pFilters,
+								.flt_count = pSigFlt->filter_count, .bFull = false, .pRowSet = pRowSet};
+	if (xdb_bmpidx_and (pSigFlt, xdb_bmpidx_query_cb, &query) >= 0) {
+		return XDB_OK;
+	}
+
+	xdb_rowset_t	*pSets = xdb_malloc (2 * sizeof (xdb_rowset_t));
+	if (xdb_unlikely (NULL == pSets)) {
+		return -XDB_E_MEMORY;
+	}
+	xdb_rowset_t	*pDrvSet = &pSets[0], *pBmpSet = &pSets[1];
+	xdb_rowset_init (pDrvSet);
+	xdb_rowset_init (pBmpSet);
+
+	pSigFlt->pIdxFilter->pIdxm->pIdxOps->idx_query (pConn, pSigFlt->pIdxFilter, pDrvSet);
+	xdb_rowid count = pDrvSet->count;
+
+	for (int i = 0; (i < pSigFlt->and_count) && (count > 0); ++i) {
+		xdb_idxfilter_t *pIdxFilter = &pSigFlt->pAndFilters[i];
+		if (XDB_IDX_BITMAP == pIdxFilter->pIdxm->idx_type) {
+			// test index bitmap directly, NE keeps rows not in it
+			xdb_bmp_t *pKeyBmp = xdb_bmpidx_get (pIdxFilter);
+			bool bNot = (XDB_TOK_NE == pIdxFilter->match_opt);
+			xdb_rowid n = 0;
+			for (xdb_rowid r = 0; r < count; ++r) {
+				if (((NULL != pKeyBmp) && xdb_bmp_get (pKeyBmp, pDrvSet->pRowList[r].rid)) != bNot) {
+					pDrvSet->pRowList[n++] = pDrvSet->pRowList[r];
+				}
+			}
+			count = n;
+			continue;
+		}
+		pBmpSet->pBmp = &pBmpSet->bmp;
+		xdb_bmp_init (pBmpSet->pBmp);
+		pIdxFilter->pIdxm->pIdxOps->idx_query (pConn, pIdxFilter, pBmpSet);
+		xdb_rowid n = 0;
+		for (xdb_rowid r = 0; r < count; ++r) {
+			if (xdb_bmp_get (pBmpSet->pBmp, pDrvSet->pRowList[r].rid)) {
+				pDrvSet->pRowList[n++] = pDrvSet->pRowList[r];
+			}
+		}
+		count = n;
+		xdb_bmp_free (pBmpSet->pBmp);
+		xdb_rowset_clean (pBmpSet);
+	}
+
+	int rc = XDB_OK;
+	for (xdb_rowid r = 0; r < count; ++r) {
+		void *pRow = pDrvSet->pRowList[r].ptr;
+		if (xdb_row_and_match (pTblm, pRow, pSigFlt->pFilters, pSigFlt->filter_count)) {
+			rc = xdb_rowset_add (pRowSet, pDrvSet->pRowList[r].rid, pRow);
+			if (xdb_unlikely (rc < 0)) {
+				// limit reached is not error
+				rc = (-XDB_E_FULL == rc) ? XDB_OK : rc;
+				break;
+			}
+		}
+	}
+
+	xdb_rowset_free (pDrvSet);
+	xdb_rowset_free (pBmpSet);
+	xdb_free (pSets);
+	return rc;
+}
+
+// return -XDB_E_MEMORY if intermediate row sets can't be allocated
 XDB_STATIC int 
 xdb_sql_query (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowset_t *pRowSet, xdb_reftbl_t *pRefTbl)
 {
 	if (xdb_likely (pRefTbl->bUseIdx)) {
+		int rc = XDB_OK;
 		if (xdb_unlikely (pRefTbl->or_count > 1)) {
 			pRowSet->pBmp = &pRowSet->bmp;
 			xdb_bmp_init (pRowSet->pBmp);
 		}
 		for (int i = 0; i < pRefTbl->or_count; ++i) {
 			xdb_idxfilter_t 	*pIdxFilter = pRefTbl->or_list[i].pIdxFilter;
+			if (xdb_unlikely (pRefTbl->or_list[i].and_count > 0)) {
+				rc = xdb_sql_and_query (pConn, pRefTbl->pRefTblm, pRowSet, &pRefTbl->or_list[i]);
+				if (xdb_unlikely (rc < 0)) {
+					break;
+				}
+				continue;
+			}
 			pIdxFilter->pIdxm->pIdxOps->idx_query (pConn, pIdxFilter, pRowSet);
 		}
 		if (xdb_unlikely (pRowSet->pBmp != NULL)) {
 			xdb_bmp_free (pRowSet->pBmp);
 			pRowSet->pBmp = NULL;
 		}
-		return XDB_OK;
+		return rc;
 	}
 
 	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
@@ -2428,6 +3035,70 @@ xdb_sql_join (xdb_stmt_select_t *pStmt, xdb_rowptr_t *pRowPtrs, int level, xdb_r
 	return 0;
 }
 
+typedef struct {
+	xdb_conn_t		*pConn;
+	xdb_tblm_t		*pTblm;
+	int64_t			count;
+} xdb_bmpcount_t;
+
+XDB_STATIC int 
+xdb_sql_bmpcount_cb (uint32_t rid, void *pArg)
+{
+	xdb_bmpcount_t	*pCount = pArg;
+	if (xdb_row_valid (pCount->pConn, pCount->pTblm, XDB_IDPTR(&pCount->pTblm->stg_mgr, rid), rid)) {
+		pCount->count++;
+	}
+	return XDB_OK;
+}
+
+/*
+ * SELECT COUNT(*) whose filters are all answered by bitmap indexes: popcount of ANDed bitmaps.
+ * Rows of open transaction or TTL may be invisible, then each rowid is checked instead.
+ * Return -1 if can't count by bitmap.
+ */
+XDB_STATIC int64_t 
+xdb_sql_bmpcount (xdb_stmt_select_t *pStmt, xdb_reftbl_t *pRefTbl)
+{
+	xdb_tblm_t		*pTblm = pStmt->pTblm;
+
+	if ((1 != pStmt->reftbl_count) || !pRefTbl->bUseIdx || (1 != pRefTbl->or_count)) {
+		return -1;
+	}
+	for (int i = 0; i < pStmt->pMeta->col_count; ++i) {
+		if (XDB_TOK_COUNT != pStmt->sel_cols[i].exp.exp_op) {
+			return -1;
+		}
+	}
+
+	xdb_singfilter_t *pSigFlt = &pRefTbl->or_list[0];
+	for (int j = 0; j < pSigFlt->filter_count; ++j) {
+		xdb_value_t	*pVal = &pSigFlt->pFilters[j]->val;
+		bool		bCover = false;
+		for (int k = 0; (k <= pSigFlt->and_count) && !bCover; ++k) {
+			xdb_idxfilter_t *pIdxFilter = k ? &pSigFlt->pAndFilters[k-1] : pSigFlt->pIdxFilter;
+			for (int m = 0; m < pIdxFilter->match_cnt; ++m) {
+				if (pIdxFilter->pIdxVals[m] == pVal) {
+					bCover = true;
+					break;
+				}
+			}
+		}
+		if (!bCover) {
+			return -1;
+		}
+	}
+
+	// writer holds table lock till commit
+	if ((NULL == pTblm->pTtlFld) && (XDB_LOCK_THREAD == pTblm->lock_mode) && (pTblm->tbl_lock.count >= 0)) {
+		return xdb_bmpidx_and (pSigFlt, NULL, NULL);
+	}
+	xdb_bmpcount_t bmp_count = {.pConn = pStmt->pConn, .pTblm = pTblm, .count = 0};
+	if (xdb_bmpidx_and (pSigFlt, xdb_sql_bmpcount_cb, &bmp_count) < 0) {
+		return -1;
+	}
+	return bmp_count.count;
+}
+
 XDB_STATIC int 
 xdb_sql_filter (xdb_stmt_select_t *pStmt)
 {
@@ -2463,7 +3134,40 @@ xdb_sql_filter (xdb_stmt_select_t *pStmt)
 	}
 
 	xdb_reftbl_t *pRefTbl = &pStmt->ref_tbl[0];
-	xdb_sql_query (pConn, pTblm, pRowSet, pRefTbl);
+
+	if (xdb_unlikely (pStmt->agg_count > 0)) {
+		int64_t count = xdb_sql_bmpcount (pStmt, pRefTbl);
+		if (count >= 0) {
+			// same as rows added to row set with offset and limit
+			count = (count > pRowSet->offset) ? count - pRowSet->offset : 0;
+			if (count > pRowSet->limit) {
+				count = pRowSet->limit;
+			}
+			pRowSet->count = 1;
+			pRowSet->pRowList[0].ptr = pStmt->agg_buf;
+			void *pRow = pStmt->agg_buf;
+			*((uint8_t*)pRow + pStmt->pMeta->row_size - 1) = XDB_VTYPE_NONE;
+			uint8_t *pNull = pRow + pStmt->pMeta->null_off;
+			for (int i = 0; i < pStmt->pMeta->col_count; ++i) {
+				XDB_SET_NOTNULL (pNull, i);
+				xdb_field_t *pField = pStmt->sel_cols[i].exp.op_val[1].pField;
+				if ((NULL != pField) && (XDB_TYPE_DOUBLE == pField->sup_type)) {
+					xdb_row_setFloat ((uintptr_t)pStmt->pMeta, pRow, i, count);
+				} else {
+					xdb_row_setInt ((uintptr_t)pStmt->pMeta, pRow, i, count);
+				}
+			}
+			return XDB_OK;
+		}
+	}
+
+	int rc = xdb_sql_query (pConn, pTblm, pRowSet, pRefTbl);
+	if (xdb_unlikely (rc < 0)) {
+		if (xdb_unlikely (pStmt->reftbl_count > 1)) {
+			xdb_rowset_free (&row_set);
+		}
+		return rc;
+	}
 
 	if (xdb_unlikely (pStmt->reftbl_count > 1)) {
 		xdb_rowptr_t row_ptrs[XDB_MAX_JOIN];
@@ -2636,6 +3340,7 @@ xdb_queryres_alloc (xdb_conn_t *pConn, xdb_size size)
 		pQueryRes->pConn = pConn;
 		pQueryRes->res.len_type = (sizeof (xdb_res_t)) | (XDB_RET_REPLY<<28);
 		pQueryRes->pStmt = NULL;
+		pQueryRes->pStructMap = NULL;
 		pQueryRes->buf_len = size;
 		pConn->pQueryRes = pQueryRes;
 	} else if (pQueryRes->buf_len < size) {
@@ -2646,6 +3351,8 @@ xdb_queryres_alloc (xdb_conn_t *pConn, xdb_size size)
 	}
 
 	pQueryRes->buf_free = pQueryRes->buf_len - (sizeof (*pQueryRes) + 4); // last 4 is end of row (len = 0)
+	xdb_structmap_release (pQueryRes->pStructMap);
+	pQueryRes->pStructMap = NULL;
 
 	return NULL;
 
@@ -2703,6 +3410,52 @@ error:
 		pNull = (void*)pCurDat + pStmt->pMeta->null_off;	\
 	}
 
+// Index-only select: one covering index lookup, rest filters and selected fields are all in index cover
+XDB_STATIC xdb_idxfilter_t* 
+xdb_sql_cover (xdb_stmt_select_t *pStmt)
+{
+	xdb_reftbl_t	*pRefTbl = &pStmt->ref_tbl[0];
+
+	if ((1 != pStmt->reftbl_count) || pStmt->agg_count || pStmt->order_count || (NULL != pStmt->callback) || 
+		!pRefTbl->bUseIdx || (1 != pRefTbl->or_count) || (pRefTbl->or_list[0].and_count > 0)) {
+		return NULL;
+	}
+
+	xdb_idxfilter_t	*pIdxFilter = pRefTbl->or_list[0].pIdxFilter;
+	uint64_t		cov_bit = 1ULL << XDB_OBJ_ID(pIdxFilter->pIdxm);
+	if (0 == pIdxFilter->pIdxm->cov_count) {
+		return NULL;
+	}
+
+	for (int i = 0; i < pIdxFilter->idx_flt_cnt; ++i) {
+		xdb_filter_t *pFilter = pIdxFilter->pIdxFlts[i];
+		if (!(pFilter->pField->cov_bmp & cov_bit) || (NULL != pFilter->pExtract)) {
+			return NULL;
+		}
+	}
+
+	for (int i = 0; i < pStmt->col_count; ++i) {
+		if ((0 == pStmt->exp_count) && !pStmt->bColRemap) {
+			// fields only result, column i is field i
+			if (!(pStmt->pTblm->pFields[i].cov_bmp & cov_bit)) {
+				return NULL;
+			}
+			continue;
+		}
+		xdb_exp_t *pExp = &pStmt->sel_cols[i].exp;
+		xdb_value_t *pVal = &pExp->op_val[0];
+		if ((XDB_TYPE_FIELD == pVal->val_type) && (!(pVal->pField->cov_bmp & cov_bit) || (NULL != pVal->pExtract))) {
+			return NULL;
+		}
+		pVal = &pExp->op_val[1];
+		if ((XDB_TOK_NONE != pExp->exp_op) && (NULL != pVal->pField) && !(pVal->pField->cov_bmp & cov_bit)) {
+			return NULL;
+		}
+	}
+
+	return pIdxFilter;
+}
+
 XDB_STATIC xdb_res_t* 
 xdb_sql_select (xdb_stmt_select_t *pStmt)
 {
@@ -2713,7 +3466,25 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 
 	xdb_rdlock_tblstg (pStmt->pTblm);
 
-	xdb_sql_filter (pStmt);
+	// rows are index covers, expand to row buffer with other fields 0
+	XDB_BUF_DEF(pCovRow, 4096);
+	xdb_idxm_t		*pCovIdxm = NULL;
+	xdb_idxfilter_t	*pCovFilter = xdb_sql_cover (pStmt);
+	if (xdb_unlikely (NULL != pCovFilter)) {
+		XDB_BUF_ALLOC (pCovRow, pStmt->pTblm->row_size);
+		if (NULL != pCovRow) {
+			memset (pCovRow, 0, pStmt->pTblm->row_size);
+			*((uint8_t*)pCovRow + pStmt->pTblm->vtype_off) = XDB_VTYPE_NONE;
+			pCovFilter->bCover = true;
+			pCovIdxm = pCovFilter->pIdxm;
+		}
+	}
+
+	if (xdb_unlikely (xdb_sql_filter (pStmt) < 0)) {
+		XDB_SETERR(XDB_E_MEMORY, "Run out of memory")
+		pRes = &pConn->conn_res;
+		goto exit;
+	}
 
 	if (xdb_unlikely (pStmt->callback != NULL)) {
 		pRes = &pConn->conn_res;
@@ -2732,6 +3503,11 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 
 	xdb_queryRes_t	*pQueryRes = pConn->pQueryRes;
 	pRes = &pQueryRes->res;
+	// hold mapping, statement may remap before result is freed
+	pQueryRes->pStructMap = pStmt->pStructMap;
+	if (NULL != pQueryRes->pStructMap) {
+		pQueryRes->pStructMap->ref_cnt++;
+	}
 
 	int				row_size = (pStmt->pMeta->row_size + 3)>>2<<2;
 
@@ -2761,9 +3537,12 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 		uint64_t	offset = (void*)pCurDat - (void*)pQueryRes;
 		pCurDat->len_type = row_size + 4;
 		XDB_RES_ALLOC();
-		if (0 == (pStmt->exp_count)) {
+		if ((0 == pStmt->exp_count) && !pStmt->bColRemap) {
 			if (xdb_likely (1 == pStmt->reftbl_count)) {
 				void *pPtr = pRowSet->pRowList[id].ptr;
+				if (xdb_unlikely (NULL != pCovIdxm)) {
+					pPtr = xdb_hash_cover_row (pCovIdxm, pPtr, pCovRow);
+				}
 				memcpy (pCurDat->rowdat, pPtr, pStmt->pTblm->row_size);
 				*((uint8_t*)pCurDat->rowdat + pStmt->pTblm->vtype_off) = XDB_VTYPE_DATA;
 				if (pStmt->pTblm->pVdatm != NULL) {
@@ -2792,6 +3571,9 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 			}
 		} else {
 			void *pRow = pRowSet->pRowList[id].ptr;
+			if (xdb_unlikely (NULL != pCovIdxm)) {
+				pRow = xdb_hash_cover_row (pCovIdxm, pRow, pCovRow);
+			}
 			int voff = 0, vlen;
 			uint8_t *pNull = (void*)pCurDat->rowdat + pStmt->pMeta->null_off;
 			*((uint8_t*)pCurDat->rowdat + row_size - 1) = XDB_VTYPE_DATA;
@@ -2809,6 +3591,10 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 				}
 				xdb_type_t sup_type = s_xdb_prompt_type[pCol->col_type];
 				if (xdb_unlikely (sup_type != pVal->sup_type)) {
+					if (pVal != &res_val) {
+						res_val = *pVal;
+						pVal = &res_val;
+					}
 					xdb_convert_val (pVal, sup_type);
 				}
 				if (xdb_unlikely (s_xdb_vdat[pCol->col_type])) {
@@ -2844,6 +3630,10 @@ xdb_sql_select (xdb_stmt_select_t *pStmt)
 exit:
 	xdb_rowset_clean (pRowSet);
 	xdb_rdunlock_tblstg (pStmt->pTblm);
+	if (xdb_unlikely (NULL != pCovIdxm)) {
+		pCovFilter->bCover = false;
+	}
+	XDB_BUF_FREE (pCovRow);
 
 	return pRes;
 }
@@ -3130,7 +3920,7 @@ xdb_row_insert (xdb_conn_t *pConn, xdb_tblm_t *pTblm, void *pRow, bool bUpdOrRol
 		// alloc set dirty ^ XDB_ROW_TRANS => XDB_ROW_COMMIT
 		XDB_ROW_CTRL (pStgMgr->pStgHdr, pRowDb) &= XDB_ROW_MASK;
 		XDB_ROW_CTRL (pStgMgr->pStgHdr, pRowDb) |= XDB_ROW_COMMIT;
-		int rc = xdb_idx_addRow (pConn, pTblm, rid, pRowDb);
+		int rc = xdb_likely (!pTblm->bBulkLoad) ? xdb_idx_addRow (pConn, pTblm, rid, pRowDb) : XDB_OK;
 		if (xdb_unlikely (XDB_OK != rc)) {
 			xdb_stg_free (pStgMgr, rid, pRowDb);
 			rid = -1;
@@ -3138,7 +3928,7 @@ xdb_row_insert (xdb_conn_t *pConn, xdb_tblm_t *pTblm, void *pRow, bool bUpdOrRol
 	} else {
 		XDB_ROW_CTRL (pStgMgr->pStgHdr, pRowDb) |= XDB_ROW_TRANS;
 
-		int rc = xdb_idx_addRow (pConn, pTblm, rid, pRowDb);
+		int rc = xdb_likely (!pTblm->bBulkLoad) ? xdb_idx_addRow (pConn, pTblm, rid, pRowDb) : XDB_OK;
 		if (xdb_likely (XDB_OK == rc)) {
 			xdb_trans_addrow (pConn, pTblm, rid, true);
 		} else {
@@ -3293,7 +4083,7 @@ xdb_row_update (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow,
 					xdb_row_set (pTblm, pUpdRow, set_flds, set_count);
 					bCopy = true;
 				}
-				xdb_rowid rid2 = pIdxm->pIdxOps->idx_query2 (pConn, pIdxm, pUpdRow);
+				xdb_rowid rid2 = xdb_idx_rowmatch (pIdxm, pUpdRow) ? pIdxm->pIdxOps->idx_query2 (pConn, pIdxm, pUpdRow) : 0;
 				if (xdb_unlikely ((rid2 > 0) && (rid2 != rid))) {
 					XDB_EXPECT ((rid2 == rid) || (0 == rid2), XDB_E_EXISTS, "Duplicate entry");
 				}
@@ -3312,6 +4102,7 @@ xdb_row_update (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow,
 		// fast inplace update
 		xdb_idx_remRow_bmp (pTblm, rid, pRow, idx_affect, idx_count);
 		xdb_row_set (pTblm, pRow, set_flds, set_count);
+		xdb_stg_dirty_id (&pTblm->stg_mgr, rid);
 		xdb_idx_addRow_bmp (pConn, pTblm, rid, pRow, idx_affect, idx_count);
 	} else {
 		if (!bCopy) {
@@ -3330,6 +4121,11 @@ xdb_row_update (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow,
 		bDel = xdb_row_updDel (pConn, pTblm, rid, pRow);
 		xdb_rowid newid = xdb_row_insert (pConn, pTblm, pUpdRow, true);
 		pRowNew = XDB_IDPTR(&pTblm->stg_mgr, newid);
+#if (XDB_WAL_DELTA == 1)
+		if (!bDel && !pTblm->bMemory && (newid > 0)) {
+			xdb_trans_updrow (pConn, pTblm, newid, rid);
+		}
+#endif
 		// may remap
 		pRow = XDB_IDPTR(&pTblm->stg_mgr, rid);
 
@@ -3482,7 +4278,10 @@ xdb_sql_update (xdb_stmt_select_t *pStmt)
 	xdb_mark_dirty (pTblm);
 
 	xdb_rowset_t	*pRowSet = &pConn->row_set;
-	xdb_sql_filter (pStmt);
+	if (xdb_unlikely (xdb_sql_filter (pStmt) < 0)) {
+		XDB_SETERR(XDB_E_MEMORY, "Run out of memory")
+		pRowSet->count = 0;
+	}
 	pRes->affected_rows = pRowSet->count;
 
 	for (xdb_rowid id = 0 ; id < pRowSet->count; ++id) {
@@ -3515,7 +4314,10 @@ xdb_sql_delete (xdb_stmt_select_t *pStmt)
 	xdb_mark_dirty (pTblm);
 
 	xdb_rowset_t	*pRowSet = &pConn->row_set;
-	xdb_sql_filter (pStmt);
+	if (xdb_unlikely (xdb_sql_filter (pStmt) < 0)) {
+		XDB_SETERR(XDB_E_MEMORY, "Run out of memory")
+		pRowSet->count = 0;
+	}
 	pRes->affected_rows = pRowSet->count;
 
 	for (xdb_rowid id = 0 ; id < pRowSet->count; ++id) {
@@ -16,9 +16,19 @@
 #endif
 
 static xdb_objm_t	s_xdb_db_list;
+// background task walks DB list with read lock, close and drop take write lock
+static xdb_rwlock_t	s_xdb_db_list_lock;
 
 static char			s_xdb_datadir[XDB_PATH_LEN + 1];
 static char			s_xdb_svrid[XDB_NAME_LEN + 1];
+static char			s_xdb_wal_archive[XDB_PATH_LEN + 1];	// empty disables WAL archive
+
+static xdb_ckpt_cfg_t	s_xdb_ckpt_cfg = {
+	.period		= XDB_CKPT_PERIOD,
+	.threads	= XDB_CKPT_THREADS,
+	.wal_size	= XDB_CKPT_WAL_SIZE,
+	.dirty_size	= XDB_CKPT_DIRTY_SIZE,
+};
 
 XDB_STATIC xdb_dbm_t* 
 xdb_find_db (const char *db_name)
@@ -196,7 +206,7 @@ xdb_create_db (xdb_stmt_db_t *pStmt)
 		if (xdb_fexist (path)) {
 			xdb_dbm_t*	pCurDbm = pConn->pCurDbm;
 			pConn->pCurDbm = pDbm;
-			xdb_source (pConn, path);
+			xdb_source (pConn, path, false);
 			pConn->pCurDbm = pCurDbm;
 		}
 	}
@@ -232,6 +242,8 @@ xdb_close_db (xdb_conn_t *pConn, xdb_dbm_t *pDbm)
 	xdb_dblog ("------ close db '%s' ------\n", XDB_OBJ_NAME(pDbm));
 	xdb_yield ();
 
+	xdb_rwlock_wrlock (&s_xdb_db_list_lock);
+
 	xdb_flush_db (pDbm, 0);
 
 	int count = XDB_OBJM_MAX(pDbm->db_objm);
@@ -265,6 +277,8 @@ xdb_close_db (xdb_conn_t *pConn, xdb_dbm_t *pDbm)
 
 	xdb_free (pDbm);
 
+	xdb_rwlock_wrunlock (&s_xdb_db_list_lock);
+
 	return 0;
 }
 
@@ -274,6 +288,8 @@ xdb_drop_db (xdb_conn_t *pConn, xdb_dbm_t *pDbm)
 	char path[XDB_PATH_LEN + 32];
 	xdb_sprintf (path, "%s/xdb.db", pDbm->db_path);
 
+	xdb_rwlock_wrlock (&s_xdb_db_list_lock);
+
 	int count = XDB_OBJM_MAX(pDbm->db_objm);
 	for (int i = 0; i < count; ++i) {
 		xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
@@ -302,6 +318,8 @@ xdb_drop_db (xdb_conn_t *pConn, xdb_dbm_t *pDbm)
 
 	xdb_free (pDbm);
 
+	xdb_rwlock_wrunlock (&s_xdb_db_list_lock);
+
 	return 0;
 }
 
@@ -353,6 +371,99 @@ xdb_gen_db_schema (xdb_dbm_t *pDbm)
 	return 0;
 }
 
+// sleep if background checkpoint syncs faster than io_rate
+XDB_STATIC void 
+xdb_ckpt_throttle (xdb_dbm_t *pDbm, xdb_size bytes, uint32_t flags)
+{
+	uint64_t total = xdb_atomic_add (&pDbm->ckpt.cur_bytes, bytes);
+	xdb_size io_rate = s_xdb_ckpt_cfg.io_rate;
+	if (!(flags & XDB_FLUSH_BG) || (0 == io_rate) || (0 == bytes)) {
+		return;
+	}
+	uint64_t due_us = pDbm->ckpt.start_us + total * 1000000 / io_rate;
+	uint64_t now_us = xdb_timestamp_us ();
+	if (due_us > now_us) {
+		xdb_msleep ((due_us - now_us + 999) / 1000);
+	}
+}
+
+// return trigger of background checkpoint or NULL
+XDB_STATIC const char* 
+xdb_ckpt_due (xdb_dbm_t *pDbm)
+{
+	const char	*reason = NULL;
+	xdb_db_t 	*pDb = XDB_DBPTR(pDbm);
+
+	// only background task takes DB read lock, so stats are safe to set
+	xdb_rdlock_db (pDbm);
+
+	if (pDb->flush_id == pDb->lastchg_id) {
+		pDbm->ckpt.chg_ms = 0;
+		goto exit;
+	}
+	uint64_t now_ms = xdb_timestamp_ms ();
+	if (0 == pDbm->ckpt.chg_ms) {
+		pDbm->ckpt.chg_ms = now_ms;
+	}
+
+	xdb_wal_rdlock (pDbm);
+	pDbm->ckpt.wal_size = XDB_WAL_PTR(pDbm->pWalm)->commit_size;
+	xdb_wal_rdunlock (pDbm);
+	if (s_xdb_ckpt_cfg.wal_size && (pDbm->ckpt.wal_size >= s_xdb_ckpt_cfg.wal_size)) {
+		reason = "WAL";
+	}
+
+	if (s_xdb_ckpt_cfg.dirty_size) {
+		xdb_size bytes = 0;
+		int count = XDB_OBJM_MAX(pDbm->db_objm);
+		for (int i = 0; i < count; ++i) {
+			xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
+			if (NULL != pTblm) {
+				bytes += xdb_dirty_bytes_table (pTblm);
+			}
+		}
+		pDbm->ckpt.dirty_bytes = bytes;
+		if ((NULL == reason) && (bytes >= s_xdb_ckpt_cfg.dirty_size)) {
+			reason = "DIRTY";
+		}
+	}
+
+	if ((NULL == reason) && s_xdb_ckpt_cfg.period && (now_ms - pDbm->ckpt.chg_ms >= s_xdb_ckpt_cfg.period)) {
+		reason = "AGE";
+	}
+	if (NULL != reason) {
+		pDbm->ckpt.reason = reason;
+	}
+
+exit:
+	xdb_rdunlock_db (pDbm);
+	return reason;
+}
+
+typedef struct {
+	xdb_tblm_t		**ppTblm;
+	uint64_t		ckpt_cid;
+	uint32_t		flags;
+	bool			bFail;
+} xdb_flush_t;
+
+XDB_STATIC void 
+xdb_flush_job (int id, void *pArg)
+{
+	xdb_flush_t		*pFlush = pArg;
+	xdb_tblm_t		*pTblm = pFlush->ppTblm[id];
+
+	if (xdb_flush_table (pTblm, pFlush->ckpt_cid, pFlush->flags) < 0) {
+		xdb_errlog ("Table '%s' doesn't cover checkpoint %"PRIu64", keep backup WAL\n", XDB_OBJ_NAME(pTblm), pFlush->ckpt_cid);
+		pFlush->bFail = true;
+	}
+}
+
+/*
+ * Fuzzy checkpoint, DML doesn't take DB lock, it only serializes with DDL and other checkpoints.
+ * Switch WAL and record checkpoint commit id, wait till commits in backup WAL are applied,
+ * flush tables while new commits go to active WAL, then recycle backup WAL.
+ */
 XDB_STATIC int 
 xdb_flush_db (xdb_dbm_t *pDbm, uint32_t flags)
 {
@@ -374,15 +485,54 @@ xdb_flush_db (xdb_dbm_t *pDbm, uint32_t flags)
 
 	// Switch wal if has commit, then flush tables, afterward backup wal can be recycled
 	bool bSwitch = xdb_wal_switch (pDbm);
+	uint64_t ckpt_cid = 0;
 
-	// flush tables
+	if (bSwitch) {
+		ckpt_cid = XDB_WAL_PTR(pDbm->pWalmBak)->ckpt_cid;
+		// commits in backup WAL may be not applied to tables yet, they don't wait for any lock held here
+		uint32_t pending;
+		for (xdb_atomic_read (&pDbm->pWalmBak->commit_pending, &pending); pending > 0; 
+				xdb_atomic_read (&pDbm->pWalmBak->commit_pending, &pending)) {
+			xdb_yield ();
+		}
+	}
+
+	pDbm->ckpt.start_us		= xdb_timestamp_us ();
+	pDbm->ckpt.cur_bytes	= 0;
+
+	// flush tables, backup wal is recycled only after every table covers checkpoint
+	// changed tables are flushed by workers, clean ones only record checkpoint here
+	// without memory for worker list, changed tables are flushed here one by one
 	int count = XDB_OBJM_MAX(pDbm->db_objm);
+	xdb_flush_t flush = {.ppTblm = (count > 0) ? xdb_malloc (count * sizeof (xdb_tblm_t*)) : NULL, .ckpt_cid = ckpt_cid, .flags = flags};
+	int tbl_count = 0;
 	for (int i = 0; i < count; ++i) {
 		xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
-		if ((NULL != pTblm)) {
-			xdb_flush_table (pTblm, flags);
+		if (NULL == pTblm) {
+			continue;
+		}
+		xdb_rdlock_tblstg (pTblm);
+		bool bDirty = XDB_TBLPTR(pTblm)->flush_id != XDB_TBLPTR(pTblm)->lastchg_id;
+		xdb_rdunlock_tblstg (pTblm);
+		if (bDirty && (NULL != flush.ppTblm)) {
+			flush.ppTblm[tbl_count++] = pTblm;
+		} else if (xdb_flush_table (pTblm, ckpt_cid, flags) < 0) {
+			xdb_errlog ("Table '%s' doesn't cover checkpoint %"PRIu64", keep backup WAL\n", XDB_OBJ_NAME(pTblm), ckpt_cid);
+			flush.bFail = true;
 		}
 	}
+	if (tbl_count > 0) {
+		xdb_run_jobs (tbl_count, s_xdb_ckpt_cfg.threads, xdb_flush_job, &flush);
+	}
+	xdb_free (flush.ppTblm);
+	if (flush.bFail) {
+		bSwitch = false;
+	}
+
+	// backup WAL is kept if it can't be archived, try again next round
+	if (bSwitch && (xdb_wal_archive (pDbm->pWalmBak) < 0)) {
+		bSwitch = false;
+	}
 
 	// flush backup wal if switched
 	if (bSwitch) {
@@ -399,37 +549,94 @@ xdb_flush_db (xdb_dbm_t *pDbm, uint32_t flags)
 		// fsync may take long time, so do it out of wal lock
 		xdb_stg_sync (&pDbm->pWalm->stg_mgr,    0, 0, false);
 		xdb_stg_sync (&pDbm->pWalmBak->stg_mgr, 0, 0, false);
+
+		// old rows of UPDATE records in recycled WAL are not redo base any more
+		for (int i = 0; i < count; ++i) {
+			xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
+			if (NULL != pTblm) {
+				xdb_free_updrows (pTblm, pDbm->pWalmBak - pDbm->wal_mgr, flags);
+			}
+		}
 	}
 
 	pDb->flush_time = xdb_timestamp();
 
+	xdb_ckpt_stat_t *pStat = &pDbm->ckpt;
+	if (!(flags & XDB_FLUSH_BG)) {
+		pStat->reason = "FLUSH";
+	}
+	pStat->count++;
+	pStat->last_time	= pDb->flush_time;
+	pStat->last_us		= xdb_timestamp_us () - pStat->start_us;
+	xdb_atomic_read (&pStat->cur_bytes, &pStat->last_bytes);
+	pStat->total_bytes += pStat->last_bytes;
+	xdb_sysdb_upd_ckpt (pDbm);
+
 exit:
 	xdb_wrunlock_db (pDbm);
 	return 0;
 }
 
+typedef struct {
+	xdb_tblm_t		**ppTblm;
+	int				flags;
+} xdb_repair_t;
+
+XDB_STATIC void 
+xdb_repair_job (int id, void *pArg)
+{
+	xdb_repair_t	*pRepair = pArg;
+	xdb_tblm_t		*pTblm = pRepair->ppTblm[id];
+
+	xdb_wrlock_tblstg (pTblm);
+	__xdb_repair_table (pTblm, pRepair->flags);
+	xdb_wrunlock_tblstg (pTblm);
+}
+
 XDB_STATIC xdb_ret
 xdb_repair_db (xdb_dbm_t *pDbm, int flags)
 {
 	// Lock DB
 	xdb_print ("=== Begin Repair Database %s ===\n", XDB_OBJ_NAME (pDbm));
 
-	// check all tables
+	// replay row images first, then repair rebuilds free list and indexes
+	xdb_wal_redo (pDbm);
+
+	// collect dirty tables, tables are independent so repair them in parallel
+	// without memory for worker list, dirty tables are repaired here one by one
 	int count = XDB_OBJM_MAX(pDbm->db_objm);
+	xdb_repair_t repair = {.ppTblm = (count > 0) ? xdb_malloc (count * sizeof (xdb_tblm_t*)) : NULL, .flags = flags};
+	int tbl_count = 0;
 	for (int i = 0; i < count; ++i) {
 		xdb_tblm_t *pTblm = XDB_OBJM_GET(pDbm->db_objm, i);
 		if (NULL != pTblm) {
 			xdb_wrlock_tblstg (pTblm);
 			xdb_tbl_t *pTbl = XDB_TBLPTR(pTblm);
 			if (pTbl->flush_id != pTbl->lastchg_id) {
-				__xdb_repair_table (pTblm, flags);
+				if (NULL != repair.ppTblm) {
+					repair.ppTblm[tbl_count++] = pTblm;
+				} else {
+					__xdb_repair_table (pTblm, flags);
+				}
 			}
 			xdb_wrunlock_tblstg (pTblm);
 		}	
 	}
+	if (tbl_count > 0) {
+		int thread_count = xdb_run_jobs (tbl_count, XDB_RECOVER_THREADS, xdb_repair_job, &repair);
+		xdb_print ("  Repair %d tables with %d threads\n", tbl_count, thread_count);
+	}
+	xdb_free (repair.ppTblm);
 
-	xdb_wal_redo (pDbm);
+	xdb_db_t *pDb = XDB_DBPTR(pDbm);
+	if (pDb->flush_id == pDb->lastchg_id) {
+		pDb->lastchg_id++;
+	}
 	xdb_flush_db (pDbm, 0);
+	xdb_wal_archive (pDbm->pWalmBak);
+	xdb_wal_archive (pDbm->pWalm);
+	xdb_wal_flush (pDbm->pWalm);
+	xdb_wal_flush (pDbm->pWalmBak);
 
 	xdb_print ("=== End Recover database %s ===\n", XDB_OBJ_NAME (pDbm));
 
@@ -12,6 +12,31 @@
 #ifndef __XDB_DB_H__
 #define __XDB_DB_H__
 
+// checkpoint scheduler settings, 0 disables the trigger
+typedef struct {
+	uint32_t		period;		// ms
+	uint32_t		threads;
+	xdb_size		wal_size;
+	xdb_size		dirty_size;
+	xdb_size		io_rate;	// bytes per second for background checkpoint, 0 is unlimited
+} xdb_ckpt_cfg_t;
+
+typedef struct {
+	uint64_t		count;
+	const char		*reason;	// last trigger
+	uint64_t		chg_ms;		// first change seen since last checkpoint
+	uint64_t		last_time;
+	uint64_t		last_us;
+	uint64_t		last_bytes;
+	uint64_t		total_bytes;
+	uint64_t		wal_size;	// WAL size when triggered
+	uint64_t		dirty_bytes;// dirty bytes when triggered
+	uint64_t		start_us;
+	uint64_t		cur_bytes;	// synced by running checkpoint
+} xdb_ckpt_stat_t;
+
+#define XDB_FLUSH_BG		(1<<0)	// background checkpoint, obeys io_rate
+
 typedef struct xdb_dbm_t {
 	xdb_obj_t		obj;
 	char			db_path[XDB_PATH_LEN+1];
@@ -31,6 +56,8 @@ typedef struct xdb_dbm_t {
 	xdb_rwlock_t		db_lock;
 
 	xdb_vec_t		sub_list;
+
+	xdb_ckpt_stat_t	ckpt;
 } xdb_dbm_t;
 
 typedef struct xdb_dbobj_t {
@@ -59,6 +86,9 @@ xdb_repair_db (xdb_dbm_t *pDbm, int flags);
 XDB_STATIC int 
 xdb_flush_db (xdb_dbm_t *pDbm, uint32_t flags);
 
+XDB_STATIC void 
+xdb_ckpt_throttle (xdb_dbm_t *pDbm, xdb_size bytes, uint32_t flags);
+
 XDB_STATIC int 
 xdb_ttl_db (xdb_dbm_t *pDbm, bool bNow, uint32_t flags);
 
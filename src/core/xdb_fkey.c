@@ -49,7 +49,7 @@ xdb_create_fkey (xdb_stmt_fkey_t *pStmt)
 		pFkeym->filter.pFilters[i]->pField = pStmt->pRefFlds[i];
 		pFkeym->filter.pFilters[i]->cmp_op = XDB_TOK_EQ;
 	}
-	xdb_find_idx (pStmt->pRefTblm, &pFkeym->filter, fld_bmp);
+	xdb_find_idx (pStmt->pRefTblm, NULL, &pFkeym->filter, fld_bmp);
 
 	xdb_strcpy (XDB_OBJ_NAME(pFkeym), pStmt->fkey_name);
 	XDB_OBJ_ID(pFkeym) = -1;
@@ -15,6 +15,49 @@
 #define xdb_hashlog(...)
 #endif
 
+// mark node or slot written, so flush only syncs changed pages
+#define XDB_HASH_WNODE(pNode)	xdb_stg_dirty (&pIdxm->stg_mgr, pNode, sizeof(xdb_hashNode_t))
+#define XDB_HASH_WSLOT(slot)	xdb_stg_dirty (&pIdxm->stg_mgr2, &pHashSlot[slot], sizeof(xdb_rowid))
+
+// node is followed by cover for covering index, so node size is stg blk_size
+#define XDB_HASH_NODE(id)		((xdb_hashNode_t*)((void*)pHashNode + (xdb_size)(id) * pIdxm->stg_mgr.blk_size))
+#define XDB_HASH_COVER(pNode)	((void*)(pNode) + sizeof(xdb_hashNode_t))
+
+XDB_STATIC void 
+xdb_hash_cover_set (xdb_idxm_t *pIdxm, void *pCov, void *pRow)
+{
+	uint8_t		*pNull = pRow + pIdxm->pTblm->null_off;
+	uint64_t	notnull = 0;
+
+	for (int i = 0; i < pIdxm->cov_count; ++i) {
+		xdb_hashCov_t *pCovFld = &pIdxm->cov_fld[i];
+		memcpy (pCov + pCovFld->cov_off, pRow + pCovFld->fld_off, pCovFld->len);
+		if (XDB_IS_NOTNULL (pNull, pCovFld->fld_id)) {
+			notnull |= (1ULL << i);
+		}
+	}
+	*(uint64_t*)pCov = notnull;
+}
+
+// copy key and INCLUDE fields in cover back to row buffer, other fields are untouched
+XDB_STATIC void* 
+xdb_hash_cover_row (xdb_idxm_t *pIdxm, const void *pCov, void *pRow)
+{
+	uint8_t		*pNull = pRow + pIdxm->pTblm->null_off;
+	uint64_t	notnull = *(uint64_t*)pCov;
+
+	for (int i = 0; i < pIdxm->cov_count; ++i) {
+		xdb_hashCov_t *pCovFld = &pIdxm->cov_fld[i];
+		memcpy (pRow + pCovFld->fld_off, pCov + pCovFld->cov_off, pCovFld->len);
+		if (notnull & (1ULL << i)) {
+			XDB_SET_NOTNULL (pNull, pCovFld->fld_id);
+		} else {
+			XDB_SET_NULL (pNull, pCovFld->fld_id);
+		}
+	}
+	return pRow;
+}
+
 #if 0
 XDB_STATIC void 
 xdb_hash_dump (xdb_idxm_t* pIdxm)
@@ -32,11 +75,11 @@ xdb_hash_dump (xdb_idxm_t* pIdxm)
 		xdb_print ("slot:%d\n", slot);
 		xdb_hashNode_t	*pCurNode;
 		for (; rid > 0; rid = pCurNode->next) {
-			pCurNode = &pHashNode[rid];
+			pCurNode = XDB_HASH_NODE(rid);
 			xdb_print ("  %u: nxt %x pre %x sib %x\n", rid, pCurNode->next, pCurNode->prev, pCurNode->sibling);
 			xdb_hashNode_t *pSibNode;
 			for (xdb_rowid sid = pCurNode->sibling; sid > 0; sid = pSibNode->next) {
-				pSibNode = &pHashNode[sid];
+				pSibNode = XDB_HASH_NODE(sid);
 				xdb_print ("    %u: nxt %x pre %x sib %x\n", sid, pSibNode->next, pSibNode->prev, pSibNode->sibling);
 				if (pSibNode->next == sid) {
 					printf ("	 ERROR: next == sid\n", pSibNode->next, sid);
@@ -67,11 +110,15 @@ xdb_hash_rehash (xdb_idxm_t *pIdxm, xdb_rowid old_max)
 
 	xdb_hashlog ("Rehash %s old_max %d new_max %d node %d rid %d Begin\n", XDB_OBJ_NAME(pIdxm), old_max, hash_mask, pIdxm->node_cap, pHashHdr->row_count);
 
+	// nodes are moved all over
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	xdb_stg_dirty_all (&pIdxm->stg_mgr2);
+
 	for (slot = 0; slot < old_max; ++slot) {
 		rid = pHashSlot[slot];
 		
 		for (; XDB_ROWID_VALID (rid, max_rid); rid = next_rid) {
-			pCurNode = &pHashNode[rid];
+			pCurNode = XDB_HASH_NODE(rid);
 			next_rid = pCurNode->next;
 			new_slot = pCurNode->hash_val & hash_mask;
 			if (new_slot != slot) {
@@ -79,7 +126,7 @@ xdb_hash_rehash (xdb_idxm_t *pIdxm, xdb_rowid old_max)
 				// remove from old slot
 				if (pCurNode->next) {
 					xdb_hashlog ("  rid %d has next %d, point to its prev %d\n", rid, pCurNode->next, pCurNode->prev & (~XDB_ROWID_MSB));
-					pNxtNode = &pHashNode[pCurNode->next];
+					pNxtNode = XDB_HASH_NODE(pCurNode->next);
 					pNxtNode->prev = pCurNode->prev;
 				}
 				if (pCurNode->prev & XDB_ROWID_MSB) {
@@ -92,7 +139,7 @@ xdb_hash_rehash (xdb_idxm_t *pIdxm, xdb_rowid old_max)
 					xdb_hashlog ("  rid %d's next %d is 1st top rid for slot %d\n", rid, pCurNode->next, slot_id);
 				} else if (pCurNode->prev) {
 					xdb_hashlog ("  rid %d has prev %d, point to it's next %d\n", rid, pCurNode->prev, pCurNode->next);
-					pPreNode = &pHashNode[pCurNode->prev];
+					pPreNode = XDB_HASH_NODE(pCurNode->prev);
 					pPreNode->next = pCurNode->next;
 		 		}
 
@@ -111,7 +158,7 @@ xdb_hash_rehash (xdb_idxm_t *pIdxm, xdb_rowid old_max)
 					pHashSlot[new_slot] = rid;
 					pCurNode->next = fisrt_rid;
 					pCurNode->prev = XDB_ROWID_MSB | new_slot;
-					pNxtNode = &pHashNode[fisrt_rid];
+					pNxtNode = XDB_HASH_NODE(fisrt_rid);
 					pNxtNode->prev = rid;
 				}
 			}
@@ -123,13 +170,100 @@ xdb_hash_rehash (xdb_idxm_t *pIdxm, xdb_rowid old_max)
 	return 0;
 }
 
+/*
+ * Split block Bloom filter: hash value selects a 512-bit block, then one bit is set 
+ * in each of its 8 words, so a test touches one cache line.
+ */
+static const uint32_t s_xdb_bloom_salt[8] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static inline uint64_t* 
+xdb_hash_bloom_blk (xdb_hashBloom_t *pBloom, uint32_t hash_val, uint32_t *pKey)
+{
+	uint64_t h = hash_val * 0x9E3779B97F4A7C15ULL;
+	*pKey = (uint32_t)h;
+	return pBloom->pBlk + (((h >> 32) & pBloom->blk_mask) << 3);
+}
+
+static inline void 
+xdb_hash_bloom_set (xdb_hashBloom_t *pBloom, uint32_t hash_val)
+{
+	uint32_t key;
+	uint64_t *pBlk = xdb_hash_bloom_blk (pBloom, hash_val, &key);
+	for (int i = 0; i < 8; ++i) {
+		pBlk[i] |= 1ULL << ((key * s_xdb_bloom_salt[i]) >> 26);
+	}
+}
+
+static inline bool 
+xdb_hash_bloom_test (xdb_hashBloom_t *pBloom, uint32_t hash_val)
+{
+	uint32_t key;
+	uint64_t *pBlk = xdb_hash_bloom_blk (pBloom, hash_val, &key);
+	for (int i = 0; i < 8; ++i) {
+		if (!(pBlk[i] & (1ULL << ((key * s_xdb_bloom_salt[i]) >> 26)))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// size for cap rows and set top node hash of each chain, siblings share the hash. Filter is off if no memory.
+XDB_STATIC void 
+xdb_hash_bloom_build (xdb_idxm_t *pIdxm, xdb_rowid cap)
+{
+	xdb_hashBloom_t	*pBloom = &pIdxm->bloom;
+	xdb_hashNode_t	*pHashNode = pIdxm->pHashNode;
+	xdb_rowid		*pHashSlot = pIdxm->pHashSlot;
+	uint64_t		blk_count;
+
+	if (cap < 1024) {
+		cap = 1024;
+	}
+	for (blk_count = 1; (blk_count << 9) < (uint64_t)cap * XDB_BLOOM_BITS; blk_count <<= 1)
+		;
+
+	xdb_free (pBloom->pBlk);
+	pBloom->pBlk = xdb_calloc (blk_count << 6);
+	pBloom->blk_mask	= blk_count - 1;
+	pBloom->cap			= cap;
+	pBloom->del_count	= 0;
+	if (NULL == pBloom->pBlk) {
+		xdb_errlog ("Failed to alloc Bloom filter for index %s", XDB_OBJ_NAME(pIdxm));
+		return;
+	}
+
+	for (xdb_rowid slot = 0; slot < pIdxm->slot_cap; ++slot) {
+		for (xdb_rowid rid = pHashSlot[slot]; rid > 0; rid = XDB_HASH_NODE(rid)->next) {
+			xdb_hash_bloom_set (pBloom, XDB_HASH_NODE(rid)->hash_val);
+		}
+	}
+}
+
+// false positive rate measured by lookups, < 0 if no filter
+XDB_STATIC double 
+xdb_hash_bloom_fpr (xdb_idxm_t *pIdxm)
+{
+	xdb_hashBloom_t	*pBloom = &pIdxm->bloom;
+	if (NULL == pBloom->pBlk) {
+		return -1;
+	}
+	uint64_t neg = pBloom->neg_count + pBloom->fp_count;
+	return neg ? (double)pBloom->fp_count / neg : 0;
+}
+
 XDB_STATIC int 
 xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRow)
 {
 	xdb_stgmgr_t	*pStgMgr	= &pIdxm->pTblm->stg_mgr;
 
+	// partial index may skip rows, so rowid can jump
 	if (new_rid > pIdxm->node_cap) {
-		xdb_stg_truncate (&pIdxm->stg_mgr, pIdxm->node_cap<<1);
+		xdb_rowid cap;
+		for (cap = pIdxm->node_cap; cap < new_rid; cap <<= 1)
+			;
+		xdb_stg_truncate (&pIdxm->stg_mgr, cap);
 		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
 		pIdxm->pHashHdr  = (xdb_hashHdr_t*)pIdxm->stg_mgr.pStgHdr;
 		pIdxm->pHashNode = pIdxm->stg_mgr.pBlkDat1;
@@ -148,7 +282,7 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 #endif
 	}
 
-	uint32_t hash_val = xdb_row_hash (pIdxm->pTblm, pRow, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+	uint32_t hash_val = pIdxm->pKeyOps->key_hash (pIdxm, pRow);
 	uint32_t slot_id = hash_val & pIdxm->slot_mask;
 
 	xdb_hashlog ("add rid %d hash %x slot %d\n", new_rid, hash_val, slot_id);
@@ -158,13 +292,18 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 	xdb_hashNode_t	*pHashNode = pIdxm->pHashNode;
 	xdb_rowid		rid, sid;
 
-	xdb_hashNode_t	*pNewNode = &pHashNode[new_rid];
+	xdb_hashNode_t	*pNewNode = XDB_HASH_WNODE (XDB_HASH_NODE(new_rid));
 	pNewNode->hash_val = hash_val;
+	if (pIdxm->cov_count > 0) {
+		xdb_stg_dirty_id (&pIdxm->stg_mgr, new_rid);
+		xdb_hash_cover_set (pIdxm, XDB_HASH_COVER(pNewNode), pRow);
+	}
 
 	xdb_rowid first_rid = pHashSlot[slot_id];
 
 	if (0 == first_rid) {
 		xdb_hashlog ("  insert first %d in slot %d \n", new_rid, slot_id);
+		XDB_HASH_WSLOT (slot_id);
 		pHashSlot[slot_id] = new_rid;
 		pNewNode->next = pNewNode->sibling = 0;
 		pNewNode->prev = XDB_ROWID_MSB | slot_id;
@@ -172,13 +311,15 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 		pHashHdr->node_count++;
 	} else {
 		xdb_hashNode_t	*pTopNode = NULL, *pSibNode;
-		for (rid = first_rid; rid > 0; rid = pTopNode->next) {
-			pTopNode = &pHashNode[rid];
+		// new key needn't walk chain for duplicate or unique check
+		rid = ((NULL == pIdxm->bloom.pBlk) || xdb_hash_bloom_test (&pIdxm->bloom, hash_val)) ? first_rid : 0;
+		for (; rid > 0; rid = pTopNode->next) {
+			pTopNode = XDB_HASH_NODE(rid);
 			if (pTopNode->hash_val != hash_val) {
 				continue;
 			}
 			void *pRowDb = XDB_IDPTR(pStgMgr, rid);
-			bool eq = xdb_row_isequal2 (pIdxm->pTblm, pRow, pRowDb, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+			bool eq = pIdxm->pKeyOps->key_eq2 (pIdxm, pRow, pRowDb);
 			if (eq) {
 				if (pIdxm->bUnique && pConn && xdb_row_valid (pConn, pIdxm->pTblm, pRowDb, rid)) {
 					goto error;
@@ -189,7 +330,7 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 		if (rid) {
 			if (pIdxm->bUnique && pConn) {
 				for (sid = pTopNode->sibling; sid > 0; sid = pSibNode->next) {
-					pSibNode = &pHashNode[sid];
+					pSibNode = XDB_HASH_NODE(sid);
 					void *pRowDb = XDB_IDPTR(pStgMgr, sid);
 					if (xdb_likely (xdb_row_valid (pConn, pIdxm->pTblm, pRowDb, sid))) {
 						goto error;
@@ -199,23 +340,25 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 
 			xdb_hashlog ("  Duplicate insert %d in slot %d to rid %d as 1st sibling\n", new_rid, slot_id, rid);
 			xdb_rowid sibling_rid = pTopNode->sibling;
+			XDB_HASH_WNODE (pTopNode);
 			pTopNode->sibling = new_rid;
 			pNewNode->prev  = 0;
 			pNewNode->next = sibling_rid;
 			pNewNode->sibling = rid;
 			if (sibling_rid) {
 				xdb_dbglog ("  1st sibling %d replace previous 1st silbing %d\n", new_rid, sibling_rid);
-				pSibNode = &pHashNode[sibling_rid];
+				pSibNode = XDB_HASH_WNODE (XDB_HASH_NODE(sibling_rid));
 				pSibNode->prev = new_rid;
 				pSibNode->sibling = XDB_ROWID_MSB;
 			}
 		} else {
 			xdb_hashlog ("  Insert %d in slot %d at head %d\n", new_rid, slot_id, first_rid);
+			XDB_HASH_WSLOT (slot_id);
 			pHashSlot[slot_id] = new_rid;
 			pNewNode->next = first_rid;
 			pNewNode->prev = XDB_ROWID_MSB | slot_id;
 			pNewNode->sibling = 0;
-			xdb_hashNode_t *pNxtNode = &pHashNode[first_rid];
+			xdb_hashNode_t *pNxtNode = XDB_HASH_WNODE (XDB_HASH_NODE(first_rid));
 			pNxtNode->prev = new_rid;
 			pHashHdr->node_count++;
 		}
@@ -223,6 +366,14 @@ xdb_hash_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRo
 
 	pHashHdr->row_count++;
 
+	if (NULL != pIdxm->bloom.pBlk) {
+		if (xdb_likely (pHashHdr->row_count <= pIdxm->bloom.cap)) {
+			xdb_hash_bloom_set (&pIdxm->bloom, hash_val);
+		} else {
+			xdb_hash_bloom_build (pIdxm, pHashHdr->row_count << 1);
+		}
+	}
+
 #if 0
 	if (xdb_hash_check (pConn, pIdxm, 0) < 0) { exit(-1); }
 #endif
@@ -244,7 +395,7 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 	xdb_rowid		*pHashSlot = pIdxm->pHashSlot;
 	xdb_hashNode_t *pHashNode = pIdxm->pHashNode;
 
-	pCurNode = &pHashNode[rid];
+	pCurNode = XDB_HASH_NODE(rid);
 
 	xdb_hashlog ("del rid %d hash %x slot %d\n", rid, pCurNode->hash_val, slot_id);
 
@@ -252,17 +403,19 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 		// not in index
 		return 0;
 	}
+	XDB_HASH_WNODE (pCurNode);
 
 	if (xdb_likely (! (pCurNode->sibling & XDB_ROWID_MASK))) {
 		// normal node, either not 1st sibling or no sibling top
 		if (pCurNode->next) {
 			//xdb_dbglog ("  rid %d has next %d, point to its prev %d\n", rid, pCurNode->next, pCurNode->prev & XDB_ROWID_MASK);
-			pNxtNode = &pHashNode[pCurNode->next];
+			pNxtNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->next));
 			pNxtNode->prev = pCurNode->prev;
 		}
 		if (pCurNode->prev & XDB_ROWID_MSB) {
 			// is the first top record
 			slot_id = pCurNode->prev & XDB_ROWID_MASK;
+			XDB_HASH_WSLOT (slot_id);
 			pHashSlot[slot_id] = pCurNode->next;
 			if (0 == pCurNode->next) {
 				pHashHdr->slot_count--;
@@ -270,7 +423,7 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 			xdb_hashlog ("  rid %d's next %d is 1st top record for slot %d\n", rid, pCurNode->next, slot_id);
 		} else if (pCurNode->prev) {
 			xdb_hashlog ("  rid %d has prev %d, point to it's next %d\n", rid, pCurNode->prev, pCurNode->next);
-			pPreNode = &pHashNode[pCurNode->prev];
+			pPreNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->prev));
 			pPreNode->next = pCurNode->next;
  		}
 		if (! (pCurNode->sibling & XDB_ROWID_MSB)) {
@@ -279,22 +432,22 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 	} else {
 		if (0 == pCurNode->prev) {
 			// It's the 1st sibling
-			pTopNode = &pHashNode[pCurNode->sibling];
+			pTopNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->sibling));
 			pTopNode->sibling = pCurNode->next;
 			if (pCurNode->next) {
 				xdb_hashlog ("  1st sibling %d has next sibling %d, prompt to 1st siblinig\n", rid, pCurNode->next);
-				pNxtSibNode = &pHashNode[pCurNode->next];
+				pNxtSibNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->next));
 				pNxtSibNode->prev = 0;
 				pNxtSibNode->sibling = pCurNode->sibling;
 			}
 		} else {
 			// It's the top node which has sibling
 			xdb_hashlog ("  Top rid %d has sibling %d, prompt to top\n", rid, pCurNode->sibling);
-			pSibNode = &pHashNode[pCurNode->sibling];
+			pSibNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->sibling));
 			// if has next silbing, prompt to first sibling
 			if (pSibNode->next) {
 				xdb_hashlog ("  1st Sibling %d has next sibling %d, prompt to 1st sibling\n", pCurNode->sibling, pSibNode->next);
-				pNxtSibNode = &pHashNode[pSibNode->next];
+				pNxtSibNode = XDB_HASH_WNODE (XDB_HASH_NODE(pSibNode->next));
 				pNxtSibNode->sibling = pNxtSibNode->prev;
 				pNxtSibNode->prev = 0;
 			}
@@ -302,17 +455,18 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 			pSibNode->next = pCurNode->next;
 			if (pCurNode->next) {
 				xdb_hashlog ("  rid %d has next %d, point to it's sibling %d\n", rid, pCurNode->next, pCurNode->sibling);
-				pNxtNode = &pHashNode[pCurNode->next];
+				pNxtNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->next));
 				pNxtNode->prev = pCurNode->sibling;
 			}
 			pSibNode->prev = pCurNode->prev;
 			if (pCurNode->prev & XDB_ROWID_MSB) {
 				slot_id = pCurNode->prev & XDB_ROWID_MASK;
+				XDB_HASH_WSLOT (slot_id);
 				pHashSlot[slot_id] = pCurNode->sibling;
 				xdb_hashlog ("  rid %d's 1st sibing %d prompt to 1st top for slot %d\n", rid, pCurNode->sibling, slot_id);
 			} else if (pCurNode->prev) {
 				xdb_hashlog ("  rid %d has prev %d, point to it's sibling %d\n", rid, pCurNode->prev, pCurNode->sibling);
-				pPreNode = &pHashNode[pCurNode->prev];
+				pPreNode = XDB_HASH_WNODE (XDB_HASH_NODE(pCurNode->prev));
 				pPreNode->next = pCurNode->sibling;
 			}
 		}
@@ -325,6 +479,11 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 
 	pHashHdr->row_count--;
 
+	// removed keys stay in filter and raise false positives, rebuild after enough churn
+	if ((NULL != pIdxm->bloom.pBlk) && (++pIdxm->bloom.del_count > (pIdxm->bloom.cap >> 3))) {
+		xdb_hash_bloom_build (pIdxm, pHashHdr->row_count << 1);
+	}
+
 #if 0
 	if (xdb_hash_check (NULL, pIdxm, 0) < 0) { exit(-1); }
 #endif
@@ -332,11 +491,69 @@ xdb_hash_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
 	return 0;
 }
 
+/*
+ * Index-only lookup: keys and rest filters are compared on cover copied to row buffer, 
+ * base row is only checked for visibility, rows added are covers.
+ */
+XDB_STATIC xdb_rowid 
+xdb_hash_query_cover (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pRowSet, uint32_t hash_val, xdb_rowid rid)
+{
+	xdb_idxm_t		*pIdxm = pIdxFilter->pIdxm;
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	int				count = pIdxFilter->idx_flt_cnt;
+	xdb_hashNode_t	*pHashNode = pIdxm->pHashNode;
+	xdb_stgmgr_t	*pStgMgr	= &pTblm->stg_mgr;
+	xdb_hashNode_t	*pCurNode;
+	void			*pCov;
+
+	XDB_BUF_DEF(pRowBuf, 4096);
+	XDB_BUF_ALLOC (pRowBuf, pTblm->row_size);
+	if (xdb_unlikely (NULL == pRowBuf)) {
+		return XDB_OK;
+	}
+
+	for (; rid > 0; rid = pCurNode->next) {
+		pCurNode = XDB_HASH_NODE(rid);
+		if (xdb_unlikely (pCurNode->hash_val != hash_val)) {
+			continue;
+		}
+		pCov = XDB_HASH_COVER(pCurNode);
+		xdb_hash_cover_row (pIdxm, pCov, pRowBuf);
+		if (xdb_unlikely (! pIdxm->pKeyOps->key_eq (pIdxm, pRowBuf, pIdxFilter->pIdxVals))) {
+			continue;
+		}
+		if (xdb_likely (xdb_row_valid (pConn, pTblm, XDB_IDPTR(pStgMgr, rid), rid))) {
+			if ((0 == count) || xdb_row_and_match (pTblm, pRowBuf, pIdxFilter->pIdxFlts, count)) {
+				if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pRowSet, rid, pCov))) {
+					goto exit;
+				}
+			}
+		}
+
+		for (rid = pCurNode->sibling; rid > 0; rid = pCurNode->next) {
+			pCurNode = XDB_HASH_NODE(rid);
+			pCov = XDB_HASH_COVER(pCurNode);
+			if (xdb_likely (xdb_row_valid (pConn, pTblm, XDB_IDPTR(pStgMgr, rid), rid))) {
+				if ((0 == count) || xdb_row_and_match (pTblm, xdb_hash_cover_row (pIdxm, pCov, pRowBuf), pIdxFilter->pIdxFlts, count)) {
+					if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pRowSet, rid, pCov))) {
+						goto exit;
+					}
+				}
+			}
+		}
+		break;
+	}
+
+exit:
+	XDB_BUF_FREE (pRowBuf);
+	return XDB_OK;
+}
+
 XDB_STATIC xdb_rowid 
 xdb_hash_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pRowSet)
 {
 	xdb_idxm_t			*pIdxm = pIdxFilter->pIdxm;
-	uint32_t hash_val = xdb_val_hash (pIdxFilter->pIdxVals, pIdxm->fld_count);
+	uint32_t hash_val = pIdxm->pKeyOps->val_hash (pIdxm, pIdxFilter->pIdxVals);
 	uint32_t slot_id = hash_val & pIdxm->slot_mask;
 	int				count = pIdxFilter->idx_flt_cnt;
 
@@ -350,20 +567,31 @@ xdb_hash_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pR
 	pHashHdr->query_times++;
 #endif
 
+	if ((NULL != pIdxm->bloom.pBlk) && !xdb_hash_bloom_test (&pIdxm->bloom, hash_val)) {
+#if !defined (XDB_HPO)
+		pIdxm->bloom.neg_count++;
+#endif
+		return XDB_OK;
+	}
+
 	xdb_rowid rid = pHashSlot[slot_id];
 
 	xdb_hashlog ("hash_get_slot hash 0x%x mod 0x%x slot %d 1st row %d\n", hash_val, pIdxm->slot_mask, slot_id, rid);
 
+	if (xdb_unlikely (pIdxFilter->bCover)) {
+		return xdb_hash_query_cover (pConn, pIdxFilter, pRowSet, hash_val, rid);
+	}
+
 	xdb_hashNode_t	*pCurNode;
 	for (; rid > 0; rid = pCurNode->next) {
-		pCurNode = &pHashNode[rid];
+		pCurNode = XDB_HASH_NODE(rid);
 		xdb_prefetch (pCurNode);
 		void *pRow = XDB_IDPTR(pStgMgr, rid);
 		xdb_prefetch (pRow);
 		if (xdb_unlikely (pCurNode->hash_val != hash_val)) {
 			continue;
 		}
-		if (xdb_unlikely (! xdb_row_isequal (pIdxm->pTblm, pRow, pIdxm->pFields, pIdxm->pExtract, pIdxFilter->pIdxVals, pIdxm->fld_count))) {
+		if (xdb_unlikely (! pIdxm->pKeyOps->key_eq (pIdxm, pRow, pIdxFilter->pIdxVals))) {
 			continue;
 		}
 		if (xdb_likely (xdb_row_valid (pConn, pIdxm->pTblm, pRow, rid))) {
@@ -376,7 +604,7 @@ xdb_hash_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pR
 		}
 
 		for (rid = pCurNode->sibling; rid > 0; rid = pCurNode->next) {
-			pCurNode = &pHashNode[rid];
+			pCurNode = XDB_HASH_NODE(rid);
 			pRow = XDB_IDPTR(pStgMgr, rid);
 			if (xdb_likely (xdb_row_valid (pConn, pIdxm->pTblm, pRow, rid))) {
 				// Compare rest fields
@@ -391,13 +619,17 @@ xdb_hash_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pR
 		return XDB_OK;
 	}
 
+#if !defined (XDB_HPO)
+	pIdxm->bloom.fp_count += (NULL != pIdxm->bloom.pBlk);
+#endif
+
 	return XDB_OK;
 }
 
 XDB_STATIC xdb_rowid 
 xdb_hash_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
 {
-	uint32_t hash_val = xdb_row_hash2 (pIdxm->pTblm, pRow2, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+	uint32_t hash_val = pIdxm->pKeyOps->key_hash2 (pIdxm, pRow2);
 	uint32_t slot_id = hash_val & pIdxm->slot_mask;
 
 	xdb_hashHdr_t	*pHashHdr  = pIdxm->pHashHdr;	
@@ -410,26 +642,33 @@ xdb_hash_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
 	pHashHdr->query_times++;
 #endif
 
+	if ((NULL != pIdxm->bloom.pBlk) && !xdb_hash_bloom_test (&pIdxm->bloom, hash_val)) {
+#if !defined (XDB_HPO)
+		pIdxm->bloom.neg_count++;
+#endif
+		return 0;
+	}
+
 	xdb_rowid rid = pHashSlot[slot_id];
 
 	xdb_hashlog ("hash_get_slot2 hash 0x%x mod 0x%x slot %d 1st row %d\n", hash_val, pIdxm->slot_mask, slot_id, rid);
 
 	xdb_hashNode_t	*pCurNode;
 	for (; rid > 0; rid = pCurNode->next) {
-		pCurNode = &pHashNode[rid];
+		pCurNode = XDB_HASH_NODE(rid);
 		xdb_prefetch (pCurNode);
 		void *pRow = XDB_IDPTR(pStgMgr, rid);
 		xdb_prefetch (pRow);
 		if (xdb_unlikely (pCurNode->hash_val != hash_val)) {
 			continue;
 		}
-		if (xdb_row_isequal2 (pIdxm->pTblm, pRow, pRow2, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count) && 
+		if (pIdxm->pKeyOps->key_eq2 (pIdxm, pRow, pRow2) && 
 			xdb_row_valid (pConn, pIdxm->pTblm, pRow, rid)) {
 			return rid;
 		}
 
 		for (rid = pCurNode->sibling; rid > 0; rid = pCurNode->next) {
-			pCurNode = &pHashNode[rid];
+			pCurNode = XDB_HASH_NODE(rid);
 			pRow = XDB_IDPTR(pStgMgr, rid);
 			if (xdb_likely (xdb_row_valid (pConn, pIdxm->pTblm, pRow, rid))) {
 				return rid;
@@ -439,6 +678,10 @@ xdb_hash_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
 		return 0;
 	}
 
+#if !defined (XDB_HPO)
+	pIdxm->bloom.fp_count += (NULL != pIdxm->bloom.pBlk);
+#endif
+
 	return 0;
 }
 
@@ -454,6 +697,9 @@ xdb_hash_close (xdb_idxm_t *pIdxm)
 	xdb_sprintf (path, "%s/T%06d/I%02d.hash", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
 	xdb_stg_close (&pIdxm->stg_mgr2); 
 
+	xdb_free (pIdxm->bloom.pBlk);
+	pIdxm->bloom.pBlk = NULL;
+
 	return XDB_OK;
 }
 
@@ -469,6 +715,9 @@ xdb_hash_drop (xdb_idxm_t *pIdxm)
 	xdb_sprintf (path, "%s/T%06d/I%02d.hash", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
 	xdb_stg_drop (&pIdxm->stg_mgr2, path); 
 
+	xdb_free (pIdxm->bloom.pBlk);
+	pIdxm->bloom.pBlk = NULL;
+
 	return XDB_OK;
 }
 
@@ -479,7 +728,32 @@ xdb_hash_create (xdb_idxm_t *pIdxm)
 	char path[XDB_PATH_LEN + 32];
 	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
 
-	xdb_stghdr_t stg_hdr = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC, .blk_size = sizeof(xdb_hashNode_t), 
+	// cover layout: notnull bits then key and INCLUDE fields, each aligned
+	uint32_t cov_size = 0;
+	pIdxm->cov_count = 0;
+	if (pIdxm->inc_count > 0) {
+		cov_size = sizeof (uint64_t);
+		for (int i = 0; i < pIdxm->fld_count + pIdxm->inc_count; ++i) {
+			xdb_field_t		*pField = (i < pIdxm->fld_count) ? pIdxm->pFields[i] : pIdxm->pIncFlds[i - pIdxm->fld_count];
+			xdb_hashCov_t	*pCovFld = &pIdxm->cov_fld[pIdxm->cov_count++];
+			int				align = s_xdb_type_len[pField->fld_type];
+			pCovFld->fld_id		= pField->fld_id;
+			pCovFld->fld_off	= pField->fld_off;
+			pCovFld->len		= s_xdb_type_len[pField->fld_type];
+			if ((XDB_TYPE_CHAR == pField->fld_type) || (XDB_TYPE_BINARY == pField->fld_type)) {
+				// len(2B) + data + '\0'
+				pCovFld->fld_off -= 2;
+				pCovFld->len = 2 + pField->fld_len + 1;
+			}
+			align = ((8 == align) || (4 == align)) ? align : 2;
+			cov_size = (cov_size + align - 1) & ~(align - 1);
+			pCovFld->cov_off = cov_size;
+			cov_size += pCovFld->len;
+		}
+		cov_size = XDB_ALIGN8 (cov_size);
+	}
+
+	xdb_stghdr_t stg_hdr = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC, .blk_size = sizeof(xdb_hashNode_t) + cov_size, 
 							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_hashHdr_t, hash_node)};
 	pIdxm->stg_mgr.pOps = pTblm->stg_mgr.pOps;
 	pIdxm->stg_mgr.pStgHdr	= &stg_hdr;
@@ -508,6 +782,10 @@ xdb_hash_create (xdb_idxm_t *pIdxm)
 	pIdxm->slot_mask = pIdxm->slot_cap - 1;
 	pIdxm->pHashSlot  = pIdxm->stg_mgr2.pBlkDat;
 
+	if (pIdxm->bBloom) {
+		xdb_hash_bloom_build (pIdxm, pIdxm->pHashHdr->row_count << 1);
+	}
+
 	return XDB_OK;
 }
 
@@ -520,15 +798,64 @@ xdb_hash_init (xdb_idxm_t *pIdxm)
 	pIdxm->pHashHdr->old_count	= 0;
 	pIdxm->pHashHdr->rehash_count = 0;
 	memset (pIdxm->pHashSlot, 0, sizeof(xdb_rowid) * XDB_STG_CAP(&pIdxm->stg_mgr2));
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	xdb_stg_dirty_all (&pIdxm->stg_mgr2);
+	if (pIdxm->bBloom) {
+		xdb_hash_bloom_build (pIdxm, 0);
+	}
 	return XDB_OK;
 }
 
+// presize nodes and slots once, then add without any incremental grow or rehash
 XDB_STATIC int 
+xdb_hash_build (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid count)
+{
+	xdb_stgmgr_t	*pStgMgr	= &pIdxm->pTblm->stg_mgr;
+	xdb_rowid		cap, max_rid = 0;
+
+	for (xdb_rowid i = 0; i < count; ++i) {
+		if (pRids[i] > max_rid) {
+			max_rid = pRids[i];
+		}
+	}
+	for (cap = pIdxm->node_cap; cap < max_rid; cap <<= 1)
+		;
+	if (cap > pIdxm->node_cap) {
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
+		pIdxm->pHashHdr  = (xdb_hashHdr_t*)pIdxm->stg_mgr.pStgHdr;
+		pIdxm->pHashNode = pIdxm->stg_mgr.pBlkDat1;
+	}
+
+	for (cap = pIdxm->slot_cap; (cap>>1) < count; cap <<= 1)
+		;
+	if (cap > pIdxm->slot_cap) {
+		if (xdb_stg_truncate (&pIdxm->stg_mgr2, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->slot_cap		= XDB_STG_CAP(&pIdxm->stg_mgr2);
+		pIdxm->slot_mask	= pIdxm->slot_cap - 1;
+		pIdxm->pHashSlot	= pIdxm->stg_mgr2.pBlkDat;
+		memset (pIdxm->pHashSlot, 0, sizeof(xdb_rowid) * pIdxm->slot_cap);
+	}
+
+	if (pIdxm->bBloom) {
+		xdb_hash_bloom_build (pIdxm, count << 1);
+	}
+
+	for (xdb_rowid i = 0; i < count; ++i) {
+		xdb_hash_add (NULL, pIdxm, pRids[i], XDB_IDPTR(pStgMgr, pRids[i]));
+	}
+
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_size 
 xdb_hash_sync (xdb_idxm_t *pIdxm)
 {
-	xdb_stg_sync (&pIdxm->stg_mgr,    0, 0, false);
-	xdb_stg_sync (&pIdxm->stg_mgr2,   0, 0, false);
-	return 0;
+	return xdb_stg_sync_dirty (&pIdxm->stg_mgr) + xdb_stg_sync_dirty (&pIdxm->stg_mgr2);
 }
 
 static xdb_idx_ops s_xdb_hash_ops = {
@@ -540,5 +867,6 @@ static xdb_idx_ops s_xdb_hash_ops = {
 	.idx_drop 	= xdb_hash_drop,
 	.idx_close 	= xdb_hash_close,
 	.idx_init	= xdb_hash_init,
-	.idx_sync	= xdb_hash_sync
+	.idx_sync	= xdb_hash_sync,
+	.idx_build	= xdb_hash_build
 };
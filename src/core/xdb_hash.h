@@ -19,6 +19,24 @@ typedef struct xdb_hashNode_t {
 	uint32_t 				hash_val;
 } xdb_hashNode_t;
 
+// covering index copies key and INCLUDE fields after node: notnull bits(8B) + fields
+typedef struct xdb_hashCov_t {
+	uint32_t				cov_off;	// offset in cover
+	uint32_t				fld_off;	// offset in row, CHAR/BINARY starts from len
+	uint16_t				len;
+	uint16_t				fld_id;
+} xdb_hashCov_t;
+
+// blocked Bloom filter of node hash values, kept in memory and rebuilt from nodes
+typedef struct xdb_hashBloom_t {
+	uint64_t				*pBlk;		// 8 words (one cache line) per block
+	uint32_t				blk_mask;
+	xdb_rowid				cap;		// rows sized for, rebuild when exceeded
+	xdb_rowid				del_count;	// removed since build, bits are left set
+	uint64_t				neg_count;	// lookups rejected by filter
+	uint64_t				fp_count;	// lookups passed filter but found no key
+} xdb_hashBloom_t;
+
 typedef struct xdb_hashHdr_t {
 	xdb_stghdr_t			blk_hdr;
 	uint64_t				query_times;
@@ -0,0 +1,450 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * Open addressing hash, each group has 16 one byte tags followed by their rowids.
+ * Lookup compares all tags of a group at once, so a miss usually costs one group
+ * load instead of walking a chain of nodes. Rows with same key take one entry each.
+ */
+
+#if XDB_LOG_FLAGS & XDB_LOG_HASH
+#define xdb_hash2log(...)	xdb_print(__VA_ARGS__)
+#else
+#define xdb_hash2log(...)
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define XDB_HASH2_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define XDB_HASH2_NEON
+#endif
+
+#define XDB_HASH2_TAG(hash)			(XDB_HASH2_FULL | ((hash) & 0x7F))
+#define XDB_HASH2_GID(hash, mask)	(((hash) >> 7) & (mask))
+// max load is 7/8 of tags including deleted ones
+#define XDB_HASH2_LIMIT(grp_cap)	((grp_cap) * XDB_HASH2_GRP / 8 * 7)
+
+#define XDB_HASH2_WGRP(pGrp)		xdb_stg_dirty (&pIdxm->stg_mgr, pGrp, sizeof(xdb_hash2Grp_t))
+
+/*
+ * Bits of tags equal to tag, walk with XDB_HASH2_BIT and clear lowest bit.
+ * NEON has no movemask, narrowing shift gives 4 bits per tag and top one is kept.
+ */
+#if defined(XDB_HASH2_SSE2)
+#define XDB_HASH2_SHIFT		0
+static inline uint64_t
+xdb_hash2_match (const uint8_t *pTag, uint8_t tag)
+{
+	__m128i tags = _mm_loadu_si128 ((const __m128i*)pTag);
+	return (uint32_t)_mm_movemask_epi8 (_mm_cmpeq_epi8 (tags, _mm_set1_epi8 ((char)tag)));
+}
+#elif defined(XDB_HASH2_NEON)
+#define XDB_HASH2_SHIFT		2
+static inline uint64_t
+xdb_hash2_match (const uint8_t *pTag, uint8_t tag)
+{
+	uint8x16_t cmp = vceqq_u8 (vld1q_u8 (pTag), vdupq_n_u8 (tag));
+	uint8x8_t nib = vshrn_n_u16 (vreinterpretq_u16_u8 (cmp), 4);
+	return vget_lane_u64 (vreinterpret_u64_u8 (nib), 0) & 0x8888888888888888ULL;
+}
+#else
+#define XDB_HASH2_SHIFT		0
+static inline uint64_t
+xdb_hash2_match (const uint8_t *pTag, uint8_t tag)
+{
+	uint64_t mask = 0;
+	for (int i = 0; i < XDB_HASH2_GRP; ++i) {
+		mask |= (uint64_t)(pTag[i] == tag) << i;
+	}
+	return mask;
+}
+#endif
+
+#define XDB_HASH2_BIT(mask)			(xdb_ctz64(mask) >> XDB_HASH2_SHIFT)
+
+/*
+ * Row hash of integer key is the value, mix it first so tags and groups don't follow key order.
+ * Only low 32 bits are same for row and value hash of negative INT, as HASH uses.
+ */
+static inline uint64_t
+xdb_hash2_mix (uint64_t hash)
+{
+	hash = (uint32_t)hash * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 32);
+}
+
+XDB_STATIC void
+xdb_hash2_setptr (xdb_idxm_t *pIdxm)
+{
+	pIdxm->pHash2Hdr	= (xdb_hash2Hdr_t*)pIdxm->stg_mgr.pStgHdr;
+	pIdxm->slot_cap		= XDB_STG_CAP(&pIdxm->stg_mgr);
+	pIdxm->slot_mask	= pIdxm->slot_cap - 1;
+}
+
+// put into first empty tag, caller makes sure key is new or duplicate is allowed
+XDB_STATIC void
+xdb_hash2_put (xdb_idxm_t *pIdxm, uint64_t hash_val, xdb_rowid rid)
+{
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+	uint32_t		gid = XDB_HASH2_GID(hash_val, pIdxm->slot_mask);
+
+	for (uint32_t step = 0; ; gid = (gid + ++step) & pIdxm->slot_mask) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		uint64_t mask = xdb_hash2_match (pGrp->tag, XDB_HASH2_EMPTY);
+		if (mask) {
+			int i = XDB_HASH2_BIT(mask);
+			pGrp->tag[i] = XDB_HASH2_TAG(hash_val);
+			pGrp->rid[i] = rid;
+			return;
+		}
+	}
+}
+
+// grow or clear deleted tags, rows are hashed again as tags don't keep whole hash
+XDB_STATIC int
+xdb_hash2_resize (xdb_idxm_t *pIdxm, xdb_rowid grp_cap)
+{
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+	xdb_rowid		count = 0;
+
+	xdb_rowid *pRids = xdb_malloc (sizeof(xdb_rowid) * (pHash2Hdr->row_count + 1));
+	if (NULL == pRids) {
+		return -XDB_E_MEMORY;
+	}
+	for (xdb_rowid gid = 0; gid < pIdxm->slot_cap; ++gid) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		for (int i = 0; i < XDB_HASH2_GRP; ++i) {
+			if ((pGrp->tag[i] & XDB_HASH2_FULL) && (count <= pHash2Hdr->row_count)) {
+				pRids[count++] = pGrp->rid[i];
+			}
+		}
+	}
+
+	xdb_hash2log ("Resize %s groups %d -> %d rows %d deleted %d\n", XDB_OBJ_NAME(pIdxm), pIdxm->slot_cap, grp_cap, count, pHash2Hdr->del_count);
+
+	if (grp_cap > pIdxm->slot_cap) {
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, grp_cap) < 0) {
+			xdb_free (pRids);
+			return -XDB_E_MEMORY;
+		}
+		xdb_hash2_setptr (pIdxm);
+		pHash2Hdr = pIdxm->pHash2Hdr;
+	}
+	memset (pHash2Hdr->hash_grp, 0, sizeof(xdb_hash2Grp_t) * pIdxm->slot_cap);
+	pHash2Hdr->del_count = 0;
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+
+	for (xdb_rowid i = 0; i < count; ++i) {
+		uint64_t hash_val = pIdxm->pKeyOps->key_hash (pIdxm, XDB_IDPTR(pStgMgr, pRids[i]));
+		xdb_hash2_put (pIdxm, xdb_hash2_mix (hash_val), pRids[i]);
+	}
+
+	xdb_free (pRids);
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_hash2_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRow)
+{
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+
+	if (xdb_unlikely (pHash2Hdr->row_count + pHash2Hdr->del_count >= XDB_HASH2_LIMIT(pIdxm->slot_cap))) {
+		// double when half full of rows, else only deleted tags are cleared
+		xdb_rowid cap = (pHash2Hdr->row_count >= XDB_HASH2_LIMIT(pIdxm->slot_cap) / 2) ? pIdxm->slot_cap << 1 : pIdxm->slot_cap;
+		if (xdb_hash2_resize (pIdxm, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pHash2Hdr = pIdxm->pHash2Hdr;
+	}
+
+	uint64_t		hash_val = xdb_hash2_mix (pIdxm->pKeyOps->key_hash (pIdxm, pRow));
+	uint8_t			tag = XDB_HASH2_TAG(hash_val);
+	uint32_t		gid = XDB_HASH2_GID(hash_val, pIdxm->slot_mask);
+	xdb_hash2Grp_t	*pFreeGrp = NULL;
+	int				free_id = 0;
+	bool			bExist = false, bUnique = pIdxm->bUnique && pConn;
+
+	xdb_hash2log ("add rid %d hash %"PRIx64" group %d\n", new_rid, hash_val, gid);
+
+	// probe till group with empty tag, unique index checks all rows of same key
+	for (uint32_t step = 0; ; gid = (gid + ++step) & pIdxm->slot_mask) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		xdb_prefetch (&pGrp->rid[0]);
+		for (uint64_t mask = xdb_hash2_match (pGrp->tag, tag); mask && (!bExist || bUnique); mask &= mask - 1) {
+			xdb_rowid rid = pGrp->rid[XDB_HASH2_BIT(mask)];
+			void *pRowDb = XDB_IDPTR(pStgMgr, rid);
+			if (pIdxm->pKeyOps->key_eq2 (pIdxm, pRow, pRowDb)) {
+				if (bUnique && xdb_row_valid (pConn, pTblm, pRowDb, rid)) {
+					return -XDB_E_EXISTS;
+				}
+				bExist = true;
+			}
+		}
+		uint64_t empty = xdb_hash2_match (pGrp->tag, XDB_HASH2_EMPTY);
+		if (NULL == pFreeGrp) {
+			uint64_t mask = empty | xdb_hash2_match (pGrp->tag, XDB_HASH2_DELETED);
+			if (mask) {
+				pFreeGrp = pGrp;
+				free_id = XDB_HASH2_BIT(mask);
+			}
+		}
+		if (empty || (bExist && !bUnique && pFreeGrp)) {
+			break;
+		}
+	}
+
+	if (XDB_HASH2_DELETED == pFreeGrp->tag[free_id]) {
+		pHash2Hdr->del_count--;
+	}
+	XDB_HASH2_WGRP (pFreeGrp);
+	pFreeGrp->tag[free_id] = tag;
+	pFreeGrp->rid[free_id] = new_rid;
+
+	pHash2Hdr->row_count++;
+	if (!bExist) {
+		pHash2Hdr->node_count++;
+	}
+
+	return 0;
+}
+
+XDB_STATIC int
+xdb_hash2_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
+{
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+	uint64_t		hash_val = xdb_hash2_mix (pIdxm->pKeyOps->key_hash (pIdxm, pRow));
+	uint8_t			tag = XDB_HASH2_TAG(hash_val);
+	uint32_t		gid = XDB_HASH2_GID(hash_val, pIdxm->slot_mask);
+	xdb_hash2Grp_t	*pRowGrp = NULL;
+	int				row_id = 0;
+	bool			bExist = false;
+
+	xdb_hash2log ("del rid %d hash %"PRIx64" group %d\n", rid, hash_val, gid);
+
+	// find row and whether other rows have same key
+	for (uint32_t step = 0; ; gid = (gid + ++step) & pIdxm->slot_mask) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		for (uint64_t mask = xdb_hash2_match (pGrp->tag, tag); mask; mask &= mask - 1) {
+			int i = XDB_HASH2_BIT(mask);
+			if (pGrp->rid[i] == rid) {
+				pRowGrp = pGrp;
+				row_id = i;
+			} else if (!bExist && pIdxm->pKeyOps->key_eq2 (pIdxm, pRow, XDB_IDPTR(pStgMgr, pGrp->rid[i]))) {
+				bExist = true;
+			}
+		}
+		if (xdb_hash2_match (pGrp->tag, XDB_HASH2_EMPTY) || (pRowGrp && bExist)) {
+			break;
+		}
+	}
+
+	if (xdb_unlikely (NULL == pRowGrp)) {
+		// not in index
+		return 0;
+	}
+
+	// probe stops at group with empty tag already, so tag can be empty instead of deleted
+	XDB_HASH2_WGRP (pRowGrp);
+	if (xdb_hash2_match (pRowGrp->tag, XDB_HASH2_EMPTY)) {
+		pRowGrp->tag[row_id] = XDB_HASH2_EMPTY;
+	} else {
+		pRowGrp->tag[row_id] = XDB_HASH2_DELETED;
+		pHash2Hdr->del_count++;
+	}
+	pRowGrp->rid[row_id] = 0;
+
+	pHash2Hdr->row_count--;
+	if (!bExist) {
+		pHash2Hdr->node_count--;
+	}
+
+	return 0;
+}
+
+XDB_STATIC xdb_rowid
+xdb_hash2_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pRowSet)
+{
+	xdb_idxm_t		*pIdxm = pIdxFilter->pIdxm;
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+	uint64_t		hash_val = xdb_hash2_mix (pIdxm->pKeyOps->val_hash (pIdxm, pIdxFilter->pIdxVals));
+	uint8_t			tag = XDB_HASH2_TAG(hash_val);
+	uint32_t		gid = XDB_HASH2_GID(hash_val, pIdxm->slot_mask);
+	int				count = pIdxFilter->idx_flt_cnt;
+
+	//affect multi-thead performance
+#if !defined (XDB_HPO)
+	pHash2Hdr->query_times++;
+#endif
+
+	for (uint32_t step = 0; ; gid = (gid + ++step) & pIdxm->slot_mask) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		for (uint64_t mask = xdb_hash2_match (pGrp->tag, tag); mask; mask &= mask - 1) {
+			xdb_rowid rid = pGrp->rid[XDB_HASH2_BIT(mask)];
+			void *pRow = XDB_IDPTR(pStgMgr, rid);
+			if (xdb_unlikely (! pIdxm->pKeyOps->key_eq (pIdxm, pRow, pIdxFilter->pIdxVals))) {
+				continue;
+			}
+			if (xdb_likely (xdb_row_valid (pConn, pTblm, pRow, rid))) {
+				// Compare rest fields
+				if ((0 == count) || xdb_row_and_match (pTblm, pRow, pIdxFilter->pIdxFlts, count)) {
+					if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pRowSet, rid, pRow))) {
+						return XDB_OK;
+					}
+				}
+			}
+		}
+		if (xdb_likely (xdb_hash2_match (pGrp->tag, XDB_HASH2_EMPTY))) {
+			break;
+		}
+	}
+
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_rowid
+xdb_hash2_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
+{
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_hash2Hdr_t	*pHash2Hdr = pIdxm->pHash2Hdr;
+	uint64_t		hash_val = xdb_hash2_mix (pIdxm->pKeyOps->key_hash2 (pIdxm, pRow2));
+	uint8_t			tag = XDB_HASH2_TAG(hash_val);
+	uint32_t		gid = XDB_HASH2_GID(hash_val, pIdxm->slot_mask);
+
+	//affect multi-thead performance
+#if !defined (XDB_HPO)
+	pHash2Hdr->query_times++;
+#endif
+
+	for (uint32_t step = 0; ; gid = (gid + ++step) & pIdxm->slot_mask) {
+		xdb_hash2Grp_t *pGrp = &pHash2Hdr->hash_grp[gid];
+		for (uint64_t mask = xdb_hash2_match (pGrp->tag, tag); mask; mask &= mask - 1) {
+			xdb_rowid rid = pGrp->rid[XDB_HASH2_BIT(mask)];
+			void *pRow = XDB_IDPTR(pStgMgr, rid);
+			if (pIdxm->pKeyOps->key_eq2 (pIdxm, pRow, pRow2) &&
+				xdb_row_valid (pConn, pTblm, pRow, rid)) {
+				return rid;
+			}
+		}
+		if (xdb_likely (xdb_hash2_match (pGrp->tag, XDB_HASH2_EMPTY))) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+XDB_STATIC int
+xdb_hash2_close (xdb_idxm_t *pIdxm)
+{
+	xdb_stg_close (&pIdxm->stg_mgr);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_hash2_drop (xdb_idxm_t *pIdxm)
+{
+	char path[XDB_PATH_LEN + 32];
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+	xdb_stg_drop (&pIdxm->stg_mgr, path);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_hash2_create (xdb_idxm_t *pIdxm)
+{
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+	char path[XDB_PATH_LEN + 32];
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+
+	// group count is power of 2, zero tag is empty, so grow only clears new groups
+	xdb_stghdr_t stg_hdr = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC|XDB_STG_CLEAR, .blk_size = sizeof(xdb_hash2Grp_t),
+							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_hash2Hdr_t, hash_grp)};
+	pIdxm->stg_mgr.pOps = pTblm->stg_mgr.pOps;
+	pIdxm->stg_mgr.pStgHdr	= &stg_hdr;
+	int rc = xdb_stg_open (&pIdxm->stg_mgr, path, NULL, NULL);
+	if (rc != XDB_OK) {
+		xdb_errlog ("Failed to create index %s", XDB_OBJ_NAME(pIdxm));
+		return rc;
+	}
+
+	xdb_hash2_setptr (pIdxm);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_hash2_init (xdb_idxm_t *pIdxm)
+{
+	pIdxm->pHash2Hdr->row_count		= 0;
+	pIdxm->pHash2Hdr->node_count	= 0;
+	pIdxm->pHash2Hdr->del_count		= 0;
+	memset (pIdxm->pHash2Hdr->hash_grp, 0, sizeof(xdb_hash2Grp_t) * pIdxm->slot_cap);
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	return XDB_OK;
+}
+
+// presize groups once, then add without any grow
+XDB_STATIC int
+xdb_hash2_build (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid count)
+{
+	xdb_stgmgr_t	*pStgMgr	= &pIdxm->pTblm->stg_mgr;
+	xdb_rowid		cap;
+
+	for (cap = pIdxm->slot_cap; XDB_HASH2_LIMIT(cap) <= count; cap <<= 1)
+		;
+	if (cap > pIdxm->slot_cap) {
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		xdb_hash2_setptr (pIdxm);
+		xdb_hash2_init (pIdxm);
+	}
+
+	for (xdb_rowid i = 0; i < count; ++i) {
+		xdb_hash2_add (NULL, pIdxm, pRids[i], XDB_IDPTR(pStgMgr, pRids[i]));
+	}
+
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_size
+xdb_hash2_sync (xdb_idxm_t *pIdxm)
+{
+	return xdb_stg_sync_dirty (&pIdxm->stg_mgr);
+}
+
+static xdb_idx_ops s_xdb_hash2_ops = {
+	.idx_add 	= xdb_hash2_add,
+	.idx_rem 	= xdb_hash2_rem,
+	.idx_query 	= xdb_hash2_query,
+	.idx_query2	= xdb_hash2_query2,
+	.idx_create = xdb_hash2_create,
+	.idx_drop 	= xdb_hash2_drop,
+	.idx_close 	= xdb_hash2_close,
+	.idx_init	= xdb_hash2_init,
+	.idx_sync	= xdb_hash2_sync,
+	.idx_build	= xdb_hash2_build
+};
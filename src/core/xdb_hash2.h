@@ -0,0 +1,36 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+#ifndef __XDB_HASH2_H__
+#define __XDB_HASH2_H__
+
+// open addressing hash, 16 tags are probed at once, rowid is stored next to its tag
+#define XDB_HASH2_GRP			16
+#define XDB_HASH2_EMPTY		0x00
+#define XDB_HASH2_DELETED		0x01
+#define XDB_HASH2_FULL		0x80	// full tag is 0x80 | low 7 bits of hash
+
+typedef struct {
+	uint8_t					tag[XDB_HASH2_GRP];
+	xdb_rowid				rid[XDB_HASH2_GRP];
+} xdb_hash2Grp_t;
+
+typedef struct {
+	xdb_stghdr_t			blk_hdr;
+	uint64_t				query_times;
+	xdb_rowid 				row_count;
+	xdb_rowid 				node_count;	// distinct keys
+	xdb_rowid				del_count;	// deleted tags, cleared by rehash
+	uint32_t				rsvd[4];
+	xdb_hash2Grp_t			hash_grp[];
+} xdb_hash2Hdr_t;
+
+#endif // __XDB_HASH2_H__
@@ -22,18 +22,50 @@ xdb_find_index (xdb_tblm_t *pTblm, const char *idx_name)
 	return xdb_objm_get (&pTblm->idx_objm, idx_name);
 }
 
+// writers call xdb_mark_dirty before touching index, so current table change id is newer than last flush
+#define XDB_IDX_CHGID(pTblm)	(XDB_TBLPTR(pTblm)->lastchg_id)
+
+static inline void 
+xdb_idx_setchg (xdb_idxm_t *pIdxm, uint64_t chg_id)
+{
+	pIdxm->stg_mgr.pStgHdr->chg_id = chg_id;
+}
+
+// index is not modified after last sync, so it matches the table rows at that time
+// flush_id 0 means never synced or created by old version without the tags
+static inline bool 
+xdb_idx_isclean (xdb_idxm_t *pIdxm)
+{
+	xdb_stghdr_t *pStgHdr = pIdxm->stg_mgr.pStgHdr;
+	return (0 != pStgHdr->flush_id) && (pStgHdr->chg_id <= pStgHdr->flush_id);
+}
+
+// row belongs to index, partial index skips rows not matching its filters
+XDB_STATIC bool 
+xdb_idx_rowmatch (xdb_idxm_t *pIdxm, void *pRow)
+{
+	return xdb_likely (0 == pIdxm->filter_count) || xdb_row_and_match (pIdxm->pTblm, pRow, pIdxm->pFilters, pIdxm->filter_count);
+}
+
 XDB_STATIC int 
 xdb_idx_addRow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow)
 {
 	int rc;
+	uint64_t chg_id = XDB_IDX_CHGID(pTblm);
 	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		if (!xdb_idx_rowmatch (pIdxm, pRow)) {
+			continue;
+		}
+		xdb_idx_setchg (pIdxm, chg_id);
 		rc = pIdxm->pIdxOps->idx_add (pConn, pIdxm, rid, pRow);
 		if (xdb_unlikely (rc != XDB_OK)) {
-			// recover added index
+			// recover added index, skip partial index the row didn't enter
 			for (int j = 0; j < i; ++j) {
-				xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
-				pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
+				xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[j]);
+				if (xdb_idx_rowmatch (pIdxm, pRow)) {
+					pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
+				}
 			}
 			return rc;
 		}
@@ -45,14 +77,21 @@ XDB_STATIC int
 xdb_idx_addRow_bmp (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow, uint8_t *idx_affect, int count)
 {
 	int rc;
+	uint64_t chg_id = XDB_IDX_CHGID(pTblm);
 	for (int i = 0; i < count; ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, idx_affect[i]);
+		if (!xdb_idx_rowmatch (pIdxm, pRow)) {
+			continue;
+		}
+		xdb_idx_setchg (pIdxm, chg_id);
 		rc = pIdxm->pIdxOps->idx_add (pConn, pIdxm, rid, pRow);
 		if (xdb_unlikely (rc != XDB_OK)) {
-			// recover added index
+			// recover added index, skip partial index the row didn't enter
 			for (int j = 0; j < i; ++j) {
-				xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
-				pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
+				xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, idx_affect[j]);
+				if (xdb_idx_rowmatch (pIdxm, pRow)) {
+					pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
+				}
 			}
 			return rc;
 		}
@@ -63,8 +102,13 @@ xdb_idx_addRow_bmp (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, void *p
 XDB_STATIC int 
 xdb_idx_remRow_bmp (xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow, uint8_t *idx_affect, int count)
 {
+	uint64_t chg_id = XDB_IDX_CHGID(pTblm);
 	for (int i = 0; i < count; ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, idx_affect[i]);
+		if (!xdb_idx_rowmatch (pIdxm, pRow)) {
+			continue;
+		}
+		xdb_idx_setchg (pIdxm, chg_id);
 		pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
 	}
 	return count;
@@ -73,22 +117,140 @@ xdb_idx_remRow_bmp (xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow, uint8_t *idx_a
 XDB_STATIC int 
 xdb_idx_remRow (xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow)
 {
+	uint64_t chg_id = XDB_IDX_CHGID(pTblm);
 	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		if (!xdb_idx_rowmatch (pIdxm, pRow)) {
+			continue;
+		}
+		xdb_idx_setchg (pIdxm, chg_id);
 		pIdxm->pIdxOps->idx_rem (pIdxm, rid, pRow);
 	}
 	return 0;
 }
 
+// rows and distinct keys are maintained exactly by index add/rem, used by planner cost
+XDB_STATIC void 
+xdb_idx_stats (xdb_idxm_t *pIdxm, xdb_rowid *pRows, xdb_rowid *pKeys, uint64_t *pQueries)
+{
+	*pRows = *pKeys = 0;
+	*pQueries = 0;
+	switch (pIdxm->idx_type) {
+	case XDB_IDX_HASH:
+		if (NULL != pIdxm->pHashHdr) {
+			*pRows		= pIdxm->pHashHdr->row_count;
+			*pKeys		= pIdxm->pHashHdr->node_count;
+			*pQueries	= pIdxm->pHashHdr->query_times;
+		}
+		break;
+	case XDB_IDX_RBTREE:
+		if (NULL != pIdxm->pRbtrHdr) {
+			*pRows		= pIdxm->pRbtrHdr->row_count;
+			*pKeys		= pIdxm->pRbtrHdr->node_count;
+			*pQueries	= pIdxm->pRbtrHdr->query_times;
+		}
+		break;
+	case XDB_IDX_BITMAP:
+		if (NULL != pIdxm->pBmpHdr) {
+			*pRows		= pIdxm->pBmpHdr->row_count;
+			*pKeys		= pIdxm->pBmpHdr->node_count;
+			*pQueries	= pIdxm->pBmpHdr->query_times;
+		}
+		break;
+	case XDB_IDX_LPM:
+		if (NULL != pIdxm->pLpmHdr) {
+			*pRows		= pIdxm->pLpmHdr->row_count;
+			*pKeys		= pIdxm->pLpmHdr->node_count;
+			*pQueries	= pIdxm->pLpmHdr->query_times;
+		}
+		break;
+	case XDB_IDX_HASH2:
+		if (NULL != pIdxm->pHash2Hdr) {
+			*pRows		= pIdxm->pHash2Hdr->row_count;
+			*pKeys		= pIdxm->pHash2Hdr->node_count;
+			*pQueries	= pIdxm->pHash2Hdr->query_times;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 static xdb_idx_ops s_xdb_hash_ops;
 static xdb_idx_ops s_xdb_rbtree_ops;
+static xdb_idx_ops s_xdb_bmpidx_ops;
+static xdb_idx_ops s_xdb_lpm_ops;
+static xdb_idx_ops s_xdb_hash2_ops;
 
 static xdb_idx_ops *s_xdb_idx_ops[] = {
 	[XDB_IDX_HASH]		= &s_xdb_hash_ops,
 	[XDB_IDX_RBTREE]	= &s_xdb_rbtree_ops,
+	[XDB_IDX_BITMAP]	= &s_xdb_bmpidx_ops,
+	[XDB_IDX_LPM]		= &s_xdb_lpm_ops,
+	[XDB_IDX_HASH2]		= &s_xdb_hash2_ops,
 };
 
 
+// build empty index from rows in bulk, partial index takes matched rows only
+XDB_STATIC int 
+xdb_idx_bulk_build (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid count)
+{
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	xdb_rowid		*pMatch = NULL, match_count = 0;
+
+	if (NULL == pIdxm->pIdxOps->idx_build) {
+		return -XDB_E_NOTFOUND;
+	}
+	if (pIdxm->filter_count > 0) {
+		pMatch = xdb_malloc (((size_t)count + 1) * sizeof (xdb_rowid));
+		if (NULL == pMatch) {
+			return -XDB_E_MEMORY;
+		}
+		for (xdb_rowid i = 0; i < count; ++i) {
+			if (xdb_idx_rowmatch (pIdxm, XDB_IDPTR(pStgMgr, pRids[i]))) {
+				pMatch[match_count++] = pRids[i];
+			}
+		}
+		pRids = pMatch;
+		count = match_count;
+	}
+
+	int rc = pIdxm->pIdxOps->idx_build (pIdxm, pRids, count);
+	xdb_free (pMatch);
+
+	return rc;
+}
+
+XDB_STATIC xdb_key_ops* 
+xdb_idx_keyops (xdb_idxm_t *pIdxm)
+{
+	for (int i = 0; i < pIdxm->fld_count; ++i) {
+		if (NULL != pIdxm->pExtract[i]) {
+			return &s_xdb_key_gen_ops;
+		}
+	}
+	if (1 == pIdxm->fld_count) {
+		switch (pIdxm->pFields[0]->fld_type) {
+		case XDB_TYPE_INT:
+			return &s_xdb_key_i32_ops;
+		case XDB_TYPE_BIGINT:
+		case XDB_TYPE_TIMESTAMP:
+			return &s_xdb_key_i64_ops;
+		case XDB_TYPE_CHAR:
+			return &s_xdb_key_str_ops;
+		case XDB_TYPE_INET:
+			return &s_xdb_key_inet_ops;
+		case XDB_TYPE_MAC:
+			return &s_xdb_key_mac_ops;
+		default:
+			break;
+		}
+	} else if ((2 == pIdxm->fld_count) && (XDB_TYPE_INT == pIdxm->pFields[0]->fld_type) && (XDB_TYPE_INT == pIdxm->pFields[1]->fld_type)) {
+		return &s_xdb_key_ii_ops;
+	}
+	return &s_xdb_key_gen_ops;
+}
+
 XDB_STATIC void 
 xdb_index_order (xdb_tblm_t	*pTblm)
 {
@@ -100,6 +262,101 @@ xdb_index_order (xdb_tblm_t	*pTblm)
 	}
 }
 
+XDB_STATIC void 
+xdb_idx_filter_free (xdb_idxm_t *pIdxm)
+{
+	for (int i = 0; i < pIdxm->filter_count; ++i) {
+		xdb_free (pIdxm->filters[i].pExtract);
+		xdb_free (pIdxm->filters[i].val.val_str.str);
+	}
+	pIdxm->filter_count = 0;
+}
+
+// WHERE of partial index, values are converted from own copy of token text
+XDB_STATIC int 
+xdb_idx_filter_init (xdb_conn_t *pConn, xdb_idxm_t *pIdxm, xdb_stmt_idx_t *pStmt)
+{
+	for (int i = 0; i < pStmt->filter_count; ++i) {
+		xdb_stmt_idxflt_t	*pStmtFlt = &pStmt->filters[i];
+		xdb_filter_t		*pFilter = &pIdxm->filters[i];
+
+		memset (pFilter, 0, sizeof (*pFilter));
+		pIdxm->pFilters[i] = pFilter;
+		pIdxm->filter_count++;
+		pFilter->pField = xdb_find_field (pIdxm->pTblm, pStmtFlt->col, 0);
+		XDB_EXPECT (NULL != pFilter->pField, XDB_E_STMT, "Can't find field '%s'", pStmtFlt->col);
+		XDB_EXPECT ((NULL == pStmtFlt->extract) || (XDB_TYPE_JSON == pFilter->pField->fld_type), XDB_E_STMT, "Field '%s' isn't JSON", pStmtFlt->col);
+		pFilter->cmp_op = pStmtFlt->cmp_op;
+		if (NULL != pStmtFlt->extract) {
+			pFilter->pExtract = xdb_strdup (pStmtFlt->extract, 0);
+			XDB_EXPECT (NULL != pFilter->pExtract, XDB_E_MEMORY, "Can't alloc memory");
+		}
+		char *pVal = xdb_malloc (pStmtFlt->vlen + 1);
+		XDB_EXPECT (NULL != pVal, XDB_E_MEMORY, "Can't alloc memory");
+		memcpy (pVal, pStmtFlt->val, pStmtFlt->vlen);
+		pVal[pStmtFlt->vlen] = '\0';
+		pFilter->val.val_str.str = pVal;
+		pFilter->val.val_str.len = pStmtFlt->vlen;
+		XDB_EXPECT2 (xdb_parse_fltval (pConn, pFilter, pStmtFlt->vtype, pVal, pStmtFlt->vlen) >= XDB_OK);
+		XDB_EXPECT ((XDB_TOK_LIKE != pFilter->cmp_op) || (XDB_TYPE_CHAR == pFilter->val.val_type), XDB_E_STMT, "LIKE needs string value");
+	}
+	return XDB_OK;
+
+error:
+	return -XDB_E_STMT;
+}
+
+// " WHERE ..." of partial index
+XDB_STATIC int 
+xdb_idx_filter2str (char buf[], xdb_idxm_t *pIdxm)
+{
+	int len = 0;
+
+	for (int i = 0; i < pIdxm->filter_count; ++i) {
+		xdb_filter_t	*pFilter = &pIdxm->filters[i];
+		xdb_value_t		*pVal = &pFilter->val;
+		len += sprintf (buf+len, " %s %s", i ? "AND" : "WHERE", XDB_OBJ_NAME(pFilter->pField));
+		if (NULL != pFilter->pExtract) {
+			len += sprintf (buf+len, "->'%s'", pFilter->pExtract);
+		}
+		len += sprintf (buf+len, " %s ", (XDB_TOK_LIKE == pFilter->cmp_op) ? "LIKE" : xdb_tok2str (pFilter->cmp_op));
+		switch (pVal->val_type) {
+		case XDB_TYPE_BIGINT:
+			if (XDB_TYPE_BOOL == pFilter->pField->fld_type) {
+				len += sprintf (buf+len, "%s", pVal->ival ? "true" : "false");
+			} else {
+				len += sprintf (buf+len, "%"PRId64, pVal->ival);
+			}
+			break;
+		case XDB_TYPE_UBIGINT:
+			len += sprintf (buf+len, "%"PRIu64, pVal->uval);
+			break;
+		case XDB_TYPE_BINARY:
+			buf[len++] = 'X';
+			buf[len++] = '\'';
+			for (int h = 0; h < pVal->str.len; ++h) {
+				buf[len++] = s_xdb_hex_2_str[((uint8_t*)pVal->str.str)[h]][0];
+				buf[len++] = s_xdb_hex_2_str[((uint8_t*)pVal->str.str)[h]][1];
+			}
+			buf[len++] = '\'';
+			break;
+		case XDB_TYPE_CHAR:
+		case XDB_TYPE_INET:
+		case XDB_TYPE_MAC:
+			buf[len++] = '\'';
+			len += xdb_str_escape (buf+len, pVal->val_str.str, pVal->val_str.len);
+			buf[len++] = '\'';
+			break;
+		default:
+			len += sprintf (buf+len, "%s", pVal->val_str.str);
+			break;
+		}
+	}
+	buf[len] = '\0';
+
+	return len;
+}
+
 XDB_STATIC int 
 xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 {
@@ -115,6 +372,27 @@ xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 	}
 
 	XDB_EXPECT (XDB_OBJM_COUNT (pTblm->idx_objm) < XDB_MAX_INDEX, XDB_E_FULL, "Can create at most %d indexes", XDB_MAX_INDEX);
+	XDB_EXPECT (!pStmt->bUnique || (XDB_IDX_BITMAP != pStmt->idx_type), XDB_E_STMT, "BITMAP index can't be UNIQUE");
+	XDB_EXPECT (!pStmt->bUnique || (XDB_IDX_LPM != pStmt->idx_type), XDB_E_STMT, "LPM index can't be UNIQUE");
+	if (XDB_IDX_LPM == pStmt->idx_type) {
+		xdb_field_t *pField = (1 == pStmt->fld_count) ? xdb_find_field (pTblm, pStmt->idx_col[0], 0) : NULL;
+		XDB_EXPECT ((NULL != pField) && (XDB_TYPE_INET == pField->fld_type) && (NULL == pStmt->idx_extract[0]), 
+					XDB_E_STMT, "LPM index needs one INET field");
+	}
+	if (pStmt->inc_count > 0) {
+		XDB_EXPECT (XDB_IDX_HASH == pStmt->idx_type, XDB_E_STMT, "INCLUDE needs HASH index");
+		for (int i = 0; i < pStmt->fld_count + pStmt->inc_count; ++i) {
+			bool bKey = i < pStmt->fld_count;
+			char *col = bKey ? pStmt->idx_col[i] : pStmt->inc_col[i - pStmt->fld_count];
+			xdb_field_t *pField = xdb_find_field (pTblm, col, 0);
+			XDB_EXPECT (NULL != pField, XDB_E_STMT, "Can't find field '%s'", col);
+			XDB_EXPECT (!s_xdb_vdat[pField->fld_type] && (!bKey || (NULL == pStmt->idx_extract[i])), 
+						XDB_E_STMT, "Covering index field '%s' must be fixed size", col);
+		}
+	}
+
+	XDB_EXPECT (!pStmt->bPrimary || (0 == pStmt->filter_count), XDB_E_STMT, "PRIMARY KEY can't have WHERE");
+	XDB_EXPECT (!pStmt->bBloom || (XDB_IDX_HASH == pStmt->idx_type), XDB_E_STMT, "BLOOM needs HASH index");
 
 	pIdxm = xdb_calloc (sizeof(xdb_idxm_t));
 	if (NULL == pIdxm) {
@@ -122,6 +400,11 @@ xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 	}
 
 	pIdxm->pTblm = pStmt->pTblm;
+	if (xdb_idx_filter_init (pConn, pIdxm, pStmt) < 0) {
+		xdb_idx_filter_free (pIdxm);
+		xdb_free (pIdxm);
+		goto error;
+	}
 	xdb_strcpy (XDB_OBJ_NAME(pIdxm), pStmt->idx_name);
 	XDB_OBJ_ID(pIdxm) = pStmt->xoid;
 	xdb_objm_add (&pTblm->idx_objm, pIdxm);
@@ -130,6 +413,7 @@ xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 	pIdxm->idx_type = pStmt->idx_type;
 	pIdxm->bUnique = pStmt->bUnique;
 	pIdxm->bPrimary = pStmt->bPrimary;
+	pIdxm->bBloom = pStmt->bBloom;
 	pIdxm->idx_type = pStmt->idx_type;
 
 	for (int i = 0; i < pIdxm->fld_count; ++i) {
@@ -152,6 +436,22 @@ xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 		}
 	}
 
+	// key and INCLUDE fields are copied in index, update of INCLUDE field refreshes the copy
+	pIdxm->inc_count = pStmt->inc_count;
+	for (int i = 0; i < pIdxm->inc_count; ++i) {
+		pIdxm->pIncFlds[i] = xdb_find_field (pStmt->pTblm, pStmt->inc_col[i], 0);
+		pIdxm->pIncFlds[i]->idx_bmp |= (1<<XDB_OBJ_ID(pIdxm));
+		pIdxm->pIncFlds[i]->cov_bmp |= (1<<XDB_OBJ_ID(pIdxm));
+	}
+	for (int i = 0; (i < pIdxm->fld_count) && (pIdxm->inc_count > 0); ++i) {
+		pIdxm->pFields[i]->cov_bmp |= (1<<XDB_OBJ_ID(pIdxm));
+	}
+	// update of filter field may move row in or out of partial index
+	for (int i = 0; i < pIdxm->filter_count; ++i) {
+		pIdxm->filters[i].pField->idx_bmp |= (1<<XDB_OBJ_ID(pIdxm));
+	}
+
+	pIdxm->pKeyOps = xdb_idx_keyops (pIdxm);
 	pIdxm->pIdxOps = s_xdb_idx_ops[pIdxm->idx_type];
 	rc = pIdxm->pIdxOps->idx_create (pIdxm);
 	if (rc != 0) {
@@ -162,14 +462,41 @@ xdb_create_index (xdb_stmt_idx_t *pStmt, bool bCreateTbl)
 
 	if (pStmt->xoid < 0) {
 		xdb_stgmgr_t	 *pStgMgr = &pTblm->stg_mgr;
-		xdb_rowid		max_rid = XDB_STG_MAXID(pStgMgr);
-		
+		xdb_rowid		max_rid = XDB_STG_MAXID(pStgMgr), count = 0, rows = 0, keys = 0;
+		uint64_t		queries;
+
+		// never synced yet
+		xdb_idx_setchg (pIdxm, XDB_IDX_CHGID(pTblm));
+
+		// rows are collected to build in bulk, fall back to add one by one if no memory
+		xdb_rowid *pRids = (max_rid > 0) ? xdb_malloc (((size_t)max_rid + 1) * sizeof (xdb_rowid)) : NULL;
 		for (xdb_rowid rid = 1; rid <= max_rid; ++rid) {
 			void *pRow = XDB_IDPTR(pStgMgr, rid);
 			if (xdb_row_valid (pConn, pTblm, pRow, rid)) {
-				pIdxm->pIdxOps->idx_add (pConn, pIdxm, rid, pRow);
+				if (NULL != pRids) {
+					pRids[count++] = rid;
+				} else if (xdb_idx_rowmatch (pIdxm, pRow)) {
+					pIdxm->pIdxOps->idx_add (pConn, pIdxm, rid, pRow);
+				}
 			}
 		}
+		if (NULL != pRids) {
+			rc = xdb_idx_bulk_build (pIdxm, pRids, count);
+			if (XDB_OK == rc) {
+				xdb_idx_stats (pIdxm, &rows, &keys, &queries);
+			}
+			// bulk build doesn't check unique, add one by one to skip duplicate rows as before
+			if ((XDB_OK != rc) || (pIdxm->bUnique && (rows != keys))) {
+				pIdxm->pIdxOps->idx_init (pIdxm);
+				for (xdb_rowid i = 0; i < count; ++i) {
+					void *pRow = XDB_IDPTR(pStgMgr, pRids[i]);
+					if (xdb_idx_rowmatch (pIdxm, pRow)) {
+						pIdxm->pIdxOps->idx_add (pConn, pIdxm, pRids[i], pRow);
+					}
+				}
+			}
+			xdb_free (pRids);
+		}
 		if (!bCreateTbl) {
 			xdb_gen_db_schema (pTblm->pDbm);
 		}
@@ -196,6 +523,7 @@ xdb_close_index (xdb_idxm_t *pIdxm)
 		pIdxm->pFields[i]->idx_fid[XDB_OBJ_ID(pIdxm)] = -1;
 		xdb_free (pIdxm->pExtract[i]);
 	}
+	xdb_idx_filter_free (pIdxm);
 
 	xdb_objm_del (&pTblm->idx_objm, pIdxm);
 
@@ -218,7 +546,16 @@ xdb_drop_index (xdb_idxm_t *pIdxm)
 	for (int i = 0; i < pIdxm->fld_count; ++i) {
 		pIdxm->pFields[i]->idx_fid[XDB_OBJ_ID(pIdxm)] = -1;
 		pIdxm->pFields[i]->idx_bmp &= ~(1<<XDB_OBJ_ID(pIdxm));
+		pIdxm->pFields[i]->cov_bmp &= ~(1<<XDB_OBJ_ID(pIdxm));
+	}
+	for (int i = 0; i < pIdxm->inc_count; ++i) {
+		pIdxm->pIncFlds[i]->idx_bmp &= ~(1<<XDB_OBJ_ID(pIdxm));
+		pIdxm->pIncFlds[i]->cov_bmp &= ~(1<<XDB_OBJ_ID(pIdxm));
 	}
+	for (int i = 0; i < pIdxm->filter_count; ++i) {
+		pIdxm->filters[i].pField->idx_bmp &= ~(1<<XDB_OBJ_ID(pIdxm));
+	}
+	xdb_idx_filter_free (pIdxm);
 
 	xdb_objm_del (&pTblm->idx_objm, pIdxm);
 
@@ -258,25 +595,56 @@ xdb_dump_create_index ()
 #endif
 
 XDB_STATIC void 
+xdb_dirty_take_index (xdb_tblm_t *pTblm)
+{
+	int count = XDB_OBJM_MAX(pTblm->idx_objm);
+	for (int i = 0; i < count; ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, i);
+		if (NULL != pIdxm) {
+			xdb_stg_dirty_take (&pIdxm->stg_mgr);
+			xdb_stg_dirty_take (&pIdxm->stg_mgr2);
+		}
+	}
+}
+
+XDB_STATIC xdb_size 
+xdb_dirty_bytes_index (xdb_tblm_t *pTblm)
+{
+	xdb_size bytes = 0;
+	int count = XDB_OBJM_MAX(pTblm->idx_objm);
+	for (int i = 0; i < count; ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, i);
+		if (NULL != pIdxm) {
+			bytes += xdb_stg_dirty_bytes (&pIdxm->stg_mgr) + xdb_stg_dirty_bytes (&pIdxm->stg_mgr2);
+		}
+	}
+	return bytes;
+}
+
+XDB_STATIC xdb_size 
 xdb_flush_index (xdb_tblm_t *pTblm)
 {
+	xdb_size bytes = 0;
 	int count = XDB_OBJM_MAX(pTblm->idx_objm);
 	for (int i = 0; i < count; ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, i);
 		if (NULL != pIdxm) {
-			pIdxm->pIdxOps->idx_sync (pIdxm);
+			bytes += pIdxm->pIdxOps->idx_sync (pIdxm);
 		}
 	}
+	return bytes;
 }
 
+// mark synced only after index reached disk, caller holds table storage lock
 XDB_STATIC void 
-xdb_init_index (xdb_tblm_t *pTblm)
+xdb_idx_setflush (xdb_tblm_t *pTblm, uint64_t flush_id)
 {
 	int count = XDB_OBJM_MAX(pTblm->idx_objm);
 	for (int i = 0; i < count; ++i) {
 		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, i);
 		if (NULL != pIdxm) {
-			pIdxm->pIdxOps->idx_init (pIdxm);
+			pIdxm->stg_mgr.pStgHdr->flush_id = flush_id;
+			xdb_stg_sync (&pIdxm->stg_mgr, 0, 4094, true);
 		}
 	}
 }
@@ -287,6 +655,9 @@ xdb_idx2str(xdb_idx_type tp)
 	const char *id2str[] = {
 		[XDB_IDX_HASH	] = "HASH",
 		[XDB_IDX_RBTREE	] = "RBTREE",
+		[XDB_IDX_BITMAP	] = "BITMAP",
+		[XDB_IDX_LPM	] = "LPM",
+		[XDB_IDX_HASH2	] = "HASH2",
 	};
 	return tp <= XDB_ARY_LEN(id2str) ? id2str[tp] : "Unknown";
 }
@@ -20,10 +20,22 @@ typedef struct {
 	int (*idx_create) (struct xdb_idxm_t *pIdxm);
 	int (*idx_close) (struct xdb_idxm_t* pIdxm);
 	int (*idx_drop) (struct xdb_idxm_t* pIdxm);
-	int (*idx_sync) (struct xdb_idxm_t* pIdxm);
+	xdb_size (*idx_sync) (struct xdb_idxm_t* pIdxm);
 	int (*idx_init) (struct xdb_idxm_t* pIdxm);
+	int (*idx_build) (struct xdb_idxm_t* pIdxm, xdb_rowid *pRids, xdb_rowid count); // optional bulk build on empty index
 } xdb_idx_ops;
 
+// key hash and compare, specialized for common key shapes when index is created or opened
+typedef struct {
+	uint64_t (*key_hash) (struct xdb_idxm_t *pIdxm, void *pRow);
+	uint64_t (*key_hash2) (struct xdb_idxm_t *pIdxm, void *pRow2);
+	uint64_t (*val_hash) (struct xdb_idxm_t *pIdxm, xdb_value_t **ppValues);
+	bool (*key_eq) (struct xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues);
+	bool (*key_eq2) (struct xdb_idxm_t *pIdxm, void *pRowL, void *pRowR);
+	int (*key_cmp) (struct xdb_idxm_t *pIdxm, void *pRow, xdb_value_t **ppValues, int count); // first count fields
+	int (*key_cmp2) (struct xdb_idxm_t *pIdxm, const void *pRowL, const void *pRowR);
+} xdb_key_ops;
+
 typedef struct xdb_idxm_t {
 	xdb_obj_t		obj;
 	struct xdb_tblm_t *pTblm;
@@ -33,6 +45,15 @@ typedef struct xdb_idxm_t {
 	int				fld_count;
 	xdb_field_t		*pFields[XDB_MAX_MATCH_COL];
 	char			*pExtract[XDB_MAX_MATCH_COL];
+	int				inc_count;
+	xdb_field_t		*pIncFlds[XDB_MAX_MATCH_COL];	// INCLUDE fields
+	int				cov_count;	// key and INCLUDE fields copied in hash node
+	xdb_hashCov_t	cov_fld[XDB_MAX_MATCH_COL];
+	bool			bBloom;
+	xdb_hashBloom_t	bloom;
+	int				filter_count;	// partial index, only rows matching all filters are indexed
+	xdb_filter_t	*pFilters[XDB_MAX_IDX_FILTER];
+	xdb_filter_t	filters[XDB_MAX_IDX_FILTER];
 	uint32_t		slot_mask;
 	xdb_hashHdr_t	*pHashHdr;	
 	xdb_rbtree_t	*pRbtrHdr;
@@ -40,9 +61,18 @@ typedef struct xdb_idxm_t {
 	xdb_rowid		slot_cap;
 	xdb_rowid		node_cap;
 	xdb_hashNode_t	*pHashNode;
+	xdb_bmpHdr_t	*pBmpHdr;
+	xdb_bmpKey_t	*pBmpKey;
+	xdb_bmp_t		**ppKeyBmp;	// bitmap of each key, rebuilt on open
+	xdb_rowid		key_cap;
+	xdb_rowid		bmp_cap;
+	xdb_lpmHdr_t	*pLpmHdr;
+	xdb_lpmNode_t	*pLpmNode;
+	xdb_hash2Hdr_t	*pHash2Hdr;	// slot_cap and slot_mask are for groups
 	xdb_stgmgr_t	stg_mgr;
 	xdb_stgmgr_t	stg_mgr2;
 	xdb_idx_ops		*pIdxOps;
+	xdb_key_ops		*pKeyOps;
 } xdb_idxm_t;
 
 XDB_STATIC int 
@@ -60,7 +90,19 @@ xdb_idx_remRow_bmp (xdb_tblm_t *pTblm, xdb_rowid rid, void *pRow, uint8_t *idx_d
 XDB_STATIC xdb_idxm_t* 
 xdb_find_index (xdb_tblm_t *pTblm, const char *idx_name);
 
+XDB_STATIC bool 
+xdb_idx_rowmatch (xdb_idxm_t *pIdxm, void *pRow);
+
+XDB_STATIC int 
+xdb_idx_filter2str (char buf[], xdb_idxm_t *pIdxm);
+
 XDB_STATIC const char* 
 xdb_idx2str(xdb_idx_type tp);
 
+XDB_STATIC void 
+xdb_idx_stats (xdb_idxm_t *pIdxm, xdb_rowid *pRows, xdb_rowid *pKeys, uint64_t *pQueries);
+
+XDB_STATIC void* 
+xdb_hash_cover_row (xdb_idxm_t *pIdxm, const void *pCov, void *pRow);
+
 #endif // __XDB_INDEX_H__
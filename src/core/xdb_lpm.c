@@ -0,0 +1,425 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * Longest prefix match index for INET field: one path compressed binary trie per family.
+ * Prefix node chains rows of the prefix, glue node only forks and always has 2 children,
+ * so lookup visits at most address bits + 1 nodes.
+ */
+
+#if XDB_LOG_FLAGS & XDB_LOG_IDX
+#define xdb_lpmlog(...)	xdb_print(__VA_ARGS__)
+#else
+#define xdb_lpmlog(...)
+#endif
+
+#define XDB_LPM_WROW(rid)		((xdb_lpmRow_t*)xdb_stg_dirty (&pIdxm->stg_mgr, &pIdxm->pLpmHdr->lpm_row[(rid)-1], sizeof(xdb_lpmRow_t)))
+#define XDB_LPM_WNODE(nid)		((xdb_lpmNode_t*)xdb_stg_dirty_id (&pIdxm->stg_mgr2, nid))
+#define XDB_LPM_BIT(addr, i)	(((addr)[(i)>>3] >> (7 - ((i)&7))) & 1)
+
+// trie of address family, prefix length is clamped to address bits
+XDB_STATIC int
+xdb_lpm_family (const xdb_inet_t *pInet, int *pBits)
+{
+	int max = (4 == pInet->family) ? 32 : ((6 == pInet->family) ? 128 : 0);
+	if (xdb_unlikely (0 == max)) {
+		return -1;
+	}
+	*pBits = pInet->mask < max ? pInet->mask : max;
+	return 6 == pInet->family;
+}
+
+// leading equal bits of two addresses, at most bits
+XDB_STATIC int
+xdb_lpm_common (const uint8_t *pAddrL, const uint8_t *pAddrR, int bits)
+{
+	int i;
+	for (i = 0; (i < (bits >> 3)) && (pAddrL[i] == pAddrR[i]); ++i)
+		;
+	int common = i << 3;
+	if (common < bits) {
+		uint8_t diff = pAddrL[i] ^ pAddrR[i];
+		for (uint8_t m = 0x80; (common < bits) && !(diff & m); m >>= 1) {
+			common++;
+		}
+	}
+	return common;
+}
+
+XDB_STATIC xdb_rowid
+xdb_lpm_newnode (xdb_idxm_t *pIdxm, const uint8_t *pAddr, int bits, int family, xdb_rowid parent)
+{
+	xdb_lpmNode_t	*pNode;
+	xdb_rowid		nid = xdb_stg_alloc (&pIdxm->stg_mgr2, (void**)&pNode);
+	if (nid <= 0) {
+		return 0;
+	}
+	// storage may be remapped
+	pIdxm->pLpmNode = pIdxm->stg_mgr2.pBlkDat1;
+
+	memset (pNode, 0, sizeof (*pNode));
+	pNode->parent	= parent;
+	pNode->bits		= bits;
+	pNode->family	= family;
+	memcpy (pNode->addr, pAddr, bits >> 3);
+	if (bits & 7) {
+		pNode->addr[bits >> 3] = pAddr[bits >> 3] & (0xFF << (8 - (bits & 7)));
+	}
+	return nid;
+}
+
+// set child of parent (root if 0) at side to nid
+XDB_STATIC void
+xdb_lpm_link (xdb_idxm_t *pIdxm, int family, xdb_rowid parent, int side, xdb_rowid nid)
+{
+	if (0 == parent) {
+		pIdxm->pLpmHdr->root[family] = nid;
+	} else {
+		XDB_LPM_WNODE (parent)->child[side] = nid;
+	}
+	if (nid > 0) {
+		XDB_LPM_WNODE (nid)->parent = parent;
+	}
+}
+
+// find or add node of prefix, 0 is no memory
+XDB_STATIC xdb_rowid
+xdb_lpm_insert (xdb_idxm_t *pIdxm, int family, const uint8_t *pAddr, int bits)
+{
+	xdb_rowid	parent = 0, nid = pIdxm->pLpmHdr->root[family];
+	int			side = 0, common = 0;
+
+	while (nid > 0) {
+		xdb_lpmNode_t *pNode = &pIdxm->pLpmNode[nid];
+		common = xdb_lpm_common (pNode->addr, pAddr, pNode->bits < bits ? pNode->bits : bits);
+		if (common < pNode->bits) {
+			break;
+		}
+		if (pNode->bits == bits) {
+			return nid;
+		}
+		parent	= nid;
+		side	= XDB_LPM_BIT (pAddr, pNode->bits);
+		nid		= pNode->child[side];
+	}
+
+	xdb_rowid new_id = xdb_lpm_newnode (pIdxm, pAddr, bits, family, parent);
+	if (0 == new_id) {
+		return 0;
+	}
+	xdb_rowid top = new_id;
+	if (nid > 0) {
+		// nid diverges from new prefix at bit common
+		if (common < bits) {
+			top = xdb_lpm_newnode (pIdxm, pAddr, common, family, parent);
+			if (0 == top) {
+				xdb_stg_free (&pIdxm->stg_mgr2, new_id, &pIdxm->pLpmNode[new_id]);
+				return 0;
+			}
+			xdb_lpm_link (pIdxm, family, top, XDB_LPM_BIT (pAddr, common), new_id);
+			xdb_lpmlog ("glue node %d /%d\n", top, common);
+		}
+		xdb_lpm_link (pIdxm, family, top, XDB_LPM_BIT (pIdxm->pLpmNode[nid].addr, common), nid);
+	}
+	xdb_lpm_link (pIdxm, family, parent, side, top);
+	xdb_lpmlog ("new node %d /%d parent %d\n", new_id, bits, parent);
+
+	return new_id;
+}
+
+// free node without rows, and glue node left with one child
+XDB_STATIC void
+xdb_lpm_prune (xdb_idxm_t *pIdxm, xdb_rowid nid)
+{
+	while (nid > 0) {
+		xdb_lpmNode_t *pNode = &pIdxm->pLpmNode[nid];
+		if (pNode->rid || (pNode->child[0] && pNode->child[1])) {
+			break;
+		}
+		xdb_rowid child	= pNode->child[0] ? pNode->child[0] : pNode->child[1];
+		xdb_rowid parent = pNode->parent;
+		int side = parent ? (pIdxm->pLpmNode[parent].child[1] == nid) : 0;
+		xdb_lpm_link (pIdxm, pNode->family, parent, side, child);
+		xdb_lpmlog ("free node %d /%d\n", nid, pNode->bits);
+		xdb_stg_free (&pIdxm->stg_mgr2, nid, pNode);
+		// parent lost one child only if leaf was freed
+		nid = child ? 0 : parent;
+	}
+}
+
+XDB_STATIC int
+xdb_lpm_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid new_rid, void *pRow)
+{
+	xdb_rowid	cap;
+	int			bits;
+
+	if (new_rid > pIdxm->node_cap) {
+		for (cap = pIdxm->node_cap; cap < new_rid; cap <<= 1)
+			;
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
+		pIdxm->pLpmHdr  = (xdb_lpmHdr_t*)pIdxm->stg_mgr.pStgHdr;
+	}
+
+	xdb_lpmHdr_t	*pLpmHdr = pIdxm->pLpmHdr;
+	if (xdb_unlikely (pLpmHdr->lpm_row[new_rid-1].node)) {
+		return XDB_OK;
+	}
+
+	const xdb_inet_t *pInet = pRow + pIdxm->pFields[0]->fld_off;
+	int family = xdb_lpm_family (pInet, &bits);
+	if (xdb_unlikely (family < 0)) {
+		// NULL is not indexed
+		return XDB_OK;
+	}
+	xdb_rowid nid = xdb_lpm_insert (pIdxm, family, pInet->addr, bits);
+	if (xdb_unlikely (0 == nid)) {
+		return -XDB_E_MEMORY;
+	}
+
+	xdb_lpmNode_t	*pNode = XDB_LPM_WNODE (nid);
+	xdb_lpmRow_t	*pLpmRow = XDB_LPM_WROW (new_rid);
+	pLpmRow->node	= nid;
+	pLpmRow->next	= pNode->rid;
+	pLpmRow->prev	= 0;
+	if (pNode->rid) {
+		XDB_LPM_WROW (pNode->rid)->prev = new_rid;
+	} else {
+		pLpmHdr->node_count++;
+	}
+	pNode->rid = new_rid;
+	pLpmHdr->row_count++;
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_lpm_rem (xdb_idxm_t* pIdxm, xdb_rowid rid, void *pRow)
+{
+	xdb_lpmHdr_t	*pLpmHdr = pIdxm->pLpmHdr;
+
+	if (xdb_unlikely ((rid > pIdxm->node_cap) || (0 == pLpmHdr->lpm_row[rid-1].node))) {
+		// not in index
+		return 0;
+	}
+
+	xdb_lpmRow_t	*pLpmRow = XDB_LPM_WROW (rid);
+	xdb_rowid		nid = pLpmRow->node;
+	xdb_lpmNode_t	*pNode = XDB_LPM_WNODE (nid);
+
+	if (pLpmRow->prev) {
+		XDB_LPM_WROW (pLpmRow->prev)->next = pLpmRow->next;
+	} else {
+		pNode->rid = pLpmRow->next;
+	}
+	if (pLpmRow->next) {
+		XDB_LPM_WROW (pLpmRow->next)->prev = pLpmRow->prev;
+	}
+	pLpmRow->node = pLpmRow->next = pLpmRow->prev = 0;
+	pLpmHdr->row_count--;
+
+	if (0 == pNode->rid) {
+		pLpmHdr->node_count--;
+		xdb_lpm_prune (pIdxm, nid);
+	}
+
+	return 0;
+}
+
+// rows of prefix node, -XDB_E_FULL if row set is full
+XDB_STATIC int
+xdb_lpm_rows (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowid nid, xdb_rowset_t *pRowSet)
+{
+	xdb_idxm_t		*pIdxm = pIdxFilter->pIdxm;
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	int				count = pIdxFilter->idx_flt_cnt;
+
+	for (xdb_rowid rid = pIdxm->pLpmNode[nid].rid; rid > 0; rid = pIdxm->pLpmHdr->lpm_row[rid-1].next) {
+		void *pRow = XDB_IDPTR(pStgMgr, rid);
+		if (xdb_likely (xdb_row_valid (pConn, pIdxm->pTblm, pRow, rid))) {
+	 		if ((0 == count) || xdb_row_and_match (pIdxm->pTblm, pRow, pIdxFilter->pIdxFlts, count)) {
+				if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pRowSet, rid, pRow))) {
+					return -XDB_E_FULL;
+				}
+			}
+		}
+	}
+	return XDB_OK;
+}
+
+/*
+ * >>= walks the address path and returns rows from longest prefix to shortest,
+ * so LIMIT 1 gets the longest prefix match. <<= returns subtree of the value prefix.
+ */
+XDB_STATIC xdb_rowid
+xdb_lpm_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *pRowSet)
+{
+	xdb_idxm_t			*pIdxm = pIdxFilter->pIdxm;
+	const xdb_inet_t	*pInet = &pIdxFilter->pIdxVals[0]->inet;
+	xdb_rowid			path[XDB_LPM_BITS * 2], nid;
+	int					bits, n = 0;
+
+	//affect multi-thead performance
+#if !defined (XDB_HPO)
+	pIdxm->pLpmHdr->query_times++;
+#endif
+
+	int family = xdb_lpm_family (pInet, &bits);
+	if (family < 0) {
+		return XDB_OK;
+	}
+	xdb_lpmNode_t *pLpmNode = pIdxm->pLpmNode;
+	nid = pIdxm->pLpmHdr->root[family];
+
+	if (XDB_TOK_SUPEQ == pIdxFilter->match_opt) {
+		while (nid > 0) {
+			xdb_lpmNode_t *pNode = &pLpmNode[nid];
+			if ((pNode->bits > bits) || (xdb_lpm_common (pNode->addr, pInet->addr, pNode->bits) < pNode->bits)) {
+				break;
+			}
+			if (pNode->rid) {
+				path[n++] = nid;
+			}
+			if (pNode->bits == bits) {
+				break;
+			}
+			nid = pNode->child[XDB_LPM_BIT (pInet->addr, pNode->bits)];
+		}
+		while ((n > 0) && (xdb_lpm_rows (pConn, pIdxFilter, path[--n], pRowSet) >= 0))
+			;
+		return XDB_OK;
+	}
+
+	// 1st node inside value prefix
+	while (nid > 0) {
+		xdb_lpmNode_t *pNode = &pLpmNode[nid];
+		int len = pNode->bits < bits ? pNode->bits : bits;
+		if (xdb_lpm_common (pNode->addr, pInet->addr, len) < len) {
+			return XDB_OK;
+		}
+		if (pNode->bits >= bits) {
+			break;
+		}
+		nid = pNode->child[XDB_LPM_BIT (pInet->addr, pNode->bits)];
+	}
+	// preorder, stack holds at most one sibling per level
+	if (nid > 0) {
+		path[n++] = nid;
+	}
+	while (n > 0) {
+		nid = path[--n];
+		xdb_lpmNode_t *pNode = &pLpmNode[nid];
+		if (pNode->rid && (xdb_lpm_rows (pConn, pIdxFilter, nid, pRowSet) < 0)) {
+			break;
+		}
+		if (pNode->child[1]) {
+			path[n++] = pNode->child[1];
+		}
+		if (pNode->child[0]) {
+			path[n++] = pNode->child[0];
+		}
+	}
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_lpm_close (xdb_idxm_t *pIdxm)
+{
+	xdb_stg_close (&pIdxm->stg_mgr);
+	xdb_stg_close (&pIdxm->stg_mgr2);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_lpm_drop (xdb_idxm_t *pIdxm)
+{
+	char path[XDB_PATH_LEN + 32];
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+	xdb_stg_drop (&pIdxm->stg_mgr, path);
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.lpm", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+	xdb_stg_drop (&pIdxm->stg_mgr2, path);
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_lpm_create (xdb_idxm_t *pIdxm)
+{
+	xdb_tblm_t *pTblm = pIdxm->pTblm;
+	char path[XDB_PATH_LEN + 32];
+	xdb_sprintf (path, "%s/T%06d/I%02d.idx", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+
+	xdb_stghdr_t stg_hdr = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_NOALLOC|XDB_STG_CLEAR, .blk_size = sizeof(xdb_lpmRow_t),
+							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_lpmHdr_t, lpm_row)};
+	pIdxm->stg_mgr.pOps = pTblm->stg_mgr.pOps;
+	pIdxm->stg_mgr.pStgHdr	= &stg_hdr;
+	int rc = xdb_stg_open (&pIdxm->stg_mgr, path, NULL, NULL);
+	if (rc != XDB_OK) {
+		xdb_errlog ("Failed to create index %s", XDB_OBJ_NAME(pIdxm));
+		return rc;
+	}
+
+	xdb_sprintf (path, "%s/T%06d/I%02d.lpm", pTblm->pDbm->db_path, XDB_OBJ_ID(pTblm), XDB_OBJ_ID(pIdxm));
+
+	xdb_stghdr_t stg_hdr2 = {.stg_magic = 0xE7FCFDFB, .blk_flags=XDB_STG_CLEAR, .blk_size = sizeof(xdb_lpmNode_t),
+							.ctl_off = 0, .blk_off = XDB_OFFSET(xdb_lpmNodeHdr_t, lpm_node)};
+	pIdxm->stg_mgr2.pOps = pTblm->stg_mgr.pOps;
+	pIdxm->stg_mgr2.pStgHdr	= &stg_hdr2;
+	rc = xdb_stg_open (&pIdxm->stg_mgr2, path, NULL, NULL);
+	if (rc != XDB_OK) {
+		xdb_errlog ("Failed to create index %s", XDB_OBJ_NAME(pIdxm));
+		return rc;
+	}
+
+	pIdxm->pLpmHdr	= (xdb_lpmHdr_t*)pIdxm->stg_mgr.pStgHdr;
+	pIdxm->node_cap	= XDB_STG_CAP(&pIdxm->stg_mgr);
+	pIdxm->pLpmNode	= pIdxm->stg_mgr2.pBlkDat1;
+
+	return XDB_OK;
+}
+
+XDB_STATIC int
+xdb_lpm_init (xdb_idxm_t *pIdxm)
+{
+	pIdxm->pLpmHdr->row_count	= 0;
+	pIdxm->pLpmHdr->node_count	= 0;
+	pIdxm->pLpmHdr->root[0]		= 0;
+	pIdxm->pLpmHdr->root[1]		= 0;
+	memset (pIdxm->pLpmHdr->lpm_row, 0, sizeof(xdb_lpmRow_t) * pIdxm->node_cap);
+	xdb_stg_init (&pIdxm->stg_mgr2);
+	XDB_STG_MAXID(&pIdxm->stg_mgr2) = 0;
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	return XDB_OK;
+}
+
+XDB_STATIC xdb_size
+xdb_lpm_sync (xdb_idxm_t *pIdxm)
+{
+	return xdb_stg_sync_dirty (&pIdxm->stg_mgr) + xdb_stg_sync_dirty (&pIdxm->stg_mgr2);
+}
+
+static xdb_idx_ops s_xdb_lpm_ops = {
+	.idx_add 	= xdb_lpm_add,
+	.idx_rem 	= xdb_lpm_rem,
+	.idx_query 	= xdb_lpm_query,
+	.idx_create = xdb_lpm_create,
+	.idx_drop 	= xdb_lpm_drop,
+	.idx_close 	= xdb_lpm_close,
+	.idx_init	= xdb_lpm_init,
+	.idx_sync	= xdb_lpm_sync,
+};
@@ -0,0 +1,48 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+#ifndef __XDB_LPM_H__
+#define __XDB_LPM_H__
+
+#define XDB_LPM_BITS	128
+
+typedef struct {
+	xdb_rowid				node;	// trie node of row prefix, 0 is not indexed
+	xdb_rowid				next;	// rows with same prefix
+	xdb_rowid				prev;
+} xdb_lpmRow_t;
+
+typedef struct {
+	xdb_stghdr_t			blk_hdr;
+	uint64_t				query_times;
+	xdb_rowid 				row_count;
+	xdb_rowid 				node_count;	// distinct prefixes
+	xdb_rowid				root[2];	// IPv4, IPv6 trie
+	uint32_t				rsvd[4];
+	xdb_lpmRow_t			lpm_row[];
+} xdb_lpmHdr_t;
+
+typedef struct {
+	xdb_rowid				rid;		// 1st row of prefix, 0 is glue node
+	xdb_rowid				parent;
+	xdb_rowid				child[2];
+	uint8_t					bits;		// prefix length
+	uint8_t					family;		// 0 IPv4, 1 IPv6
+	uint8_t					rsvd[2];
+	uint8_t					addr[16];	// prefix, host bits are 0
+} xdb_lpmNode_t;
+
+typedef struct {
+	xdb_stghdr_t			blk_hdr;
+	xdb_lpmNode_t			lpm_node[];
+} xdb_lpmNodeHdr_t;
+
+#endif // __XDB_LPM_H__
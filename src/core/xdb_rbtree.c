@@ -21,6 +21,8 @@
 #define XDB_RB_NULL					0
 
 #define XDB_RB_NODE(row_id)			(&pT->rb_node[row_id])
+// node to be written, mark it so flush only syncs changed pages
+#define XDB_RB_WNODE(row_id)		((xdb_rbnode_t*)xdb_stg_dirty (&pIdxm->stg_mgr, XDB_RB_NODE(row_id), sizeof(xdb_rbnode_t)))
 #define rb_prev						rb_left
 #define rb_next						rb_right
 
@@ -33,16 +35,17 @@
  *             B     C                      A     B
  */
 XDB_STATIC void 
-xdb_rb_left_rotate (xdb_rbtree_t *pT, xdb_rowid X)
+xdb_rb_left_rotate (xdb_idxm_t *pIdxm, xdb_rowid X)
 {
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
 	xdb_rowid		Y;
-	xdb_rbnode_t	*pX = XDB_RB_NODE(X), *pY, *pB, *pXP;
+	xdb_rbnode_t	*pX = XDB_RB_WNODE(X), *pY, *pB, *pXP;
 
     // Prowonditions: (x->right != T.nil);
 
 	// 1: y = x.right
 	Y = pX->rb_right;
-	pY = XDB_RB_NODE(Y);
+	pY = XDB_RB_WNODE(Y);
 
     // 2: x.right = y.left
     pX->rb_right = pY->rb_left; // Turn Y's left subtree B into X's right subtree
@@ -50,7 +53,7 @@ xdb_rb_left_rotate (xdb_rbtree_t *pT, xdb_rowid X)
     // 3: if y.left != T.nil
     if (pY->rb_left != XDB_RB_NULL) {
     	// 4: y.left.p = x
-		pB = XDB_RB_NODE(pY->rb_left); 	// set B's parent to X
+		pB = XDB_RB_WNODE(pY->rb_left); 	// set B's parent to X
 		pB->rb_parent = X;
     }
 
@@ -63,7 +66,7 @@ xdb_rb_left_rotate (xdb_rbtree_t *pT, xdb_rowid X)
         pT->rb_root = Y;
 		xdb_rbtlog ("  Set %d as root\n", Y);
     } else {
-        pXP = XDB_RB_NODE(pX->rb_parent);
+        pXP = XDB_RB_WNODE(pX->rb_parent);
     	// 8: elseif x == x.p.left
         if (X == pXP->rb_left) {
 			// 9: x.p.left = y
@@ -89,16 +92,17 @@ xdb_rb_left_rotate (xdb_rbtree_t *pT, xdb_rowid X)
  *         A     B                                B    C 
  */
 XDB_STATIC void 
-xdb_rb_right_rotate (xdb_rbtree_t *pT, xdb_rowid Y)
+xdb_rb_right_rotate (xdb_idxm_t *pIdxm, xdb_rowid Y)
 {
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
 	xdb_rowid		X;
-	xdb_rbnode_t	*pY = XDB_RB_NODE(Y), *pX, *pB, *pYP;
+	xdb_rbnode_t	*pY = XDB_RB_WNODE(Y), *pX, *pB, *pYP;
 
     // Prowonditions: (y->left != T.nil);
 
 	// 1: x = y.left
 	X = pY->rb_left;
-	pX = XDB_RB_NODE(X);
+	pX = XDB_RB_WNODE(X);
 
     // 2: y.left = x.right
     pY->rb_left = pX->rb_right; // Turn X's right subtree B into Y's left subtree
@@ -106,7 +110,7 @@ xdb_rb_right_rotate (xdb_rbtree_t *pT, xdb_rowid Y)
     // 3: if x.right != T.nil
     if (pX->rb_right != XDB_RB_NULL) {
     	// 4: x.right.p = y
-		pB = XDB_RB_NODE(pX->rb_right); 	// set B's parent to Y
+		pB = XDB_RB_WNODE(pX->rb_right); 	// set B's parent to Y
 		pB->rb_parent = Y;
     }
 
@@ -119,7 +123,7 @@ xdb_rb_right_rotate (xdb_rbtree_t *pT, xdb_rowid Y)
         pT->rb_root = X;
 		xdb_rbtlog ("  Set %d as root\n", X);
     } else {
-        pYP = XDB_RB_NODE(pY->rb_parent);
+        pYP = XDB_RB_WNODE(pY->rb_parent);
     	// 8: elseif y == y.p.left
         if (Y == pYP->rb_left) {
 			// 9: y.p.left = x
@@ -138,11 +142,13 @@ xdb_rb_right_rotate (xdb_rbtree_t *pT, xdb_rowid Y)
 }
 
 XDB_STATIC void 
-xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
+xdb_rb_insert_fixup (xdb_idxm_t *pIdxm, xdb_rowid Z)
 {
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
 	xdb_rowid 		Y, ZP, ZPP;
 	xdb_rbnode_t	*pY, *pZ = XDB_RB_NODE(Z), *pZP, *pZPP;
 
+	// nodes are only read here, XDB_RB_WNODE right before write marks page dirty
 	ZP = pZ->rb_parent;
 	pZP = XDB_RB_NODE(ZP);
 	// 1: while z.p.color == RED
@@ -157,11 +163,11 @@ xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
 			// 4: if y.color == RED	: case 1
             if (pY->color_sibling & XDB_RB_RED) {
 				// 5: z.p.color = BLACK
-				pZP->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(ZP)->color_sibling &= (~XDB_RB_RED);
 				// 6: y.color = BLACK
-                pY->color_sibling &= (~XDB_RB_RED);
+                XDB_RB_WNODE(Y)->color_sibling &= (~XDB_RB_RED);
                 // 7: z.p.p.color = RED
-                pZPP->color_sibling |= XDB_RB_RED;
+                XDB_RB_WNODE(ZPP)->color_sibling |= XDB_RB_RED;
                 // 8: z = z.p.p
                 Z = ZPP;
             } else {
@@ -170,22 +176,20 @@ xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
 	            	// 10: z = z.p
 	            	Z = ZP;
 	            	// 11 : LEFT-ROTATE(T,z)
-	                xdb_rb_left_rotate (pT, Z);
+	                xdb_rb_left_rotate (pIdxm, Z);
 
 					pZ = XDB_RB_NODE(Z);
 					ZP = pZ->rb_parent;
-					pZP = XDB_RB_NODE(ZP);
-					ZPP = pZP->rb_parent;
-					pZPP = XDB_RB_NODE(ZPP);
+					ZPP = XDB_RB_NODE(ZP)->rb_parent;
 	            }
 
 				// case 3
 	            // 12: z.p.color = BLACK
-	            pZP->color_sibling &= (~XDB_RB_RED);
+	            XDB_RB_WNODE(ZP)->color_sibling &= (~XDB_RB_RED);
 	            // 13: z.p.p.color = RED
-	            pZPP->color_sibling |= XDB_RB_RED;
+	            XDB_RB_WNODE(ZPP)->color_sibling |= XDB_RB_RED;
 	            // 14: RIGHT-ROTATE(T, z.p.p)
-	            xdb_rb_right_rotate (pT, ZPP);
+	            xdb_rb_right_rotate (pIdxm, ZPP);
 			}
         }
         else {
@@ -196,11 +200,11 @@ xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
 			// 4: if y.color == RED	: case 1
             if (pY->color_sibling & XDB_RB_RED) {
 				// 5: z.p.color = BLACK
-				pZP->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(ZP)->color_sibling &= (~XDB_RB_RED);
 				// 6: y.color = BLACK
-                pY->color_sibling &= (~XDB_RB_RED);
+                XDB_RB_WNODE(Y)->color_sibling &= (~XDB_RB_RED);
                 // 7: z.p.p.color = RED
-                pZPP->color_sibling |= XDB_RB_RED;
+                XDB_RB_WNODE(ZPP)->color_sibling |= XDB_RB_RED;
                 // 8: z = z.p.p
                 Z = ZPP;
             } else {
@@ -209,22 +213,20 @@ xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
 	            	// 10: z = z.p
 	            	Z = ZP;
 	            	// 11 : RIGHT-ROTATE(T,z)
-	                xdb_rb_right_rotate (pT, Z);
+	                xdb_rb_right_rotate (pIdxm, Z);
 
 					pZ = XDB_RB_NODE(Z);
 					ZP = pZ->rb_parent;
-					pZP = XDB_RB_NODE(ZP);
-					ZPP = pZP->rb_parent;
-					pZPP = XDB_RB_NODE(ZPP);
+					ZPP = XDB_RB_NODE(ZP)->rb_parent;
 	            }
 
 				// case 3
 	            // 12: z.p.color = BLACK
-	            pZP->color_sibling &= (~XDB_RB_RED);
+	            XDB_RB_WNODE(ZP)->color_sibling &= (~XDB_RB_RED);
 	            // 13: z.p.p.color = RED
-	            pZPP->color_sibling |= XDB_RB_RED;
+	            XDB_RB_WNODE(ZPP)->color_sibling |= XDB_RB_RED;
 	            // 14: LEFT-ROTATE(T, z.p.p)
-	            xdb_rb_left_rotate (pT, ZPP);
+	            xdb_rb_left_rotate (pIdxm, ZPP);
 			}
         }
 
@@ -234,7 +236,9 @@ xdb_rb_insert_fixup (xdb_rbtree_t *pT, xdb_rowid Z)
     }
 
 	// 16: T.root.color = BLACK
-	XDB_RB_NODE(pT->rb_root)->color_sibling &= (~XDB_RB_RED);
+	if (XDB_RB_NODE(pT->rb_root)->color_sibling & XDB_RB_RED) {
+		XDB_RB_WNODE(pT->rb_root)->color_sibling &= (~XDB_RB_RED);
+	}
 }
 
 XDB_STATIC int 
@@ -242,16 +246,23 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 {
 	xdb_stgmgr_t	*pStgMgr	= &pIdxm->pTblm->stg_mgr;
 	int					cmp;
-	xdb_rbtree_t 		*pT		= pIdxm->pRbtrHdr;
+	xdb_rbtree_t 		*pT;
 	xdb_rowid 			 X, Y, S;
-	xdb_rbnode_t 		*pX, *pY, *pZ = XDB_RB_NODE(Z), *pS;
+	xdb_rbnode_t 		*pX, *pY, *pZ, *pS;
 	void				*pXRow;
 
+	// partial index may skip rows, so rowid can jump
 	if (Z > pIdxm->node_cap) {
-		xdb_stg_truncate (&pIdxm->stg_mgr, pIdxm->node_cap<<1);
+		xdb_rowid cap;
+		for (cap = pIdxm->node_cap; cap < Z; cap <<= 1)
+			;
+		xdb_stg_truncate (&pIdxm->stg_mgr, cap);
 		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
 		pIdxm->pRbtrHdr  = (xdb_rbtree_t*)pIdxm->stg_mgr.pStgHdr;
 	}
+	// truncate may remap
+	pT = pIdxm->pRbtrHdr;
+	pZ = XDB_RB_WNODE(Z);
 
 	xdb_rbtlog ("rbtree add rid %d\n", Z);
 
@@ -267,7 +278,7 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 		Y = X;
 
 		pXRow = XDB_IDPTR(pStgMgr, X);
-		cmp = xdb_row_cmp3 (pZRow, pXRow, pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+		cmp = pIdxm->pKeyOps->key_cmp2 (pIdxm, pZRow, pXRow);
 		if (0 == cmp) {
 			if (pIdxm->bUnique && pConn && xdb_row_valid (pConn, pIdxm->pTblm, pXRow, X)) {
 				xdb_rbtlog ("  Duplicate insert %d to unique index %s\n", Z, XDB_OBJ_NAME(pIdxm));
@@ -290,6 +301,7 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 		// same roword add to sibling
 		xdb_rbtlog ("  Duplicate insert %d to roword %d as 1st sibling\n", Z, X);
 		S = pX->color_sibling & XDB_ROWID_MASK;
+		pX = XDB_RB_WNODE(X);
 		pX->color_sibling &= XDB_RB_COLOR;
 		pX->color_sibling |= Z;
 		pZ->rb_next = S;
@@ -298,7 +310,7 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 		pZ->color_sibling = XDB_RB_NULL;
 		if (XDB_RB_NULL != S) {
 			xdb_rbtlog ("  1st sibling %d replace previous 1st silbing %d\n", Z, S);
-			pS = XDB_RB_NODE(S);
+			pS = XDB_RB_WNODE(S);
 			pS->rb_prev = Z;
 			pS->rb_parent = XDB_RB_NULL | XDB_RB_SIB_NODE;
 		}
@@ -314,7 +326,7 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 	        pT->rb_root = Z;
 			xdb_rbtlog ("  Set %d as root\n", Z);
 	    } else {
-			pY = XDB_RB_NODE(Y);
+			pY = XDB_RB_WNODE(Y);
 			// 11: elseif z.key < y.key
 	        if (cmp < 0) {
 				// 12: y.left = z
@@ -334,7 +346,7 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 	    pZ->color_sibling = XDB_RB_RED;
 
 		// 17: RB-INSERT-FIXUP(T, z)
-		xdb_rb_insert_fixup (pT, Z);
+		xdb_rb_insert_fixup (pIdxm, Z);
 
 		pT->node_count++;
 	}
@@ -345,10 +357,11 @@ xdb_rbtree_add (xdb_conn_t *pConn, xdb_idxm_t* pIdxm, xdb_rowid Z, void *pZRow)
 }
 
 static inline void 
-xdb_rb_transplant (xdb_rbtree_t *pT, xdb_rowid U, xdb_rowid V)
+xdb_rb_transplant (xdb_idxm_t *pIdxm, xdb_rowid U, xdb_rowid V)
 {
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
 	xdb_rowid			UP;
-	xdb_rbnode_t 		*pU = XDB_RB_NODE(U), *pV = XDB_RB_NODE(V), *pUP;
+	xdb_rbnode_t 		*pU = XDB_RB_NODE(U), *pUP;
 
 	UP = pU->rb_parent;
 	pUP = XDB_RB_NODE(UP);
@@ -361,13 +374,13 @@ xdb_rb_transplant (xdb_rbtree_t *pT, xdb_rowid U, xdb_rowid V)
 	// 3: elseif u == u.p.left
 	else if (U == pUP->rb_left) {
 		// 4: u.p.left = v
-		pUP->rb_left = V;
+		XDB_RB_WNODE(UP)->rb_left = V;
 	} else {
 		// 5: else u.p.rigth = v
-		pUP->rb_right = V;		
+		XDB_RB_WNODE(UP)->rb_right = V;		
 	}
 	// 6: v.p = u.p
-	pV->rb_parent = UP;
+	XDB_RB_WNODE(V)->rb_parent = UP;
 }
 
 static inline xdb_rowid 
@@ -397,11 +410,13 @@ xdb_rb_maximum (xdb_rbtree_t *pT, xdb_rowid X)
 }
 
 XDB_STATIC void 
-xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
+xdb_rb_delete_fixup (xdb_idxm_t *pIdxm, xdb_rowid X)
 {
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
 	xdb_rowid			W, XP;
 	xdb_rbnode_t 		*pX = XDB_RB_NODE(X), *pXP, *pW, *pWL, *pWR;
 
+	// nodes are only read here, XDB_RB_WNODE right before write marks page dirty
 	// 1: while x != T.root and x.color == BLACK
 	while ((X != pT->rb_root) && !(pX->color_sibling&XDB_RB_RED)) 
 	{
@@ -417,11 +432,11 @@ xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
 			// 4: if w.color == RED		case 1:
 			if (pW->color_sibling&XDB_RB_RED) {
 				// 5: w.color = BLACK
-				pW->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(W)->color_sibling &= (~XDB_RB_RED);
 				// 6: x.p.color = RED
-				pXP->color_sibling |= XDB_RB_RED;
+				XDB_RB_WNODE(XP)->color_sibling |= XDB_RB_RED;
 				// 7: LEFT-ROTATE(T, x.p)
-				xdb_rb_left_rotate (pT, XP);
+				xdb_rb_left_rotate (pIdxm, XP);
 				// 8: w = x.p.right
 				XP = pX->rb_parent;
 				pXP = XDB_RB_NODE(XP);
@@ -434,35 +449,35 @@ xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
 			pWR = XDB_RB_NODE(pW->rb_right);
 			if (!(pWL->color_sibling&XDB_RB_RED) && !(pWR->color_sibling&XDB_RB_RED)) {
 				// 10: w.color = RED
-				pW->color_sibling |= XDB_RB_RED;
+				XDB_RB_WNODE(W)->color_sibling |= XDB_RB_RED;
 				// 11: x = x.p
 				X = pX->rb_parent;
 			} else {
 			// 12: else if w.right.color = BLACK		case 3:
 				if (!(pWR->color_sibling&XDB_RB_RED)) {
 					// 13: w.left.color = BLACK
-					pWL->color_sibling &= (~XDB_RB_RED);
+					XDB_RB_WNODE(pW->rb_left)->color_sibling &= (~XDB_RB_RED);
 					// 14: w.color = RED
-					pW->color_sibling |= XDB_RB_RED;
+					XDB_RB_WNODE(W)->color_sibling |= XDB_RB_RED;
 					// 15: RIGHT-ROTATE(T, w)
-					xdb_rb_right_rotate (pT, W);
+					xdb_rb_right_rotate (pIdxm, W);
 					// 16: w = x.p.right
 					XP = pX->rb_parent;
 					pXP = XDB_RB_NODE(XP);
 					W = pXP->rb_right;
 					pW = XDB_RB_NODE(W);
-					pWR = XDB_RB_NODE(pW->rb_right);
 				}
 				// case 4:
 				// 17: w.color = x.p.color
+				pW = XDB_RB_WNODE(W);
 				pW->color_sibling &= (~XDB_RB_RED);
 				pW->color_sibling |= (pXP->color_sibling&XDB_RB_RED);
 				// 18: x.p.color = BLACK
-				pXP->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(XP)->color_sibling &= (~XDB_RB_RED);
 				// 19: w.right.color = BLACK
-				pWR->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(pW->rb_right)->color_sibling &= (~XDB_RB_RED);
 				// 20: LEFT-ROTATE(T, x.p)
-				xdb_rb_left_rotate (pT, XP);
+				xdb_rb_left_rotate (pIdxm, XP);
 				// 21: x = T.root
 				X = pT->rb_root;
 			}
@@ -476,11 +491,11 @@ xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
 			// 4: if w.color == RED		case 1:
 			if (pW->color_sibling&XDB_RB_RED) {
 				// 5: w.color = BLACK
-				pW->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(W)->color_sibling &= (~XDB_RB_RED);
 				// 6: x.p.color = RED
-				pXP->color_sibling |= XDB_RB_RED;
+				XDB_RB_WNODE(XP)->color_sibling |= XDB_RB_RED;
 				// 7: RIGHT-ROTATE(T, x.p)
-				xdb_rb_right_rotate (pT, XP);
+				xdb_rb_right_rotate (pIdxm, XP);
 				// 8: w = x.p.left
 				XP = pX->rb_parent;
 				pXP = XDB_RB_NODE(XP);
@@ -493,35 +508,35 @@ xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
 			pWR = XDB_RB_NODE(pW->rb_right);
 			if (!(pWL->color_sibling&XDB_RB_RED) && !(pWR->color_sibling&XDB_RB_RED)) {
 				// 10: w.color = RED
-				pW->color_sibling |= XDB_RB_RED;
+				XDB_RB_WNODE(W)->color_sibling |= XDB_RB_RED;
 				// 11: x = x.p
 				X = pX->rb_parent;
 			} else {
 			// 12: else if w.left.color = BLACK		case 3:
 				if (!(pWL->color_sibling&XDB_RB_RED)) {
 					// 13: w.right.color = BLACK
-					pWR->color_sibling &= (~XDB_RB_RED);
+					XDB_RB_WNODE(pW->rb_right)->color_sibling &= (~XDB_RB_RED);
 					// 14: w.color = RED
-					pW->color_sibling |= XDB_RB_RED;
+					XDB_RB_WNODE(W)->color_sibling |= XDB_RB_RED;
 					// 15: LEFT-ROTATE(T, w)
-					xdb_rb_left_rotate (pT, W);
+					xdb_rb_left_rotate (pIdxm, W);
 					// 16: w = x.p.left
 					XP = pX->rb_parent;
 					pXP = XDB_RB_NODE(XP);
 					W = pXP->rb_left;
 					pW = XDB_RB_NODE(W);
-					pWL = XDB_RB_NODE(pW->rb_left);
 				}
 				// case 4:
 				// 17: w.color = x.p.color
+				pW = XDB_RB_WNODE(W);
 				pW->color_sibling &= (~XDB_RB_RED);
 				pW->color_sibling |= (pXP->color_sibling&XDB_RB_RED);
 				// 18: x.p.color = BLACK
-				pXP->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(XP)->color_sibling &= (~XDB_RB_RED);
 				// 19: w.left.color = BLACK
-				pWL->color_sibling &= (~XDB_RB_RED);
+				XDB_RB_WNODE(pW->rb_left)->color_sibling &= (~XDB_RB_RED);
 				// 20: RIGHT-ROTATE(T, x.p)
-				xdb_rb_right_rotate (pT, XP);
+				xdb_rb_right_rotate (pIdxm, XP);
 				// 21: x = T.root
 				X = pT->rb_root;
 			}
@@ -531,7 +546,9 @@ xdb_rb_delete_fixup (xdb_rbtree_t *pT, xdb_rowid X)
 	}
 
 	// 23: x.color = BLACK
-	pX->color_sibling &= (~XDB_RB_RED);	
+	if (pX->color_sibling & XDB_RB_RED) {
+		XDB_RB_WNODE(X)->color_sibling &= (~XDB_RB_RED);
+	}
 }
 
 XDB_STATIC int 
@@ -554,24 +571,24 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 		if (XDB_RB_NULL == pZ->rb_prev) {
 			// first sibling
 			P = pZ->rb_parent & XDB_ROWID_MASK;
-			pP = XDB_RB_NODE(P);
+			pP = XDB_RB_WNODE(P);
 			pP->color_sibling &= XDB_RB_COLOR;
 			Y = pZ->rb_next;
 			if (XDB_RB_NULL != Y) {
 				// Prompt next sibling to first sibling
 				pP->color_sibling |= Y;
-				pY = XDB_RB_NODE(Y);
+				pY = XDB_RB_WNODE(Y);
 				pY->rb_parent |= P;
 				pY->rb_prev = XDB_RB_NULL;
 			}
 		} else {
 			// other sibling
 			X = pZ->rb_prev;
-			pX = XDB_RB_NODE(X);
+			pX = XDB_RB_WNODE(X);
 			Y = pZ->rb_next;
 			pX->rb_next = Y;
 			if (XDB_RB_NULL != Y) {
-				pY = XDB_RB_NODE(Y);
+				pY = XDB_RB_WNODE(Y);
 				pY->rb_prev = X;
 			}
 		}
@@ -579,12 +596,12 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 		/* 
 		 * It has sibling
 		 */
-		pS = XDB_RB_NODE(S);
+		pS = XDB_RB_WNODE(S);
 		// Prompt next sibling to first sibling
 		Y = pS->rb_next;
 		pS->color_sibling = (pZ->color_sibling&XDB_RB_COLOR) | Y;
 		if (XDB_RB_NULL != Y) {
-			pY = XDB_RB_NODE(Y);
+			pY = XDB_RB_WNODE(Y);
 			pY->rb_parent |= S; // has MSB set already
 			pY->rb_prev = XDB_RB_NULL;
 		}
@@ -592,19 +609,19 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 		X = pZ->rb_left;
 		pS->rb_left = X;
 		if (XDB_RB_NULL != X) {
-			pX = XDB_RB_NODE(X);
+			pX = XDB_RB_WNODE(X);
 			pX->rb_parent = S;
 		}
 		Y = pZ->rb_right;
 		pS->rb_right = Y;
 		if (XDB_RB_NULL != Y) {
-			pY = XDB_RB_NODE(Y);
+			pY = XDB_RB_WNODE(Y);
 			pY->rb_parent = S;
 		}
 		P = pZ->rb_parent;
 		pS->rb_parent = P;
 		if (XDB_RB_NULL != P) {
-			pP = XDB_RB_NODE(P);
+			pP = XDB_RB_WNODE(P);
 			if (pP->rb_left == Z) {
 				pP->rb_left = S;
 			} else {
@@ -630,18 +647,18 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 			// 4: x = z.right
 			X = pZ->rb_right;
 			// 5: RB-TRANSLPANT(T, z, z.right)
-			xdb_rb_transplant (pT, Z, X);
+			xdb_rb_transplant (pIdxm, Z, X);
 		}
 		// 6: elseif z.right == T.nul
 		else if (pZ->rb_right == XDB_RB_NULL) {
 			// 7: x = z.left
 			X = pZ->rb_left;		
 			// 8: RB-TRANSLPANT(T, z, z.left)
-			xdb_rb_transplant (pT, Z, X);
+			xdb_rb_transplant (pIdxm, Z, X);
 		} else {
 			// 9: else y = TREE-MINIMUM(z.right)
 			Y = xdb_rb_minimum (pT, pZ->rb_right);
-			pY = XDB_RB_NODE(Y);
+			pY = XDB_RB_WNODE(Y);
 			// 10: y-orignal-color = y.color
 			y_org_color = pY->color_sibling&XDB_RB_COLOR;
 			// 11: x = y.right
@@ -649,23 +666,23 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 			// 12: if y.p == z
 			if (pY->rb_parent == Z) {
 				// 13: x.p = y
-				pX = XDB_RB_NODE(X);
+				pX = XDB_RB_WNODE(X);
 				// X may be nil, so need to set parent for fixup to work
 				pX->rb_parent = Y;
 			} else {
 				// 14: else RB-TRANSLPANT(T, y, y.right)
-				xdb_rb_transplant (pT, Y, X);
+				xdb_rb_transplant (pIdxm, Y, X);
 				// 15: y.right = z.right
 				pY->rb_right = pZ->rb_right;
 				// 16: y.right.p = y
-				XDB_RB_NODE(pY->rb_right)->rb_parent = Y;
+				XDB_RB_WNODE(pY->rb_right)->rb_parent = Y;
 			}
 			// 17: RB-TRANSLPANT(T, z, y)
-			xdb_rb_transplant (pT, Z, Y);
+			xdb_rb_transplant (pIdxm, Z, Y);
 			// 18: y.left = z.left
 			pY->rb_left = pZ->rb_left;
 			// 19: y.left.p = y
-			XDB_RB_NODE(pY->rb_left)->rb_parent = Y;
+			XDB_RB_WNODE(pY->rb_left)->rb_parent = Y;
 			// 20: y.color = z.color
 			pY->color_sibling &= (~XDB_RB_RED);
 			pY->color_sibling |= (pZ->color_sibling&XDB_RB_RED);
@@ -674,14 +691,14 @@ xdb_rbtree_rem (xdb_idxm_t* pIdxm, xdb_rowid Z, void *pRow)
 		// 21: if y-orignal-color == BLACK
 		if (!(y_org_color & XDB_RB_RED)) {
 			// 22: RB-DELETE-FIXUP(T, x)
-			xdb_rb_delete_fixup (pT, X);
+			xdb_rb_delete_fixup (pIdxm, X);
 		}
 
 		pT->node_count--;
 	}
 
 	// reset curnode
-	memset (pZ, 0, sizeof (*pZ));
+	memset (XDB_RB_WNODE(Z), 0, sizeof (*pZ));
 
 	pT->row_count--;
 
@@ -731,7 +748,7 @@ xdb_rb_precessor (xdb_rbtree_t *pT, xdb_rowid X)
 }
 
 static inline xdb_rowid 
-xdb_rb_find (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, xdb_rowid *pL, int *pCmp)
+xdb_rb_find (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, int match_cnt, xdb_rowid *pL, int *pCmp)
 {
 	int cmp = 0;
 	xdb_rowid 			 X;
@@ -747,7 +764,7 @@ xdb_rb_find (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, xdb_rowid *pL, int *
 		pX = XDB_RB_NODE(X);
 		xdb_prefetch (pX);
 		*pL = X;
-		cmp = xdb_row_cmp (pTblm, pRow, pIdxm->pFields, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
+		cmp = pIdxm->pKeyOps->key_cmp (pIdxm, pRow, pIdxFilter->pIdxVals, match_cnt);
 		if (xdb_likely (cmp < 0)) {
 			X = pX->rb_left;
 		} else if (xdb_likely (cmp > 0)) {
@@ -761,7 +778,7 @@ xdb_rb_find (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, xdb_rowid *pL, int *
 }
 
 static inline xdb_rowid 
-xdb_rb_find_minimun (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, xdb_rowid X, xdb_rowid *pL)
+xdb_rb_find_minimun (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, int match_cnt, xdb_rowid X, xdb_rowid *pL)
 {
 	int cmp;
 	xdb_rowid 			 L;
@@ -779,7 +796,7 @@ xdb_rb_find_minimun (xdb_rbtree_t *pT, xdb_idxfilter_t *pIdxFilter, xdb_rowid X,
 		}
 		void *pRow = XDB_IDPTR(pStgMgr, L);
 		xdb_prefetch (pRow);
-		cmp = xdb_row_cmp (pTblm, pRow, pIdxm->pFields, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
+		cmp = pIdxm->pKeyOps->key_cmp (pIdxm, pRow, pIdxFilter->pIdxVals, match_cnt);
 	} while (!cmp);
 	*pL = L;
 	return X;
@@ -797,6 +814,8 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 	xdb_tblm_t 			*pTblm	= pIdxm->pTblm;
 	xdb_stgmgr_t		*pStgMgr	= &pTblm->stg_mgr;
 	int					count = pIdxFilter->idx_flt_cnt;
+	xdb_value_t			*pMax = NULL;
+	int					max_opt = -1;
 
 	//affect multi-thead performance
 #if !defined (XDB_HPO)
@@ -810,13 +829,13 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 	case XDB_TOK_GE:
 	case XDB_TOK_GT:
 		// Find the 1st eq node
-		X = xdb_rb_find (pT, pIdxFilter, &L, &cmp);
+		X = xdb_rb_find (pT, pIdxFilter, pIdxFilter->match_cnt, &L, &cmp);
 		if (xdb_likely (XDB_RB_NULL != X)) {
 			// Find equl node
 			if (xdb_likely (XDB_TOK_GT != pIdxFilter->match_opt)) {
 				// GE or EQ
 				if (pIdxFilter->match_cnt < pIdxm->fld_count) {
-					X = xdb_rb_find_minimun (pT, pIdxFilter, X, &L);
+					X = xdb_rb_find_minimun (pT, pIdxFilter, pIdxFilter->match_cnt, X, &L);
 				}
 			} else {
 				// GT, Goto 1st > node
@@ -827,7 +846,7 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 					}
 					pRow = XDB_IDPTR(pStgMgr, X);
 					xdb_prefetch (pRow);
-					cmp = xdb_row_cmp (pTblm, pRow, pIdxm->pFields, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
+					cmp = pIdxm->pKeyOps->key_cmp (pIdxm, pRow, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
 				} while (!cmp);
 			}
 		} else {
@@ -843,27 +862,23 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 				}
 			}
 		}
+		pMax = pIdxFilter->pIdxVal2;
+		max_opt = pIdxFilter->match_opt2;
 		break;
 
 	case XDB_TOK_LT:
 	case XDB_TOK_LE:
-		// Goto the min node
-		if (1 == pIdxm->fld_count) {
+		// Goto the min node of equal prefix
+		if (1 == pIdxFilter->match_cnt) {
 			X = xdb_rb_minimum (pT, pT->rb_root);
 		} else {
-			// Find the 1st eq node
-			X = xdb_rb_find (pT, pIdxFilter, &L, &cmp);
+			X = xdb_rb_find (pT, pIdxFilter, pIdxFilter->match_cnt - 1, &L, &cmp);
 			if (xdb_likely (XDB_RB_NULL != X)) {
-				X = xdb_rb_find_minimun (pT, pIdxFilter, X, &L);
-			} else {
-				if (cmp > 0) {
-					// precessor is parent
-					X = L;
-				} else {
-					X = XDB_RB_NULL;
-				}
+				X = xdb_rb_find_minimun (pT, pIdxFilter, pIdxFilter->match_cnt - 1, X, &L);
 			}
 		}
+		pMax = pIdxFilter->pIdxVals[pIdxFilter->match_cnt - 1];
+		max_opt = pIdxFilter->match_opt;
 		break;
 
 	default:
@@ -885,16 +900,14 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 				// doesn't satfiy match condition, stop
 				break;
 			}
-#ifdef RBT_TBD
-			if (pIdxFilter->match_opt2 > 0) {
-				// check the other boundary
-				cmp = 0; // cmp the last field
-				if (cmp<0 || ((0==cmp)&&(XDB_TOK_LT == pIdxFilter->match_opt2))) {
+			if (pMax != NULL) {
+				// check the upper boundary
+				cmp = xdb_row_cmp (pTblm, pRow, &pIdxm->pFields[pIdxFilter->match_cnt-1], &pMax, 1);
+				if (cmp<0 || ((0==cmp)&&(XDB_TOK_LT == max_opt))) {
 					xdb_rbtlog ("%d is beyond range\n", X);
 					break;
 				}
 			}
-#endif
 		}
 
 		if (xdb_likely (xdb_row_valid (pConn, pTblm, pRow, X))) {
@@ -912,7 +925,7 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 			pS = XDB_RB_NODE(S);
 			pRow = XDB_IDPTR(pStgMgr, S);
 
-			if (xdb_likely (xdb_row_valid (pConn, pTblm, pRow, X))) {
+			if (xdb_likely (xdb_row_valid (pConn, pTblm, pRow, S))) {
 				// Compare rest fields
 				if ((0 == count) || xdb_row_and_match (pIdxm->pTblm, pRow, pIdxFilter->pIdxFlts, count)) {
 					if (xdb_unlikely (-XDB_E_FULL == xdb_rowset_add (pRowSet, S, pRow))) {
@@ -933,7 +946,7 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 		}
 		pRow = XDB_IDPTR(pStgMgr, X);
 		if (XDB_TOK_EQ == pIdxFilter->match_opt) {
-			cmp = xdb_row_cmp (pTblm, pRow, pIdxm->pFields, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
+			cmp = pIdxm->pKeyOps->key_cmp (pIdxm, pRow, pIdxFilter->pIdxVals, pIdxFilter->match_cnt);
 			if (cmp) {
 				break;
 			}
@@ -943,6 +956,239 @@ xdb_rbtree_query (xdb_conn_t *pConn, xdb_idxfilter_t *pIdxFilter, xdb_rowset_t *
 	return XDB_OK;
 }
 
+XDB_STATIC xdb_rowid 
+xdb_rbtree_query2 (xdb_conn_t *pConn, struct xdb_idxm_t* pIdxm, void *pRow2)
+{
+	int					cmp;
+	xdb_rowid 			 X, S;
+	xdb_rbnode_t 		*pX, *pS;
+	void 		 		*pRow;
+	xdb_rbtree_t 		*pT		= pIdxm->pRbtrHdr;
+	xdb_tblm_t 			*pTblm	= pIdxm->pTblm;
+	xdb_stgmgr_t		*pStgMgr	= &pTblm->stg_mgr;
+
+	//affect multi-thead performance
+#if !defined (XDB_HPO)
+	pT->query_times++;
+#endif
+
+	for (X = pT->rb_root; XDB_RB_NULL != X; ) {
+		pRow = XDB_IDPTR(pStgMgr, X);
+		xdb_prefetch (pRow);
+		pX = XDB_RB_NODE(X);
+		// same order as add, row2 may be update row
+		cmp = pIdxm->pKeyOps->key_cmp2 (pIdxm, pRow2, pRow);
+		if (cmp < 0) {
+			X = pX->rb_left;
+		} else if (cmp > 0) {
+			X = pX->rb_right;
+		} else {
+			if (xdb_row_valid (pConn, pTblm, pRow, X)) {
+				return X;
+			}
+			for (S = pX->color_sibling&XDB_ROWID_MASK; XDB_RB_NULL != S; S = pS->rb_next) {
+				pS = XDB_RB_NODE(S);
+				pRow = XDB_IDPTR(pStgMgr, S);
+				if (xdb_likely (xdb_row_valid (pConn, pTblm, pRow, S))) {
+					return S;
+				}
+			}
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static inline int 
+xdb_rbtree_rowcmp (xdb_idxm_t *pIdxm, xdb_rowid L, xdb_rowid R)
+{
+	xdb_stgmgr_t	*pStgMgr = &pIdxm->pTblm->stg_mgr;
+	return pIdxm->pKeyOps->key_cmp2 (pIdxm, XDB_IDPTR(pStgMgr, L), XDB_IDPTR(pStgMgr, R));
+}
+
+// sort in parallel if more keys
+#define XDB_RB_PSORT_MIN	65536
+
+typedef struct {
+	xdb_idxm_t		*pIdxm;
+	xdb_rowid		*pSrc;
+	xdb_rowid		*pDst;
+	xdb_rowid		count;
+	xdb_rowid		width;	// run width each job sorts
+} xdb_rbsort_t;
+
+// merge each two runs of width in [lo, hi) from pSrc to pDst
+XDB_STATIC void 
+xdb_rbtree_merge (xdb_idxm_t *pIdxm, xdb_rowid *pSrc, xdb_rowid *pDst, xdb_rowid lo, xdb_rowid hi, xdb_rowid width)
+{
+	for (; lo < hi; lo += 2*width) {
+		xdb_rowid mid = (lo + width < hi) ? lo + width : hi;
+		xdb_rowid end = (mid + width < hi) ? mid + width : hi;
+		xdb_rowid l = lo, r = mid, k = lo;
+		while ((l < mid) && (r < end)) {
+			pDst[k++] = (xdb_rbtree_rowcmp (pIdxm, pSrc[l], pSrc[r]) <= 0) ? pSrc[l++] : pSrc[r++];
+		}
+		while (l < mid) {
+			pDst[k++] = pSrc[l++];
+		}
+		while (r < end) {
+			pDst[k++] = pSrc[r++];
+		}
+	}
+}
+
+// every job does same passes, so all runs end in same buffer
+XDB_STATIC void 
+xdb_rbtree_sort_job (int id, void *pArg)
+{
+	xdb_rbsort_t	*pSort = pArg;
+	xdb_rowid		*pSrc = pSort->pSrc, *pDst = pSort->pDst, *pSwap;
+	xdb_rowid		lo = (xdb_rowid)id * pSort->width;
+	xdb_rowid		hi = (lo + pSort->width < pSort->count) ? lo + pSort->width : pSort->count;
+
+	for (xdb_rowid width = 1; width < pSort->width; width <<= 1) {
+		xdb_rbtree_merge (pSort->pIdxm, pSrc, pDst, lo, hi, width);
+		pSwap = pSrc; pSrc = pDst; pDst = pSwap;
+	}
+}
+
+/*
+ * Stable bottom-up merge sort by index key, equal keys keep rowid order.
+ * Many keys are cut to runs of power of 2 width sorted in parallel, then merged.
+ */
+XDB_STATIC xdb_rowid* 
+xdb_rbtree_sort (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid *pTmp, xdb_rowid count)
+{
+	xdb_rbsort_t	sort = {.pIdxm = pIdxm, .pSrc = pRids, .pDst = pTmp, .count = count, .width = 1};
+	xdb_rowid		*pSrc = pRids, *pDst = pTmp, *pSwap;
+
+	if (count >= XDB_RB_PSORT_MIN) {
+		while (sort.width * XDB_SORT_THREADS < count) {
+			sort.width <<= 1;
+		}
+		xdb_run_jobs ((count + sort.width - 1) / sort.width, XDB_SORT_THREADS, xdb_rbtree_sort_job, &sort);
+		for (xdb_rowid width = 1; width < sort.width; width <<= 1) {
+			pSwap = pSrc; pSrc = pDst; pDst = pSwap;
+		}
+	}
+
+	for (xdb_rowid width = sort.width; width < count; width <<= 1) {
+		xdb_rbtree_merge (pIdxm, pSrc, pDst, 0, count, width);
+		pSwap = pSrc; pSrc = pDst; pDst = pSwap;
+	}
+
+	return pSrc;
+}
+
+/*
+ * Build balanced subtree from sorted unique keys, the middle key is root.
+ * Subtree sizes differ by at most 1, so all leaves are on the last two levels,
+ * color the last level (if not full) red and the rest black.
+ */
+XDB_STATIC xdb_rowid 
+xdb_rbtree_build_sub (xdb_rbtree_t *pT, xdb_rowid *pKeys, xdb_rowid lo, xdb_rowid hi, xdb_rowid P, int depth, int red_depth)
+{
+	if (lo >= hi) {
+		return XDB_RB_NULL;
+	}
+	xdb_rowid		mid = lo + (hi - lo) / 2;
+	xdb_rowid		X = pKeys[mid];
+	xdb_rbnode_t	*pX = XDB_RB_NODE(X);
+
+	pX->rb_parent = P;
+	// keep sibling list built before
+	pX->color_sibling &= XDB_ROWID_MASK;
+	if (depth == red_depth) {
+		pX->color_sibling |= XDB_RB_RED;
+	}
+	pX->rb_left  = xdb_rbtree_build_sub (pT, pKeys, lo, mid, X, depth + 1, red_depth);
+	pX->rb_right = xdb_rbtree_build_sub (pT, pKeys, mid + 1, hi, X, depth + 1, red_depth);
+
+	return X;
+}
+
+XDB_STATIC int 
+xdb_rbtree_build (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid count)
+{
+	if (count <= 0) {
+		return XDB_OK;
+	}
+
+	xdb_rowid max_rid = 0;
+	for (xdb_rowid i = 0; i < count; ++i) {
+		if (pRids[i] > max_rid) {
+			max_rid = pRids[i];
+		}
+	}
+	if (max_rid > pIdxm->node_cap) {
+		xdb_rowid cap = pIdxm->node_cap > 0 ? pIdxm->node_cap : 1;
+		while (cap < max_rid) {
+			cap <<= 1;
+		}
+		if (xdb_stg_truncate (&pIdxm->stg_mgr, cap) < 0) {
+			return -XDB_E_MEMORY;
+		}
+		pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
+		pIdxm->pRbtrHdr  = (xdb_rbtree_t*)pIdxm->stg_mgr.pStgHdr;
+	}
+
+	// caller's rows may be shared by other index builds, so sort a copy
+	xdb_rowid *pBuf = xdb_malloc ((size_t)count * 2 * sizeof (xdb_rowid));
+	if (NULL == pBuf) {
+		return -XDB_E_MEMORY;
+	}
+	memcpy (pBuf, pRids, (size_t)count * sizeof (xdb_rowid));
+	xdb_rowid *pSorted = xdb_rbtree_sort (pIdxm, pBuf, pBuf + count, count);
+
+	/*
+	 * Link duplicate keys to sibling list of the first one, and compact unique keys
+	 * to the front, the other buffer is free after sort, so reuse it
+	 */
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
+	xdb_rowid		*pKeys = (pSorted == pBuf) ? pBuf + count : pBuf;
+	xdb_rowid		key_count = 0, X = XDB_RB_NULL, S = XDB_RB_NULL;
+	for (xdb_rowid i = 0; i < count; ++i) {
+		xdb_rowid		Z = pSorted[i];
+		xdb_rbnode_t	*pZ = XDB_RB_NODE(Z);
+		if ((XDB_RB_NULL != X) && (0 == xdb_rbtree_rowcmp (pIdxm, Z, X))) {
+			pZ->rb_next = XDB_RB_NULL;
+			pZ->color_sibling = XDB_RB_NULL;
+			if (XDB_RB_NULL == S) {
+				// first sibling
+				XDB_RB_NODE(X)->color_sibling = Z;
+				pZ->rb_prev = XDB_RB_NULL;
+				pZ->rb_parent = X | XDB_RB_SIB_NODE;
+			} else {
+				XDB_RB_NODE(S)->rb_next = Z;
+				pZ->rb_prev = S;
+				pZ->rb_parent = XDB_RB_NULL | XDB_RB_SIB_NODE;
+			}
+			S = Z;
+		} else {
+			pZ->color_sibling = XDB_RB_NULL;
+			pKeys[key_count++] = Z;
+			X = Z;
+			S = XDB_RB_NULL;
+		}
+	}
+
+	// first level which is not full
+	int red_depth = 0;
+	while (((uint64_t)2 << red_depth) <= (uint64_t)key_count + 1) {
+		red_depth++;
+	}
+	pT->rb_root		= xdb_rbtree_build_sub (pT, pKeys, 0, key_count, XDB_RB_NULL, 0, red_depth);
+	pT->node_count	= key_count;
+	pT->row_count	= count;
+	// nodes are written in place without per-node dirty
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+
+	xdb_free (pBuf);
+
+	return XDB_OK;
+}
+
 XDB_STATIC int 
 xdb_rbtree_close (xdb_idxm_t *pIdxm)
 {
@@ -992,25 +1238,33 @@ xdb_rbtree_create (xdb_idxm_t *pIdxm)
 XDB_STATIC int 
 xdb_rbtree_init (xdb_idxm_t *pIdxm)
 {
-	memset (pIdxm->pRbtrHdr, 0, sizeof(*pIdxm->pRbtrHdr));
+	xdb_rbtree_t	*pT = pIdxm->pRbtrHdr;
+
+	// keep blk_hdr, storage layout is still valid
+	pT->rb_root		= XDB_RB_NULL;
+	pT->node_count	= 0;
+	pT->row_count	= 0;
+	memset (XDB_RB_NODE(XDB_RB_NULL), 0, sizeof(xdb_rbnode_t));
+	xdb_stg_dirty_all (&pIdxm->stg_mgr);
+	pIdxm->node_cap = XDB_STG_CAP(&pIdxm->stg_mgr);
 	return XDB_OK;
 }
 
-XDB_STATIC int 
+XDB_STATIC xdb_size 
 xdb_rbtree_sync (xdb_idxm_t *pIdxm)
 {
-	xdb_stg_sync (&pIdxm->stg_mgr,    0, 0, false);
-	return 0;
+	return xdb_stg_sync_dirty (&pIdxm->stg_mgr);
 }
 
 static xdb_idx_ops s_xdb_rbtree_ops = {
 	.idx_add 	= xdb_rbtree_add,
 	.idx_rem 	= xdb_rbtree_rem,
 	.idx_query 	= xdb_rbtree_query,
-	//.idx_query2	= xdb_rbtree_query2,
+	.idx_query2	= xdb_rbtree_query2,
 	.idx_create = xdb_rbtree_create,
 	.idx_drop 	= xdb_rbtree_drop,
 	.idx_close 	= xdb_rbtree_close,
 	.idx_init	= xdb_rbtree_init,
-	.idx_sync	= xdb_rbtree_sync
+	.idx_sync	= xdb_rbtree_sync,
+	.idx_build	= xdb_rbtree_build
 };
@@ -12,6 +12,20 @@
 XDB_STATIC xdb_res_t*
 xdb_stmt_vbexec2 (xdb_stmt_t *pStmt, va_list ap);
 
+// checkpoint setting in [min, max], false if malformed or out of range
+static bool 
+xdb_ckpt_cfg_parse (const char *str, int64_t min, int64_t max, int64_t *pVal)
+{
+	char *end;
+	errno = 0;
+	long long val = strtoll (str, &end, 10);
+	if ((end == str) || (*end != '\0') || (ERANGE == errno) || (val < min) || (val > max)) {
+		return false;
+	}
+	*pVal = val;
+	return true;
+}
+
 XDB_STATIC int 
 xdb_sql_set (xdb_stmt_set_t *pStmt)
 {
@@ -25,6 +39,39 @@ xdb_sql_set (xdb_stmt_set_t *pStmt)
 		xdb_strcpy (s_xdb_svrid, pStmt->svrid);
 	}
 
+	// checkpoint scheduler, 0 disables the trigger, check all before applying any
+	int64_t period = s_xdb_ckpt_cfg.period, threads = s_xdb_ckpt_cfg.threads;
+	int64_t wal_size = s_xdb_ckpt_cfg.wal_size, dirty_size = s_xdb_ckpt_cfg.dirty_size, io_rate = s_xdb_ckpt_cfg.io_rate;
+	if (NULL != pStmt->ckpt_period) {
+		XDB_EXPECT_RETE(xdb_ckpt_cfg_parse (pStmt->ckpt_period, 0, UINT32_MAX, &period), XDB_E_PARAM, 
+			"Invalid CHECKPOINT_PERIOD '%s'", pStmt->ckpt_period);
+	}
+	if (NULL != pStmt->ckpt_threads) {
+		XDB_EXPECT_RETE(xdb_ckpt_cfg_parse (pStmt->ckpt_threads, 1, 1024, &threads), XDB_E_PARAM, 
+			"CHECKPOINT_THREADS must be 1 to 1024");
+	}
+	if (NULL != pStmt->ckpt_wal_size) {
+		XDB_EXPECT_RETE(xdb_ckpt_cfg_parse (pStmt->ckpt_wal_size, 0, INT64_MAX, &wal_size), XDB_E_PARAM, 
+			"Invalid CHECKPOINT_WAL_SIZE '%s'", pStmt->ckpt_wal_size);
+	}
+	if (NULL != pStmt->ckpt_dirty_size) {
+		XDB_EXPECT_RETE(xdb_ckpt_cfg_parse (pStmt->ckpt_dirty_size, 0, INT64_MAX, &dirty_size), XDB_E_PARAM, 
+			"Invalid CHECKPOINT_DIRTY_SIZE '%s'", pStmt->ckpt_dirty_size);
+	}
+	if (NULL != pStmt->ckpt_io_rate) {
+		XDB_EXPECT_RETE(xdb_ckpt_cfg_parse (pStmt->ckpt_io_rate, 0, INT64_MAX, &io_rate), XDB_E_PARAM, 
+			"Invalid CHECKPOINT_IO_RATE '%s'", pStmt->ckpt_io_rate);
+	}
+	s_xdb_ckpt_cfg.period		= period;
+	s_xdb_ckpt_cfg.threads		= threads;
+	s_xdb_ckpt_cfg.wal_size		= wal_size;
+	s_xdb_ckpt_cfg.dirty_size	= dirty_size;
+	s_xdb_ckpt_cfg.io_rate		= io_rate;
+	if (NULL != pStmt->wal_archive) {
+		XDB_EXPECT_RETE(strlen (pStmt->wal_archive) < sizeof (s_xdb_wal_archive), XDB_E_PARAM, "Too long path");
+		xdb_strcpy (s_xdb_wal_archive, pStmt->wal_archive);
+	}
+
 	if (NULL != pStmt->format) {
 		if (pConn->res_format >= XDB_FMT_NATIVELE) {
 			XDB_EXPECT_RETE(pConn->res_format < XDB_FMT_NATIVELE, XDB_E_CONSTRAINT, 
@@ -189,16 +236,51 @@ xdb_stmt_exec (xdb_stmt_t *pStmt)
 			{
 				xdb_stmt_select_t *pStmtSel = (xdb_stmt_select_t*)pStmt;
 				xdb_reftbl_t *pRefTbl = &pStmtSel->ref_tbl[0];
+				char	*pMsg = pConn->conn_msg.msg;
+				int		len, size = sizeof (pConn->conn_msg.msg);
 				if (pRefTbl->bUseIdx) {
-					pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Query table '%s' with INDEX ", XDB_OBJ_NAME(pRefTbl->pRefTblm));
-					for (int i = 0; i < pRefTbl->or_count; ++i) {
-						xdb_idxfilter_t 	*pIdxFilter = pRefTbl->or_list[i].pIdxFilter;
-						xdb_idxm_t	*pIdxm = pIdxFilter ? pIdxFilter->pIdxm : NULL;
-						pConn->conn_msg.len += sprintf (pConn->conn_msg.msg+pConn->conn_msg.len, " %s", XDB_OBJ_NAME(pIdxm));
+					len = snprintf (pMsg, size, "Query table '%s' with INDEX ", XDB_OBJ_NAME(pRefTbl->pRefTblm));
+					for (int i = 0; (i < pRefTbl->or_count) && (len < size); ++i) {
+						xdb_singfilter_t	*pSigFlt = &pRefTbl->or_list[i];
+						for (int j = 0; (j <= pSigFlt->and_count) && (len < size); ++j) {
+							xdb_idxfilter_t 	*pIdxFilter = j ? &pSigFlt->pAndFilters[j-1] : pSigFlt->pIdxFilter;
+							xdb_idxm_t	*pIdxm = pIdxFilter->pIdxm;
+							xdb_rowid	rows, keys;
+							uint64_t	queries;
+							xdb_idx_stats (pIdxm, &rows, &keys, &queries);
+							len += snprintf (pMsg+len, size-len, "%s%s(%s %s est_rows=%.1f rows=%"PRIu64" keys=%"PRIu64" queries=%"PRIu64" cost=%.1f", 
+											j ? " AND " : " ", XDB_OBJ_NAME(pIdxm), xdb_idx2str(pIdxm->idx_type), 
+											(XDB_TOK_NE == pIdxFilter->match_opt) ? "not" : 
+											(XDB_IDX_LPM == pIdxm->idx_type) ? "prefix" : 
+											((pIdxFilter->match_cnt == pIdxm->fld_count) && (XDB_TOK_EQ == pIdxFilter->match_opt)) ? "eq" : "range",
+											pIdxFilter->est_rows, (uint64_t)rows, (uint64_t)keys, queries, pIdxFilter->cost);
+							if (pIdxm->bBloom && (len < size)) {
+								len += snprintf (pMsg+len, size-len, " bloom_fpr=%.4f", xdb_hash_bloom_fpr (pIdxm));
+							}
+							if (len < size) {
+								len += snprintf (pMsg+len, size-len, ")");
+							}
+						}
+						if (pSigFlt->and_count && (len < size)) {
+							len += snprintf (pMsg+len, size-len, " intersect(est_rows=%.1f cost=%.1f)", pSigFlt->est_rows, pSigFlt->cost);
+						}
+					}
+					if ((NULL != xdb_sql_cover (pStmtSel)) && (len < size)) {
+						len += snprintf (pMsg+len, size-len, " covering");
+					}
+					if (len < size) {
+						len += snprintf (pMsg+len, size-len, " cost=%.1f scan_cost=%.1f", pRefTbl->idx_cost, pRefTbl->scan_cost);
 					}
 				} else {
-					pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Scan table '%s' Table", XDB_OBJ_NAME(pRefTbl->pRefTblm));
+					len = snprintf (pMsg, size, "Scan table '%s' Table", XDB_OBJ_NAME(pRefTbl->pRefTblm));
+					if (pRefTbl->scan_cost > 0) {
+						len += snprintf (pMsg+len, size-len, " cost=%.1f", pRefTbl->scan_cost);
+					}
+					if (pRefTbl->idx_cost > 0) {
+						len += snprintf (pMsg+len, size-len, " index_cost=%.1f", pRefTbl->idx_cost);
+					}
 				}
+				pConn->conn_msg.len = len < size ? len : size - 1;
 				pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
 			}
 			rc = XDB_OK;
@@ -247,7 +329,7 @@ xdb_stmt_exec (xdb_stmt_t *pStmt)
 			}
 			break;
 		case XDB_STMT_SOURCE:
-			rc = xdb_source (pStmt->pConn, ((xdb_stmt_backup_t*)pStmt)->file);
+			rc = xdb_source (pStmt->pConn, ((xdb_stmt_backup_t*)pStmt)->file, ((xdb_stmt_backup_t*)pStmt)->bFast);
 			break;
 		case XDB_STMT_DUMP_DB:
 			{
@@ -258,6 +340,30 @@ xdb_stmt_exec (xdb_stmt_t *pStmt)
 			pStmt->stmt_type = XDB_STMT_DUMP_DB;
 			pStmt->pSql = NULL;
 			break;
+		case XDB_STMT_RESTORE_DB:
+			rc = xdb_restore ((xdb_stmt_backup_t*)pStmt);
+			break;
+		case XDB_STMT_LOAD:
+			rc = xdb_load_data ((xdb_stmt_load_t*)pStmt);
+			break;
+		case XDB_STMT_DUMP_TBL:
+			rc = xdb_dump_table ((xdb_stmt_load_t*)pStmt);
+			// type will be overwritten by xdb_dump_table
+			pStmt->stmt_type = XDB_STMT_DUMP_TBL;
+			pStmt->pSql = NULL;
+			break;
+		case XDB_STMT_COPY:
+			rc = xdb_copy_arrow ((xdb_stmt_copy_t*)pStmt);
+			// type will be overwritten by query
+			pStmt->stmt_type = XDB_STMT_COPY;
+			pStmt->pSql = NULL;
+			break;
+		case XDB_STMT_BACKUP_DB:
+			{
+				xdb_stmt_backup_t *pStmtBak = (xdb_stmt_backup_t*)pStmt;
+				rc = xdb_backup (pConn, pStmtBak->pDbm, pStmtBak->file, pStmtBak->bIncr);
+			}
+			break;
 		case XDB_STMT_DUMP_WAL:
 			xdb_wal_dump (pConn->pCurDbm);
 			break;
@@ -747,7 +853,7 @@ xdb_bind_str2 (xdb_stmt_t *pStmt, uint16_t para_id, const char *str, int len)
 xdb_ret
 xdb_bind_str (xdb_stmt_t *pStmt, uint16_t para_id, const char *str)
 {
-	return xdb_bind_str2 (pStmt, para_id, str, 0);
+	return xdb_bind_str2 (pStmt, para_id, str, strlen (str));
 }
 
 xdb_ret
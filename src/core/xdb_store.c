@@ -218,9 +218,11 @@ xdb_stg_free (xdb_stgmgr_t *pStgMgr, xdb_rowid rowid, void *pRow)
 		XDB_ROW_CTRL(pStgHdr,pNext) = XDB_ROW_FREE;
 	}
 	*pNext = 0;
+	xdb_stg_dirty (pStgMgr, pRow, pStgHdr->blk_size);
 	if (pStgHdr->blk_tail) {
 		xdb_rowid *pTail = XDB_IDPTR(pStgMgr, pStgHdr->blk_tail);
 		*pTail = rowid;
+		xdb_stg_dirty (pStgMgr, pTail, sizeof (*pTail));
 	} else {
 		pStgHdr->blk_head = rowid;
 	}
@@ -263,6 +265,8 @@ xdb_stg_truncate (xdb_stgmgr_t *pStgMgr, xdb_rowid new_maxid)
 
 	pStgHdr = pStgMgr->pStgHdr;
 	pStgHdr->blk_cap = new_maxid;
+	// file size changed, fsync to keep metadata
+	xdb_stg_dirty_all (pStgMgr);
 	pStgMgr->pBlkDat = (void*)pStgHdr + pStgHdr->blk_off;
 	pStgMgr->pBlkDat1 = pStgMgr->pBlkDat - pStgHdr->blk_size;
 	if ((newsize > oldsize) && (pStgHdr->blk_flags & XDB_STG_CLEAR)) {
@@ -321,6 +325,8 @@ xdb_stg_alloc (xdb_stgmgr_t *pStgMgr, void **ppRow)
 		XDB_ROW_CTRL(pStgHdr, *ppRow) = XDB_ROW_DIRTY;
 	}
 	pStgHdr->blk_alloc++;
+	// caller fills the row under the same lock
+	xdb_stg_dirty (pStgMgr, *ppRow, pStgHdr->blk_size);
 
 	return rid;
 }
@@ -331,6 +337,8 @@ xdb_stg_init (xdb_stgmgr_t *pStgMgr)
 	pStgMgr->pStgHdr->blk_head = 0;
 	pStgMgr->pStgHdr->blk_tail = 0;
 	pStgMgr->pStgHdr->blk_alloc = 0;
+	// caller rebuilds the whole storage
+	xdb_stg_dirty_all (pStgMgr);
 }
 
 XDB_STATIC int 
@@ -379,6 +387,11 @@ xdb_stg_close (xdb_stgmgr_t *pStgMgr)
 	}
 	xdb_size size = pStgMgr->pStgHdr->blk_off + pStgMgr->pStgHdr->blk_size * pStgMgr->pStgHdr->blk_cap;
 
+	xdb_free (pStgMgr->dirty.pBmp);
+	xdb_free (pStgMgr->sync.pBmp);
+	memset (&pStgMgr->dirty, 0, sizeof (pStgMgr->dirty));
+	memset (&pStgMgr->sync, 0, sizeof (pStgMgr->sync));
+
 	int rc = pStgMgr->pOps->store_close (&pStgMgr->stg_fd, size, (void**)&pStgMgr->pStgHdr);
 	if (rc < 0) {
 		return rc;
@@ -413,3 +426,121 @@ xdb_stg_sync (xdb_stgmgr_t *pStgMgr, xdb_size offset, xdb_size size, bool bAsync
 	}
 	return XDB_OK;
 }
+
+XDB_STATIC int 
+xdb_stg_dirty_grow (xdb_stgmgr_t *pStgMgr, uint64_t page)
+{
+	uint64_t page_cap = pStgMgr->dirty.page_cap ? pStgMgr->dirty.page_cap : 64;
+	while (page_cap <= page) {
+		page_cap <<= 1;
+	}
+	uint64_t *pBmp = xdb_realloc (pStgMgr->dirty.pBmp, page_cap / 8);
+	if (NULL == pBmp) {
+		pStgMgr->dirty.bAll = true;
+		return -XDB_E_MEMORY;
+	}
+	memset ((void*)pBmp + pStgMgr->dirty.page_cap / 8, 0, (page_cap - pStgMgr->dirty.page_cap) / 8);
+	pStgMgr->dirty.pBmp		= pBmp;
+	pStgMgr->dirty.page_cap	= page_cap;
+	return XDB_OK;
+}
+
+// Move dirty pages to sync set, caller holds the lock which writers hold, so no change is lost
+XDB_STATIC void 
+xdb_stg_dirty_take (xdb_stgmgr_t *pStgMgr)
+{
+	xdb_stgdirty_t *pDirty = &pStgMgr->dirty, *pSync = &pStgMgr->sync;
+
+	if (NULL == pSync->pBmp) {
+		pSync->pBmp		= pDirty->pBmp;
+		pSync->page_cap	= pDirty->page_cap;
+	} else if (NULL != pDirty->pBmp) {
+		// last sync was not done, merge
+		if (pDirty->page_cap > pSync->page_cap) {
+			uint64_t *pBmp = pSync->pBmp;
+			pSync->pBmp = pDirty->pBmp;
+			pDirty->pBmp = pBmp;
+			uint64_t page_cap = pSync->page_cap;
+			pSync->page_cap = pDirty->page_cap;
+			pDirty->page_cap = page_cap;
+		}
+		for (uint64_t i = 0; i < pDirty->page_cap / 64; ++i) {
+			pSync->pBmp[i] |= pDirty->pBmp[i];
+		}
+		xdb_free (pDirty->pBmp);
+	}
+	pSync->bAll |= pDirty->bAll;
+	if (NULL != pStgMgr->pStgHdr) {
+		// header may be remapped by writers while syncing
+		pSync->size = pStgMgr->pStgHdr->blk_off + (xdb_size)pStgMgr->pStgHdr->blk_size * pStgMgr->pStgHdr->blk_cap;
+	}
+
+	pDirty->pBmp		= NULL;
+	pDirty->page_cap	= 0;
+	pDirty->pages		= 0;
+	pDirty->bAll		= false;
+}
+
+/*
+ * Sync pages taken by xdb_stg_dirty_take, header page is always synced.
+ * Too many ranges cost more than one fsync, which only writes dirty pages anyway.
+ * Return bytes synced.
+ */
+XDB_STATIC xdb_size 
+xdb_stg_sync_dirty (xdb_stgmgr_t *pStgMgr)
+{
+	xdb_stgdirty_t	*pSync = &pStgMgr->sync;
+	xdb_size		bytes = 0;
+
+	if ((NULL == pStgMgr->pStgHdr) || ((NULL == pSync->pBmp) && !pSync->bAll)) {
+		goto exit;
+	}
+
+	xdb_size	size = pSync->size;
+	uint64_t	page_max = (size + (1 << XDB_STG_PAGE_BITS) - 1) >> XDB_STG_PAGE_BITS;
+	uint64_t	page_cap = pSync->page_cap < page_max ? pSync->page_cap : page_max;
+	uint64_t	page, pages = 0;
+	int			ranges = 0;
+
+	if (!pSync->bAll) {
+		pSync->pBmp[0] |= 1;
+		for (page = 0; page < page_cap; ++page) {
+			if (pSync->pBmp[page >> 6] & (1ULL << (page & 63))) {
+				pages++;
+				if ((0 == page) || !(pSync->pBmp[(page-1) >> 6] & (1ULL << ((page-1) & 63)))) {
+					ranges++;
+				}
+			}
+		}
+	}
+
+	if (pSync->bAll || (ranges > XDB_STG_SYNC_RANGES)) {
+		xdb_stg_sync (pStgMgr, 0, 0, false);
+		bytes = pSync->bAll ? size : (pages << XDB_STG_PAGE_BITS);
+		goto exit;
+	}
+
+	for (page = 0; page < page_cap; ) {
+		if (!(pSync->pBmp[page >> 6] & (1ULL << (page & 63)))) {
+			page++;
+			continue;
+		}
+		uint64_t first = page;
+		while ((page < page_cap) && (pSync->pBmp[page >> 6] & (1ULL << (page & 63)))) {
+			page++;
+		}
+		xdb_size off = first << XDB_STG_PAGE_BITS, len = (page - first) << XDB_STG_PAGE_BITS;
+		if (off + len > size) {
+			len = size - off;
+		}
+		xdb_stg_sync (pStgMgr, off, len, false);
+		bytes += len;
+	}
+
+exit:
+	xdb_free (pSync->pBmp);
+	pSync->page_cap	= 0;
+	pSync->bAll		= false;
+	pSync->size		= 0;
+	return bytes;
+}
@@ -51,9 +51,20 @@ typedef struct xdb_stghdr_t {
 	xdb_rowid		blk_maxid;
 	xdb_rowid		blk_cap;
 	xdb_rowid		blk_limit;
-	uint32_t		rsvd2[5];
+	uint32_t		rsvd1;
+	uint64_t		chg_id;		// owner change id of last modify
+	uint64_t		flush_id;	// owner change id of last sync
 } xdb_stghdr_t;
 
+// in memory only, pages changed since last flush
+typedef struct {
+	uint64_t		*pBmp;
+	uint64_t		page_cap;	// pages pBmp can hold
+	bool			bAll;		// untracked change or no memory, sync whole file
+	xdb_size		size;		// file size when taken
+	uint64_t		pages;		// pages set in pBmp
+} xdb_stgdirty_t;
+
 typedef struct xdb_stgmgr_t {
 	xdb_stghdr_t	*pStgHdr;
 	xdb_fd 			stg_fd;
@@ -62,6 +73,8 @@ typedef struct xdb_stgmgr_t {
 	void			*pBlkDat1;
 	uint32_t		blk_size;
 	char			*file;
+	xdb_stgdirty_t	dirty;		// set by writers under table lock
+	xdb_stgdirty_t	sync;		// taken by flush under table lock, synced after unlock
 } xdb_stgmgr_t;
 
 #define XDB_STG_CAP(pStgMgr)	(pStgMgr)->pStgHdr->blk_cap
@@ -79,4 +92,50 @@ xdb_stg_expand (xdb_stgmgr_t *pStgMgr);
 XDB_STATIC void 
 xdb_stg_free (xdb_stgmgr_t *pStgMgr, xdb_rowid rowid, void *pRow);
 
+XDB_STATIC int 
+xdb_stg_dirty_grow (xdb_stgmgr_t *pStgMgr, uint64_t page);
+
+// mark [ptr, ptr+len) changed, return ptr
+static inline void* 
+xdb_stg_dirty (xdb_stgmgr_t *pStgMgr, void *ptr, uint32_t len)
+{
+	if (xdb_unlikely ((XDB_INV_FD == pStgMgr->stg_fd) || pStgMgr->dirty.bAll)) {
+		return ptr;
+	}
+	uint64_t page = (uint64_t)(ptr - (void*)pStgMgr->pStgHdr) >> XDB_STG_PAGE_BITS;
+	uint64_t last = (uint64_t)(ptr + len - 1 - (void*)pStgMgr->pStgHdr) >> XDB_STG_PAGE_BITS;
+	for (; page <= last; ++page) {
+		if (xdb_unlikely (page >= pStgMgr->dirty.page_cap) && (xdb_stg_dirty_grow (pStgMgr, page) < 0)) {
+			break;
+		}
+		uint64_t bit = 1ULL << (page & 63);
+		if (!(pStgMgr->dirty.pBmp[page >> 6] & bit)) {
+			pStgMgr->dirty.pBmp[page >> 6] |= bit;
+			pStgMgr->dirty.pages++;
+		}
+	}
+	return ptr;
+}
+
+#define xdb_stg_dirty_id(pStgMgr, id)	xdb_stg_dirty (pStgMgr, XDB_IDPTR(pStgMgr, id), (pStgMgr)->blk_size)
+
+static inline void 
+xdb_stg_dirty_all (xdb_stgmgr_t *pStgMgr)
+{
+	pStgMgr->dirty.bAll = true;
+}
+
+// estimated bytes to sync by next flush
+static inline xdb_size 
+xdb_stg_dirty_bytes (xdb_stgmgr_t *pStgMgr)
+{
+	if ((XDB_INV_FD == pStgMgr->stg_fd) || (NULL == pStgMgr->pStgHdr)) {
+		return 0;
+	}
+	if (pStgMgr->dirty.bAll) {
+		return pStgMgr->pStgHdr->blk_off + (xdb_size)pStgMgr->pStgHdr->blk_size * pStgMgr->pStgHdr->blk_cap;
+	}
+	return pStgMgr->dirty.pages << XDB_STG_PAGE_BITS;
+}
+
 #endif // __XDB_STORE_H__
@@ -0,0 +1,413 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+/*
+ * Struct mapping is compiled once per prepared statement: each C struct field is resolved
+ * by name to result column (SELECT meta) or bind parameter (INSERT), and conversion is
+ * chosen ahead, so per row work is offset copy without name lookup or bind call.
+ */
+
+XDB_STATIC int
+xdb_struct_kind (int type)
+{
+	switch (type) {
+	case XDB_TYPE_BOOL:
+	case XDB_TYPE_TINYINT:
+	case XDB_TYPE_SMALLINT:
+	case XDB_TYPE_INT:
+	case XDB_TYPE_BIGINT:
+	case XDB_TYPE_UTINYINT:
+	case XDB_TYPE_USMALLINT:
+	case XDB_TYPE_UINT:
+	case XDB_TYPE_UBIGINT:
+	case XDB_TYPE_TIMESTAMP:
+		return XDB_SF_INT;
+	case XDB_TYPE_FLOAT:
+	case XDB_TYPE_DOUBLE:
+		return XDB_SF_FLOAT;
+	case XDB_TYPE_CHAR:
+	case XDB_TYPE_BINARY:
+	case XDB_TYPE_VCHAR:
+	case XDB_TYPE_VBINARY:
+	case XDB_TYPE_JSON:
+		return XDB_SF_CHAR;
+	case XDB_TYPE_INET:
+	case XDB_TYPE_MAC:
+		return XDB_SF_COPY;
+	}
+	return -1;
+}
+
+XDB_STATIC int64_t
+xdb_struct_getInt (const void *pVal, int type)
+{
+	switch (type) {
+	case XDB_TYPE_INT:
+		return *(int32_t*)pVal;
+	case XDB_TYPE_UINT:
+		return *(uint32_t*)pVal;
+	case XDB_TYPE_BIGINT:
+	case XDB_TYPE_UBIGINT:
+	case XDB_TYPE_TIMESTAMP:
+		return *(int64_t*)pVal;
+	case XDB_TYPE_BOOL:
+	case XDB_TYPE_TINYINT:
+		return *(int8_t*)pVal;
+	case XDB_TYPE_UTINYINT:
+		return *(uint8_t*)pVal;
+	case XDB_TYPE_SMALLINT:
+		return *(int16_t*)pVal;
+	case XDB_TYPE_USMALLINT:
+		return *(uint16_t*)pVal;
+	}
+	return 0;
+}
+
+XDB_STATIC double
+xdb_struct_getFloat (const void *pVal, int type)
+{
+	switch (type) {
+	case XDB_TYPE_FLOAT:
+		return *(float*)pVal;
+	case XDB_TYPE_DOUBLE:
+		return *(double*)pVal;
+	}
+	return xdb_struct_getInt (pVal, type);
+}
+
+XDB_STATIC void
+xdb_struct_setFloat (void *pAddr, int type, double val)
+{
+	if ((XDB_TYPE_FLOAT == type) || (XDB_TYPE_DOUBLE == type)) {
+		xdb_fld_setFloat (pAddr, type, val);
+	} else {
+		xdb_fld_setInt (pAddr, type, (int64_t)val);
+	}
+}
+
+XDB_STATIC xdb_ret
+xdb_struct_compile (xdb_structfld_t *pFld, const xdb_struct_field_t *pSf, int col_type)
+{
+	int c_kind	 = xdb_struct_kind (pSf->type);
+	int col_kind = xdb_struct_kind (col_type);
+
+	pFld->c_type	= pSf->type;
+	pFld->col_type	= col_type;
+	pFld->c_len		= pSf->len;
+	pFld->c_off		= pSf->off;
+
+	if (XDB_TYPE_NULL == pSf->type) {
+		pFld->op = XDB_SF_NULL;
+		return (sizeof (bool) == pSf->len) ? XDB_OK : -XDB_E_PARAM;
+	}
+	if ((c_kind < 0) || (col_kind < 0)) {
+		return -XDB_E_PARAM;
+	}
+
+	if (XDB_SF_CHAR == c_kind) {
+		if (XDB_SF_CHAR != col_kind) {
+			return -XDB_E_PARAM;
+		}
+		switch (pSf->type) {
+		case XDB_TYPE_CHAR:
+			pFld->op = XDB_SF_CHAR;
+			return (pSf->len > 0) ? XDB_OK : -XDB_E_PARAM;
+		case XDB_TYPE_BINARY:
+			pFld->op = XDB_SF_BINARY;
+			return (pSf->len > 0) ? XDB_OK : -XDB_E_PARAM;
+		case XDB_TYPE_VCHAR:
+			pFld->op = XDB_SF_PTR;
+			return (pSf->len == sizeof (char*)) ? XDB_OK : -XDB_E_PARAM;
+		}
+		return -XDB_E_PARAM;
+	}
+
+	if (pSf->len != s_xdb_type_len[pSf->type]) {
+		return -XDB_E_PARAM;
+	}
+	if (pSf->type == col_type) {
+		pFld->op = XDB_SF_COPY;
+	} else if ((XDB_SF_COPY == c_kind) || (XDB_SF_COPY == col_kind) || (XDB_SF_CHAR == col_kind)) {
+		return -XDB_E_PARAM;
+	} else if ((XDB_SF_FLOAT == c_kind) || (XDB_SF_FLOAT == col_kind)) {
+		pFld->op = XDB_SF_FLOAT;
+	} else {
+		pFld->op = XDB_SF_INT;
+	}
+	return XDB_OK;
+}
+
+xdb_ret
+xdb_stmt_map_struct (xdb_stmt_t *pStmt, const xdb_struct_field_t *pFields, int count, uint32_t size)
+{
+	if (xdb_unlikely ((NULL == pStmt) || (NULL == pFields) || (count <= 0) || (count > XDB_MAX_COLUMN) || (0 == size))) {
+		return -XDB_E_PARAM;
+	}
+
+	xdb_structmap_t *pMap = xdb_malloc (sizeof (*pMap) + count * sizeof (xdb_structfld_t));
+	if (xdb_unlikely (NULL == pMap)) {
+		return -XDB_E_MEMORY;
+	}
+	pMap->pMeta	= NULL;
+	pMap->size	= size;
+	pMap->count	= count;
+	pMap->ref_cnt = 1;
+
+	xdb_ret rc = -XDB_E_PARAM;
+
+	switch (pStmt->stmt_type) {
+	case XDB_STMT_SELECT:
+		{
+			xdb_stmt_select_t	*pStmtSel = (xdb_stmt_select_t*)pStmt;
+			xdb_meta_t			*pMeta = pStmtSel->pMeta;
+			xdb_col_t			**pCols = (xdb_col_t**)pMeta->col_list;
+			pMap->pMeta = pMeta;
+			for (int i = 0; i < count; ++i) {
+				int id;
+				for (id = 0; id < pMeta->col_count; ++id) {
+					if (!strcasecmp (pCols[id]->col_name, pFields[i].col_name)) {
+						break;
+					}
+				}
+				if (id == pMeta->col_count) {
+					rc = -XDB_E_NOTFOUND;
+					goto error;
+				}
+				rc = xdb_struct_compile (&pMap->flds[i], &pFields[i], pCols[id]->col_type);
+				if (rc != XDB_OK) {
+					goto error;
+				}
+				pMap->flds[i].col_id  = id;
+				pMap->flds[i].col_off = pCols[id]->col_off;
+			}
+			xdb_structmap_release (pStmtSel->pStructMap);
+			pStmtSel->pStructMap = pMap;
+		}
+		break;
+	case XDB_STMT_INSERT:
+	case XDB_STMT_REPLACE:
+		{
+			xdb_stmt_insert_t	*pStmtIns = (xdb_stmt_insert_t*)pStmt;
+			for (int i = 0; i < count; ++i) {
+				int id;
+				for (id = 0; id < pStmtIns->bind_count; ++id) {
+					if (!strcasecmp (XDB_OBJ_NAME(pStmtIns->pBind[id]), pFields[i].col_name)) {
+						break;
+					}
+				}
+				if (id == pStmtIns->bind_count) {
+					rc = -XDB_E_NOTFOUND;
+					goto error;
+				}
+				xdb_field_t *pField = pStmtIns->pBind[id];
+				rc = xdb_struct_compile (&pMap->flds[i], &pFields[i], pField->fld_type);
+				if (rc != XDB_OK) {
+					goto error;
+				}
+				if ((XDB_SF_NULL == pMap->flds[i].op) && (pField->fld_flags & XDB_FLD_NOTNULL)) {
+					rc = -XDB_E_PARAM;
+					goto error;
+				}
+				pMap->flds[i].col_id  = id;
+				pMap->flds[i].col_off = pField->fld_off;
+			}
+			xdb_structmap_release (pStmtIns->pStructMap);
+			pStmtIns->pStructMap = pMap;
+		}
+		break;
+	default:
+		goto error;
+	}
+
+	return XDB_OK;
+
+error:
+	xdb_free (pMap);
+	return rc;
+}
+
+xdb_res_t*
+xdb_insert_struct (xdb_stmt_t *pStmt, const void *pStructs, int count)
+{
+	xdb_conn_t			*pConn = pStmt->pConn;
+	xdb_stmt_insert_t	*pStmtIns = (xdb_stmt_insert_t*)pStmt;
+	xdb_res_t			*pRes = &pConn->conn_res;
+	uint64_t			affected_rows = 0;
+
+	XDB_EXPECT (((XDB_STMT_INSERT == pStmt->stmt_type) || (XDB_STMT_REPLACE == pStmt->stmt_type)) && (NULL != pStmtIns->pStructMap),
+				XDB_E_PARAM, "Statement has no struct mapping");
+	XDB_EXPECT ((count >= 0) && ((NULL != pStructs) || (0 == count)), XDB_E_PARAM, "Invalid struct array");
+
+	pRes->errcode		= 0;
+	pRes->col_meta		= 0;
+	pRes->row_count		= 0;
+	pRes->affected_rows	= 0;
+	pRes->data_len		= 0;
+
+	xdb_structmap_t	*pMap = pStmtIns->pStructMap;
+
+	for (int n = 0; n < count; ++n) {
+		const void *pStruct = pStructs + (uint64_t)n * pMap->size;
+		for (int i = 0; i < pMap->count; ++i) {
+			xdb_structfld_t	*pFld	= &pMap->flds[i];
+			xdb_field_t		*pField	= pStmtIns->pBind[pFld->col_id];
+			void			*pRow	= pStmtIns->pBindRow[pFld->col_id];
+			void			*pDst	= pRow + pFld->col_off;
+			const void		*pSrc	= pStruct + pFld->c_off;
+			switch (pFld->op) {
+			case XDB_SF_COPY:
+				memcpy (pDst, pSrc, pFld->c_len);
+				break;
+			case XDB_SF_INT:
+				xdb_fld_setInt (pDst, pFld->col_type, xdb_struct_getInt (pSrc, pFld->c_type));
+				break;
+			case XDB_SF_FLOAT:
+				xdb_struct_setFloat (pDst, pFld->col_type, xdb_struct_getFloat (pSrc, pFld->c_type));
+				break;
+			case XDB_SF_NULL:
+				if (*(bool*)pSrc) {
+					XDB_SET_NULL ((uint8_t*)pRow + pField->pTblm->null_off, pField->fld_id);
+				} else {
+					XDB_SET_NOTNULL ((uint8_t*)pRow + pField->pTblm->null_off, pField->fld_id);
+				}
+				break;
+			default:
+				{
+					const char	*str = pSrc;
+					int			len = pFld->c_len;
+					if (XDB_SF_PTR == pFld->op) {
+						str = *(const char**)pSrc;
+						if (NULL == str) {
+							str = "";
+						}
+						len = strlen (str);
+					} else if (XDB_SF_CHAR == pFld->op) {
+						len = strnlen (str, pFld->c_len);
+					}
+					XDB_EXPECT (len <= pField->fld_len, XDB_E_PARAM, "Field '%s' max len %d < input %d", XDB_OBJ_NAME(pField), pField->fld_len, len);
+					if ((XDB_TYPE_CHAR == pField->fld_type) || (XDB_TYPE_BINARY == pField->fld_type)) {
+						// C char array may have no NUL
+						*(uint16_t*)(pDst - 2) = len;
+						memcpy (pDst, str, len);
+						*(char*)(pDst + len) = '\0';
+					} else {
+						xdb_fld_setStr (pConn, pField, pRow, str, len);
+					}
+				}
+				break;
+			}
+		}
+		pRes = xdb_stmt_exec (pStmt);
+		if (xdb_unlikely (pRes->errcode)) {
+			return pRes;
+		}
+		affected_rows += pRes->affected_rows;
+	}
+
+	pRes->affected_rows = affected_rows;
+	return pRes;
+
+error:
+	return &pConn->conn_res;
+}
+
+XDB_STATIC void
+xdb_struct_fetch (xdb_res_t *pRes, xdb_structmap_t *pMap, void *pRow, void *pStruct)
+{
+	uint8_t *pNull = pMap->pMeta->null_off ? (uint8_t*)(pRow + pMap->pMeta->null_off) : NULL;
+
+	for (int i = 0; i < pMap->count; ++i) {
+		xdb_structfld_t	*pFld = &pMap->flds[i];
+		void			*pDst = pStruct + pFld->c_off;
+		void			*pSrc = pRow + pFld->col_off;
+		if (XDB_SF_NULL == pFld->op) {
+			*(bool*)pDst = (NULL != pNull) && !XDB_IS_NOTNULL(pNull, pFld->col_id);
+			continue;
+		}
+		if ((NULL != pNull) && !XDB_IS_NOTNULL(pNull, pFld->col_id)) {
+			memset (pDst, 0, pFld->c_len);
+			continue;
+		}
+		switch (pFld->op) {
+		case XDB_SF_COPY:
+			memcpy (pDst, pSrc, pFld->c_len);
+			break;
+		case XDB_SF_INT:
+			xdb_fld_setInt (pDst, pFld->c_type, xdb_struct_getInt (pSrc, pFld->col_type));
+			break;
+		case XDB_SF_FLOAT:
+			xdb_struct_setFloat (pDst, pFld->c_type, xdb_struct_getFloat (pSrc, pFld->col_type));
+			break;
+		default:
+			{
+				int			len = 0;
+				const char	*str = xdb_column_str2 (pRes, pRow, pFld->col_id, &len);
+				if (XDB_SF_PTR == pFld->op) {
+					*(const char**)pDst = str;
+					break;
+				}
+				if (NULL == str) {
+					len = 0;
+				}
+				if (XDB_SF_CHAR == pFld->op) {
+					if (len >= pFld->c_len) {
+						len = pFld->c_len - 1;
+					}
+					memcpy (pDst, str, len);
+					*(char*)(pDst + len) = '\0';
+				} else {
+					if (len > pFld->c_len) {
+						len = pFld->c_len;
+					}
+					memcpy (pDst, str, len);
+					memset (pDst + len, 0, pFld->c_len - len);
+				}
+			}
+			break;
+		}
+	}
+}
+
+int
+xdb_fetch_structs (xdb_res_t *pRes, void *pStructs, int count)
+{
+	if (xdb_unlikely ((NULL == pRes) || (NULL == pStructs) || (count < 0))) {
+		return -XDB_E_PARAM;
+	}
+	if (xdb_unlikely (pRes->errcode || (0 == pRes->col_meta))) {
+		return 0;
+	}
+
+	// only query result has struct mapping and it must be compiled for this result meta
+	xdb_queryRes_t	*pQueryRes = (void*)pRes - offsetof(xdb_queryRes_t, res);
+	xdb_structmap_t	*pMap = pQueryRes->pStructMap;
+	if (xdb_unlikely ((NULL == pMap) || ((uintptr_t)pMap->pMeta != pRes->col_meta))) {
+		return -XDB_E_PARAM;
+	}
+
+	int n;
+	for (n = 0; n < count; ++n) {
+		xdb_rowdat_t *pCurRow = (xdb_rowdat_t*)pRes->row_data;
+		if (pCurRow->len_type <= 0) {
+			break;
+		}
+		xdb_struct_fetch (pRes, pMap, pCurRow->rowdat, pStructs + (uint64_t)n * pMap->size);
+		pRes->row_data += pCurRow->len_type;
+	}
+
+	return n;
+}
+
+int
+xdb_fetch_struct (xdb_res_t *pRes, void *pStruct)
+{
+	return xdb_fetch_structs (pRes, pStruct, 1);
+}
@@ -0,0 +1,52 @@
+/******************************************************************************
+* Copyright (c) 2024-present JC Wang. All rights reserved
+*
+*   https://crossdb.org
+*   https://github.com/crossdb-org/crossdb
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at https://mozilla.org/MPL/2.0/.
+******************************************************************************/
+
+#ifndef __CROSS_STRUCT_H__
+#define __CROSS_STRUCT_H__
+
+typedef enum {
+	XDB_SF_COPY,	// same fixed type
+	XDB_SF_INT,		// integer conversion
+	XDB_SF_FLOAT,	// numeric conversion by double
+	XDB_SF_CHAR,	// string <-> C char array
+	XDB_SF_BINARY,	// string <-> C byte array
+	XDB_SF_PTR,		// string <-> C const char*
+	XDB_SF_NULL,	// column is NULL <-> C bool
+} xdb_sfop_e;
+
+typedef struct {
+	uint8_t		op;			// xdb_sfop_e
+	uint8_t		c_type;
+	uint8_t		col_type;
+	uint8_t		rsvd;
+	uint16_t	c_len;
+	uint16_t	col_id;		// result column or bind parameter
+	uint32_t	c_off;
+	uint32_t	col_off;	// result column offset
+} xdb_structfld_t;
+
+typedef struct xdb_structmap_t {
+	xdb_meta_t		*pMeta;		// result meta of SELECT
+	uint32_t		size;
+	uint16_t		count;
+	uint16_t		ref_cnt;	// statement and query result using it
+	xdb_structfld_t	flds[];
+} xdb_structmap_t;
+
+static inline void
+xdb_structmap_release (xdb_structmap_t *pMap)
+{
+	if ((NULL != pMap) && (0 == --pMap->ref_cnt)) {
+		xdb_free (pMap);
+	}
+}
+
+#endif // __CROSS_STRUCT_H__
@@ -10,6 +10,8 @@
 ******************************************************************************/
 
 static xdb_conn_t *s_xdb_sysdb_pConn = NULL;
+// checkpoint thread, FLUSH and commit path update system tables concurrently
+static xdb_rwlock_t s_xdb_sysdb_lock;
 
 XDB_STATIC void 
 xdb_sysdb_add_db (xdb_dbm_t *pDbm)
@@ -20,11 +22,13 @@ xdb_sysdb_add_db (xdb_dbm_t *pDbm)
 
 	char buf[65536];
 	xdb_dump_create_db (pDbm, buf, sizeof(buf), 0);
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO databases (database,engine,schema) VALUES('%s','%s','%s')", 
 		XDB_OBJ_NAME(pDbm), pDbm->bMemory?"MEMORY":"MMAP", buf);
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't add to system table database %s\n", XDB_OBJ_NAME(pDbm)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -33,10 +37,32 @@ xdb_sysdb_del_db (xdb_dbm_t *pDbm)
 	if (!s_xdb_bInit) {
 		return;
 	}
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM databases WHERE database='%s'", XDB_OBJ_NAME(pDbm));
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't del from system table database %s\n", XDB_OBJ_NAME(pDbm)));
 	}
+	pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM checkpoints WHERE database='%s'", XDB_OBJ_NAME(pDbm));
+	if (pRes->errcode != XDB_E_NOTFOUND) {
+		XDB_RESCHK(pRes, xdb_errlog("Can't del from system table checkpoints %s\n", XDB_OBJ_NAME(pDbm)));
+	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
+}
+
+XDB_STATIC void 
+xdb_sysdb_upd_ckpt (xdb_dbm_t *pDbm)
+{
+	if (!s_xdb_bInit || (NULL == s_xdb_sysdb_pConn)) {
+		return;
+	}
+	xdb_ckpt_stat_t *pStat = &pDbm->ckpt;
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
+	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "REPLACE INTO checkpoints (database,ckpt_count,reason,last_time,last_us,last_bytes,total_bytes,wal_size,dirty_bytes) "
+		"VALUES('%s',%"PRIu64",'%s',%"PRIu64",%"PRIu64",%"PRIu64",%"PRIu64",%"PRIu64",%"PRIu64")", 
+		XDB_OBJ_NAME(pDbm), pStat->count, pStat->reason, pStat->last_time, pStat->last_us, 
+		pStat->last_bytes, pStat->total_bytes, pStat->wal_size, pStat->dirty_bytes);
+	XDB_RESCHK(pRes, xdb_errlog("Can't update system table checkpoints %s\n", XDB_OBJ_NAME(pDbm)));
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -47,12 +73,14 @@ xdb_sysdb_add_col (xdb_tblm_t *pTblm)
 	}
 	for (int i = 0; i < pTblm->fld_count; ++i) {
 		xdb_field_t *pFld = &pTblm->pFields[i];
+		xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 		xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO columns (database,table,column,type,len) VALUES('%s','%s','%s','%s',%d)", 
 			XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pFld), xdb_type2str (pFld->fld_type), pFld->fld_len);
 		if (pRes->errcode != XDB_E_NOTFOUND) {
 			XDB_RESCHK(pRes, xdb_errlog("Can't add to system table column %s %s %s\n", 
 				XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pFld)));
 		}
+		xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 	}
 }
 
@@ -83,11 +111,13 @@ xdb_sysdb_upd_tbl_schema (xdb_tblm_t *pTblm)
 	}
 	char buf[65536];
 	xdb_dump_create_table (pTblm, buf, sizeof(buf), 0);
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "UPDATE tables SET schema=`%s` WHERE database='%s' AND table='%s'", 
 		buf, XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm));
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't update system table table schema %s\n", XDB_OBJ_NAME(pTblm->pDbm)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -99,11 +129,13 @@ xdb_sysdb_add_idx (xdb_idxm_t *pIdxm)
 	char collist[255];
 	xdb_tblm_t *pTblm = pIdxm->pTblm;
 	xdb_fld2str (collist, sizeof(collist), pIdxm->pFields, pIdxm->pExtract, pIdxm->fld_count);
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO indexes (database,table,idx_key,type,col_list) VALUES('%s','%s','%s','%s',`%s`)",
 			XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pIdxm), xdb_idx2str(pIdxm->idx_type), collist);
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK (pRes, xdb_errlog("Can't add system table index '%s','%s','%s','%s','%s')\n", XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pIdxm), "HASH", collist));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 	xdb_sysdb_upd_tbl_schema (pTblm);
 }
 
@@ -114,9 +146,11 @@ xdb_sysdb_del_idx (xdb_idxm_t *pIdxm)
 		return;
 	}
 	xdb_tblm_t *pTblm = pIdxm->pTblm;
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM indexes WHERE database='%s' AND table='%s' AND idx_key='%s'",
 			XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pIdxm));
 	XDB_RESCHK (pRes);
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 	xdb_sysdb_upd_tbl_schema (pTblm);
 }
 
@@ -143,9 +177,11 @@ xdb_sysdb_del_col (xdb_tblm_t *pTblm)
 	}
 	for (int i = 0; i < pTblm->fld_count; ++i) {
 		xdb_field_t *pFld = &pTblm->pFields[i];
+		xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 		xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM columns WHERE database='%s' AND table='%s' AND column='%s'", 
 			XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), XDB_OBJ_NAME(pFld));
 		XDB_RESCHK(pRes);
+		xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 	}
 }
 
@@ -156,11 +192,13 @@ xdb_sysdb_add_tbl (xdb_tblm_t *pTblm, bool bAddTbl, bool bAddCol, bool bAddIdx)
 		return;
 	}
 	if (bAddTbl) {
+		xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 		xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO tables (database,table,engine) VALUES('%s','%s','%s')", 
 			XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm), pTblm->bMemory?"MEMORY":"MMAP");
 		if (pRes->errcode != XDB_E_NOTFOUND) {
 			XDB_RESCHK(pRes, xdb_errlog("Can't add system table table %s\n", XDB_OBJ_NAME(pTblm)));
 		}
+		xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 	}
 	if (bAddCol) {
 		xdb_sysdb_add_col (pTblm);
@@ -178,8 +216,10 @@ xdb_sysdb_del_tbl (xdb_tblm_t *pTblm)
 		return;
 	}
 	xdb_sysdb_del_col (pTblm);
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM tables WHERE database='%s' AND table='%s'", XDB_OBJ_NAME(pTblm->pDbm), XDB_OBJ_NAME(pTblm));
 	XDB_RESCHK(pRes);
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -188,11 +228,13 @@ xdb_sysdb_add_svr (xdb_server_t *pSvr)
 	if (!s_xdb_bInit) {
 		return;
 	}
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO servers (server,port) VALUES('%s',%u)", 
 		XDB_OBJ_NAME(pSvr), pSvr->svr_port);
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't add to system table servers %s\n", XDB_OBJ_NAME(pSvr)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -201,10 +243,12 @@ xdb_sysdb_del_svr (xdb_server_t *pSvr)
 	if (!s_xdb_bInit) {
 		return;
 	}
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "DELETE FROM servers WHERE server='%s'", XDB_OBJ_NAME(pSvr));
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't del from system table servers %s\n", XDB_OBJ_NAME(pSvr)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -214,11 +258,13 @@ xdb_sysdb_add_pub (xdb_pub_t *pPub)
 		return;
 	}
 
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO publications (pubname, database) VALUES('%s','%s')", 
 		XDB_OBJ_NAME(pPub), "");
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't add to system table publications %s\n", XDB_OBJ_NAME(pPub)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC void 
@@ -228,11 +274,13 @@ xdb_sysdb_add_sub (xdb_subscribe_t *pSub)
 		return;
 	}
 
+	xdb_rwlock_wrlock (&s_xdb_sysdb_lock);
 	xdb_res_t *pRes = xdb_pexec (s_xdb_sysdb_pConn, "INSERT INTO subscriptions (client_id, subname, tables) VALUES('%s','%s','%s')", 
 		pSub->client_id, pSub->sub_name, pSub->tables?pSub->tables:"");
 	if (pRes->errcode != XDB_E_NOTFOUND) {
 		XDB_RESCHK(pRes, xdb_errlog("Can't add to system table subscriptions %s\n", XDB_OBJ_NAME(pSub)));
 	}
+	xdb_rwlock_wrunlock (&s_xdb_sysdb_lock);
 }
 
 XDB_STATIC int 
@@ -278,6 +326,9 @@ xdb_sysdb_init ()
 	pRes = xdb_exec (pConn, "CREATE TABLE IF NOT EXISTS databases (database CHAR(64), engine CHAR(8), data_path VARCHAR, schema VARCHAR, PRIMARY KEY (database))");
 	XDB_RESCHK(pRes, xdb_errlog ("Can't create system table databases\n"));
 
+	pRes = xdb_exec (pConn, "CREATE TABLE IF NOT EXISTS checkpoints (database CHAR(64), ckpt_count BIGINT, reason CHAR(8), last_time BIGINT, last_us BIGINT, last_bytes BIGINT, total_bytes BIGINT, wal_size BIGINT, dirty_bytes BIGINT, PRIMARY KEY (database))");
+	XDB_RESCHK(pRes, xdb_errlog ("Can't create system table checkpoints\n"));
+
 	pRes = xdb_exec (pConn, "CREATE TABLE IF NOT EXISTS servers (server CHAR(64), port INT)");
 	XDB_RESCHK(pRes, xdb_errlog ("Can't create system table databases\n"));
 #if 0
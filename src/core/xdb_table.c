@@ -261,6 +261,9 @@ xdb_free_table (xdb_tblm_t *pTblm)
 		xdb_objm_free (&pTblm->trig_objm[i]);
 	}
 	xdb_free (pTblm->pFields);
+	for (int i = 0; i < XDB_ARY_LEN(pTblm->upd_free); ++i) {
+		xdb_free (pTblm->upd_free[i].pRids);
+	}
 	xdb_free (pTblm);
 }
 
@@ -379,10 +382,23 @@ xdb_dump_create_table (xdb_tblm_t *pTblm, char buf[], xdb_size size, uint32_t fl
 				}
 			}
 			len --;
+			len += sprintf (buf+len, ")");
+			if (pIdxm->inc_count > 0) {
+				len += sprintf (buf+len, " INCLUDE (");
+				for (int j = 0; j < pIdxm->inc_count; ++j) {
+					len += sprintf (buf+len, "%s,", XDB_OBJ_NAME(pIdxm->pIncFlds[j]));
+				}
+				len --;
+				len += sprintf (buf+len, ")");
+			}
+			len += xdb_idx_filter2str (buf+len, pIdxm);
+			if (pIdxm->bBloom) {
+				len += sprintf (buf+len, " BLOOM");
+			}
 			if (0 == flags) {
-				len += sprintf (buf+len, "),\n");
+				len += sprintf (buf+len, ",\n");
 			} else {
-				len += sprintf (buf+len, ") XOID=%d,\n", XDB_OBJ_ID(pIdxm));
+				len += sprintf (buf+len, " XOID=%d,\n", XDB_OBJ_ID(pIdxm));
 			}
 		}
 	}
@@ -405,44 +421,227 @@ xdb_dump_create_table (xdb_tblm_t *pTblm, char buf[], xdb_size size, uint32_t fl
 	return len;
 }
 
+// WAL is recycled, old rows of its UPDATE records are not needed by redo any more
+// freed rows are synced by the checkpoint recycling WAL, so table doesn't become dirty again
+XDB_STATIC void 
+xdb_free_updrows (xdb_tblm_t *pTblm, int wal_id, uint32_t flags)
+{
+	xdb_updfree_t *pUpdFree = &pTblm->upd_free[wal_id];
+	if (0 == pUpdFree->count) {
+		return;
+	}
+	xdb_wrlock_tblstg (pTblm);
+	xdb_tbl_t *pTbl = XDB_TBLPTR(pTblm);
+	// dirty table keeps freed pages for next flush
+	bool bClean = pTbl->flush_id == pTbl->lastchg_id;
+	for (uint32_t i = 0; i < pUpdFree->count; ++i) {
+		xdb_rowid rid = pUpdFree->pRids[i];
+		__xdb_row_delete (pTblm, rid, XDB_IDPTR(&pTblm->stg_mgr, rid));
+	}
+	pUpdFree->count = 0;
+	if (bClean) {
+		xdb_stg_dirty_take (&pTblm->stg_mgr);
+		xdb_dirty_take_vdat (pTblm->pVdatm);
+	}
+	xdb_wrunlock_tblstg (pTblm);
+
+	if (bClean) {
+		// DB is not broken if lost, repair handles it
+		xdb_size bytes = xdb_stg_sync_dirty (&pTblm->stg_mgr);
+		bytes += xdb_flush_vdat (pTblm->pVdatm);
+		xdb_ckpt_throttle (pTblm->pDbm, bytes, flags);
+		xdb_wrlock_tblstg (pTblm);
+		XDB_TBLPTR(pTblm)->sync_total += bytes;
+		xdb_wrunlock_tblstg (pTblm);
+	}
+}
+
+XDB_STATIC xdb_size 
+xdb_dirty_bytes_table (xdb_tblm_t *pTblm)
+{
+	xdb_rdlock_tblstg (pTblm);
+	xdb_size bytes = xdb_stg_dirty_bytes (&pTblm->stg_mgr);
+	bytes += xdb_dirty_bytes_vdat (pTblm->pVdatm);
+	bytes += xdb_dirty_bytes_index (pTblm);
+	xdb_rdunlock_tblstg (pTblm);
+	return bytes;
+}
+
+/*
+ * Writers are only latched while dirty pages are taken, pages are synced after.
+ * Caller makes sure commits up to ckpt_cid are applied before.
+ */
 XDB_STATIC int 
-xdb_flush_table (xdb_tblm_t *pTblm, uint32_t flags)
+xdb_flush_table (xdb_tblm_t *pTblm, uint64_t ckpt_cid, uint32_t flags)
 {
 	xdb_wrlock_tblstg (pTblm);
 	xdb_tbl_t *pTbl = XDB_TBLPTR(pTblm);
 	if (pTbl->flush_id == pTbl->lastchg_id) {
+		if (pTbl->ckpt_cid < ckpt_cid) {
+			pTbl->ckpt_cid = ckpt_cid;
+		}
 		xdb_wrunlock_tblstg (pTblm);
 		return XDB_OK;
 	}
 
 	xdb_tbllog ("Flush Table '%s' %"PRIu64" -> %"PRIu64"\n", XDB_OBJ_NAME(pTblm), pTbl->flush_id, pTbl->lastchg_id);
 
-	pTbl->flush_id = pTbl->lastchg_id;
+	uint64_t flush_id = pTbl->flush_id = pTbl->lastchg_id;
+
+	// take dirty pages under lock, writers mark new pages into fresh sets
+	xdb_stg_dirty_take (&pTblm->stg_mgr);
+	xdb_dirty_take_vdat (pTblm->pVdatm);
+	xdb_dirty_take_index (pTblm);
 
 	xdb_wrunlock_tblstg (pTblm);
 
-	xdb_stg_sync (&pTblm->stg_mgr,    0, 0, false); 
+	xdb_size bytes = xdb_stg_sync_dirty (&pTblm->stg_mgr);
+	xdb_ckpt_throttle (pTblm->pDbm, bytes, flags);
+
+	xdb_size vbytes = xdb_flush_vdat (pTblm->pVdatm);
+	xdb_ckpt_throttle (pTblm->pDbm, vbytes, flags);
 
-	xdb_flush_vdat (pTblm->pVdatm);
+	xdb_size ibytes = xdb_flush_index (pTblm);
+	xdb_ckpt_throttle (pTblm->pDbm, ibytes, flags);
 
-	xdb_flush_index (pTblm);
+	bytes += vbytes + ibytes;
+
+	// headers may be remapped by writers meanwhile
+	xdb_wrlock_tblstg (pTblm);
+	// indexes of bulk load are built at end, keep them dirty for repair
+	if (!pTblm->bBulkLoad) {
+		xdb_idx_setflush (pTblm, flush_id);
+	}
+	pTbl = XDB_TBLPTR(pTblm);
+	pTbl->sync_bytes  = bytes;
+	pTbl->sync_total += bytes;
+	if (pTbl->ckpt_cid < ckpt_cid) {
+		pTbl->ckpt_cid = ckpt_cid;
+	}
+	xdb_wrunlock_tblstg (pTblm);
+	xdb_tbllog ("Flush Table '%s' synced %"PRIu64" bytes\n", XDB_OBJ_NAME(pTblm), bytes);
 
 	return 0;
 }
 
+// rebuild index from committed rows, pRids lists them if not NULL
+XDB_STATIC void 
+xdb_idx_rebuild (xdb_idxm_t *pIdxm, xdb_rowid *pRids, xdb_rowid count)
+{
+	xdb_tblm_t		*pTblm = pIdxm->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+
+	pIdxm->pIdxOps->idx_init (pIdxm);
+	xdb_idx_setchg (pIdxm, XDB_IDX_CHGID(pTblm));
+	if (NULL == pRids) {
+		xdb_rowid max_rid = XDB_STG_MAXID(pStgMgr);
+		for (xdb_rowid rid = 1; rid <= max_rid; ++rid) {
+			void *pRow = XDB_IDPTR(pStgMgr, rid);
+			if ((XDB_ROW_COMMIT == (XDB_ROW_CTRL (pStgMgr->pStgHdr, pRow) & XDB_ROW_MASK)) && xdb_idx_rowmatch (pIdxm, pRow)) {
+				pIdxm->pIdxOps->idx_add (NULL, pIdxm, rid, pRow);
+			}
+		}
+	} else if (xdb_idx_bulk_build (pIdxm, pRids, count) < 0) {
+		pIdxm->pIdxOps->idx_init (pIdxm);
+		for (xdb_rowid i = 0; i < count; ++i) {
+			void *pRow = XDB_IDPTR(pStgMgr, pRids[i]);
+			if (xdb_idx_rowmatch (pIdxm, pRow)) {
+				pIdxm->pIdxOps->idx_add (NULL, pIdxm, pRids[i], pRow);
+			}
+		}
+	}
+}
+
+typedef struct {
+	xdb_idxm_t		*pIdxms[XDB_MAX_INDEX];
+	xdb_rowid		*pRids;
+	xdb_rowid		count;
+} xdb_idxbuild_t;
+
+XDB_STATIC void 
+xdb_idx_build_job (int id, void *pArg)
+{
+	xdb_idxbuild_t *pBuild = pArg;
+	xdb_idx_rebuild (pBuild->pIdxms[id], pBuild->pRids, pBuild->count);
+}
+
+/*
+ * Rows were loaded without index, build all indexes in bulk.
+ * Unique indexes go first one by one and drop duplicate rows like INSERT does,
+ * then other indexes are built in parallel, one thread per index.
+ * Return count of dropped duplicate rows.
+ */
+XDB_STATIC xdb_rowid 
+xdb_bulkload_end (xdb_conn_t *pConn, xdb_tblm_t *pTblm)
+{
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_idxbuild_t	build = {.count = 0};
+	xdb_idxm_t		*pUniqs[XDB_MAX_INDEX];
+	int				uniq_count = 0, idx_count = 0;
+
+	xdb_wrlock_tblstg (pTblm);
+
+	xdb_rowid	max_rid = XDB_STG_MAXID(pStgMgr), dup_count = 0;
+	xdb_rowid	*pRids = build.pRids = xdb_malloc (((size_t)max_rid + 1) * sizeof (xdb_rowid));
+	if (NULL != pRids) {
+		for (xdb_rowid rid = 1; rid <= max_rid; ++rid) {
+			if (XDB_ROW_COMMIT == (XDB_ROW_CTRL (pStgMgr->pStgHdr, XDB_IDPTR(pStgMgr, rid)) & XDB_ROW_MASK)) {
+				pRids[build.count++] = rid;
+			}
+		}
+	}
+
+	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		if (!pIdxm->bUnique || (NULL == pRids)) {
+			build.pIdxms[idx_count++] = pIdxm;
+			continue;
+		}
+		pIdxm->pIdxOps->idx_init (pIdxm);
+		xdb_idx_setchg (pIdxm, XDB_IDX_CHGID(pTblm));
+		xdb_rowid count = 0;
+		for (xdb_rowid j = 0; j < build.count; ++j) {
+			void *pRow = XDB_IDPTR(pStgMgr, pRids[j]);
+			if (!xdb_idx_rowmatch (pIdxm, pRow) || xdb_likely (XDB_OK == pIdxm->pIdxOps->idx_add (pConn, pIdxm, pRids[j], pRow))) {
+				pRids[count++] = pRids[j];
+				continue;
+			}
+			for (int k = 0; k < uniq_count; ++k) {
+				if (xdb_idx_rowmatch (pUniqs[k], pRow)) {
+					pUniqs[k]->pIdxOps->idx_rem (pUniqs[k], pRids[j], pRow);
+				}
+			}
+			__xdb_row_delete (pTblm, pRids[j], pRow);
+			dup_count++;
+		}
+		build.count = count;
+		pUniqs[uniq_count++] = pIdxm;
+	}
+
+	xdb_run_jobs (idx_count, XDB_RECOVER_THREADS, xdb_idx_build_job, &build);
+	xdb_free (pRids);
+
+	pTblm->bBulkLoad = false;
+
+	xdb_wrunlock_tblstg (pTblm);
+
+	return dup_count;
+}
+
 XDB_STATIC int 
 __xdb_repair_table (xdb_tblm_t *pTblm, uint32_t flags)
 {
 	xdb_print ("  --- Begin Repair table %s\n", XDB_OBJ_NAME(pTblm));
 
-	xdb_stg_init (&pTblm->stg_mgr);
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_rowid		max_rid = XDB_STG_MAXID(pStgMgr), count = 0;
+	bool			bUncommit = false;
 
-	xdb_init_index (pTblm);
+	// committed rows are collected to build indexes in bulk, fall back to add one by one if no memory
+	xdb_rowid *pRids = xdb_malloc (((size_t)max_rid + 1) * sizeof (xdb_rowid));
 
 	xdb_vdat_mark (pTblm->pVdatm);
 
-	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
-	xdb_rowid max_rid = XDB_STG_MAXID(pStgMgr);
 	xdb_stg_init (pStgMgr);
 	for (xdb_rowid rid = 1; rid <= max_rid; ++rid) {
 		void *pRow = XDB_IDPTR(pStgMgr, rid);
@@ -455,12 +654,32 @@ __xdb_repair_table (xdb_tblm_t *pTblm, uint32_t flags)
 					*(uint32_t*)pVdat = (0x8 << XDB_VDAT_LENBITS) | (*(uint32_t*)pVdat & XDB_VDAT_LENMASK);
 				}
 			}
-			xdb_idx_addRow (NULL, pTblm, rid, pRow);
+			if (NULL != pRids) {
+				pRids[count++] = rid;
+			}
 		} else {
+			if (XDB_ROW_FREE != ctrl) {
+				bUncommit = true;
+			}
 			xdb_stg_free (pStgMgr, rid, pRow);
 		}
 	}
 
+	/*
+	 * Index not changed after last sync matches the rows at that time and can be kept.
+	 * Uncommitted rows may be in index or not, so rebuild all in this case.
+	 */
+	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		if (!bUncommit && xdb_idx_isclean (pIdxm)) {
+			xdb_print ("    Keep clean index %s\n", XDB_OBJ_NAME(pIdxm));
+			continue;
+		}
+		xdb_idx_rebuild (pIdxm, pRids, count);
+	}
+
+	xdb_free (pRids);
+
 	xdb_vdat_clean (pTblm->pVdatm);
 
 	xdb_print ("  --- End Repair table %s\n", XDB_OBJ_NAME(pTblm));
@@ -12,6 +12,13 @@
 #ifndef __XDB_TBL_H__
 #define __XDB_TBL_H__
 
+// old rows of UPDATE WAL records, freed after the WAL is recycled
+typedef struct {
+	xdb_rowid		*pRids;
+	uint32_t		count;
+	uint32_t		cap;
+} xdb_updfree_t;
+
 typedef struct xdb_tblm_t {
 	xdb_obj_t		obj;
 	uint16_t		fld_count;
@@ -26,6 +33,7 @@ typedef struct xdb_tblm_t {
 	bool			bLog;
 	bool			bMemory;
 	bool			bPrimary;
+	bool			bBulkLoad;	// fresh table loaded by SOURCE FAST: no WAL, indexes built at end
 	xdb_lockmode_e	lock_mode;
 
 	struct xdb_dbm_t *pDbm;
@@ -53,6 +61,7 @@ typedef struct xdb_tblm_t {
 	xdb_rowid		row_cap;
 
 	xdb_stgmgr_t	stg_mgr;
+	xdb_updfree_t	upd_free[2];	// per WAL, under storage lock
 	
 	xdb_rwlock_t	tbl_lock;
 	xdb_rwlock_t	stg_lock;
@@ -75,7 +84,10 @@ typedef struct xdb_tbl_t {
 	uint64_t		lastchg_id;	// last commit id
 	uint64_t		flush_id;	// last flush id
 	//statistics
-	uint64_t		rsvd2[13];
+	uint64_t		sync_bytes;	// bytes synced by last flush
+	uint64_t		sync_total;	// bytes synced by all flushes
+	uint64_t		ckpt_cid;	// WAL commit id covered by last flush
+	uint64_t		rsvd2[10];
 	uint8_t			pRowDat[];
 } xdb_tbl_t;
 
@@ -107,6 +119,15 @@ XDB_STATIC int
 xdb_dump_create_table (xdb_tblm_t *pTblm, char buf[], xdb_size size, uint32_t flags);
 
 XDB_STATIC int 
-xdb_flush_table (xdb_tblm_t *pTblm, uint32_t flags);
+xdb_flush_table (xdb_tblm_t *pTblm, uint64_t ckpt_cid, uint32_t flags);
+
+XDB_STATIC xdb_size 
+xdb_dirty_bytes_table (xdb_tblm_t *pTblm);
+
+XDB_STATIC void 
+xdb_free_updrows (xdb_tblm_t *pTblm, int wal_id, uint32_t flags);
+
+XDB_STATIC xdb_rowid 
+xdb_bulkload_end (xdb_conn_t *pConn, xdb_tblm_t *pTblm);
 
 #endif // __XDB_TBL_H__
@@ -47,6 +47,8 @@ xdb_trans_addrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, bool bNew
 		pTblTrans = xdb_malloc (sizeof (xdb_tblTrans_t));
 		XDB_EXPECT (NULL != pTblTrans, XDB_E_MEMORY, "No memory");
 		pDbTrans->pTblTrans[tbl_xoid] = pTblTrans;
+		pTblTrans->pUpdRows = NULL;
+		pTblTrans->upd_cap	= 0;
 		xdb_tbltrans_init (pTblTrans);
 	}
 	pTblTrans->pTblm = pTblm;
@@ -76,6 +78,29 @@ xdb_trans_delrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid)
 	return XDB_OK;
 }
 
+// Remember old row of updated row, WAL may log the new row as changed fields of old row
+XDB_STATIC int 
+xdb_trans_updrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid new_id, xdb_rowid old_id)
+{
+	xdb_tblTrans_t	*pTblTrans = pConn->pDbTrans[XDB_OBJ_ID(pTblm->pDbm)]->pTblTrans[XDB_OBJ_ID(pTblm)];
+
+	if (xdb_unlikely (pTblTrans->upd_count >= pTblTrans->upd_cap)) {
+		uint32_t upd_cap = pTblTrans->upd_cap ? pTblTrans->upd_cap << 1 : 64;
+		xdb_updrow_t *pUpdRows = xdb_realloc (pTblTrans->pUpdRows, upd_cap * sizeof (xdb_updrow_t));
+		if (NULL == pUpdRows) {
+			// logged as delete and new row
+			return -XDB_E_MEMORY;
+		}
+		pTblTrans->pUpdRows	= pUpdRows;
+		pTblTrans->upd_cap	= upd_cap;
+	}
+	pTblTrans->pUpdRows[pTblTrans->upd_count].new_id	= new_id;
+	pTblTrans->pUpdRows[pTblTrans->upd_count].old_id	= old_id;
+	pTblTrans->upd_count++;
+
+	return XDB_OK;
+}
+
 XDB_STATIC void 
 xdb_dbtrans_init (xdb_dbTrans_t *pDbTrans)
 {
@@ -89,6 +114,8 @@ xdb_tbltrans_init (xdb_tblTrans_t *pTblTrans)
 {
 	xdb_bmp_init (&pTblTrans->new_rows);
 	xdb_bmp_init (&pTblTrans->del_rows);
+	pTblTrans->upd_count	= 0;
+	pTblTrans->bUpdWal		= false;
 }
 
 #if 0
@@ -254,6 +281,7 @@ xdb_trans_newrow_commit (uint32_t rid, void *pArg)
 	// change TRANS->COMMIT
 	XDB_ROW_CTRL (pStgMgr->pStgHdr, pRow) &= ~XDB_ROW_MASK;
 	XDB_ROW_CTRL (pStgMgr->pStgHdr, pRow) |= XDB_ROW_COMMIT;
+	xdb_stg_dirty (pStgMgr, pRow, pStgMgr->blk_size);
 
 	return XDB_OK;
 }
@@ -268,12 +296,54 @@ xdb_trans_delrow_commit (uint32_t rid, void *pArg)
 
 	xdb_rowid *pRow = XDB_IDPTR(pStgMgr, rid);
 
-	xdb_idx_remRow (pTblTrans->pTblm, rid, pRow);
+	// rows of bulk load are not in index yet
+	if (xdb_likely (!pTblTrans->pTblm->bBulkLoad)) {
+		xdb_idx_remRow (pTblTrans->pTblm, rid, pRow);
+	}
 	__xdb_row_delete (pTblTrans->pTblm, rid, pRow);
 
 	return XDB_OK;
 }
 
+/*
+ * Old row of UPDATE WAL record is the base of redo, so it's only unlinked now 
+ * and freed by xdb_free_updrows after the WAL is recycled.
+ */
+XDB_STATIC void 
+xdb_trans_updrow_commit (xdb_tblTrans_t *pTblTrans)
+{
+	xdb_tblm_t		*pTblm = pTblTrans->pTblm;
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_walm_t		*pWalm = pTblTrans->pDbTrans->pWalm;
+	xdb_updfree_t	*pUpdFree = (NULL != pWalm) ? &pTblm->upd_free[pWalm - pTblm->pDbm->wal_mgr] : NULL;
+
+	for (uint32_t i = 0; i < pTblTrans->upd_count; ++i) {
+		xdb_rowid rid = pTblTrans->pUpdRows[i].old_id;
+		if (rid & XDB_ROWID_MSB) {
+			xdb_trans_delrow_commit (rid & XDB_ROWID_MASK, pTblTrans);
+			continue;
+		}
+		void *pRow = XDB_IDPTR(pStgMgr, rid);
+		xdb_idx_remRow (pTblm, rid, pRow);
+		if ((NULL != pUpdFree) && (pUpdFree->count >= pUpdFree->cap)) {
+			uint32_t cap = pUpdFree->cap ? pUpdFree->cap << 1 : 256;
+			xdb_rowid *pRids = xdb_realloc (pUpdFree->pRids, cap * sizeof (xdb_rowid));
+			if (NULL != pRids) {
+				pUpdFree->pRids = pRids;
+				pUpdFree->cap	= cap;
+			}
+		}
+		XDB_ROW_CTRL (pStgMgr->pStgHdr, pRow) &= ~XDB_ROW_MASK;
+		xdb_stg_dirty (pStgMgr, pRow, pStgMgr->blk_size);
+		if ((NULL != pUpdFree) && (pUpdFree->count < pUpdFree->cap)) {
+			pUpdFree->pRids[pUpdFree->count++] = rid;
+		} else {
+			// no memory, row is reclaimed by table repair
+			xdb_errlog ("Can't keep old row %d of table '%s'\n", rid, XDB_OBJ_NAME(pTblm));
+		}
+	}
+}
+
 XDB_STATIC int 
 xdb_trans_tbl_commit (uint32_t tid, void *pArg)
 {
@@ -282,6 +352,9 @@ xdb_trans_tbl_commit (uint32_t tid, void *pArg)
 
 	xdb_translog ("    commit table '%s'\n", XDB_OBJ_NAME(pTblTrans->pTblm));
 
+	// flush takes dirty pages under storage lock
+	xdb_wrlock_tblstg (pTblTrans->pTblm);
+
 	xdb_mark_dirty (pTblTrans->pTblm);
 
 	// iterate new rows -> commit
@@ -290,6 +363,12 @@ xdb_trans_tbl_commit (uint32_t tid, void *pArg)
 	// iterate del rows -> delete
 	xdb_bmp_iterate (&pTblTrans->del_rows, xdb_trans_delrow_commit, pTblTrans);
 
+	if (pTblTrans->bUpdWal) {
+		xdb_trans_updrow_commit (pTblTrans);
+	}
+
+	xdb_wrunlock_tblstg (pTblTrans->pTblm);
+
 	xdb_tbltrans_init (pTblTrans);
 
 	return XDB_OK;		
@@ -303,6 +382,11 @@ xdb_trans_db_commit (uint32_t did, void *pArg)
 	xdb_translog ("  commit db '%s'\n", XDB_OBJ_NAME((xdb_dbm_t*)XDB_OBJM_GET(s_xdb_db_list, did)));
 	xdb_lv2bmp_iterate (&pDbTrans->tbl_rows, xdb_trans_tbl_commit, pDbTrans);
 
+	if (NULL != pDbTrans->pWalm) {
+		xdb_atomic_dec (&pDbTrans->pWalm->commit_pending);
+		pDbTrans->pWalm = NULL;
+	}
+
 	return XDB_OK;
 }
 
@@ -327,6 +411,9 @@ xdb_commit (xdb_conn_t *pConn)
 	}
 	xdb_translog ("Commit Transaction %s\n", pConn->bAutoTrans ? "AUTO" : "");
 
+	// checkpoint full wal for each DB
+	xdb_lv2bmp_iterate (&pConn->dbTrans_bmp, xdb_trans_db_walchk, pConn);
+
 	// write wal for each DB
 	xdb_lv2bmp_iterate (&pConn->dbTrans_bmp, xdb_trans_db_wal, pConn);
 
@@ -345,10 +432,14 @@ xdb_trans_tbl_rollback (uint32_t tid, void *pArg)
 	xdb_dbTrans_t *pDbTrans = pArg;
 	xdb_tblTrans_t	*pTblTrans = pDbTrans->pTblTrans[tid];
 
+	xdb_wrlock_tblstg (pTblTrans->pTblm);
+
 	xdb_mark_dirty (pTblTrans->pTblm);
 
 	// iterate new rows, -> delete
 	xdb_bmp_iterate (&pTblTrans->new_rows, xdb_trans_delrow_commit, pTblTrans);
+
+	xdb_wrunlock_tblstg (pTblTrans->pTblm);
 	// iterate del rows -> just free bmp
 
 	xdb_tbltrans_init (pTblTrans);
@@ -424,6 +515,7 @@ xdb_trans_free (xdb_conn_t *pConn)
 				if (NULL != pTblTrans) {
 					xdb_bmp_free (&pTblTrans->new_rows);
 					xdb_bmp_free (&pTblTrans->del_rows);
+					xdb_free (pTblTrans->pUpdRows);
 					xdb_free (pTblTrans);
 				}
 			}
@@ -436,32 +528,43 @@ xdb_trans_free (xdb_conn_t *pConn)
 
 static volatile uint64_t	s_xdb_bg_run = 0;
 static uint32_t	s_xdb_bg_flush = 0;
-static uint32_t	s_xdb_flush_period = 1;
+static uint32_t	s_xdb_ttl_period = 1000; // ms
 
+/*
+ * Checkpoint scheduler, poll each DB and flush when WAL size, dirty pages or age of oldest change exceeds setting.
+ * Tables of one DB are flushed by worker threads, see xdb_flush_db.
+ */
 void* xdb_bg_task (void *data)
 {
-	sleep (10);
+	uint64_t ttl_ms = xdb_timestamp_ms ();
 	while (s_xdb_bInit) {
-		sleep (s_xdb_flush_period);
+		xdb_msleep (XDB_CKPT_POLL);
 		if (!s_xdb_bInit) {
 			break;
 		}
 		s_xdb_bg_run++;
-		if (!s_xdb_bInit) {
-			break;
+		uint64_t now_ms = xdb_timestamp_ms ();
+		bool bTtl = now_ms - ttl_ms >= s_xdb_ttl_period;
+		if (bTtl) {
+			ttl_ms = now_ms;
 		}
+		xdb_rwlock_rdlock (&s_xdb_db_list_lock);
 		for (int i = 0; i < XDB_OBJM_MAX(s_xdb_db_list); ++i) {
 			xdb_dbm_t	*pDbm	= XDB_OBJM_GET(s_xdb_db_list, i);
-			xdb_db_t	*pDb	= XDB_DBPTR(pDbm);
-			if (s_xdb_bInit && (NULL != pDbm) && (pDb->lastchg_id != pDb->flush_id)) {
-				xdb_translog ("XDB BGTask run %d flush %s\n", s_xdb_bg_run, XDB_OBJ_NAME(pDbm));
-				xdb_flush_db (pDbm, 0);
+			if (!s_xdb_bInit || (NULL == pDbm) || pDbm->bMemory) {
+				continue;
+			}
+			const char *reason = xdb_ckpt_due (pDbm);
+			if (s_xdb_bInit && (NULL != reason)) {
+				xdb_translog ("XDB BGTask run %d flush %s by %s\n", s_xdb_bg_run, XDB_OBJ_NAME(pDbm), reason);
+				xdb_flush_db (pDbm, XDB_FLUSH_BG);
 				s_xdb_bg_flush++;
 			}
-			if (s_xdb_bInit && (NULL != pDbm) && pDbm->bTtlTbl) {				
+			if (s_xdb_bInit && bTtl && pDbm->bTtlTbl) {				
 				xdb_ttl_db (pDbm, false, 0);
 			}
 		}
+		xdb_rwlock_rdunlock (&s_xdb_db_list_lock);
 	}
 
 	s_xdb_bg_run = 0;
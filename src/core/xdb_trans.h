@@ -12,11 +12,20 @@
 #ifndef __XDB_TRANS_H__
 #define __XDB_TRANS_H__
 
+typedef struct {
+	xdb_rowid	new_id;
+	xdb_rowid	old_id;		// MSB is set if logged as delete
+} xdb_updrow_t;
+
 typedef struct {
 	struct xdb_dbTrans_t *pDbTrans;
 	xdb_tblm_t *pTblm;
 	xdb_bmp_t	new_rows;
 	xdb_bmp_t	del_rows;
+	xdb_updrow_t *pUpdRows;	// new row -> old committed row, for UPDATE WAL record
+	uint32_t	upd_count;
+	uint32_t	upd_cap;
+	bool		bUpdWal;	// olds of pUpdRows are taken from del_rows by WAL
 } xdb_tblTrans_t;
 
 typedef struct xdb_dbTrans_t {
@@ -25,6 +34,7 @@ typedef struct xdb_dbTrans_t {
 	xdb_lv2bmp_t	tbl_rdlocks;
 	xdb_lv2bmp_t	tbl_rows;
 	uint64_t		commit_len;
+	xdb_walm_t		*pWalm;		// WAL the commit is written to, till applied
 	xdb_tblTrans_t	*pTblTrans[];
 } xdb_dbTrans_t;
 
@@ -34,6 +44,9 @@ xdb_trans_addrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, bool bNew
 XDB_STATIC int 
 xdb_trans_delrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid);
 
+XDB_STATIC int 
+xdb_trans_updrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid new_id, xdb_rowid old_id);
+
 XDB_STATIC bool 
 xdb_trans_getrow (xdb_conn_t *pConn, xdb_tblm_t *pTblm, xdb_rowid rid, bool bNew);
 
@@ -171,7 +171,8 @@ XDB_STATIC void
 xdb_vdata_free (xdb_vdatm_t *pVdatm, uint8_t type, xdb_rowid vid)
 {
 	xdb_stgmgr_t *pStgMgr = &pVdatm->stg_mgr[type];
-	uint32_t *pVdat = XDB_IDPTR(pStgMgr, vid);
+	// vdata file is opened on first access after reload
+	uint32_t *pVdat = xdb_vdata_get (pVdatm, type, vid);
 
 	if ((*pVdat>>XDB_VDAT_LENBITS) <= 8) { // b1000
 		xdb_vdatlog ("%s VDAT free t %d v %d\n", XDB_OBJ_NAME(pVdatm->pTblm),type, vid);
@@ -179,19 +180,45 @@ xdb_vdata_free (xdb_vdatm_t *pVdatm, uint8_t type, xdb_rowid vid)
 	} else {
 		// refcnt--
 		*pVdat -= (1<<XDB_VDAT_LENBITS);
+		xdb_stg_dirty (pStgMgr, pVdat, sizeof (*pVdat));
 	}
 }
 
 XDB_STATIC void 
-xdb_flush_vdat (xdb_vdatm_t *pVdatm)
+xdb_dirty_take_vdat (xdb_vdatm_t *pVdatm)
 {
 	if (NULL == pVdatm) {
 		return;
 	}
-	xdb_tblm_t *pTblm = pVdatm->pTblm;
 	for (int i = 0; i < XDB_ARY_LEN(s_xdb_vdat_size); ++i) {
-		xdb_stg_sync (&pTblm->pVdatm->stg_mgr[i],	  0, 0, false); 
+		xdb_stg_dirty_take (&pVdatm->stg_mgr[i]);
+	}
+}
+
+XDB_STATIC xdb_size 
+xdb_dirty_bytes_vdat (xdb_vdatm_t *pVdatm)
+{
+	xdb_size bytes = 0;
+	if (NULL == pVdatm) {
+		return 0;
+	}
+	for (int i = 0; i < XDB_ARY_LEN(s_xdb_vdat_size); ++i) {
+		bytes += xdb_stg_dirty_bytes (&pVdatm->stg_mgr[i]);
+	}
+	return bytes;
+}
+
+XDB_STATIC xdb_size 
+xdb_flush_vdat (xdb_vdatm_t *pVdatm)
+{
+	xdb_size bytes = 0;
+	if (NULL == pVdatm) {
+		return 0;
+	}
+	for (int i = 0; i < XDB_ARY_LEN(s_xdb_vdat_size); ++i) {
+		bytes += xdb_stg_sync_dirty (&pVdatm->stg_mgr[i]);
 	}
+	return bytes;
 }
 
 XDB_STATIC void 
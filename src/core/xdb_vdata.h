@@ -72,6 +72,7 @@ xdb_vdata_ref (xdb_vdatm_t *pVdatm, uint8_t type, xdb_rowid vid)
 	uint32_t *pVdat = xdb_vdata_get (pVdatm, type, vid);
 	if (xdb_likely (pVdat != NULL)) {
 		*pVdat += (1<<XDB_VDAT_LENBITS);
+		xdb_stg_dirty (&pVdatm->stg_mgr[type], pVdat, sizeof (*pVdat));
 	}
 }
 
@@ -128,12 +128,172 @@ static int xdb_wal_expand (xdb_walm_t *pWalm, int size)
 	return XDB_OK;
 }
 
+// field bytes in row, CHAR and BINARY have 2B len before and '\0' after, vdata field has offset only
+static inline uint32_t 
+xdb_wal_fld_span (xdb_field_t *pField, uint32_t *pOff)
+{
+	if ((XDB_TYPE_CHAR == pField->fld_type) || (XDB_TYPE_BINARY == pField->fld_type)) {
+		*pOff = pField->fld_off - 2;
+		return pField->fld_len + 3;
+	}
+	*pOff = pField->fld_off;
+	return s_xdb_vdat[pField->fld_type] ? 4 : pField->fld_len;
+}
+
+static inline uint32_t 
+xdb_wal_tail_len (xdb_tblm_t *pTblm)
+{
+	return pTblm->row_size - pTblm->null_off + ((pTblm->vfld_count > 0) ? 4 : 0);
+}
+
+XDB_STATIC int 
+xdb_trans_delrow_wal (uint32_t rid, void *pArg);
+
+XDB_STATIC int 
+xdb_updrow_cmp (const void *pKey, const void *pEle)
+{
+	xdb_rowid new_id = ((const xdb_updrow_t*)pEle)->new_id;
+	return (*(const xdb_rowid*)pKey > new_id) - (*(const xdb_rowid*)pKey < new_id);
+}
+
+XDB_STATIC int 
+xdb_u64_cmp (const void *p1, const void *p2)
+{
+	return (*(const uint64_t*)p1 > *(const uint64_t*)p2) - (*(const uint64_t*)p1 < *(const uint64_t*)p2);
+}
+
+/*
+ * Pick old row of each new row for UPDATE record, the latest one wins if row id was reused in transaction.
+ * Old rows are taken out of del_rows, so they're deleted by UPDATE record and commit.
+ */
+XDB_STATIC void 
+xdb_trans_updrow_wal_prep (xdb_tblTrans_t *pTblTrans)
+{
+	uint32_t count = pTblTrans->upd_count;
+	pTblTrans->upd_count = 0;
+	if (0 == count) {
+		return;
+	}
+	// new_id << 32 | seq, reuse as result array of same size after sort
+	uint64_t *pKeys = xdb_malloc (count * sizeof (uint64_t));
+	if (NULL == pKeys) {
+		return;
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		pKeys[i] = ((uint64_t)pTblTrans->pUpdRows[i].new_id << 32) | i;
+	}
+	qsort (pKeys, count, sizeof (uint64_t), xdb_u64_cmp);
+
+	xdb_updrow_t *pUpdRows = (xdb_updrow_t*)pKeys;
+	uint32_t upd_count = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		xdb_rowid new_id = pKeys[i] >> 32;
+		if ((i + 1 < count) && ((pKeys[i + 1] >> 32) == new_id)) {
+			continue;
+		}
+		xdb_rowid old_id = pTblTrans->pUpdRows[(uint32_t)pKeys[i]].old_id;
+		if (xdb_bmp_get (&pTblTrans->new_rows, new_id) && xdb_bmp_get (&pTblTrans->del_rows, old_id)) {
+			xdb_bmp_clr (&pTblTrans->del_rows, old_id);
+			pUpdRows[upd_count].new_id	= new_id;
+			pUpdRows[upd_count].old_id	= old_id;
+			upd_count++;
+		}
+	}
+
+	xdb_free (pTblTrans->pUpdRows);
+	pTblTrans->pUpdRows		= pUpdRows;
+	pTblTrans->upd_cap		= count;
+	pTblTrans->upd_count	= upd_count;
+	pTblTrans->bUpdWal		= true;
+}
+
+// Log changed fields and row tail against old row, fall back to delete old and new row image if not smaller
+XDB_STATIC int 
+xdb_trans_updrow_wal (xdb_tblTrans_t *pTblTrans, xdb_updrow_t *pUpdRow)
+{
+	xdb_tblm_t		*pTblm		= pTblTrans->pTblm;
+	xdb_stgmgr_t	*pStgMgr 	= &pTblm->stg_mgr;
+	xdb_walm_t		*pWalm		= pTblTrans->pDbTrans->pDbm->pWalm;
+	void			*pNew		= XDB_IDPTR(pStgMgr, pUpdRow->new_id);
+	void			*pOld		= XDB_IDPTR(pStgMgr, pUpdRow->old_id);
+	uint16_t		fid_list[XDB_MAX_COLUMN];
+	uint32_t		upd_cnt = 0, data_len = 0, off, len;
+
+	for (int i = 0; i < pTblm->fld_count; ++i) {
+		len = xdb_wal_fld_span (&pTblm->pFields[i], &off);
+		if (memcmp (pNew + off, pOld + off, len)) {
+			fid_list[upd_cnt++] = i;
+			data_len += len;
+		}
+	}
+
+	uint32_t tail_len = xdb_wal_tail_len (pTblm);
+	uint32_t vdat_len = 0, new_vlen = 0;
+	uint32_t *pNewVdat = NULL;
+	if (pTblm->vfld_count > 0) {
+		pNewVdat = xdb_row_vdata_get (pTblm, pNew);
+		uint32_t *pOldVdat = xdb_row_vdata_get (pTblm, pOld);
+		if (NULL != pNewVdat) {
+			new_vlen = vdat_len = *pNewVdat & XDB_VDAT_LENMASK;
+			if ((NULL != pOldVdat) && ((*pOldVdat & XDB_VDAT_LENMASK) == new_vlen) && !memcmp (pNewVdat + 1, pOldVdat + 1, new_vlen)) {
+				vdat_len = 0;
+			}
+		}
+	}
+
+	int size = XDB_ALIGN4 (sizeof (xdb_walrow_t) + sizeof (xdb_walupd_t) + XDB_ALIGN4 (upd_cnt * 2) + data_len + tail_len + vdat_len);
+	int full_size = XDB_ALIGN4 (sizeof (xdb_walrow_t) + pTblm->row_size + ((pTblm->vfld_count > 0) ? 4 + new_vlen : 0));
+	if (size >= full_size) {
+		pUpdRow->old_id |= XDB_ROWID_MSB;
+		xdb_trans_delrow_wal (pUpdRow->old_id & XDB_ROWID_MASK, pTblTrans);
+		return XDB_ERROR;
+	}
+
+	xdb_wal_expand (pWalm, pTblTrans->pDbTrans->commit_len + size);
+
+	xdb_wal_t			*pWal = (xdb_wal_t*)pWalm->stg_mgr.pStgHdr;
+	xdb_walrow_t		*pWalRow = (void*)pWal + pWal->commit_size + pTblTrans->pDbTrans->commit_len;
+	pWalRow->row_len	= ((uint32_t)XDB_WAL_UPDATE << XDB_WAL_LENBITS) | size;
+	pWalRow->tbl_xoid   = XDB_OBJ_ID(pTblm);
+	pWalRow->row_id 	= pUpdRow->new_id;
+
+	xdb_walupd_t		*pWalUpd = (void*)pWalRow->row_data;
+	pWalUpd->old_id		= pUpdRow->old_id;
+	pWalUpd->vdat_len	= vdat_len;
+	pWalUpd->upd_cnt	= upd_cnt;
+	memcpy (pWalUpd->fid_list, fid_list, upd_cnt * 2);
+
+	void *pData = (void*)pWalUpd->fid_list + XDB_ALIGN4 (upd_cnt * 2);
+	for (int i = 0; i < upd_cnt; ++i) {
+		len = xdb_wal_fld_span (&pTblm->pFields[fid_list[i]], &off);
+		memcpy (pData, pNew + off, len);
+		pData += len;
+	}
+	memcpy (pData, pNew + pTblm->null_off, tail_len);
+	if (vdat_len > 0) {
+		memcpy (pData + tail_len, pNewVdat + 1, vdat_len);
+	}
+
+	pTblTrans->pDbTrans->commit_len += size;
+
+	xdb_wallog ("      wal upd row %d <- %d fields %d len %d\n", pUpdRow->new_id, pUpdRow->old_id, upd_cnt, size);
+
+	return XDB_OK;
+}
+
 XDB_STATIC int 
 xdb_trans_newrow_wal (uint32_t rid, void *pArg)
 {
 	xdb_tblTrans_t	*pTblTrans 	= pArg;
 	xdb_stgmgr_t	*pStgMgr 	= &pTblTrans->pTblm->stg_mgr;
 
+	if (pTblTrans->bUpdWal && (pTblTrans->upd_count > 0)) {
+		xdb_updrow_t *pUpdRow = bsearch (&rid, pTblTrans->pUpdRows, pTblTrans->upd_count, sizeof (xdb_updrow_t), xdb_updrow_cmp);
+		if ((NULL != pUpdRow) && (XDB_OK == xdb_trans_updrow_wal (pTblTrans, pUpdRow))) {
+			return XDB_OK;
+		}
+	}
+
 	xdb_rowid *pRow = XDB_IDPTR(pStgMgr, rid);
 	xdb_walm_t			*pWalm = pTblTrans->pDbTrans->pDbm->pWalm;
 
@@ -148,7 +308,8 @@ xdb_trans_newrow_wal (uint32_t rid, void *pArg)
 	}
 	size = XDB_ALIGN4 (size);
 
-	xdb_wal_expand (pWalm, size);
+	// rows of this commit are not in commit_size yet
+	xdb_wal_expand (pWalm, pTblTrans->pDbTrans->commit_len + size);
 
 	xdb_wal_t			*pWal = (xdb_wal_t*)pWalm->stg_mgr.pStgHdr;
 	xdb_walrow_t		*pWalRow = (void*)pWal + pWal->commit_size + pTblTrans->pDbTrans->commit_len;
@@ -182,7 +343,7 @@ xdb_trans_delrow_wal (uint32_t rid, void *pArg)
 	//xdb_stgmgr_t	*pStgMgr 	= &pTblTrans->pTblm->stg_mgr;
 	//xdb_rowid *pRow = XDB_IDPTR(pStgMgr, rid);
 
-	xdb_wal_expand (pWalm, sizeof (xdb_walrow_t));
+	xdb_wal_expand (pWalm, pTblTrans->pDbTrans->commit_len + sizeof (xdb_walrow_t));
 
 	xdb_wal_t			*pWal = (xdb_wal_t*)pWalm->stg_mgr.pStgHdr;
 	xdb_walrow_t		*pWalRow = (void*)pWal + pWal->commit_size + pTblTrans->pDbTrans->commit_len;
@@ -207,11 +368,14 @@ xdb_trans_tbl_wal (uint32_t tid, void *pArg)
 
 	xdb_wallog ("    commit table '%s'\n", XDB_OBJ_NAME(pTblTrans->pTblm));
 
-	if (pTblTrans->pTblm->bMemory) {
-		// skip memory table
+	if (pTblTrans->pTblm->bMemory || pTblTrans->pTblm->bBulkLoad) {
+		// skip memory table, and table in bulk load which is flushed at end
 		return XDB_OK;
 	}
 
+	// old rows of updated rows are logged by UPDATE records
+	xdb_trans_updrow_wal_prep (pTblTrans);
+
 	// iterate del rows -> delete
 	xdb_bmp_iterate (&pTblTrans->del_rows, xdb_trans_delrow_wal, pTblTrans);
 
@@ -235,9 +399,13 @@ xdb_trans_db_wal (uint32_t did, void *pArg)
 
 	pDbTrans->commit_len = 0;
 
+	// checkpoint switches WAL under the same lock, so commit lands in one WAL
+	xdb_wal_wrlock (pDbm);
+
 	xdb_lv2bmp_iterate (&pDbTrans->tbl_rows, xdb_trans_tbl_wal, pDbTrans);
 
 	if (0 == pDbTrans->commit_len) {
+		xdb_wal_wrunlock (pDbm);
 		return XDB_OK;
 	}
 	xdb_wal_t *pWal = (void*)pDbm->pWalm->stg_mgr.pStgHdr;
@@ -273,7 +441,31 @@ xdb_trans_db_wal (uint32_t did, void *pArg)
 		pWal->sync_cid	= pCommit->commit_id;
 	}
 
-	if (pWal->commit_size > XDB_WAL_MAX_SIZE) {
+	// checkpoint waits till commit is applied to tables, then WAL can be recycled
+	pDbTrans->pWalm = pDbm->pWalm;
+	xdb_atomic_inc (&pDbTrans->pWalm->commit_pending);
+
+	xdb_wal_wrunlock (pDbm);
+
+	return XDB_OK;
+}
+
+// Checkpoint full WAL before writing, a pending commit would block checkpoint
+XDB_STATIC int 
+xdb_trans_db_walchk (uint32_t did, void *pArg)
+{
+	xdb_conn_t *pConn = pArg;
+	xdb_dbm_t	*pDbm = pConn->pDbTrans[did]->pDbm;
+
+	if (pDbm->bMemory) {
+		return XDB_OK;
+	}
+
+	xdb_wal_rdlock (pDbm);
+	bool bFull = XDB_WAL_PTR(pDbm->pWalm)->commit_size > XDB_WAL_MAX_SIZE;
+	xdb_wal_rdunlock (pDbm);
+
+	if (bFull) {
 		xdb_flush_db (pDbm, 0);
 	}
 
@@ -293,6 +485,7 @@ __xdb_wal_flush (xdb_walm_t *pWalm, bool bFlush)
 	pWal->wal_commit->commit_len = 0;
 	pWal->wal_commit->commit_id = 0;
 	pWal->sync_cid = pWal->commit_id;
+	pWal->ckpt_cid = 0;
 
 	xdb_stg_sync (&pWalm->stg_mgr, 0, 0, !bFlush);
 
@@ -313,8 +506,9 @@ xdb_wal_flush (xdb_walm_t *pWalm)
 	return XDB_OK;
 }
 
+// returns last iterated commit id, pRange NULL means all commits
 XDB_STATIC uint64_t 
-xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg)
+xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg, const xdb_walrange_t *pRange)
 {
 	xdb_wal_t			*pWal = XDB_WAL_PTR(pWalm);
 	xdb_commit_t		*pCommit = pWal->wal_commit;
@@ -322,7 +516,7 @@ xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg)
 	xdb_tblm_t			*pTblm;
 	xdb_dbm_t			*pDbm = pWalm->pDbm;
 	uint64_t			commit_size = sizeof (xdb_wal_t);
-	uint64_t			last_commit_id = pWal->commit_id;
+	uint64_t			last_commit_id = (NULL != pRange) ? pRange->from_cid : pWal->commit_id;
 	void				*pWalEnd = (void*)pWal + pWal->commit_size;
 
 	// Go over until end or checksum error
@@ -344,6 +538,16 @@ xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg)
 				break;
 			}
 		}
+		if (NULL != pRange) {
+			if ((pRange->until_cid && (pCommit->commit_id > pRange->until_cid)) || 
+				(pRange->until_ts && (pCommit->timestamp > pRange->until_ts))) {
+				break;
+			}
+			if (pCommit->commit_id <= pRange->from_cid) {
+				pCommit = (xdb_commit_t*)((void*)pCommit + pCommit->commit_len);
+				continue;
+			}
+		}
 		last_commit_id = pCommit->commit_id;
 		pWalRow = (xdb_walrow_t*)(pCommit + 1);
 		void	*pComEnd= (void*)pCommit + pCommit->commit_len;
@@ -354,7 +558,7 @@ xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg)
 				break;
 			}
 			cb_func (pTblm, pWalRow, pArg);
-			pWalRow = (xdb_walrow_t*)((void*)pWalRow + pWalRow->row_len);
+			pWalRow = (xdb_walrow_t*)((void*)pWalRow + XDB_WAL_LEN(pWalRow));
 		} while ((void*)pWalRow < (void*)pComEnd);
 
 		xdb_wallog ("  === End iterate commit ID %u off %u len %d\n\n", pCommit->commit_id, (void*)pCommit-(void*)pWal, pCommit->commit_len);
@@ -366,15 +570,111 @@ xdb_wal_iterate (xdb_walm_t *pWalm, xdb_wal_callbck cb_func, void *pArg)
 	return 	last_commit_id;
 }
 
+// vdata file may lag behind WAL like table file, so grow it to hold redo row's vdata
+XDB_STATIC uint32_t* 
+xdb_wal_redo_vdata (xdb_tblm_t *pTblm, void *pDbRow)
+{
+	uint8_t		type;
+	xdb_rowid	vid = xdb_row_vdata_info (pTblm->row_size, pDbRow, &type);
+
+	if (!XDB_VTYPE_OK(type)) {
+		return NULL;
+	}
+	xdb_stgmgr_t *pStgMgr = &pTblm->pVdatm->stg_mgr[type];
+	if (NULL == pStgMgr->pStgHdr) {
+		xdb_vdata_create (pTblm->pVdatm, type);
+	}
+	if (xdb_unlikely (vid > XDB_STG_CAP(pStgMgr))) {
+		xdb_rowid cap = XDB_STG_CAP(pStgMgr);
+		while (cap < vid) {
+			cap <<= 1;
+		}
+		if (xdb_stg_truncate (pStgMgr, cap) < 0) {
+			xdb_errlog ("Failed to expand table '%s' vdata to redo vid=%d\n", XDB_OBJ_NAME(pTblm), vid);
+			return NULL;
+		}
+	}
+	// table repair marks and frees vdata up to max id
+	if (vid > XDB_STG_MAXID(pStgMgr)) {
+		XDB_STG_MAXID(pStgMgr) = vid;
+	}
+	return XDB_IDPTR(pStgMgr, vid);
+}
+
+// new row is old row with changed fields, old row is deleted
+XDB_STATIC xdb_ret 
+xdb_wal_redo_upd (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pDbRow)
+{
+	xdb_stgmgr_t	*pStgMgr = &pTblm->stg_mgr;
+	xdb_walupd_t	*pWalUpd = (void*)pWalRow->row_data;
+	uint32_t		off, len;
+
+	if (!XDB_ROWID_VALID(pWalUpd->old_id, XDB_STG_MAXID(pStgMgr))) {
+		xdb_errlog ("Table '%s' redo update invalid old rowid=%d\n", XDB_OBJ_NAME(pTblm), pWalUpd->old_id);
+		return -XDB_E_NOTFOUND;
+	}
+	void *pOld = XDB_IDPTR (pStgMgr, pWalUpd->old_id);
+
+	memcpy (pDbRow, pOld, pTblm->row_size + ((pTblm->vfld_count > 0) ? 4 : 0));
+	void *pData = (void*)pWalUpd->fid_list + XDB_ALIGN4 (pWalUpd->upd_cnt * 2);
+	for (int i = 0; i < pWalUpd->upd_cnt; ++i) {
+		if (xdb_unlikely (pWalUpd->fid_list[i] >= pTblm->fld_count)) {
+			xdb_errlog ("Table '%s' redo update invalid field %d\n", XDB_OBJ_NAME(pTblm), pWalUpd->fid_list[i]);
+			return -XDB_E_NOTFOUND;
+		}
+		len = xdb_wal_fld_span (&pTblm->pFields[pWalUpd->fid_list[i]], &off);
+		memcpy (pDbRow + off, pData, len);
+		pData += len;
+	}
+	memcpy (pDbRow + pTblm->null_off, pData, xdb_wal_tail_len (pTblm));
+	pData += xdb_wal_tail_len (pTblm);
+
+	if (pTblm->vfld_count > 0) {
+		uint32_t *pVdat = xdb_wal_redo_vdata (pTblm, pDbRow);
+		if (NULL != pVdat) {
+			uint32_t *pOldVdat = (0 == pWalUpd->vdat_len) ? xdb_row_vdata_get (pTblm, pOld) : NULL;
+			if (pWalUpd->vdat_len > 0) {
+				memcpy (pVdat + 1, pData, pWalUpd->vdat_len);
+				*pVdat = (8<<XDB_VDAT_LENBITS) | pWalUpd->vdat_len;
+			} else if (NULL != pOldVdat) {
+				len = *pOldVdat & XDB_VDAT_LENMASK;
+				memmove (pVdat + 1, pOldVdat + 1, len);
+				*pVdat = (8<<XDB_VDAT_LENBITS) | len;
+			}
+		}
+	}
+
+	XDB_ROW_CTRL (pStgMgr->pStgHdr, pOld) &= ~XDB_ROW_MASK;
+	xdb_stg_dirty (pStgMgr, pOld, pStgMgr->blk_size);
+
+	return XDB_OK;
+}
+
+/*
+ * Redo only replays row images and row state, the free list, vdata references and indexes 
+ * are rebuilt by table repair afterwards, so a row which already reached the table file is 
+ * harmless and tables are independent of each other
+ */
 XDB_STATIC xdb_ret 
 xdb_wal_redo_row (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 {
 	xdb_rowid rid = pWalRow->row_id & XDB_ROWID_MASK;
 	bool bDelete = pWalRow->row_id & XDB_ROWID_MSB;
+	bool bUpdate = XDB_WAL_UPDATE == XDB_WAL_TYPE(pWalRow);
 	void		*pRow = pWalRow->row_data;
 	xdb_stgmgr_t *pStgMgr = &pTblm->stg_mgr;
+	xdb_tbl_t	*pTbl = XDB_TBLPTR(pTblm);
 
-	xdb_wallog ("	WAL Redo %s '%s' rowid=%d: ", bDelete ? "DEELTE" : "INSERT", XDB_OBJ_NAME(pTblm), rid);
+	xdb_wallog ("	WAL Redo %s '%s' rowid=%d: ", bDelete ? "DEELTE" : (bUpdate ? "UPDATE" : "INSERT"), XDB_OBJ_NAME(pTblm), rid);
+
+	// header may not reach disk, force table repair
+	if (pTbl->flush_id == pTbl->lastchg_id) {
+		pTbl->lastchg_id++;
+	}
+	// rows are replayed without index, so indexes must be rebuilt by repair
+	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
+		xdb_idx_setchg (XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]), XDB_IDX_CHGID(pTblm));
+	}
 
 	if (bDelete) {
 		if (XDB_ROWID_VALID(rid, XDB_STG_MAXID(pStgMgr))) {
@@ -383,20 +683,40 @@ xdb_wal_redo_row (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 			xdb_fprint_dbrow (stdout, pTblm, pRow, 0);
 			xdb_wallog ("\n");
 			#endif
-			xdb_idx_remRow (pTblm, rid, pRow);
-			__xdb_row_delete (pTblm, rid, pRow);
+			XDB_ROW_CTRL (pStgMgr->pStgHdr, pRow) &= ~XDB_ROW_MASK;
+			xdb_stg_dirty (pStgMgr, pRow, pStgMgr->blk_size);
 		} else {
 			xdb_wallog ("    WAL Redo delete invalid rowid=%d\n", rid);
 		}
 	} else {
+		if (xdb_unlikely (rid > XDB_STG_CAP(pStgMgr))) {
+			xdb_rowid cap = XDB_STG_CAP(pStgMgr);
+			while (cap < rid) {
+				cap <<= 1;
+			}
+			if (xdb_stg_truncate (pStgMgr, cap) < 0) {
+				xdb_errlog ("Failed to expand table '%s' to redo rowid=%d\n", XDB_OBJ_NAME(pTblm), rid);
+				return -XDB_E_MEMORY;
+			}
+		}
+		if (rid > XDB_STG_MAXID(pStgMgr)) {
+			XDB_STG_MAXID(pStgMgr) = rid;
+		}
+
 		void *pDbRow = XDB_IDPTR (&pTblm->stg_mgr, rid);
-		if (pTblm->vfld_count > 0) {
+		if (bUpdate) {
+			xdb_ret rc = xdb_wal_redo_upd (pTblm, pWalRow, pDbRow);
+			if (rc < 0) {
+				return rc;
+			}
+		} else if (pTblm->vfld_count > 0) {
 			memcpy (pDbRow, pRow, pTblm->row_size + 4);
-			int vlen = pWalRow->row_len - sizeof(xdb_walrow_t) - pTblm->row_size - 4;
+			int vlen = XDB_WAL_LEN(pWalRow) - sizeof(xdb_walrow_t) - pTblm->row_size - 4;
 			if (vlen > 0) {
-				uint32_t *pVdat = xdb_row_vdata_get (pTblm, pDbRow);
+				uint32_t *pVdat = xdb_wal_redo_vdata (pTblm, pDbRow);
 				if (pVdat != NULL) {
-					memcpy ((void*)pVdat + 4, pRow + pTblm->row_size, vlen);
+					// vdata follows row and vid
+					memcpy ((void*)pVdat + 4, pRow + pTblm->row_size + 4, vlen);
 					// b1000
 					*pVdat = (8<<XDB_VDAT_LENBITS) | vlen;
 				}
@@ -407,8 +727,8 @@ xdb_wal_redo_row (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 
 		XDB_ROW_CTRL (pStgMgr->pStgHdr, pDbRow) &= ~XDB_ROW_MASK;
 		XDB_ROW_CTRL (pStgMgr->pStgHdr, pDbRow) |= XDB_ROW_COMMIT;
-		// will not check unique
-		xdb_idx_addRow (NULL, pTblm, rid, pDbRow);		
+		// vdata is marked by table repair
+		xdb_stg_dirty (pStgMgr, pDbRow, pStgMgr->blk_size);
 
 		#if XDB_LOG_FLAGS & XDB_LOG_WAL
 		xdb_fprint_dbrow (stdout, pTblm, pDbRow, 0);
@@ -419,42 +739,285 @@ xdb_wal_redo_row (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 	return XDB_OK;
 }
 
+typedef struct {
+	xdb_tblm_t			*pTblm;
+	xdb_walrow_t		**ppWalRow;
+	uint32_t			row_count;
+	uint32_t			row_cap;
+} xdb_redo_tbl_t;
+
+typedef struct {
+	xdb_redo_tbl_t		*pRedoTbl;	// indexed by tbl_xoid
+	uint32_t			*pTblList;	// tables which have WAL rows
+	int					tbl_max;
+	int					tbl_count;
+	bool				bError;
+} xdb_redo_t;
+
 XDB_STATIC xdb_ret 
-xdb_wal_redo (xdb_dbm_t	*pDbm)
+xdb_wal_redo_collect (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 {
-	xdb_walm_t *pWalm;
+	xdb_redo_t		*pRedo = pArg;
+	uint32_t		xoid = pWalRow->tbl_xoid;
+
+	if (xdb_unlikely (pRedo->bError || (xoid >= pRedo->tbl_max))) {
+		pRedo->bError = true;
+		return XDB_ERROR;
+	}
 
+	xdb_redo_tbl_t	*pRedoTbl = &pRedo->pRedoTbl[xoid];
+	if (xdb_unlikely (pRedoTbl->row_count >= pRedoTbl->row_cap)) {
+		uint32_t row_cap = pRedoTbl->row_cap ? pRedoTbl->row_cap << 1 : 1024;
+		xdb_walrow_t **ppWalRow = xdb_realloc (pRedoTbl->ppWalRow, row_cap * sizeof (xdb_walrow_t*));
+		if (NULL == ppWalRow) {
+			pRedo->bError = true;
+			return -XDB_E_MEMORY;
+		}
+		pRedoTbl->ppWalRow	= ppWalRow;
+		pRedoTbl->row_cap	= row_cap;
+	}
+	if (0 == pRedoTbl->row_count) {
+		pRedoTbl->pTblm = pTblm;
+		pRedo->pTblList[pRedo->tbl_count++] = xoid;
+	}
+	pRedoTbl->ppWalRow[pRedoTbl->row_count++] = pWalRow;
+
+	return XDB_OK;
+}
+
+XDB_STATIC void 
+xdb_wal_redo_job (int id, void *pArg)
+{
+	xdb_redo_t		*pRedo = pArg;
+	xdb_redo_tbl_t	*pRedoTbl = &pRedo->pRedoTbl[pRedo->pTblList[id]];
+
+	// Each table is replayed by one worker only, so per table commit order is kept
+	for (uint32_t i = 0; i < pRedoTbl->row_count; ++i) {
+		xdb_wal_redo_row (pRedoTbl->pTblm, pRedoTbl->ppWalRow[i], NULL);
+	}
+}
+
+/*
+ * Partition rows of WALs by table in commit order, then replay tables in parallel.
+ * last_cid[i] is set to the last replayed commit id of ppWalm[i].
+ */
+XDB_STATIC void 
+__xdb_wal_redo (xdb_dbm_t *pDbm, xdb_walm_t **ppWalm, uint64_t last_cid[], int count, const xdb_walrange_t *pRange)
+{
+	xdb_redo_t	redo = {.tbl_max = XDB_OBJM_MAX(pDbm->db_objm)};
+
+	redo.pRedoTbl = xdb_calloc (redo.tbl_max * sizeof (xdb_redo_tbl_t));
+	redo.pTblList = xdb_calloc (redo.tbl_max * sizeof (uint32_t));
+	if ((NULL == redo.pRedoTbl) || (NULL == redo.pTblList)) {
+		redo.bError = true;
+	}
+
+	for (int i = 0; (i < count) && !redo.bError; ++i) {
+		last_cid[i] = xdb_wal_iterate (ppWalm[i], xdb_wal_redo_collect, &redo, pRange);
+	}
+
+	if (!redo.bError) {
+		int thread_count = xdb_run_jobs (redo.tbl_count, XDB_RECOVER_THREADS, xdb_wal_redo_job, &redo);
+		(void)thread_count;
+		xdb_wallog ("  Redo %d tables with %d threads\n", redo.tbl_count, thread_count);
+	} else {
+		xdb_errlog ("Failed to partition WAL, redo serially\n");
+		for (int i = 0; i < count; ++i) {
+			last_cid[i] = xdb_wal_iterate (ppWalm[i], xdb_wal_redo_row, NULL, pRange);
+		}
+	}
+
+	if (NULL != redo.pRedoTbl) {
+		for (int i = 0; i < redo.tbl_count; ++i) {
+			xdb_free (redo.pRedoTbl[redo.pTblList[i]].ppWalRow);
+		}
+	}
+	xdb_free (redo.pRedoTbl);
+	xdb_free (redo.pTblList);
+}
+
+XDB_STATIC xdb_ret 
+xdb_wal_redo (xdb_dbm_t	*pDbm)
+{
 	xdb_print ("  --- Begin Redo WAL Log\n");
 	
 	// Lock WAL
 	xdb_wal_rdlock (pDbm);
 
-	// redo backup
-	pWalm = pDbm->pWalmBak;
-	XDB_WAL_PTR(pWalm)->commit_id = xdb_wal_iterate (pWalm, xdb_wal_redo_row, NULL);
-
-	// redo current
-	pWalm = pDbm->pWalm;
-	XDB_WAL_PTR(pWalm)->commit_id = xdb_wal_iterate (pWalm, xdb_wal_redo_row, NULL);
+	// backup WAL has older commits
+	xdb_walm_t	*pWalm[2] = {pDbm->pWalmBak, pDbm->pWalm};
+	uint64_t	last_cid[2];
+	__xdb_wal_redo (pDbm, pWalm, last_cid, 2, NULL);
+	XDB_WAL_PTR(pDbm->pWalmBak)->commit_id	= last_cid[0];
+	XDB_WAL_PTR(pDbm->pWalm)->commit_id		= last_cid[1];
 
 	// UnLock WAL
 	xdb_wal_rdunlock (pDbm);
 
-	xdb_flush_db (pDbm, 0);
-	xdb_wal_flush (pDbm->pWalm);
-	xdb_wal_flush (pDbm->pWalmBak);
-
 	xdb_print ("  --- End Redo WAL Log\n");
 
 	return XDB_OK;
 }
 
+/*
+ * Copy WAL to archive before it's recycled, segment is named by its first commit id.
+ * It's written to a temp file and renamed after sync, so archive never has partial segment.
+ */
+XDB_STATIC xdb_ret 
+xdb_wal_archive (xdb_walm_t *pWalm)
+{
+	xdb_dbm_t	*pDbm = pWalm->pDbm;
+	xdb_wal_t	*pWal = XDB_WAL_PTR(pWalm);
+
+	if (!*s_xdb_wal_archive || pDbm->bMemory || (pWal->commit_size <= sizeof (xdb_wal_t)) || (0 == pWal->wal_commit[0].commit_len)) {
+		return XDB_OK;
+	}
+
+	char path[XDB_PATH_LEN * 2 + 64], tmp[sizeof (path) + 4];
+	xdb_sprintf (path, "%s/%s", s_xdb_wal_archive, XDB_OBJ_NAME(pDbm));
+	xdb_mkdir (s_xdb_wal_archive);
+	xdb_mkdir (path);
+	int len = snprintf (path, sizeof (path), "%s/%s/W%020"PRIu64".wal", s_xdb_wal_archive, XDB_OBJ_NAME(pDbm), pWal->wal_commit[0].commit_id);
+	if ((len < 0) || (len >= (int)sizeof (path))) {
+		xdb_errlog ("WAL archive path '%s' is too long\n", s_xdb_wal_archive);
+		return -XDB_E_PARAM;
+	}
+	xdb_sprintf (tmp, "%s.tmp", path);
+
+	int rc = xdb_fwrite_sync (tmp, pWal, pWal->commit_size);
+	if (XDB_OK == rc) {
+		remove (path);
+		rc = rename (tmp, path);
+	}
+	if (XDB_OK != rc) {
+		xdb_errlog ("Can't archive WAL to '%s'\n", path);
+		remove (tmp);
+		return -XDB_E_FILE;
+	}
+	xdb_wallog ("Archive WAL '%s' commit %"PRIu64" ~ %"PRIu64"\n", path, pWal->wal_commit[0].commit_id, pWal->commit_id);
+
+	return XDB_OK;
+}
+
+/*
+ * Replay archived segments on a database opened from a physical backup.
+ * Commits already in backup are skipped, replay stops at range target or a gap in archive.
+ */
+XDB_STATIC xdb_ret 
+xdb_wal_restore (xdb_conn_t *pConn, xdb_dbm_t *pDbm, const char *archive, const xdb_walrange_t *pRange)
+{
+	DIR				*pDir = NULL;
+	struct dirent	*pEnt;
+	uint64_t		*pSegs = NULL, seg_id;
+	int				seg_count = 0, seg_cap = 0, rc = -1;
+	void			*pBuf = NULL;
+	char			path[XDB_PATH_LEN * 2 + 64];
+
+	XDB_EXPECT (!pDbm->bMemory, XDB_E_STMT, "Can't restore memory database '%s'", XDB_OBJ_NAME(pDbm));
+
+	// apply and clear commits in backup's own WAL first, they must not be replayed again after archive
+	if ((XDB_WAL_PTR(pDbm->pWalm)->commit_size > sizeof (xdb_wal_t)) || (XDB_WAL_PTR(pDbm->pWalmBak)->commit_size > sizeof (xdb_wal_t))) {
+		xdb_repair_db (pDbm, 0);
+	}
+	uint64_t cur_cid = XDB_WAL_PTR(pDbm->pWalm)->commit_id;
+	if (cur_cid < XDB_WAL_PTR(pDbm->pWalmBak)->commit_id) {
+		cur_cid = XDB_WAL_PTR(pDbm->pWalmBak)->commit_id;
+	}
+	XDB_EXPECT (!pRange->until_cid || (pRange->until_cid >= cur_cid), XDB_E_STMT, 
+				"Backup has commit %"PRIu64" already, can't restore to %"PRIu64, cur_cid, pRange->until_cid);
+
+	pDir = opendir (archive);
+	XDB_EXPECT (NULL != pDir, XDB_E_NOTFOUND, "Can't open WAL archive '%s'", archive);
+	while (NULL != (pEnt = readdir (pDir))) {
+		char ext[8];
+		if ((2 != sscanf (pEnt->d_name, "W%"SCNu64".%4s", &seg_id, ext)) || strcmp (ext, "wal")) {
+			continue;
+		}
+		if (seg_count >= seg_cap) {
+			seg_cap = seg_cap ? seg_cap << 1 : 64;
+			uint64_t *pNew = xdb_realloc (pSegs, seg_cap * sizeof (uint64_t));
+			XDB_EXPECT (NULL != pNew, XDB_E_MEMORY, "Can't alloc memory");
+			pSegs = pNew;
+		}
+		pSegs[seg_count++] = seg_id;
+	}
+	qsort (pSegs, seg_count, sizeof (uint64_t), xdb_u64_cmp);
+
+	xdb_walrange_t	range = *pRange;
+	uint64_t		base_cid = cur_cid;
+	for (int i = 0; i < seg_count; ++i) {
+		// segment is covered by backup if next one starts no later than next commit
+		if ((i + 1 < seg_count) && (pSegs[i + 1] <= cur_cid + 1)) {
+			continue;
+		}
+		if (pSegs[i] > cur_cid + 1) {
+			xdb_errlog ("WAL archive misses commit %"PRIu64" ~ %"PRIu64", stop at commit %"PRIu64"\n", cur_cid + 1, pSegs[i] - 1, cur_cid);
+			break;
+		}
+		if (pRange->until_cid && (pSegs[i] > pRange->until_cid)) {
+			break;
+		}
+
+		xdb_sprintf (path, "%s/W%020"PRIu64".wal", archive, pSegs[i]);
+		xdb_size size = 0;
+		pBuf = xdb_fread_all (path, &size);
+		XDB_EXPECT ((NULL != pBuf) && (size > sizeof (xdb_wal_t)), XDB_E_FILE, "Can't read WAL segment '%s'", path);
+
+		// segment is replayed in place by a WAL manager without storage
+		xdb_walm_t	walm = {.pDbm = pDbm}, *pSegWalm = &walm;
+		xdb_wal_t	*pWal = pBuf;
+		walm.stg_mgr.pStgHdr = pBuf;
+		if (pWal->commit_size > size) {
+			pWal->commit_size = size;
+		}
+		range.from_cid = cur_cid;
+		__xdb_wal_redo (pDbm, &pSegWalm, &cur_cid, 1, &range);
+		uint64_t seg_cid = pWal->commit_id;
+		xdb_free (pBuf);
+
+		xdb_print ("  Replay WAL segment '%s' to commit %"PRIu64"\n", path, cur_cid);
+		if ((pRange->until_cid && (cur_cid >= pRange->until_cid)) || (cur_cid < seg_cid)) {
+			// reached target inside this segment
+			break;
+		}
+	}
+
+	// new commits go after the restored ones
+	xdb_wal_wrlock (pDbm);
+	XDB_WAL_PTR(pDbm->pWalm)->commit_id		= cur_cid;
+	XDB_WAL_PTR(pDbm->pWalm)->sync_cid		= cur_cid;
+	XDB_WAL_PTR(pDbm->pWalmBak)->commit_id	= cur_cid;
+	xdb_wal_wrunlock (pDbm);
+
+	// rebuild free lists and indexes of replayed tables and checkpoint
+	xdb_repair_db (pDbm, 0);
+
+	pConn->conn_msg.len = sprintf (pConn->conn_msg.msg, "Restore database '%s' from commit %"PRIu64" to %"PRIu64, 
+									XDB_OBJ_NAME(pDbm), base_cid, cur_cid);
+	pConn->conn_msg.len_type = (XDB_RET_MSG<<28) | (pConn->conn_msg.len + 7);
+	rc = XDB_OK;
+
+error:
+	if (NULL != pDir) {
+		closedir (pDir);
+	}
+	xdb_free (pBuf);
+	xdb_free (pSegs);
+	return rc;
+}
+
 XDB_STATIC xdb_ret 
 __xdb_wal_dump_callbck (xdb_tblm_t *pTblm, xdb_walrow_t *pWalRow, void *pArg)
 {
 	xdb_rowid rid = pWalRow->row_id & XDB_ROWID_MASK;
 	bool bDelete = pWalRow->row_id & XDB_ROWID_MSB;
 	void *pRow = pWalRow->row_data;
+	if (XDB_WAL_UPDATE == XDB_WAL_TYPE(pWalRow)) {
+		xdb_walupd_t *pWalUpd = (void*)pWalRow->row_data;
+		xdb_print ("    UPDATE %s rowid=%d old rowid=%d fields=%d vdata=%d\n", XDB_OBJ_NAME(pTblm), rid, 
+					pWalUpd->old_id, pWalUpd->upd_cnt, pWalUpd->vdat_len);
+		return XDB_OK;
+	}
 	if (bDelete) {
 		pRow = XDB_IDPTR (&pTblm->stg_mgr, rid);
 	}
@@ -478,7 +1041,7 @@ __xdb_wal_dump (xdb_walm_t *pWalm)
 	xdb_print ("  Last Commit ID %"PRIu64" Rollback Count %"PRIu64"\n", 
 		pWal->commit_id, pWal->rollback_count);
 
-	xdb_wal_iterate (pWalm, __xdb_wal_dump_callbck, NULL);
+	xdb_wal_iterate (pWalm, __xdb_wal_dump_callbck, NULL, NULL);
 }
 
 XDB_STATIC void 
@@ -503,6 +1066,9 @@ xdb_wal_switch (xdb_dbm_t *pDbm)
 	xdb_wal_t *pBakWal = (xdb_wal_t*)pDbm->pWalmBak->stg_mgr.pStgHdr;
 	// Backup still has data, which means flush DB not down yet
 	if (pBakWal->commit_size > sizeof (xdb_wal_t)) {
+		if (0 == pBakWal->ckpt_cid) {
+			pBakWal->ckpt_cid = pBakWal->commit_id;
+		}
 		bSwitch = true;
 		goto exit;	
 	}
@@ -519,6 +1085,8 @@ xdb_wal_switch (xdb_dbm_t *pDbm)
 	pWalBak->wal_active = false;
 	pWal->rollback_count = pWalBak->rollback_count;
 	pWal->commit_id		= pWalBak->commit_id;
+	// checkpoint covers all commits in backup WAL
+	pWalBak->ckpt_cid	= pWalBak->commit_id;
 	bSwitch = true;
 
 	xdb_wallog ("Switch WAL\n");
@@ -12,26 +12,39 @@
 #ifndef __XDB_WAL_H__
 #define __XDB_WAL_H__
 
-#if 0
 #define XDB_WAL_LENBITS	28
-#define XDB_WAL_LENMASK	((1<<XDB_VDAT_LENBITS) - 1)
+#define XDB_WAL_LENMASK	((1<<XDB_WAL_LENBITS) - 1)
 
 typedef enum {
-	XDB_WAL_INVALID	= 0,
-	XDB_WAL_INSERT	= 1,
-	XDB_WAL_DELETE	= 2,
-	XDB_WAL_UPDATE	= 3,
+	XDB_WAL_ROW		= 0,	// new row image, or delete if MSB of row_id is set
+	XDB_WAL_UPDATE	= 3,	// new row is old row with changed fields, see xdb_walupd_t
+#if 0
 	XDB_WAL_SQL		= 4,
-} xdb_waltype_t;
 #endif
+} xdb_waltype_t;
 
 typedef struct {
 	uint32_t				row_len;	// ms4b is type
-	xdb_rowid				row_id;		// for upd, new row len
+	xdb_rowid				row_id;		// for upd, new row id
 	uint32_t				tbl_xoid;	// or interval from beg_ts in us
-	uint8_t					row_data[];	// for update, old row, new row, (upd cnt, fid list)4B align
+	uint8_t					row_data[];	// for update, xdb_walupd_t
 } xdb_walrow_t;
 
+#define XDB_WAL_TYPE(pWalRow)	((pWalRow)->row_len >> XDB_WAL_LENBITS)
+#define XDB_WAL_LEN(pWalRow)	((pWalRow)->row_len & XDB_WAL_LENMASK)
+
+/*
+ * fid list is 4B aligned, followed by data of each field, row tail [null_off, row_size) 
+ * with vdata id if table has vdata, then new vdata if vdat_len > 0.
+ * Old row is kept till WAL is recycled, so it's the base of redo.
+ */
+typedef struct {
+	xdb_rowid				old_id;
+	uint32_t				vdat_len;	// 0 means vdata is same as old row
+	uint16_t				upd_cnt;
+	uint16_t				fid_list[];
+} xdb_walupd_t;
+
 typedef struct {
 	uint64_t				commit_len; // =0 means end
 	uint64_t				commit_id;
@@ -51,16 +64,25 @@ typedef struct {
 	uint8_t					wal_active;		// is active
 	uint8_t					wal_switch;		// need switch
 	uint8_t					rsvd[6];
-	uint64_t				rsvd2[4];
+	uint64_t				ckpt_cid;		// checkpoint in progress covers commits up to this id
+	uint64_t				rsvd2[3];
 	xdb_commit_t			wal_commit[1];	// commit segment
 	xdb_walrow_t			wal_row[0];
 } xdb_wal_t;
 
+// commit range to replay, 0 is no limit
 typedef struct {
+	uint64_t				from_cid;	// skip commits <= from_cid
+	uint64_t				until_cid;	// stop before first commit > until_cid
+	uint64_t				until_ts;	// stop before first commit later than until_ts in us
+} xdb_walrange_t;
+
+typedef struct xdb_walm_t {
 	struct xdb_dbm_t		*pDbm;
 	xdb_stgmgr_t			stg_mgr;
 	xdb_rowid				wal_cap;
 	uint64_t				wal_size; // Windows WAL chg may fail
+	uint32_t				commit_pending; // commits written to WAL but not applied to tables yet
 } xdb_walm_t;
 
 #define XDB_WAL_PTR(pWalm) ((xdb_wal_t*)(pWalm->stg_mgr.pStgHdr))
@@ -71,12 +93,18 @@ typedef struct {
 XDB_STATIC int 
 xdb_trans_db_wal (uint32_t did, void *pArg);
 
+XDB_STATIC int 
+xdb_trans_db_walchk (uint32_t did, void *pArg);
+
 XDB_STATIC bool 
 xdb_wal_switch (struct xdb_dbm_t *pDbm);
 
 XDB_STATIC xdb_ret 
 __xdb_wal_flush (xdb_walm_t *pWalMgmt, bool bFlush);
 
+XDB_STATIC xdb_ret 
+xdb_wal_flush (xdb_walm_t *pWalm);
+
 XDB_STATIC void 
 xdb_wal_close (struct xdb_dbm_t *pDbm);
 
@@ -92,4 +120,10 @@ xdb_wal_dump (struct xdb_dbm_t *pDbm);
 XDB_STATIC xdb_ret 
 xdb_wal_redo (struct xdb_dbm_t *pDbm);
 
+XDB_STATIC xdb_ret 
+xdb_wal_archive (xdb_walm_t *pWalm);
+
+XDB_STATIC xdb_ret 
+xdb_wal_restore (xdb_conn_t *pConn, struct xdb_dbm_t *pDbm, const char *archive, const xdb_walrange_t *pRange);
+
 #endif // __XDB_WAL_H__
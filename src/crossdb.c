@@ -23,6 +23,9 @@
 #include "core/xdb_crud.h"
 #include "core/xdb_hash.h"
 #include "core/xdb_rbtree.h"
+#include "core/xdb_bmpidx.h"
+#include "core/xdb_lpm.h"
+#include "core/xdb_hash2.h"
 #include "core/xdb_sql.h"
 #include "core/xdb_sysdb.h"
 #include "core/xdb_vdata.h"
@@ -40,6 +43,9 @@
 #include "core/xdb_conn.h"
 #include "admin/xdb_shell.h"
 #include "admin/xdb_backup.h"
+#include "admin/xdb_load.h"
+#include "core/xdb_arrow.h"
+#include "core/xdb_struct.h"
 #include "core/xdb_wal.h"
 
 
@@ -132,6 +138,9 @@ static uint8_t s_xdb_type_len[] = {
 #include "core/xdb_index.c"
 #include "core/xdb_hash.c"
 #include "core/xdb_rbtree.c"
+#include "core/xdb_bmpidx.c"
+#include "core/xdb_lpm.c"
+#include "core/xdb_hash2.c"
 #include "core/xdb_vdata.c"
 #include "core/xdb_table.c"
 #include "core/xdb_trans.c"
@@ -142,6 +151,9 @@ static uint8_t s_xdb_type_len[] = {
 #include "server/xdb_server.c"
 #endif
 #include "admin/xdb_backup.c"
+#include "admin/xdb_load.c"
+#include "core/xdb_arrow.c"
+#include "core/xdb_struct.c"
 #if (XDB_ENABLE_PUBSUB == 1)
 #include "server/xdb_pubsub.c"
 #endif
@@ -382,6 +382,105 @@ xdb_bmp_get (xdb_bmp_t *pBmp, uint32_t bit)
 	return (pLv2Bmp->bmp5[id4] & (1LL << id5)) > 0;
 }
 
+static inline xdb_lv2bmp_t* 
+xdb_bmp_lv2get (xdb_bmp_t *pBmp, uint32_t bit)
+{
+	int id0 = bit>>30, id1 = (bit>>24)&0x3f;
+	if (0 == (pBmp->bmp1[id0] & (1LL << id1))) {
+		return NULL;
+	}
+	xdb_lv1bmp_t *pLv1Bmp = pBmp->pLv1Bmp[id0][id1];
+	int id2 = (bit>>18)&0x3f, id3 = (bit>>12)&0x3f;
+	if (0 == (pLv1Bmp->bmp3[id2] & (1LL << id3))) {
+		return NULL;
+	}
+	return pLv1Bmp->pLv2Bmp[id2][id3];
+}
+
+static inline uint64_t 
+xdb_lv2bmp_word (xdb_lv2bmp_t *pLv2Bmp, int id4)
+{
+	return (pLv2Bmp && (pLv2Bmp->bmp4 & (1LL << id4))) ? pLv2Bmp->bmp5[id4] : 0;
+}
+
+// smallest set bit
+XDB_STATIC bool 
+xdb_bmp_first (xdb_bmp_t *pBmp, uint32_t *pBit)
+{
+	for (int id0 = 0; id0 < XDB_ARY_LEN(pBmp->bmp1); ++id0) {
+		if (pBmp->bmp1[id0]) {
+			int id1 = xdb_ctz64 (pBmp->bmp1[id0]);
+			xdb_lv1bmp_t *pLv1Bmp = pBmp->pLv1Bmp[id0][id1];
+			int id2 = xdb_ctz64 (pLv1Bmp->bmp2);
+			int id3 = xdb_ctz64 (pLv1Bmp->bmp3[id2]);
+			xdb_lv2bmp_t *pLv2Bmp = pLv1Bmp->pLv2Bmp[id2][id3];
+			int id4 = xdb_ctz64 (pLv2Bmp->bmp4);
+			*pBit = ((uint32_t)id0<<30) | (id1<<24) | (id2<<18) | (id3<<12) | (id4<<6) | xdb_ctz64 (pLv2Bmp->bmp5[id4]);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Walk 64bit words of pBmp, AND with the same words of pAnds and with inverted words of pNots.
+ * Call pCb for each bit left if not NULL, return count of bits left.
+ * At most XDB_BMP_MAX_AND bitmaps each.
+ */
+XDB_STATIC uint64_t 
+xdb_bmp_and_iterate (xdb_bmp_t *pBmp, xdb_bmp_t *pAnds[], int and_cnt, xdb_bmp_t *pNots[], int not_cnt, xdb_bmp_cb pCb, void *pArg)
+{
+	uint64_t		count = 0;
+	xdb_lv2bmp_t	*pAndLv2[XDB_BMP_MAX_AND], *pNotLv2[XDB_BMP_MAX_AND];
+
+	for (int id0 = 0; id0 < XDB_ARY_LEN(pBmp->bmp1); ++id0) {
+		for (uint64_t bits1 = pBmp->bmp1[id0]; bits1; bits1 &= bits1 - 1) {
+			int id1 = xdb_ctz64 (bits1);
+			xdb_lv1bmp_t *pLv1Bmp = pBmp->pLv1Bmp[id0][id1];
+			for (uint64_t bits2 = pLv1Bmp->bmp2; bits2; bits2 &= bits2 - 1) {
+				int id2 = xdb_ctz64 (bits2);
+				for (uint64_t bits3 = pLv1Bmp->bmp3[id2]; bits3; bits3 &= bits3 - 1) {
+					int id3 = xdb_ctz64 (bits3);
+					uint32_t base = ((uint32_t)id0<<30) | (id1<<24) | (id2<<18) | (id3<<12);
+					xdb_lv2bmp_t *pLv2Bmp = pLv1Bmp->pLv2Bmp[id2][id3];
+					int i;
+					for (i = 0; i < and_cnt; ++i) {
+						pAndLv2[i] = xdb_bmp_lv2get (pAnds[i], base);
+						if (NULL == pAndLv2[i]) {
+							break;
+						}
+					}
+					if (i < and_cnt) {
+						continue;
+					}
+					for (i = 0; i < not_cnt; ++i) {
+						pNotLv2[i] = xdb_bmp_lv2get (pNots[i], base);
+					}
+					for (uint64_t bits4 = pLv2Bmp->bmp4; bits4; bits4 &= bits4 - 1) {
+						int id4 = xdb_ctz64 (bits4);
+						uint64_t word = pLv2Bmp->bmp5[id4];
+						for (i = 0; (i < and_cnt) && word; ++i) {
+							word &= xdb_lv2bmp_word (pAndLv2[i], id4);
+						}
+						for (i = 0; (i < not_cnt) && word; ++i) {
+							word &= ~xdb_lv2bmp_word (pNotLv2[i], id4);
+						}
+						if (NULL == pCb) {
+							count += xdb_popcount64 (word);
+							continue;
+						}
+						for (; word; word &= word - 1) {
+							count++;
+							pCb (base | (id4<<6) | xdb_ctz64 (word), pArg);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return count;
+}
 
 #ifdef XDB_MOD_TEST
 int bmp_dump (uint32_t bit, void *pArg)
@@ -38,6 +38,8 @@ typedef struct {
 
 typedef int (*xdb_bmp_cb) (uint32_t bit, void *pArg);
 
+#define XDB_BMP_MAX_AND		16
+
 XDB_STATIC void 
 xdb_bmp_init (xdb_bmp_t *pBmp);
 
@@ -56,6 +58,14 @@ xdb_bmp_clr (xdb_bmp_t *pBmp, uint32_t bit);
 XDB_STATIC bool 
 xdb_bmp_get (xdb_bmp_t *pBmp, uint32_t bit);
 
+XDB_STATIC bool 
+xdb_bmp_first (xdb_bmp_t *pBmp, uint32_t *pBit);
+
+XDB_STATIC uint64_t 
+xdb_bmp_and_iterate (xdb_bmp_t *pBmp, xdb_bmp_t *pAnds[], int and_cnt, xdb_bmp_t *pNots[], int not_cnt, xdb_bmp_cb pCb, void *pArg);
+
+#define xdb_bmp_count(pBmp)	xdb_bmp_and_iterate (pBmp, NULL, 0, NULL, 0, NULL, NULL)
+
 XDB_STATIC void 
 xdb_lv2bmp_iterate (xdb_lv2bmp_t *pLv2Bmp, xdb_bmp_cb pCb, void *pArg);
 XDB_STATIC void 
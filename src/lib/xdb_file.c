@@ -93,7 +93,6 @@ xdb_rmdir (const char *dirname)
 	return ret;
 }
 
-
 /******************************************************************************
 	Linux
 ******************************************************************************/
@@ -281,6 +280,193 @@ xdb_ftruncate (xdb_fd fd, uint64_t length)
 #endif // #ifdef _WIN32
 
 
+/******************************************************************************
+	XDB File copy
+******************************************************************************/
+
+static inline int 
+xdb_fflush_sync (FILE *pFile)
+{
+	int ret = fflush (pFile);
+	if (0 == ret) {
+#ifndef _WIN32
+		ret = fsync (fileno (pFile));
+#else
+		ret = _commit (_fileno (pFile));
+#endif
+	}
+	return ret;
+}
+
+// write whole buffer and sync to disk
+XDB_STATIC int 
+xdb_fwrite_sync (const char *file, const void *buf, xdb_size len)
+{
+	FILE *pFile = fopen (file, "wb");
+	if (NULL == pFile) {
+		xdb_errlog ("Can't open %s error %s\n", file, strerror(errno));
+		return -1;
+	}
+	int ret = (fwrite (buf, 1, len, pFile) == len) ? xdb_fflush_sync (pFile) : -1;
+	if (ret != 0) {
+		xdb_errlog ("Can't write %s error %s\n", file, strerror(errno));
+	}
+	fclose (pFile);
+	return ret;
+}
+
+// read whole file into malloc buffer
+XDB_STATIC void* 
+xdb_fread_all (const char *file, xdb_size *pLen)
+{
+	FILE *pFile = fopen (file, "rb");
+	if (NULL == pFile) {
+		return NULL;
+	}
+	void *buf = NULL;
+	if (0 == fseek (pFile, 0, SEEK_END)) {
+		long len = ftell (pFile);
+		if ((len > 0) && (0 == fseek (pFile, 0, SEEK_SET)) && (NULL != (buf = xdb_malloc (len)))) {
+			if (fread (buf, 1, len, pFile) != (size_t)len) {
+				xdb_free (buf);
+			} else {
+				*pLen = len;
+			}
+		}
+	}
+	fclose (pFile);
+	return buf;
+}
+
+XDB_STATIC int 
+xdb_fcopy (const char *src, const char *dst)
+{
+	int		ret = -1;
+	FILE	*pSrc = fopen (src, "rb"), *pDst = fopen (dst, "wb");
+	char	*buf = xdb_malloc (1024*1024);
+
+	if ((NULL != pSrc) && (NULL != pDst) && (NULL != buf)) {
+		size_t len;
+		ret = 0;
+		while ((len = fread (buf, 1, 1024*1024, pSrc)) > 0) {
+			if (fwrite (buf, 1, len, pDst) != len) {
+				ret = -1;
+				break;
+			}
+		}
+		if ((0 == ret) && (ferror (pSrc) || fflush (pDst))) {
+			ret = -1;
+		}
+	}
+	if (ret != 0) {
+		xdb_errlog ("Can't copy %s to %s error %s\n", src, dst, strerror(errno));
+	}
+	xdb_fclose (pSrc);
+	xdb_fclose (pDst);
+	xdb_free (buf);
+	return ret;
+}
+
+#define XDB_FCOPY_CHUNK	(64*1024)
+
+/*
+ * Copy src over existing dst, only chunks which differ are written, then sync.
+ * patch can modify first chunk before compare. Return bytes written or -1.
+ */
+XDB_STATIC int64_t 
+xdb_fcopy_diff (const char *src, const char *dst, void (*patch)(void *buf, size_t len))
+{
+	int64_t	bytes = -1;
+	FILE	*pSrc = fopen (src, "rb"), *pDst = fopen (dst, "r+b");
+	char	*buf = xdb_malloc (XDB_FCOPY_CHUNK * 2), *old = buf + XDB_FCOPY_CHUNK;
+	long	off = 0;
+
+	if (NULL == pDst) {
+		pDst = fopen (dst, "w+b");
+	}
+	if ((NULL != pSrc) && (NULL != pDst) && (NULL != buf)) {
+		size_t len;
+		bytes = 0;
+		while ((len = fread (buf, 1, XDB_FCOPY_CHUNK, pSrc)) > 0) {
+			if ((0 == off) && (NULL != patch)) {
+				patch (buf, len);
+			}
+			// stream is shared by read and write, seek between them
+			if ((0 != fseek (pDst, off, SEEK_SET)) || (fread (old, 1, len, pDst) != len) || memcmp (buf, old, len)) {
+				if ((0 != fseek (pDst, off, SEEK_SET)) || (fwrite (buf, 1, len, pDst) != len)) {
+					bytes = -1;
+					break;
+				}
+				bytes += len;
+			}
+			off += len;
+		}
+		// cut tail if src shrinks
+#ifndef _WIN32
+		if ((bytes >= 0) && (ferror (pSrc) || fflush (pDst) || ftruncate (fileno (pDst), off) || xdb_fflush_sync (pDst))) {
+#else
+		if ((bytes >= 0) && (ferror (pSrc) || fflush (pDst) || _chsize_s (_fileno (pDst), off) || xdb_fflush_sync (pDst))) {
+#endif
+			bytes = -1;
+		}
+	}
+	if (bytes < 0) {
+		xdb_errlog ("Can't copy %s to %s error %s\n", src, dst, strerror(errno));
+	}
+	xdb_fclose (pSrc);
+	xdb_fclose (pDst);
+	xdb_free (buf);
+	return bytes;
+}
+
+// join dir and file name into path, return false if truncated
+static inline bool
+xdb_path_join (char *path, size_t size, const char *dir, const char *name)
+{
+	int len = snprintf (path, size, "%s/%s", dir, name);
+	if ((len < 0) || ((size_t)len >= size)) {
+		xdb_errlog ("Path %s/%s is too long\n", dir, name);
+		return false;
+	}
+	return true;
+}
+
+// copy dir recursively, dst is created if not exist
+XDB_STATIC int 
+xdb_copydir (const char *src, const char *dst)
+{
+	DIR				*dir;
+	struct dirent	*entry;
+	char			spath[512], dpath[512];
+	struct stat		st;
+	int				ret = 0;
+
+	dir = opendir (src);
+	if (NULL == dir) {
+		xdb_errlog ("opendir %s error %s\n", src, strerror(errno));
+		return -1;
+	}
+	xdb_mkdir (dst);
+
+	while ((ret == 0) && (entry = readdir(dir)) != NULL) {
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+			continue;
+		}
+		if (!xdb_path_join (spath, sizeof(spath), src, entry->d_name) || !xdb_path_join (dpath, sizeof(dpath), dst, entry->d_name)) {
+			ret = -1;
+			break;
+		}
+		if (stat (spath, &st) < 0) {
+			continue;
+		}
+		ret = S_ISDIR(st.st_mode) ? xdb_copydir (spath, dpath) : xdb_fcopy (spath, dpath);
+	}
+	closedir (dir);
+
+	return ret;
+}
+
+
 /******************************************************************************
 	XDB File lock for Linux
 ******************************************************************************/
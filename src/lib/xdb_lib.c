@@ -38,7 +38,7 @@ xdb_hex_init ()
 		s_xdb_hex_2_str[i][1] = (hex)<10 ? hex+'0' : hex-10+'a';
 	}
 	memset (s_xdb_str_2_hex, 0xff, sizeof(s_xdb_str_2_hex));
-	for (i = 0; i < 9; ++i) {
+	for (i = 0; i < 10; ++i) {
 		s_xdb_str_2_hex['0' + i] = i;
 	}
 	for (i = 0; i < 6; ++i) {
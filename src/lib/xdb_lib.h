@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include <math.h>
+#include <float.h>
 #include <ctype.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -95,6 +96,10 @@ typedef unsigned int in_addr_t;
 #define xdb_bswap32(val) 		__builtin_bswap32(val)
 #define xdb_bswap16(val) 		__builtin_bswap16(val)
 
+// Bit count
+#define xdb_popcount64(val) 	__builtin_popcountll(val)
+#define xdb_ctz64(val) 			__builtin_ctzll(val)
+
 // Atomic
 #define xdb_atomic_read(ptr,val) 	__atomic_load(ptr, val, __ATOMIC_SEQ_CST)
 #define xdb_atomic_inc(ptr) 		__sync_add_and_fetch(ptr, 1)
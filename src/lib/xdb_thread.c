@@ -73,15 +73,118 @@ xdb_create_thread (xdb_thread_t *pThread, const void *pAttr, void *(*start_routi
 	return pthread_create (pThread, pAttr, start_routine, pArg);
 }
 
-#if 0
-#ifdef _WIN32
-typedef DWORD xdb_thread_t;
 static inline int 
-xdb_create_thread (xdb_thread_t *thread, const void *attr, void *(*start_routine) (void *), void *arg)
+xdb_join_thread (xdb_thread_t thread)
 {
-	(void) attr;
-	CreateThread (0, 0, (LPTHREAD_START_ROUTINE)start_routine, arg, 0, thread);
-	return 0;
+	return pthread_join (thread, NULL);
+}
+
+#ifndef _WIN32
+static inline int 
+xdb_cpu_count ()
+{
+	long count = sysconf (_SC_NPROCESSORS_ONLN);
+	return count > 0 ? count : 1;
+}
+#else
+static inline int 
+xdb_cpu_count ()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo (&info);
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
 }
 #endif
+
+typedef struct {
+	void	(*job) (int id, void *pArg);
+	void	*pArg;
+	int		job_count;
+	int		next_job;
+} xdb_jobs_t;
+
+static void* 
+xdb_jobs_worker (void *pArg)
+{
+	xdb_jobs_t	*pJobs = pArg;
+	int			id;
+	while ((id = __atomic_fetch_add (&pJobs->next_job, 1, __ATOMIC_RELAXED)) < pJobs->job_count) {
+		pJobs->job (id, pJobs->pArg);
+	}
+	return NULL;
+}
+
+// job workers use native threads, pthread may be missing or emulated on Windows
+#ifndef _WIN32
+typedef xdb_thread_t xdb_jobs_thread_t;
+
+static inline int 
+xdb_jobs_start (xdb_jobs_thread_t *pThread, xdb_jobs_t *pJobs)
+{
+	return xdb_create_thread (pThread, NULL, xdb_jobs_worker, pJobs);
+}
+
+static inline void 
+xdb_jobs_join (xdb_jobs_thread_t thread)
+{
+	xdb_join_thread (thread);
+}
+#else
+typedef HANDLE xdb_jobs_thread_t;
+
+static DWORD WINAPI 
+xdb_jobs_worker_win (LPVOID pArg)
+{
+	xdb_jobs_worker (pArg);
+	return 0;
+}
+
+static inline int 
+xdb_jobs_start (xdb_jobs_thread_t *pThread, xdb_jobs_t *pJobs)
+{
+	*pThread = CreateThread (NULL, 0, xdb_jobs_worker_win, pJobs, 0, NULL);
+	return (NULL != *pThread) ? 0 : -1;
+}
+
+static inline void 
+xdb_jobs_join (xdb_jobs_thread_t thread)
+{
+	WaitForSingleObject (thread, INFINITE);
+	CloseHandle (thread);
+}
 #endif
+
+// run job 0..job_count-1 on at most max_thread threads (capped by cpu count), current thread is also a worker
+static inline int 
+xdb_run_jobs (int job_count, int max_thread, void (*job) (int id, void *pArg), void *pArg)
+{
+	xdb_jobs_t			jobs = {.job = job, .pArg = pArg, .job_count = job_count};
+	xdb_jobs_thread_t	*pThread = NULL;
+	int					count = 0, thread_count = xdb_cpu_count ();
+
+	if (thread_count > max_thread) {
+		thread_count = max_thread;
+	}
+	if (thread_count > job_count) {
+		thread_count = job_count;
+	}
+	if (thread_count > 1) {
+		pThread = xdb_malloc ((thread_count - 1) * sizeof (xdb_jobs_thread_t));
+	}
+	if (NULL != pThread) {
+		for (; count < thread_count - 1; ++count) {
+			if (xdb_jobs_start (&pThread[count], &jobs) != 0) {
+				break;
+			}
+		}
+	}
+
+	xdb_jobs_worker (&jobs);
+
+	for (int i = 0; i < count; ++i) {
+		xdb_jobs_join (pThread[i]);
+	}
+	xdb_free (pThread);
+
+	return count + 1;
+}
@@ -33,6 +33,12 @@ xdb_timestamp_us ()
 	return time.tv_sec * 1000000LL + time.tv_usec;
 }
 
+static inline void 
+xdb_msleep (uint32_t ms)
+{
+	usleep (ms * 1000);
+}
+
 static inline uint64_t 
 xdb_uptime ()
 {
@@ -182,7 +182,7 @@ xdb_parse_set (xdb_conn_t* pConn, xdb_token_t *pTkn)
 		type = xdb_next_token (pTkn);
 		XDB_EXPECT (XDB_TOK_EQ==type, XDB_E_STMT, "Expect EQ");
 		type = xdb_next_token (pTkn);
-		XDB_EXPECT (XDB_TOK_STR>=type, XDB_E_STMT, "Expect STRING");
+		XDB_EXPECT ((XDB_TOK_STR>=type) || (XDB_TOK_NUM==type), XDB_E_STMT, "Expect STRING");
 
 		//xdb_dbgprint ("var: %s\n", var);
 		if (!strcasecmp (var, "DATADIR")) {
@@ -191,6 +191,18 @@ xdb_parse_set (xdb_conn_t* pConn, xdb_token_t *pTkn)
 			pStmt->format = pTkn->token;
 		} else if (!strcasecmp (var, "SERVER_ID")) {
 			pStmt->svrid = pTkn->token;
+		} else if (!strcasecmp (var, "CHECKPOINT_PERIOD")) {
+			pStmt->ckpt_period = pTkn->token;
+		} else if (!strcasecmp (var, "CHECKPOINT_THREADS")) {
+			pStmt->ckpt_threads = pTkn->token;
+		} else if (!strcasecmp (var, "CHECKPOINT_WAL_SIZE")) {
+			pStmt->ckpt_wal_size = pTkn->token;
+		} else if (!strcasecmp (var, "CHECKPOINT_DIRTY_SIZE")) {
+			pStmt->ckpt_dirty_size = pTkn->token;
+		} else if (!strcasecmp (var, "CHECKPOINT_IO_RATE")) {
+			pStmt->ckpt_io_rate = pTkn->token;
+		} else if (!strcasecmp (var, "WAL_ARCHIVE")) {
+			pStmt->wal_archive = pTkn->token;
 		}
 		type = xdb_next_token (pTkn);
 	} while (XDB_TOK_COMMA == type);
@@ -213,6 +225,13 @@ xdb_parse_source (xdb_conn_t* pConn, xdb_token_t *pTkn)
 	XDB_EXPECT (XDB_TOK_STR>=type, XDB_E_STMT, "Miss file name");
 
 	pStmt->file = pTkn->token;
+	pStmt->bFast = false;
+
+	// SOURCE 'file' [FAST]
+	type = xdb_next_token (pTkn);
+	if ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "FAST")) {
+		pStmt->bFast = true;
+	}
 	return (xdb_stmt_t*)pStmt;
 
 error:
@@ -384,6 +403,12 @@ xdb_parse_dump (xdb_conn_t* pConn, xdb_token_t *pTkn)
 				return xdb_parse_dump_db (pConn, pTkn);
 			}
 			break;
+		case 'T':
+		case 't':
+			if (!strcasecmp (pTkn->token, "TABLE")) {
+				return xdb_parse_dump_tbl (pConn, pTkn);
+			}
+			break;
 		case 'W':
 		case 'w':
 			if (!strcasecmp (pTkn->token, "WAL")) {
@@ -523,6 +548,8 @@ xdb_sql_parse (xdb_conn_t* pConn, char **ppSql, bool bPStmt)
 				pStmt->pSql = NULL;
 			} else if (! strcasecmp (token.token, "CLOSE")) {
 				pStmt = xdb_parse_close (pConn, &token);;
+			} else if (! strcasecmp (token.token, "COPY")) {
+				pStmt = xdb_parse_copy (pConn, &token);
 			} else {
 				goto error;
 			}
@@ -543,6 +570,8 @@ xdb_sql_parse (xdb_conn_t* pConn, char **ppSql, bool bPStmt)
 				pStmt = &pConn->stmt_union.stmt;
 				pStmt->stmt_type = XDB_STMT_BEGIN;
 				pStmt->pSql = NULL;
+			} else if (! strcasecmp (token.token, "BACKUP")) {
+				pStmt = xdb_parse_backup_db (pConn, &token);
 			} else {
 				goto error;
 			}
@@ -559,6 +588,8 @@ xdb_sql_parse (xdb_conn_t* pConn, char **ppSql, bool bPStmt)
 				pStmt = &pConn->stmt_union.stmt;
 				pStmt->stmt_type = XDB_STMT_REPAIR_DB;
 				pStmt->pSql = NULL;
+			} else if (! strcasecmp (token.token, "RESTORE")) {
+				pStmt = xdb_parse_restore_db (pConn, &token);
 			} else {
 				goto error;
 			}
@@ -568,6 +599,8 @@ xdb_sql_parse (xdb_conn_t* pConn, char **ppSql, bool bPStmt)
 			if (! strcasecmp (token.token, "LOCK")) {
 				pStmt = xdb_parse_lock (pConn, &token);
 				
+			} else if (! strcasecmp (token.token, "LOAD")) {
+				pStmt = xdb_parse_load (pConn, &token);
 			} else {
 				goto error;
 			}
@@ -667,12 +700,17 @@ xdb_sql_parse_alloc (xdb_conn_t* pConn, const char *sql, bool bPStmt)
 	}
 	char *pSql2 = pSql;
 	xdb_stmt_t *pStmt = xdb_sql_parse (pConn, &pSql2, bPStmt);
-	if (xdb_likely (NULL != pStmt)) {
+	if (xdb_unlikely (NULL == pStmt)) {
+		xdb_free (pSql);
+	} else {
 		pStmt->pSql = pSql;
 		// only support single STMT
 		if (pSql2 != NULL) {
 			// pSql is free here
 			xdb_stmt_free (pStmt);
+			if (bPStmt) {
+				xdb_free (pStmt);
+			}
 			return NULL;
 		}
 	}
@@ -694,6 +732,7 @@ xdb_stmt_free (xdb_stmt_t *pStmt)
 			if (pStmtIns->pRowsBuf != pStmtIns->row_buf) {
 				xdb_free (pStmtIns->pRowsBuf);
 			}
+			xdb_structmap_release (pStmtIns->pStructMap);
 		}
 		break;
 	case XDB_STMT_SELECT:
@@ -702,6 +741,7 @@ xdb_stmt_free (xdb_stmt_t *pStmt)
 			if ((pStmtSel->meta_size) > 0 && ((void*)pStmtSel->pMeta != (void*)pStmtSel->set_flds)) {
 				xdb_free (pStmtSel->pMeta);
 			}
+			xdb_structmap_release (pStmtSel->pStructMap);
 			if (xdb_unlikely (pStmtSel->bRegexp)) {
 				for (int i = 0; i < pStmtSel->reftbl_count; ++i) {
 					xdb_reftbl_t *pRefTbl = &pStmtSel->ref_tbl[i];
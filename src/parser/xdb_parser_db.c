@@ -242,3 +242,263 @@ error:
 	return NULL;
 
 }
+
+// RESTORE DATABASE name FROM 'backup_dir' [ARCHIVE 'dir'] [UNTIL COMMIT n | UNTIL TIMESTAMP 'ts']
+XDB_STATIC xdb_stmt_t* 
+xdb_parse_restore_db (xdb_conn_t* pConn, xdb_token_t *pTkn)
+{
+	xdb_stmt_backup_t *pStmt = &pConn->stmt_union.backup_stmt;
+	memset (pStmt, 0, sizeof (*pStmt));
+	pStmt->stmt_type 	= XDB_STMT_RESTORE_DB;
+
+	xdb_token_type type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "DATABASE"), XDB_E_STMT, "Miss DATABASE");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (type <= XDB_TOK_STR, XDB_E_STMT, "Miss database name");
+	pStmt->db_name	= pTkn->token;
+
+	type = xdb_next_token (pTkn);
+	while (XDB_TOK_ID == type) {
+		if (!strcasecmp (pTkn->token, "FROM")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_STR >= type, XDB_E_STMT, "Miss backup dir");
+			pStmt->file = pTkn->token;
+		} else if (!strcasecmp (pTkn->token, "ARCHIVE")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_STR >= type, XDB_E_STMT, "Miss WAL archive dir");
+			pStmt->archive = pTkn->token;
+		} else if (!strcasecmp (pTkn->token, "UNTIL")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_ID == type, XDB_E_STMT, "Expect COMMIT or TIMESTAMP");
+			if (!strcasecmp (pTkn->token, "COMMIT")) {
+				type = xdb_next_token (pTkn);
+				XDB_EXPECT (XDB_TOK_NUM == type, XDB_E_STMT, "Miss commit id");
+				pStmt->until_cid = strtoull (pTkn->token, NULL, 10);
+				XDB_EXPECT (pStmt->until_cid > 0, XDB_E_STMT, "Invalid commit id");
+			} else if (!strcasecmp (pTkn->token, "TIMESTAMP")) {
+				type = xdb_next_token (pTkn);
+				XDB_EXPECT ((XDB_TOK_STR == type) || (XDB_TOK_NUM == type), XDB_E_STMT, "Miss timestamp");
+				// number is in us
+				int64_t ts = (XDB_TOK_NUM == type) ? (int64_t)strtoull (pTkn->token, NULL, 10) : xdb_timestamp_scanf (pTkn->token);
+				XDB_EXPECT (ts > 0, XDB_E_STMT, "Invalid timestamp '%s'", pTkn->token);
+				pStmt->until_ts = ts;
+			} else {
+				XDB_EXPECT (0, XDB_E_STMT, "Expect COMMIT or TIMESTAMP");
+			}
+		} else {
+			break;
+		}
+		type = xdb_next_token (pTkn);
+	}
+	XDB_EXPECT (type >= XDB_TOK_END, XDB_E_STMT, "Unknown token '%s'", pTkn->token);
+	XDB_EXPECT (NULL != pStmt->file, XDB_E_STMT, "Miss FROM backup dir");
+
+	return (xdb_stmt_t*)pStmt;
+
+error:
+	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	return NULL;
+}
+
+// [FORMAT CSV|BINARY] [FIELDS TERMINATED BY 'c'] [IGNORE n LINES]
+XDB_STATIC xdb_token_type 
+xdb_parse_load_opt (xdb_conn_t* pConn, xdb_token_t *pTkn, xdb_stmt_load_t *pStmt, xdb_token_type type)
+{
+	while (XDB_TOK_ID == type) {
+		if (!strcasecmp (pTkn->token, "FORMAT")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_ID == type, XDB_E_STMT, "Miss format");
+			if (!strcasecmp (pTkn->token, "CSV")) {
+				pStmt->format = XDB_LOAD_CSV;
+			} else if (!strcasecmp (pTkn->token, "BINARY")) {
+				pStmt->format = XDB_LOAD_BINARY;
+			} else {
+				XDB_EXPECT (0, XDB_E_STMT, "Unknown format '%s'", pTkn->token);
+			}
+		} else if (!strcasecmp (pTkn->token, "FIELDS")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "TERMINATED"), XDB_E_STMT, "Miss TERMINATED");
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "BY"), XDB_E_STMT, "Miss BY");
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT ((XDB_TOK_STR == type) && (1 == strlen (pTkn->token)), XDB_E_STMT, "Field delimiter must be one char");
+			pStmt->delim = pTkn->token[0];
+			XDB_EXPECT (('"' != pStmt->delim) && ('\n' != pStmt->delim) && ('\r' != pStmt->delim), XDB_E_STMT, "Invalid field delimiter");
+		} else if (!strcasecmp (pTkn->token, "IGNORE")) {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_NUM == type, XDB_E_STMT, "Miss line count");
+			pStmt->skip_lines = atoi (pTkn->token);
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "LINES"), XDB_E_STMT, "Miss LINES");
+		} else {
+			break;
+		}
+		type = xdb_next_token (pTkn);
+	}
+	XDB_EXPECT (type >= XDB_TOK_END, XDB_E_STMT, "Unknown token '%s'", pTkn->token);
+	return type;
+
+error:
+	return XDB_TOK_ERR;
+}
+
+// LOAD DATA INFILE 'file' INTO TABLE tbl [FORMAT CSV|BINARY] [FIELDS TERMINATED BY 'c'] [IGNORE n LINES]
+XDB_STATIC xdb_stmt_t* 
+xdb_parse_load (xdb_conn_t* pConn, xdb_token_t *pTkn)
+{
+	xdb_stmt_load_t *pStmt = &pConn->stmt_union.load_stmt;
+	memset (pStmt, 0, sizeof (*pStmt));
+	pStmt->stmt_type 	= XDB_STMT_LOAD;
+	pStmt->delim		= ',';
+
+	xdb_token_type type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "DATA"), XDB_E_STMT, "Miss DATA");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "INFILE"), XDB_E_STMT, "Miss INFILE");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (XDB_TOK_STR == type, XDB_E_STMT, "Miss file name");
+	pStmt->file = pTkn->token;
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "INTO"), XDB_E_STMT, "Miss INTO");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "TABLE"), XDB_E_STMT, "Miss TABLE");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (type <= XDB_TOK_STR, XDB_E_STMT, "Miss table name");
+	pStmt->tbl_name = pTkn->token;
+	XDB_PARSE_DBTBLNAME();
+
+	XDB_EXPECT2 (XDB_TOK_ERR != xdb_parse_load_opt (pConn, pTkn, pStmt, type));
+
+	return (xdb_stmt_t*)pStmt;
+
+error:
+	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	return NULL;
+}
+
+// DUMP TABLE tbl INTO 'file' [FORMAT CSV|BINARY] [FIELDS TERMINATED BY 'c']
+XDB_STATIC xdb_stmt_t* 
+xdb_parse_dump_tbl (xdb_conn_t* pConn, xdb_token_t *pTkn)
+{
+	xdb_stmt_load_t *pStmt = &pConn->stmt_union.load_stmt;
+	memset (pStmt, 0, sizeof (*pStmt));
+	pStmt->stmt_type 	= XDB_STMT_DUMP_TBL;
+	pStmt->delim		= ',';
+
+	xdb_token_type type = xdb_next_token (pTkn);
+	XDB_EXPECT (type <= XDB_TOK_STR, XDB_E_STMT, "Miss table name");
+	pStmt->tbl_name = pTkn->token;
+	XDB_PARSE_DBTBLNAME();
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "INTO"), XDB_E_STMT, "Miss INTO");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (XDB_TOK_STR == type, XDB_E_STMT, "Miss file name");
+	pStmt->file = pTkn->token;
+	type = xdb_next_token (pTkn);
+
+	XDB_EXPECT2 (XDB_TOK_ERR != xdb_parse_load_opt (pConn, pTkn, pStmt, type));
+	XDB_EXPECT (0 == pStmt->skip_lines, XDB_E_STMT, "IGNORE LINES is only for LOAD DATA");
+
+	return (xdb_stmt_t*)pStmt;
+
+error:
+	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	return NULL;
+}
+
+// COPY (SELECT ...) TO 'file' [FORMAT ARROW]
+XDB_STATIC xdb_stmt_t* 
+xdb_parse_copy (xdb_conn_t* pConn, xdb_token_t *pTkn)
+{
+	xdb_stmt_copy_t *pStmt = &pConn->stmt_union.copy_stmt;
+	memset (pStmt, 0, sizeof (*pStmt));
+	pStmt->stmt_type 	= XDB_STMT_COPY;
+
+	// query is kept as raw text, find the matching ) and skip quoted strings
+	char *sql = pTkn->tk_sql;
+	if ('(' != pTkn->tk_nxt) {
+		while (isspace ((int)*sql)) {
+			sql++;
+		}
+		XDB_EXPECT ('(' == *sql, XDB_E_STMT, "Miss (SELECT ...)");
+		sql++;
+	}
+	pStmt->query = sql;
+	for (int depth = 1; depth > 0; sql++) {
+		char ch = *sql;
+		XDB_EXPECT ('\0' != ch, XDB_E_STMT, "Miss )");
+		if (('\'' == ch) || ('"' == ch) || ('`' == ch)) {
+			for (sql++; *sql && (*sql != ch); sql++) {
+				if (('\\' == *sql) && sql[1]) {
+					sql++;
+				}
+			}
+			XDB_EXPECT ('\0' != *sql, XDB_E_STMT, "Miss quote");
+		} else if ('(' == ch) {
+			depth++;
+		} else if (')' == ch) {
+			depth--;
+		}
+	}
+	sql[-1] = '\0';
+	pTkn->tk_sql	= sql;
+	pTkn->tk_type	= XDB_TOK_RP;
+
+	xdb_token_type type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "TO"), XDB_E_STMT, "Miss TO");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (XDB_TOK_STR == type, XDB_E_STMT, "Miss file name");
+	pStmt->file = pTkn->token;
+	type = xdb_next_token (pTkn);
+	if ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "FORMAT")) {
+		type = xdb_next_token (pTkn);
+		XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "ARROW"), XDB_E_STMT, "Only ARROW format is supported");
+		type = xdb_next_token (pTkn);
+	}
+	XDB_EXPECT (type >= XDB_TOK_END, XDB_E_STMT, "Unknown token '%s'", pTkn->token);
+
+	return (xdb_stmt_t*)pStmt;
+
+error:
+	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	return NULL;
+}
+
+// BACKUP DATABASE [name] TO 'dir' [INCREMENTAL]
+XDB_STATIC xdb_stmt_t* 
+xdb_parse_backup_db (xdb_conn_t* pConn, xdb_token_t *pTkn)
+{
+	xdb_stmt_backup_t *pStmt = &pConn->stmt_union.backup_stmt;
+	memset (pStmt, 0, sizeof (*pStmt));
+	pStmt->stmt_type 	= XDB_STMT_BACKUP_DB;
+
+	xdb_token_type type = xdb_next_token (pTkn);
+	XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "DATABASE"), XDB_E_STMT, "Miss DATABASE");
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (type <= XDB_TOK_STR, XDB_E_STMT, "Miss TO backup dir");
+	if ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "TO")) {
+		XDB_EXPECT (pConn->pCurDbm != NULL, XDB_E_NODB, XDB_SQL_NO_DB_ERR);
+		pStmt->pDbm = pConn->pCurDbm;
+	} else {
+		pStmt->db_name	= pTkn->token;
+		pStmt->pDbm = xdb_find_db (pStmt->db_name);
+		XDB_EXPECT (NULL != pStmt->pDbm, XDB_E_NOTFOUND, "Can't backup database '%s', database doesn't exist", pStmt->db_name);
+		type = xdb_next_token (pTkn);
+		XDB_EXPECT ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "TO"), XDB_E_STMT, "Miss TO backup dir");
+	}
+	type = xdb_next_token (pTkn);
+	XDB_EXPECT (XDB_TOK_STR >= type, XDB_E_STMT, "Miss backup dir");
+	pStmt->file = pTkn->token;
+
+	type = xdb_next_token (pTkn);
+	if ((XDB_TOK_ID == type) && !strcasecmp (pTkn->token, "INCREMENTAL")) {
+		pStmt->bIncr = true;
+		type = xdb_next_token (pTkn);
+	}
+	XDB_EXPECT (type >= XDB_TOK_END, XDB_E_STMT, "Unknown token '%s'", pTkn->token);
+
+	return (xdb_stmt_t*)pStmt;
+
+error:
+	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	return NULL;
+}
@@ -206,6 +206,7 @@ xdb_parse_insert (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt, bool bRepla
 	pStmt->stmt_type = !bReplace ? XDB_STMT_INSERT : XDB_STMT_REPLACE;
 	pStmt->pSql = NULL;
 	pStmt->pRowsBuf = NULL;
+	pStmt->pStructMap = NULL;
 
 	xdb_token_type	type = xdb_next_token (pTkn);
 
@@ -443,6 +444,9 @@ xdb_parse_insert (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt, bool bRepla
 
 error:
 	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	if (xdb_unlikely (bPStmt)) {
+		xdb_free (pStmt);
+	}
 	return NULL;
 }
 
@@ -466,6 +470,9 @@ xdb_init_where_stmt (xdb_stmt_select_t *pStmt)
 	pStmt->ref_tbl[0].bUseIdx = false;
 	pStmt->ref_tbl[0].filter_count = 0;
 	pStmt->ref_tbl[0].or_count = 0;
+	pStmt->ref_tbl[0].and_count = 0;
+	pStmt->ref_tbl[0].idx_cost = 0;
+	pStmt->ref_tbl[0].scan_cost = 0;
 #if 0
 	pStmt->ref_tbl[0].or_list[0].pIdxFilter	= NULL;
 	pStmt->ref_tbl[0].or_list[0].filter_count  = 0;
@@ -658,71 +665,583 @@ static xdb_token_type s_XDB_TOK_opposite[] = {
 	[XDB_TOK_GE] = XDB_TOK_LE,
 	[XDB_TOK_LIKE] = XDB_TOK_LIKE,
 	[XDB_TOK_REGEXP] = XDB_TOK_REGEXP,
+	[XDB_TOK_SUPEQ] = XDB_TOK_SUBEQ,
+	[XDB_TOK_SUBEQ] = XDB_TOK_SUPEQ,
 };
 
-XDB_STATIC bool
-xdb_find_idx (xdb_tblm_t	*pTblm, xdb_singfilter_t *pSigFlt, uint8_t 	bmp[])
+/*
+ * Planner cost is in row visits: sequential scan checks each row once, a row reached
+ * through index is dearer (random access, sibling chain). Index rows and distinct keys
+ * come from hash/rbtree header, range selectivity is a fixed guess.
+ */
+#define XDB_COST_SCAN_BASE		16.0	// storage walk startup
+#define XDB_COST_IDX_ROW		3.0		// row reached through index
+#define XDB_COST_HASH_PROBE		2.0
+#define XDB_COST_OR_ROW			0.5		// OR-union bitmap dedup per row
+#define XDB_COST_BMP_ROW		1.0		// index row collected into rowid bitmap
+#define XDB_COST_BMP_KEY		(1.0/16)	// bitmap index key compared in linear search
+#define XDB_COST_BMP_TEST		(1.0/16)	// rowid tested against bitmap of bitmap index
+#define XDB_RANGE_SEL			(1.0/3)	// one side range selectivity
+#define XDB_LPM_PREFIXES		4.0		// prefixes containing one address
+
+// bitmap index visits rows in rowid order like scan
+#define XDB_IDX_ROWCOST(pIdxm)	((XDB_IDX_BITMAP == (pIdxm)->idx_type) ? XDB_COST_BMP_ROW : XDB_COST_IDX_ROW)
+
+// EQ filter matching index field fid
+XDB_STATIC int
+xdb_idx_eqflt (xdb_idxm_t *pIdxm, int fid, xdb_singfilter_t *pSigFlt, uint8_t bmp[])
 {
-	int fid;
-	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
-		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
-		if (pSigFlt->filter_count < pIdxm->fld_count) {
+	xdb_field_t	*pField = pIdxm->pFields[fid];
+	uint16_t	fld_id = pField->fld_id;
+	if (!(bmp[fld_id>>3] & (1<<(fld_id&7)))) {
+		return -1;
+	}
+	for (int j = 0; j < pSigFlt->filter_count; ++j) {
+		xdb_filter_t *pFltr = pSigFlt->pFilters[j];
+		if ((pFltr->pField->fld_id != fld_id) || (XDB_TOK_EQ != pFltr->cmp_op)) {
 			continue;
 		}
-		for (fid = 0 ; fid < pIdxm->fld_count; ++fid) {
-			uint16_t fld_id = pIdxm->pFields[fid]->fld_id;
-			if (!(bmp[fld_id>>3] & (1<<(fld_id&7)))) {
+		if (pField->fld_type != XDB_TYPE_JSON) {
+			return j;
+		}
+		char *pIdxExt = pIdxm->pExtract[fid];
+		char *pExtract = pFltr->pExtract;
+		if ((NULL == pIdxExt) && (NULL == pExtract)) {
+			return j;
+		} else if (pIdxExt && pExtract && !strcmp (pIdxExt, pExtract)) {
+			return j;
+		}
+	}
+	return -1;
+}
+
+XDB_STATIC bool
+xdb_fltval_equal (xdb_filter_t *pFltr1, xdb_filter_t *pFltr2)
+{
+	xdb_value_t *pVal1 = &pFltr1->val, *pVal2 = &pFltr2->val;
+
+	if ((pVal1->val_type != pVal2->val_type) || ((NULL == pFltr1->pExtract) != (NULL == pFltr2->pExtract))) {
+		return false;
+	}
+	if ((NULL != pFltr1->pExtract) && strcmp (pFltr1->pExtract, pFltr2->pExtract)) {
+		return false;
+	}
+	switch (pVal1->val_type) {
+	case XDB_TYPE_BIGINT:
+		return pVal1->ival == pVal2->ival;
+	case XDB_TYPE_UBIGINT:
+		return pVal1->uval == pVal2->uval;
+	case XDB_TYPE_DOUBLE:
+		// FLOAT filter value is rounded when matched
+		if (XDB_TYPE_FLOAT == pFltr1->pField->fld_type) {
+			return (float)pVal1->fval == (float)pVal2->fval;
+		}
+		return pVal1->fval == pVal2->fval;
+	case XDB_TYPE_CHAR:
+		// string filter matches case-insensitively
+		return (pVal1->str.len == pVal2->str.len) && !strncasecmp (pVal1->str.str, pVal2->str.str, pVal1->str.len);
+	case XDB_TYPE_BINARY:
+		return (pVal1->str.len == pVal2->str.len) && !memcmp (pVal1->str.str, pVal2->str.str, pVal1->str.len);
+	case XDB_TYPE_INET:
+		return (pVal1->inet.family == pVal2->inet.family) && (pVal1->inet.mask == pVal2->inet.mask) && 
+				!memcmp (pVal1->inet.addr, pVal2->inet.addr, (4 == pVal1->inet.family) ? 4 : 16);
+	case XDB_TYPE_MAC:
+		return !memcmp (&pVal1->mac, &pVal2->mac, sizeof (pVal1->mac));
+	default:
+		return false;
+	}
+}
+
+// Partial index has all rows of filter list only if the list includes each index filter
+XDB_STATIC bool
+xdb_idx_fltmatch (xdb_idxm_t *pIdxm, xdb_singfilter_t *pSigFlt)
+{
+	for (int i = 0; i < pIdxm->filter_count; ++i) {
+		xdb_filter_t	*pIdxFlt = &pIdxm->filters[i];
+		int				j;
+		for (j = 0; j < pSigFlt->filter_count; ++j) {
+			xdb_filter_t *pFltr = pSigFlt->pFilters[j];
+			if ((pFltr->pField == pIdxFlt->pField) && (pFltr->cmp_op == pIdxFlt->cmp_op) && 
+				!pFltr->bBind && xdb_fltval_equal (pFltr, pIdxFlt)) {
 				break;
 			}
-			if (pIdxm->pFields[fid]->fld_type != XDB_TYPE_JSON) {
-				continue;
-			}
-			char *pIdxExt = pIdxm->pExtract[fid];
-			int j;
-			for (j = 0; j < pSigFlt->filter_count; ++j) {
-				if ((pSigFlt->pFilters[j]->pField->fld_id == fld_id)) {
-					char *pExtract = pSigFlt->pFilters[j]->pExtract;
-					if ((NULL == pIdxExt) && (NULL == pExtract)) {
-						break;
-					} else if (pIdxExt && pExtract && !strcmp (pIdxExt, pExtract)) {
-						break;
-					}
+		}
+		if (j == pSigFlt->filter_count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Distinct keys of index prefix k of n fields: keys^(k/n), solved by bisection (no libm)
+XDB_STATIC float
+xdb_idx_prefix_keys (xdb_rowid keys, int k, int n)
+{
+	if (n > 16) {
+		k = (k * 16 + n - 1) / n;
+		n = 16;
+	}
+	double	tgt = 1, lo = 1, hi = keys;
+	for (int i = 0; i < k; ++i) {
+		tgt *= keys;
+	}
+	for (int it = 0; it < 32; ++it) {
+		double mid = (lo + hi) / 2, v = 1;
+		for (int i = 0; i < n; ++i) {
+			v *= mid;
+		}
+		if (v < tgt) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// LPM index answers >>= (prefixes containing value) and <<= (prefixes inside value) only
+XDB_STATIC float
+xdb_idx_plan_lpm (xdb_idxm_t *pIdxm, xdb_singfilter_t *pSigFlt, xdb_idxfilter_t *pIdxFilter)
+{
+	xdb_rowid		rows, keys;
+	uint64_t		queries;
+	float			est, cost = 1;
+	int				flt;
+
+	for (flt = 0; flt < pSigFlt->filter_count; ++flt) {
+		xdb_filter_t *pFltr = pSigFlt->pFilters[flt];
+		if ((pFltr->pField == pIdxm->pFields[0]) && ((XDB_TOK_SUPEQ == pFltr->cmp_op) || (XDB_TOK_SUBEQ == pFltr->cmp_op))) {
+			break;
+		}
+	}
+	if (flt == pSigFlt->filter_count) {
+		return -1;
+	}
+
+	xdb_idx_stats (pIdxm, &rows, &keys, &queries);
+	if (keys <= 0) {
+		keys = 1;
+	}
+	if (XDB_TOK_SUPEQ == pSigFlt->pFilters[flt]->cmp_op) {
+		est = (float)rows / keys * XDB_LPM_PREFIXES;
+	} else {
+		est = rows * XDB_RANGE_SEL;
+	}
+	if (est > rows) {
+		est = rows;
+	}
+	// trie depth
+	for (xdb_rowid n = keys; n > 0; n >>= 1) {
+		cost++;
+	}
+	cost += est * XDB_COST_IDX_ROW;
+
+	if (NULL == pIdxFilter) {
+		return cost;
+	}
+
+	pIdxFilter->pIdxm		= pIdxm;
+	pIdxFilter->match_cnt	= 1;
+	pIdxFilter->match_opt	= pSigFlt->pFilters[flt]->cmp_op;
+	pIdxFilter->match_opt2	= -1;
+	pIdxFilter->pIdxVal2	= NULL;
+	pIdxFilter->pIdxVals[0]	= &pSigFlt->pFilters[flt]->val;
+	pIdxFilter->idx_flt_cnt	= 0;
+	pIdxFilter->est_rows	= est;
+	pIdxFilter->cost		= cost;
+	pIdxFilter->bCover		= false;
+	for (int j = 0; j < pSigFlt->filter_count; ++j) {
+		if (j != flt) {
+			pIdxFilter->pIdxFlts[pIdxFilter->idx_flt_cnt++] = pSigFlt->pFilters[j];
+		}
+	}
+
+	return cost;
+}
+
+// Cost of accessing rows by index, < 0 can't use. Fill pIdxFilter if not NULL.
+XDB_STATIC float
+xdb_idx_plan (xdb_idxm_t *pIdxm, xdb_singfilter_t *pSigFlt, uint8_t bmp[], xdb_idxfilter_t *pIdxFilter)
+{
+	int				eq_flt[XDB_MAX_MATCH_COL];
+	int				eq_cnt, lo = -1, hi = -1;
+	xdb_rowid		rows, keys;
+	uint64_t		queries;
+	float			est, cost;
+
+	if (xdb_unlikely (pIdxm->filter_count > 0) && !xdb_idx_fltmatch (pIdxm, pSigFlt)) {
+		return -1;
+	}
+	if (XDB_IDX_LPM == pIdxm->idx_type) {
+		return xdb_idx_plan_lpm (pIdxm, pSigFlt, pIdxFilter);
+	}
+
+	for (eq_cnt = 0; eq_cnt < pIdxm->fld_count; ++eq_cnt) {
+		eq_flt[eq_cnt] = xdb_idx_eqflt (pIdxm, eq_cnt, pSigFlt, bmp);
+		if (eq_flt[eq_cnt] < 0) {
+			break;
+		}
+	}
+
+	xdb_idx_stats (pIdxm, &rows, &keys, &queries);
+	if (keys <= 0) {
+		keys = 1;
+	}
+
+	if (eq_cnt == pIdxm->fld_count) {
+		est = (float)rows / keys;
+	} else {
+		// rbtree only: equal prefix and optional range on next field
+		if (XDB_IDX_RBTREE != pIdxm->idx_type) {
+			return -1;
+		}
+		xdb_field_t *pField = pIdxm->pFields[eq_cnt];
+		if (pField->fld_type != XDB_TYPE_JSON) {
+			for (int j = 0; j < pSigFlt->filter_count; ++j) {
+				xdb_filter_t *pFltr = pSigFlt->pFilters[j];
+				if ((pFltr->pField != pField) || (NULL != pFltr->pExtract)) {
+					continue;
+				}
+				if ((lo < 0) && ((XDB_TOK_GT == pFltr->cmp_op) || (XDB_TOK_GE == pFltr->cmp_op))) {
+					lo = j;
+				} else if ((hi < 0) && ((XDB_TOK_LT == pFltr->cmp_op) || (XDB_TOK_LE == pFltr->cmp_op))) {
+					hi = j;
 				}
 			}
-			if (j >= pSigFlt->filter_count) {
-				break;
-			}
 		}
+		if ((0 == eq_cnt) && (lo < 0) && (hi < 0)) {
+			return -1;
+		}
+		est = (float)rows / xdb_idx_prefix_keys (keys, eq_cnt, pIdxm->fld_count);
+		if (lo >= 0) {
+			est *= XDB_RANGE_SEL;
+		}
+		if (hi >= 0) {
+			est *= XDB_RANGE_SEL;
+		}
+	}
+
+	if ((XDB_IDX_HASH == pIdxm->idx_type) || (XDB_IDX_HASH2 == pIdxm->idx_type)) {
+		cost = XDB_COST_HASH_PROBE;
+	} else if (XDB_IDX_BITMAP == pIdxm->idx_type) {
+		cost = XDB_COST_HASH_PROBE + keys * XDB_COST_BMP_KEY;
+	} else {
+		cost = 1;
+		for (xdb_rowid n = keys; n > 0; n >>= 1) {
+			cost++;
+		}
+	}
+	cost += est * XDB_IDX_ROWCOST(pIdxm);
 
-		if (fid == pIdxm->fld_count) {
-			xdb_dbglog ("use index %s\n", XDB_OBJ_NAME(pIdxm));
-			xdb_idxfilter_t *pIdxFilter = &pSigFlt->idx_filter;
-			pIdxFilter->idx_flt_cnt = 0;
-			if (xdb_unlikely (XDB_IDX_RBTREE == pIdxm->idx_type)) {
-				pIdxFilter->match_opt = XDB_TOK_EQ;
-				pIdxFilter->match_opt2 = -1;
-				pIdxFilter->match_cnt = pIdxm->fld_count;
-			}
-			pIdxFilter->pIdxm = pIdxm;
-			int 		idx_id = XDB_OBJ_ID(pIdxm);
-
-			for (fid = 0; fid < pSigFlt->filter_count; ++fid) {
-				xdb_filter_t *pFltr = pSigFlt->pFilters[fid];
-				int idx_fid = pFltr->pField->idx_fid[idx_id];
-				if (idx_fid >= 0) {
-					// matched in index
-					pIdxFilter->pIdxVals[idx_fid] = &pFltr->val;
-				} else {
-					// extra filters
-					pIdxFilter->pIdxFlts[pIdxFilter->idx_flt_cnt++] = pFltr;
+	if (NULL == pIdxFilter) {
+		return cost;
+	}
+
+	pIdxFilter->pIdxm		= pIdxm;
+	pIdxFilter->match_cnt	= eq_cnt;
+	pIdxFilter->match_opt	= XDB_TOK_EQ;
+	pIdxFilter->match_opt2	= -1;
+	pIdxFilter->pIdxVal2	= NULL;
+	pIdxFilter->idx_flt_cnt	= 0;
+	pIdxFilter->est_rows	= est;
+	pIdxFilter->cost		= cost;
+	pIdxFilter->bCover		= false;
+	for (int i = 0; i < eq_cnt; ++i) {
+		pIdxFilter->pIdxVals[i] = &pSigFlt->pFilters[eq_flt[i]]->val;
+	}
+	if (lo >= 0) {
+		pIdxFilter->pIdxVals[eq_cnt] = &pSigFlt->pFilters[lo]->val;
+		pIdxFilter->match_opt = pSigFlt->pFilters[lo]->cmp_op;
+		pIdxFilter->match_cnt = eq_cnt + 1;
+		if (hi >= 0) {
+			pIdxFilter->pIdxVal2 = &pSigFlt->pFilters[hi]->val;
+			pIdxFilter->match_opt2 = pSigFlt->pFilters[hi]->cmp_op;
+		}
+	} else if (hi >= 0) {
+		pIdxFilter->pIdxVals[eq_cnt] = &pSigFlt->pFilters[hi]->val;
+		pIdxFilter->match_opt = pSigFlt->pFilters[hi]->cmp_op;
+		pIdxFilter->match_cnt = eq_cnt + 1;
+	}
+
+	// extra filters, range bounds are checked again for NULL rows
+	for (int j = 0; j < pSigFlt->filter_count; ++j) {
+		int i;
+		for (i = 0; (i < eq_cnt) && (eq_flt[i] != j); ++i)
+			;
+		if (i == eq_cnt) {
+			pIdxFilter->pIdxFlts[pIdxFilter->idx_flt_cnt++] = pSigFlt->pFilters[j];
+		}
+	}
+
+	return cost;
+}
+
+/*
+ * Several unselective EQ indexes: collect rowids of each index and intersect them,
+ * only survivors are filtered and returned. Smallest index drives, others are
+ * added while they save more than they cost. Bitmap index is tested per rowid
+ * without collecting, and its NE filter can exclude rowids of one key.
+ */
+XDB_STATIC void
+xdb_find_idx_and (xdb_tblm_t *pTblm, xdb_reftbl_t *pRefTbl, xdb_singfilter_t *pSigFlt, uint8_t bmp[])
+{
+	xdb_idxm_t	*pCands[XDB_MAX_INDEX];
+	float		ests[XDB_MAX_INDEX], probes[XDB_MAX_INDEX], ranks[XDB_MAX_INDEX];
+	int			ne_flts[XDB_MAX_INDEX], sels[XDB_MAX_INDEX];
+	int			cnt = 0, and_cnt = 0;
+	xdb_rowid	rows = 0, keys;
+	uint64_t	queries;
+
+	if (NULL == pRefTbl) {
+		return;
+	}
+	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		int fid, ne_flt = -1;
+		if ((XDB_IDX_LPM == pIdxm->idx_type) || !xdb_idx_fltmatch (pIdxm, pSigFlt)) {
+			continue;
+		}
+		for (fid = 0; (fid < pIdxm->fld_count) && (xdb_idx_eqflt (pIdxm, fid, pSigFlt, bmp) >= 0); ++fid)
+			;
+		if ((fid < pIdxm->fld_count) && (XDB_IDX_BITMAP == pIdxm->idx_type) && (1 == pIdxm->fld_count) && (NULL == pIdxm->pExtract[0])) {
+			for (int j = 0; j < pSigFlt->filter_count; ++j) {
+				xdb_filter_t *pFltr = pSigFlt->pFilters[j];
+				if ((pFltr->pField == pIdxm->pFields[0]) && (XDB_TOK_NE == pFltr->cmp_op) && (NULL == pFltr->pExtract)) {
+					ne_flt = j;
+					break;
 				}
 			}
-			pSigFlt->pIdxFilter = pIdxFilter;
-			return true;
 		}
+		if ((fid < pIdxm->fld_count) && (ne_flt < 0)) {
+			continue;
+		}
+		xdb_idx_stats (pIdxm, &rows, &keys, &queries);
+		if (keys <= 0) {
+			keys = 1;
+		}
+		float est, probe, rank;
+		if (ne_flt < 0) {
+			est = (float)rows / keys;
+			probe = xdb_idx_plan (pIdxm, pSigFlt, bmp, NULL) - est * XDB_IDX_ROWCOST(pIdxm);
+			rank = est;
+		} else {
+			// NE can't drive, keep after all EQ
+			est = rows - (float)rows / keys;
+			probe = XDB_COST_HASH_PROBE + keys * XDB_COST_BMP_KEY;
+			rank = rows + est;
+		}
+		// sort by estimate
+		int j;
+		for (j = cnt; (j > 0) && (ranks[j-1] > rank); --j) {
+			pCands[j] = pCands[j-1];
+			ests[j] = ests[j-1];
+			probes[j] = probes[j-1];
+			ranks[j] = ranks[j-1];
+			ne_flts[j] = ne_flts[j-1];
+		}
+		pCands[j] = pIdxm;
+		ests[j] = est;
+		probes[j] = probe;
+		ranks[j] = rank;
+		ne_flts[j] = ne_flt;
+		cnt++;
+	}
+	if ((cnt < 2) || (0 == rows) || (ne_flts[0] >= 0)) {
+		return;
+	}
+
+	// rows of driver are collected then filtered, bitmap driver isn't collected if all are bitmap
+	float est = ests[0], row_cost = XDB_IDX_ROWCOST(pCands[0]);
+	float cost = probes[0] + est * row_cost;
+	if (XDB_IDX_BITMAP != pCands[0]->idx_type) {
+		cost += est * XDB_COST_BMP_ROW;
+	}
+	for (int i = 1; (i < cnt) && (pRefTbl->and_count + and_cnt < XDB_MAX_AND_IDX); ++i) {
+		// independent columns
+		float est2 = est * ests[i] / rows;
+		float cost2 = cost + probes[i] - (est - est2) * row_cost;
+		if (XDB_IDX_BITMAP == pCands[i]->idx_type) {
+			cost2 += est * XDB_COST_BMP_TEST;
+		} else {
+			cost2 += ests[i] * XDB_COST_BMP_ROW;
+		}
+		if (cost2 < cost) {
+			sels[and_cnt++] = i;
+			est = est2;
+			cost = cost2;
+		}
+	}
+	if ((0 == and_cnt) || (cost >= pSigFlt->cost)) {
+		return;
+	}
+
+	xdb_dbglog ("intersect index %s with %d more cost %f\n", XDB_OBJ_NAME(pCands[0]), and_cnt, cost);
+	xdb_idx_plan (pCands[0], pSigFlt, bmp, &pSigFlt->idx_filter);
+	pSigFlt->idx_filter.idx_flt_cnt = 0;
+	pSigFlt->pAndFilters = &pRefTbl->and_filters[pRefTbl->and_count];
+	for (int i = 0; i < and_cnt; ++i) {
+		int				c = sels[i];
+		xdb_idxfilter_t	*pIdxFilter = &pSigFlt->pAndFilters[i];
+		if (ne_flts[c] < 0) {
+			xdb_idx_plan (pCands[c], pSigFlt, bmp, pIdxFilter);
+		} else {
+			pIdxFilter->pIdxm		= pCands[c];
+			pIdxFilter->match_cnt	= 1;
+			pIdxFilter->match_opt	= XDB_TOK_NE;
+			pIdxFilter->match_opt2	= -1;
+			pIdxFilter->pIdxVal2	= NULL;
+			pIdxFilter->pIdxVals[0]	= &pSigFlt->pFilters[ne_flts[c]]->val;
+			pIdxFilter->est_rows	= ests[c];
+			pIdxFilter->cost		= probes[c];
+		}
+		pIdxFilter->idx_flt_cnt = 0;
+	}
+	pRefTbl->and_count += and_cnt;
+	pSigFlt->and_count = and_cnt;
+	pSigFlt->est_rows = est;
+	pSigFlt->cost = cost;
+}
+
+// Pick cheapest index for one AND filter list
+XDB_STATIC bool
+xdb_find_idx (xdb_tblm_t	*pTblm, xdb_reftbl_t *pRefTbl, xdb_singfilter_t *pSigFlt, uint8_t 	bmp[])
+{
+	xdb_idxm_t	*pBest = NULL;
+	float		best_cost = 0;
+
+	for (int i = 0; i < XDB_OBJM_COUNT(pTblm->idx_objm); ++i) {
+		xdb_idxm_t *pIdxm = XDB_OBJM_GET(pTblm->idx_objm, pTblm->idx_order[i]);
+		float cost = xdb_idx_plan (pIdxm, pSigFlt, bmp, NULL);
+		if ((cost >= 0) && ((NULL == pBest) || (cost < best_cost))) {
+			pBest = pIdxm;
+			best_cost = cost;
+		}
+	}
+
+	if (NULL == pBest) {
+		return false;
+	}
+
+	xdb_dbglog ("use index %s cost %f\n", XDB_OBJ_NAME(pBest), best_cost);
+	xdb_idx_plan (pBest, pSigFlt, bmp, &pSigFlt->idx_filter);
+	pSigFlt->pIdxFilter = &pSigFlt->idx_filter;
+	pSigFlt->and_count = 0;
+	pSigFlt->est_rows = pSigFlt->idx_filter.est_rows;
+	pSigFlt->cost = best_cost;
+
+	xdb_find_idx_and (pTblm, pRefTbl, pSigFlt, bmp);
+	return true;
+}
+
+// Index access (OR-union of all branches) vs full scan
+XDB_STATIC bool
+xdb_plan_idx (xdb_tblm_t *pTblm, xdb_reftbl_t *pRefTbl)
+{
+	float	cost = 0, rows = 0;
+
+	for (int i = 0; i < pRefTbl->or_count; ++i) {
+		cost += pRefTbl->or_list[i].cost;
+		rows += pRefTbl->or_list[i].est_rows;
+	}
+	if (pRefTbl->or_count > 1) {
+		cost += rows * XDB_COST_OR_ROW;
+	}
+	pRefTbl->idx_cost = cost;
+
+	return cost <= pRefTbl->scan_cost;
+}
+
+// Convert filter value token to type of filter field
+XDB_STATIC int 
+xdb_parse_fltval (xdb_conn_t* pConn, xdb_filter_t *pFilter, xdb_token_type vtype, char *pVal, int vlen)
+{
+	xdb_field_t *pField = pFilter->pField;
+
+	switch (pField->fld_type) {
+	case XDB_TYPE_TIMESTAMP:
+		if (XDB_TOK_STR == vtype) {
+			pFilter->val.ival = xdb_timestamp_scanf (pVal);
+			pFilter->val.val_type = XDB_TYPE_BIGINT;
+			break;
+		}
+		// fall through
+	case XDB_TYPE_INT:
+	case XDB_TYPE_BIGINT:
+	case XDB_TYPE_TINYINT:
+	case XDB_TYPE_SMALLINT:
+		XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect INT Value");
+		pFilter->val.ival = atoll (pVal);
+		pFilter->val.val_type = XDB_TYPE_BIGINT;
+		//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
+		break;
+	case XDB_TYPE_UINT:
+	case XDB_TYPE_UBIGINT:
+	case XDB_TYPE_UTINYINT:
+	case XDB_TYPE_USMALLINT:
+		XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect INT Value");
+		pFilter->val.uval = atoll (pVal);
+		pFilter->val.val_type = XDB_TYPE_UBIGINT;
+		//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
+		break;
+	case XDB_TYPE_BOOL:
+		XDB_EXPECT ((XDB_TOK_ID == vtype), XDB_E_STMT, "Expect TRUE/FALSE");
+		if (!strcasecmp(pVal, "true")) {
+			pFilter->val.ival = 1;
+		} else {
+			XDB_EXPECT (!strcasecmp(pVal, "false"), XDB_E_STMT, "Expect TRUE/FALSE");
+			pFilter->val.ival = 0;
+		}
+		pFilter->val.val_type = XDB_TYPE_BIGINT;
+		break;
+	case XDB_TYPE_CHAR:
+	case XDB_TYPE_VCHAR:
+	case XDB_TYPE_JSON:
+		if (NULL == pFilter->pExtract) {
+			XDB_EXPECT (XDB_TOK_STR == vtype, XDB_E_STMT, "Expect string Value");
+			pFilter->val.str.len = vlen;
+			pFilter->val.str.str = pVal;
+			pFilter->val.val_type = XDB_TYPE_CHAR;
+			//xdb_dbgprint ("%s = %s\n", pField->fld_name.str, pFilter->val.str.str);
+		} else {
+			if (XDB_TOK_NUM == vtype) {
+				pFilter->val.ival = atoll (pVal);
+				pFilter->val.val_type = XDB_TYPE_BIGINT;
+			} else {
+				pFilter->val.str.len = vlen;
+				pFilter->val.str.str = pVal;
+				pFilter->val.val_type = XDB_TYPE_CHAR;
+			}
+		}
+		break;
+	case XDB_TYPE_BINARY:
+	case XDB_TYPE_VBINARY:
+		XDB_EXPECT (((XDB_TOK_STR == vtype) || (XDB_TOK_HEX == vtype)), XDB_E_STMT, "Expect Value");
+		pFilter->val.str.len = vlen;
+		pFilter->val.str.str = pVal;
+		pFilter->val.val_type = XDB_TYPE_BINARY;
+		//xdb_dbgprint ("%s = %s\n", pField->fld_name.str, pFilter->val.str.str);
+		break;
+	case XDB_TYPE_FLOAT:
+	case XDB_TYPE_DOUBLE:
+		XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect Value");
+		pFilter->val.fval = atof (pVal);
+		pFilter->val.val_type = XDB_TYPE_DOUBLE;
+		//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
+		break;
+	case XDB_TYPE_INET:
+		XDB_EXPECT (xdb_inet_scanf (&pFilter->val.inet, pVal),  XDB_E_STMT, "Invalid IP Addr");
+		pFilter->val.val_type = XDB_TYPE_INET;
+		break;
+	case XDB_TYPE_MAC:
+		XDB_EXPECT (xdb_mac_scanf (&pFilter->val.mac, pVal),  XDB_E_STMT, "Invalid MAC Addr");
+		pFilter->val.val_type = XDB_TYPE_MAC;
+		break;
 	}
 
-	return false;
+	return XDB_OK;
+
+error:
+	return -XDB_E_STMT;
 }
 
 XDB_STATIC int 
@@ -739,6 +1258,7 @@ xdb_parse_where (xdb_conn_t* pConn, xdb_stmt_select_t *pStmt, xdb_token_t *pTkn)
 	xdb_reftbl_t	*pRefTbl = &pStmt->ref_tbl[0];
 
 	pRefTbl->or_count = 1;
+	pRefTbl->and_count = 0;
 	xdb_singfilter_t	*pSigFlt = &pRefTbl->or_list[0];
 	pSigFlt->filter_count = 0;
 
@@ -814,6 +1334,9 @@ next_filter:
 			pField = xdb_find_field (pRefTbl[i].pRefTblm, pFldName, flen);
 		}
 		XDB_EXPECT (pField != NULL, XDB_E_STMT, "Can't find field '%s'", pFldName);
+		if (xdb_unlikely ((XDB_TOK_SUPEQ == op) || (XDB_TOK_SUBEQ == op))) {
+			XDB_EXPECT ((XDB_TYPE_INET == pField->fld_type) && (NULL == pExtract), XDB_E_STMT, "Operator '%s' needs INET field", xdb_tok2str(op));
+		}
 		if (xdb_unlikely (i > 0)) {
 			pRefTbl = &pRefTbl[i];
 			pTblm = pRefTbl->pRefTblm;
@@ -831,98 +1354,20 @@ next_filter:
 		}
 		pFilter->cmp_op = op;
 
+		pFilter->bBind = (XDB_TOK_QM == vtype);
 		if (xdb_unlikely (XDB_TOK_QM == vtype)) {
 			pFilter->val.fld_type = pField->fld_type;
 			pFilter->val.val_type = pField->sup_type;
 			pStmt->pBind[pStmt->bind_count++] = &pFilter->val;
 		} else {
-			switch (pField->fld_type) {
-			case XDB_TYPE_TIMESTAMP:
-				if (XDB_TOK_STR == vtype) {
-					pFilter->val.ival = xdb_timestamp_scanf (pVal);
-					pFilter->val.val_type = XDB_TYPE_BIGINT;
-					break;
-				}
-				// fall through
-			case XDB_TYPE_INT:
-			case XDB_TYPE_BIGINT:
-			case XDB_TYPE_TINYINT:
-			case XDB_TYPE_SMALLINT:
-				XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect INT Value");
-				pFilter->val.ival = atoll (pVal);
-				pFilter->val.val_type = XDB_TYPE_BIGINT;
-				//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
-				break;
-			case XDB_TYPE_UINT:
-			case XDB_TYPE_UBIGINT:
-			case XDB_TYPE_UTINYINT:
-			case XDB_TYPE_USMALLINT:
-				XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect INT Value");
-				pFilter->val.uval = atoll (pVal);
-				pFilter->val.val_type = XDB_TYPE_UBIGINT;
-				//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
-				break;
-			case XDB_TYPE_BOOL:
-				XDB_EXPECT ((XDB_TOK_ID == vtype), XDB_E_STMT, "Expect TRUE/FALSE");
-				if (!strcasecmp(pVal, "true")) {
-					pFilter->val.ival = 1;
-				} else {
-					XDB_EXPECT (!strcasecmp(pVal, "false"), XDB_E_STMT, "Expect TRUE/FALSE");
-					pFilter->val.ival = 0;
-				}
-				pFilter->val.val_type = XDB_TYPE_BIGINT;
-				break;
-			case XDB_TYPE_CHAR:
-			case XDB_TYPE_VCHAR:
-			case XDB_TYPE_JSON:
-				if (pExtract == NULL) {
-					XDB_EXPECT (XDB_TOK_STR == vtype, XDB_E_STMT, "Expect string Value");
-					pFilter->val.str.len = vlen;
-					pFilter->val.str.str = pVal;
-					pFilter->val.val_type = XDB_TYPE_CHAR;
-					//xdb_dbgprint ("%s = %s\n", pField->fld_name.str, pFilter->val.str.str);
-				} else {
-					if (XDB_TOK_NUM == vtype) {
-						pFilter->val.ival = atoll (pVal);
-						pFilter->val.val_type = XDB_TYPE_BIGINT;
-					} else {
-						pFilter->val.str.len = vlen;
-						pFilter->val.str.str = pVal;
-						pFilter->val.val_type = XDB_TYPE_CHAR;
-					}
-				}
-				break;
-			case XDB_TYPE_BINARY:
-			case XDB_TYPE_VBINARY:
-				XDB_EXPECT (((XDB_TOK_STR == vtype) || (XDB_TOK_HEX == vtype)), XDB_E_STMT, "Expect Value");
-				pFilter->val.str.len = vlen;
-				pFilter->val.str.str = pVal;
-				pFilter->val.val_type = XDB_TYPE_BINARY;
-				//xdb_dbgprint ("%s = %s\n", pField->fld_name.str, pFilter->val.str.str);
-				break;
-			case XDB_TYPE_FLOAT:
-			case XDB_TYPE_DOUBLE:
-				XDB_EXPECT (XDB_TOK_NUM == vtype, XDB_E_STMT, "Expect Value");
-				pFilter->val.fval = atof (pVal);
-				pFilter->val.val_type = XDB_TYPE_DOUBLE;
-				//xdb_dbgprint ("%s = %d\n", pField->fld_name.str, pFilter->val.ival);
-				break;
-			case XDB_TYPE_INET:
-				XDB_EXPECT (xdb_inet_scanf (&pFilter->val.inet, pVal),  XDB_E_STMT, "Invalid IP Addr");
-				pFilter->val.val_type = XDB_TYPE_INET;
-				break;
-			case XDB_TYPE_MAC:
-				XDB_EXPECT (xdb_mac_scanf (&pFilter->val.mac, pVal),  XDB_E_STMT, "Invalid MAC Addr");
-				pFilter->val.val_type = XDB_TYPE_MAC;
-				break;
-			}
+			XDB_EXPECT2 (xdb_parse_fltval (pConn, pFilter, vtype, pVal, vlen) >= XDB_OK);
 		}
 		type = xdb_next_token (pTkn);
 		if (xdb_unlikely (XDB_TOK_ID != type)) {
 			break;
 		} else if (!strcasecmp (pTkn->token, "OR")) {
 			if (pRefTbl->bUseIdx) {
-				pRefTbl->bUseIdx = xdb_find_idx (pTblm, pSigFlt, bmp);
+				pRefTbl->bUseIdx = xdb_find_idx (pTblm, pRefTbl, pSigFlt, bmp);
 			}
 			XDB_EXPECT (pRefTbl->or_count <= XDB_MAX_MATCH_OR, XDB_E_STMT, "Too many OR filters, MAX %d", XDB_MAX_MATCH_OR);
 			pSigFlt = &pRefTbl->or_list[pRefTbl->or_count++];
@@ -933,7 +1378,12 @@ next_filter:
 	} while (!strcasecmp (pTkn->token, "AND"));
 
 	if (pRefTbl->bUseIdx) {
-		pRefTbl->bUseIdx = xdb_find_idx (pTblm, pSigFlt, bmp);
+		pRefTbl->bUseIdx = xdb_find_idx (pTblm, pRefTbl, pSigFlt, bmp);
+	}
+	pRefTbl->idx_cost = 0;
+	pRefTbl->scan_cost = XDB_COST_SCAN_BASE + XDB_STG_MAXID(&pTblm->stg_mgr);
+	if (pRefTbl->bUseIdx) {
+		pRefTbl->bUseIdx = xdb_plan_idx (pTblm, pRefTbl);
 	}
 
 	return type;
@@ -968,7 +1418,18 @@ xdb_parse_select_cols (xdb_conn_t *pConn, xdb_stmt_select_t *pStmt, int meta_siz
 	xdb_col_t *pCol = (void*)pStmt->pMeta + pStmt->pMeta->cols_off;
 	uint64_t *pColList = (void*)pStmt->pMeta + meta_size;
 	pStmt->pMeta->col_list = (uintptr_t)pColList;
-	if (xdb_likely (0 == pStmt->agg_count + pStmt->exp_count)) {
+	// fields only result copies table row and NULL bitmap is by field id, so column i must be field i
+	if (xdb_likely (0 == pStmt->agg_count + pStmt->exp_count) && (1 == pStmt->reftbl_count)) {
+		for (int i = 0; i < pStmt->col_count; ++i) {
+			xdb_value_t *pVal = &pStmt->sel_cols[i].exp.op_val[0];
+			xdb_field_t *pField = xdb_find_field (pTblm, pVal->val_str.str, pVal->val_str.len);
+			if ((NULL != pField) && (pField->fld_id != i)) {
+				pStmt->bColRemap = true;
+				break;
+			}
+		}
+	}
+	if (xdb_likely (0 == pStmt->agg_count + pStmt->exp_count) && !pStmt->bColRemap) {
 		for (int i = 0; i < pStmt->col_count; ++i) {
 			xdb_selcol_t *pSelCol = &pStmt->sel_cols[i];
 			xdb_str_t *pName = &pSelCol->as_name;
@@ -1215,6 +1676,8 @@ xdb_parse_select (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt)
 	pStmt->pSql = NULL;
 	pStmt->meta_size = 0; // no alloc
 	pStmt->pTblm = NULL;
+	pStmt->pStructMap = NULL;
+	pStmt->callback = NULL;
 
 	xdb_init_where_stmt (pStmt);
 
@@ -1454,6 +1917,9 @@ xdb_parse_select (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt)
 
 error:
 	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	if (xdb_unlikely (bPStmt)) {
+		xdb_free (pStmt);
+	}
 	return NULL;
 }
 
@@ -1565,6 +2031,9 @@ xdb_parse_update (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt)
 
 error:
 	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	if (xdb_unlikely (bPStmt)) {
+		xdb_free (pStmt);
+	}
 	return NULL;
 }
 
@@ -1615,6 +2084,9 @@ xdb_parse_delete (xdb_conn_t* pConn, xdb_token_t *pTkn, bool bPStmt)
 
 error:
 	xdb_stmt_free ((xdb_stmt_t*)pStmt);
+	if (xdb_unlikely (bPStmt)) {
+		xdb_free (pStmt);
+	}
 	return NULL;
 }
 
@@ -18,6 +18,12 @@ xdb_parse_create_idx_def (xdb_conn_t* pConn, xdb_token_t *pTkn, xdb_stmt_idx_t *
 		type = xdb_next_token (pTkn);
 		if ((XDB_TOK_ID==type) && (!strcasecmp (pTkn->token, "BTREE") || !strcasecmp (pTkn->token, "RBTREE"))) {
 			pStmt->idx_type = XDB_IDX_RBTREE;
+		} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "BITMAP")) {
+			pStmt->idx_type = XDB_IDX_BITMAP;
+		} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "LPM")) {
+			pStmt->idx_type = XDB_IDX_LPM;
+		} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH2")) {
+			pStmt->idx_type = XDB_IDX_HASH2;
 		} else {
 			XDB_EXPECT ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH"), XDB_E_STMT, "Expect HASH");
 		}
@@ -49,6 +55,55 @@ xdb_parse_create_idx_def (xdb_conn_t* pConn, xdb_token_t *pTkn, xdb_stmt_idx_t *
 	XDB_EXPECT (XDB_TOK_RP==type, XDB_E_STMT, "Index Miss )");
 
 	type = xdb_next_token (pTkn);
+	pStmt->inc_count = 0;
+	if (XDB_TOK_ID==type && !strcasecmp (pTkn->token, "INCLUDE")) {
+		type = xdb_next_token (pTkn);
+		XDB_EXPECT (XDB_TOK_LP==type, XDB_E_STMT, "INCLUDE Miss (");
+		do {
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_ID==type, XDB_E_STMT, "INCLUDE Miss column");
+			XDB_EXPECT (pStmt->fld_count + pStmt->inc_count < XDB_MAX_MATCH_COL, XDB_E_STMT, "Too many index columns, MAX %d", XDB_MAX_MATCH_COL);
+			pStmt->inc_col[pStmt->inc_count++] = pTkn->token;
+			type = xdb_next_token (pTkn);
+		} while (XDB_TOK_COMMA == type);
+		XDB_EXPECT (XDB_TOK_RP==type, XDB_E_STMT, "INCLUDE Miss )");
+		type = xdb_next_token (pTkn);
+	}
+	// partial index: field op value [AND ...]
+	pStmt->filter_count = 0;
+	if (XDB_TOK_ID==type && !strcasecmp (pTkn->token, "WHERE")) {
+		do {
+			XDB_EXPECT (pStmt->filter_count < XDB_MAX_IDX_FILTER, XDB_E_STMT, "Too many index filters, MAX %d", XDB_MAX_IDX_FILTER);
+			xdb_stmt_idxflt_t *pFltr = &pStmt->filters[pStmt->filter_count++];
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT (XDB_TOK_ID==type, XDB_E_STMT, "Index filter Miss column");
+			pFltr->col = pTkn->token;
+			pFltr->extract = NULL;
+			type = xdb_next_token (pTkn);
+			if (XDB_TOK_EXTRACT == type) {
+				type = xdb_next_token (pTkn);
+				XDB_EXPECT (XDB_TOK_STR>=type, XDB_E_STMT, "Expect json extract string");
+				pFltr->extract = pTkn->token;
+				type = xdb_next_token (pTkn);
+			}
+			if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "LIKE")) {
+				type = XDB_TOK_LIKE;
+			}
+			XDB_EXPECT ((type >= XDB_TOK_EQ && type <= XDB_TOK_LIKE) || (XDB_TOK_NE == type), XDB_E_STMT, "Unsupported index filter operator %s", xdb_tok2str(type));
+			pFltr->cmp_op = type;
+			type = xdb_next_token (pTkn);
+			XDB_EXPECT ((XDB_TOK_ID==type) || (XDB_TOK_NUM==type) || (XDB_TOK_STR==type) || (XDB_TOK_HEX==type), XDB_E_STMT, "Index filter Miss value");
+			pFltr->vtype = type;
+			pFltr->val = pTkn->token;
+			pFltr->vlen = pTkn->tk_len;
+			type = xdb_next_token (pTkn);
+		} while (XDB_TOK_ID==type && !strcasecmp (pTkn->token, "AND"));
+	}
+	pStmt->bBloom = false;
+	if (XDB_TOK_ID==type && !strcasecmp (pTkn->token, "BLOOM")) {
+		pStmt->bBloom = true;
+		type = xdb_next_token (pTkn);
+	}
 	if (XDB_TOK_ID==type && !strcasecmp (pTkn->token, "XOID")) {
 		type = xdb_next_token (pTkn);
 		XDB_EXPECT (XDB_TOK_EQ==type, XDB_E_STMT, "Index option Expect EQ");
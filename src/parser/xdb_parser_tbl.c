@@ -115,6 +115,8 @@ xdb_parse_field (xdb_conn_t* pConn, xdb_token_t *pTkn, xdb_stmt_tbl_t *pStmt)
 			xdb_stmt_idx_t *pStmtIdx = &pStmt->stmt_idx[pStmt->idx_count++];
 			pStmtIdx->idx_type = XDB_IDX_HASH;
 			pStmtIdx->xoid	= -1;
+			pStmtIdx->inc_count = 0;
+			pStmtIdx->filter_count = 0;
 			
 			const char *idx_type = pTkn->token;			
 			type = xdb_next_token (pTkn);
@@ -144,8 +146,15 @@ xdb_parse_field (xdb_conn_t* pConn, xdb_token_t *pTkn, xdb_stmt_tbl_t *pStmt)
 				type = xdb_next_token (pTkn);
 				if ((XDB_TOK_ID==type) && (!strcasecmp (pTkn->token, "BTREE") || !strcasecmp (pTkn->token, "RBTREE"))) {
 					pStmtIdx->idx_type = XDB_IDX_RBTREE;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "BITMAP")) {
+					pStmtIdx->idx_type = XDB_IDX_BITMAP;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "LPM")) {
+					pStmtIdx->idx_type = XDB_IDX_LPM;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH2")) {
+					pStmtIdx->idx_type = XDB_IDX_HASH2;
+				} else {
+					XDB_EXPECT ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH"), XDB_E_STMT, "Expect HASH");
 				}
-				XDB_EXPECT ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH"), XDB_E_STMT, "Expect HASH");
 				type = xdb_next_token (pTkn);
 			}
 			pStmtIdx->fld_count = 1;
@@ -348,6 +357,12 @@ xdb_parse_create_table (xdb_conn_t* pConn, xdb_token_t *pTkn)
 				type = xdb_next_token (pTkn);
 				if ((XDB_TOK_ID==type) && (!strcasecmp (pTkn->token, "BTREE") || !strcasecmp (pTkn->token, "RBTREE"))) {
 					pStmtIdx->idx_type = XDB_IDX_RBTREE;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "BITMAP")) {
+					pStmtIdx->idx_type = XDB_IDX_BITMAP;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "LPM")) {
+					pStmtIdx->idx_type = XDB_IDX_LPM;
+				} else if ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH2")) {
+					pStmtIdx->idx_type = XDB_IDX_HASH2;
 				} else {
 					XDB_EXPECT ((XDB_TOK_ID==type) && !strcasecmp (pTkn->token, "HASH"), XDB_E_STMT, "Expect HASH");
 				}
@@ -160,6 +160,10 @@ typedef enum {
 	XDB_STMT_LOAD,
 	XDB_STMT_SOURCE,
 	XDB_STMT_DUMP_DB,
+	XDB_STMT_RESTORE_DB,
+	XDB_STMT_BACKUP_DB,
+	XDB_STMT_DUMP_TBL,
+	XDB_STMT_COPY,
 	XDB_STMT_SHELL,
 	XDB_STMT_HELP,
 } xdb_stmt_type;
@@ -209,8 +213,34 @@ typedef struct {
 	bool			bNoDrop;
 	bool			bNoCreate;
 	bool			bNoData;
+	char 	 		*archive;	// restore WAL archive dir
+	uint64_t		until_cid;
+	uint64_t		until_ts;
+	bool			bIncr;		// backup only changed tables
+	bool			bFast;		// source with parallel batched inserts
 } xdb_stmt_backup_t;
 
+typedef enum {
+	XDB_LOAD_CSV,
+	XDB_LOAD_BINARY,
+} xdb_load_fmt_e;
+
+typedef struct {
+	XDB_STMT_COMMON;
+	char 	 		*file;
+	char 	 		*tbl_name;
+	struct xdb_tblm_t	*pTblm;
+	xdb_load_fmt_e	format;
+	char			delim;		// CSV field delimiter
+	uint32_t		skip_lines;	// CSV header lines to skip
+} xdb_stmt_load_t;
+
+typedef struct {
+	XDB_STMT_COMMON;
+	char 	 		*file;
+	char 	 		*query;		// SELECT text, run when COPY executes
+} xdb_stmt_copy_t;
+
 typedef struct {
 	XDB_STMT_COMMON;
 	bool			bIfExistOrNot;
@@ -247,7 +277,10 @@ typedef struct {
 typedef enum {
 	XDB_IDX_HASH 		= 0,
 	XDB_IDX_RBTREE		= 1,
-	XDB_IDX_MAX 		= 3,
+	XDB_IDX_BITMAP		= 2,
+	XDB_IDX_LPM			= 3,
+	XDB_IDX_HASH2		= 4,
+	XDB_IDX_MAX 		= 5,
 } xdb_idx_type;
 
 typedef enum {
@@ -256,6 +289,16 @@ typedef enum {
 	XDB_IDX_RANGE		= (1<<2),  // support range
 } xdb_idx_flag;
 
+// partial index filter, value is token text and converted when index is created
+typedef struct {
+	char				*col;
+	char				*extract;
+	uint8_t				cmp_op;		// xdb_token_type
+	uint8_t				vtype;		// value xdb_token_type
+	int					vlen;
+	char				*val;
+} xdb_stmt_idxflt_t;
+
 typedef struct {
 	XDB_STMT_COMMON;
 	
@@ -263,6 +306,7 @@ typedef struct {
 	char				idxName[XDB_NAME_LEN+1];
 	bool				bUnique;
 	bool				bPrimary;
+	bool				bBloom;		// HASH index with Bloom filter
 	xdb_idx_type		idx_type;
 	int					xoid;
 	struct xdb_tblm_t	*pTblm;
@@ -271,6 +315,10 @@ typedef struct {
 	//xdb_field_t			*pFields[XDB_MAX_MATCH_COL];
 	char 				*idx_col[XDB_MAX_MATCH_COL];
 	char 				*idx_extract[XDB_MAX_MATCH_COL];
+	int					inc_count;
+	char 				*inc_col[XDB_MAX_MATCH_COL];	// INCLUDE columns
+	int					filter_count;
+	xdb_stmt_idxflt_t	filters[XDB_MAX_IDX_FILTER];	// WHERE of partial index
 } xdb_stmt_idx_t;
 
 typedef enum {
@@ -320,6 +368,7 @@ typedef struct xdb_filter_t {
 	//uint8_t			fld_type;	
 //	uint16_t		fld_off;
 //	uint16_t		fld_id;
+	bool			bBind;		// val is set by ? binding
 	xdb_field_t		*pField;
 	char			*pExtract;
 	xdb_value_t		val;
@@ -351,18 +400,27 @@ typedef struct {
 	int					match_cnt;
 	xdb_token_type		match_opt, match_opt2;
 	xdb_value_t 		*pIdxVals[XDB_MAX_MATCH_COL];
+	xdb_value_t 		*pIdxVal2;	// upper bound of last match field for match_opt2
 	xdb_filter_t		*pIdxFlts[XDB_MAX_MATCH_COL];
 	int 				idx_flt_cnt;
+	float				est_rows;	// planner estimate
+	float				cost;
+	bool				bCover;		// index-only, rows are index covers set by select
 } xdb_idxfilter_t;
 
 typedef struct {
 	xdb_filter_t		*pFilters[XDB_MAX_MATCH_COL/4];
 	xdb_idxfilter_t 	idx_filter;
 	xdb_idxfilter_t 	*pIdxFilter;
+	xdb_idxfilter_t 	*pAndFilters;	// rowids are intersected with pIdxFilter rows
 	uint8_t				filter_count;
+	uint8_t				and_count;
+	float				est_rows;	// planner estimate of branch
+	float				cost;
 } xdb_singfilter_t;
 
 #define XDB_MAX_MATCH_OR	64
+#define XDB_MAX_AND_IDX		8
 
 typedef struct {
 	xdb_field_t			*pField[XDB_MAX_MATCH_COL];
@@ -379,7 +437,11 @@ typedef struct {
 	uint8_t				or_count;
 	xdb_filter_t		filters[XDB_MAX_MATCH_COL*16];
 	xdb_singfilter_t	or_list[XDB_MAX_MATCH_OR];
+	uint8_t				and_count;
+	xdb_idxfilter_t 	and_filters[XDB_MAX_AND_IDX];
 	bool				bUseIdx;
+	float				idx_cost;	// planner cost of index access, 0 no usable index
+	float				scan_cost;
 } xdb_reftbl_t;
 
 typedef struct {
@@ -395,7 +457,7 @@ typedef struct {
 	uint16_t		set_bind_count;
 	uint16_t		set_count;
 	uint8_t			reftbl_count;
-	uint8_t			rsvd;
+	bool			bColRemap;	// fields only result, but column i isn't field i
 
 	// bind value
 	xdb_value_t	*pBind[XDB_MAX_MATCH_COL];
@@ -434,6 +496,8 @@ typedef struct {
 	xdb_row_callback 	callback;
 	void 				*pCbArg;
 
+	struct xdb_structmap_t	*pStructMap;
+
 	bool			bRegexp;
 } xdb_stmt_select_t;
 
@@ -442,6 +506,12 @@ typedef struct {
 	const		char *datadir;
 	const		char *format;
 	const		char *svrid;
+	const		char *ckpt_period;
+	const		char *ckpt_threads;
+	const		char *ckpt_wal_size;
+	const		char *ckpt_dirty_size;
+	const		char *ckpt_io_rate;
+	const		char *wal_archive;
 } xdb_stmt_set_t;
 
 typedef enum {
@@ -516,6 +586,8 @@ typedef struct {
 
 	xdb_field_t		*pBind[XDB_MAX_COLUMN];
 	void			*pBindRow[XDB_MAX_COLUMN];
+
+	struct xdb_structmap_t	*pStructMap;
 } xdb_stmt_insert_t;
 
 typedef struct {
@@ -542,6 +614,8 @@ typedef union {
 	xdb_stmt_replica_t	replica_stmt;
 	xdb_stmt_lock_t		lock_stmt;
 	xdb_stmt_backup_t	backup_stmt;
+	xdb_stmt_load_t		load_stmt;
+	xdb_stmt_copy_t		copy_stmt;
 } xdb_stmt_union_t;
 
 XDB_STATIC void 
@@ -76,6 +76,8 @@ static const char* xdb_tok2str(xdb_token_type tp)
 		[XDB_TOK_GT   ] = ">",
 		[XDB_TOK_GE   ] = ">=",
 		[XDB_TOK_NE   ] = "<>",
+		[XDB_TOK_SUPEQ] = ">>=",
+		[XDB_TOK_SUBEQ] = "<<=",
 		[XDB_TOK_ADD  ] = "+",
 		[XDB_TOK_SUB  ] = "-",
 		[XDB_TOK_MUL  ] = "*",
@@ -252,6 +254,10 @@ parse_ch:
 			pTkn->tk_sql += 2;
 			pTkn->tk_type = XDB_TOK_GE;
 			return XDB_TOK_GE;
+		} else if ((XDB_TOK_GT == ch) && (XDB_TOK_EQ == s_tok_type[(uint8_t)*(pTkn->tk_sql+2)])) {
+			pTkn->tk_sql += 3;
+			pTkn->tk_type = XDB_TOK_SUPEQ;
+			return XDB_TOK_SUPEQ;
 		}
 		pTkn->tk_sql++;
 		pTkn->tk_type = XDB_TOK_GT;
@@ -266,6 +272,10 @@ parse_ch:
 			pTkn->tk_sql += 2;
 			pTkn->tk_type = XDB_TOK_NE;
 			return XDB_TOK_NE;
+		} else if ((XDB_TOK_LT == ch) && (XDB_TOK_EQ == s_tok_type[(uint8_t)*(pTkn->tk_sql+2)])) {
+			pTkn->tk_sql += 3;
+			pTkn->tk_type = XDB_TOK_SUBEQ;
+			return XDB_TOK_SUBEQ;
 		}
 		pTkn->tk_sql++;
 		pTkn->tk_type = XDB_TOK_LT;
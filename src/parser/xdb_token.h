@@ -26,6 +26,8 @@ typedef enum {
 	XDB_TOK_BTWN,
 	XDB_TOK_REGEXP,
 	XDB_TOK_IN,
+	XDB_TOK_SUPEQ,	// >>= INET contains or equals
+	XDB_TOK_SUBEQ,	// <<= INET is contained by or equals
 	XDB_TOK_NE, 	// != <>
 	XDB_TOK_EXTRACT,	// ->
 	XDB_TOK_ADD, 	// +
@@ -0,0 +1,382 @@
+#define XDB_API_ROWS	100
+
+// s is NULL for id%10==5, b is id%2
+#define XDB_API_TBL(pConn, tbl)	\
+	pRes = xdb_exec (pConn, "CREATE TABLE " tbl " (id INT PRIMARY KEY, i64 BIGINT, d DOUBLE, s VARCHAR(16), c CHAR(8), b BOOL)");	\
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));	\
+	for (int i = 0; i < XDB_API_ROWS; ++i) {	\
+		if (5 == i % 10) {	\
+			pRes = xdb_pexec (pConn, "INSERT INTO " tbl " VALUES (%d, %"PRId64", %d.5, NULL, 'c%d', %s)", i, i * 1000000000LL, i, i, (i % 2) ? "true" : "false");	\
+		} else {	\
+			pRes = xdb_pexec (pConn, "INSERT INTO " tbl " VALUES (%d, %"PRId64", %d.5, 's%d', 'c%d', %s)", i, i * 1000000000LL, i, i, i, (i % 2) ? "true" : "false");	\
+		}	\
+		CHECK_AFFECT (pRes, 1);	\
+	}
+
+UTEST_I(XdbTest, fetch_arrow, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	XDB_API_TBL (pConn, "api");
+
+	struct ArrowSchema	schema;
+	struct ArrowArray	array;
+
+	pRes = xdb_exec (pConn, "SELECT id, s, b FROM api ORDER BY id");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_fetch_arrow (pRes, 64, &schema, &array), XDB_OK);
+
+	ASSERT_STREQ (schema.format, "+s");
+	ASSERT_EQ (schema.n_children, 3);
+	ASSERT_STREQ (schema.children[0]->format, "i");
+	ASSERT_STREQ (schema.children[0]->name, "id");
+	ASSERT_STREQ (schema.children[1]->format, "u");
+	ASSERT_STREQ (schema.children[1]->name, "s");
+	ASSERT_STREQ (schema.children[2]->format, "b");
+
+	ASSERT_EQ (array.length, 64);
+	ASSERT_EQ (array.n_children, 3);
+	const int32_t *pIds = array.children[0]->buffers[1];
+	struct ArrowArray *pStr = array.children[1];
+	const uint8_t *pValid = pStr->buffers[0], *pBits = array.children[2]->buffers[1];
+	const int32_t *pOffs = pStr->buffers[1];
+	const char *pData = pStr->buffers[2];
+	ASSERT_EQ (array.children[0]->null_count, 0);
+	// 5, 15, ... 55
+	ASSERT_EQ (pStr->null_count, 6);
+	for (int i = 0; i < 64; ++i) {
+		char str[16];
+		ASSERT_EQ (pIds[i], i);
+		int bit = (pBits[i >> 3] >> (i & 7)) & 1;
+		ASSERT_EQ (bit, i % 2);
+		bool bValid = (pValid[i >> 3] >> (i & 7)) & 1;
+		ASSERT_EQ (bValid, 5 != i % 10);
+		int len = bValid ? snprintf (str, sizeof (str), "s%d", i) : 0;
+		ASSERT_EQ (pOffs[i + 1] - pOffs[i], len);
+		ASSERT_EQ (memcmp (pData + pOffs[i], str, len), 0);
+	}
+	schema.release (&schema);
+	array.release (&array);
+	ASSERT_TRUE (NULL == schema.release);
+	ASSERT_TRUE (NULL == array.release);
+
+	// rest rows without schema, then end
+	ASSERT_EQ (xdb_fetch_arrow (pRes, 0, NULL, &array), XDB_OK);
+	ASSERT_EQ (array.length, XDB_API_ROWS - 64);
+	ASSERT_EQ (((const int32_t*)array.children[0]->buffers[1])[0], 64);
+	array.release (&array);
+	ASSERT_EQ (xdb_fetch_arrow (pRes, 0, NULL, &array), XDB_OK);
+	ASSERT_EQ (array.length, 0);
+	array.release (&array);
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "DROP TABLE api");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
+
+UTEST_I(XdbTest, copy_arrow, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	XDB_API_TBL (pConn, "api");
+
+	pRes = xdb_exec (pConn, "COPY (SELECT * FROM api WHERE id<50) TO 'xdb_api.arrow' FORMAT ARROW");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE (NULL != strstr (xdb_errmsg(pRes), "Copy 50 rows"));
+
+	// IPC file has magic at both ends
+	char head[8], tail[6];
+	FILE *pFile = fopen ("xdb_api.arrow", "rb");
+	ASSERT_TRUE (pFile!=NULL);
+	ASSERT_EQ (fread (head, 1, 8, pFile), 8);
+	ASSERT_EQ (fseek (pFile, -6, SEEK_END), 0);
+	ASSERT_EQ (fread (tail, 1, 6, pFile), 6);
+	ASSERT_GT (ftell (pFile), 64);
+	fclose (pFile);
+	ASSERT_EQ (memcmp (head, "ARROW1\0\0", 8), 0);
+	ASSERT_EQ (memcmp (tail, "ARROW1", 6), 0);
+	remove ("xdb_api.arrow");
+
+	pRes = xdb_exec (pConn, "COPY (SELECT * FROM nosuch) TO 'xdb_api.arrow' FORMAT ARROW");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+
+	pRes = xdb_exec (pConn, "DROP TABLE api");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
+
+// schema and footer flatbuffers outgrow initial buffer
+UTEST_I(XdbTest, copy_arrow_wide, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	char sql[4096], name[64];
+	int len = sprintf (sql, "CREATE TABLE wide (id INT PRIMARY KEY");
+	for (int i = 1; i < 24; ++i) {
+		len += sprintf (sql + len, ", wide_column_with_long_name_%02d INT", i);
+	}
+	strcpy (sql + len, ")");
+	pRes = xdb_exec (pConn, sql);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "INSERT INTO wide (id, wide_column_with_long_name_23) VALUES (1, 23)");
+	CHECK_AFFECT (pRes, 1);
+
+	pRes = xdb_exec (pConn, "COPY (SELECT * FROM wide) TO 'xdb_api.arrow' FORMAT ARROW");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	// every column name is in schema message and in footer
+	FILE *pFile = fopen ("xdb_api.arrow", "rb");
+	ASSERT_TRUE (pFile!=NULL);
+	static char buf[64 * 1024];
+	size_t size = fread (buf, 1, sizeof (buf), pFile);
+	fclose (pFile);
+	ASSERT_EQ (memcmp (buf + size - 6, "ARROW1", 6), 0);
+	for (int i = 1; i < 24; ++i) {
+		int nlen = sprintf (name, "wide_column_with_long_name_%02d", i), found = 0;
+		for (size_t pos = 0; pos + nlen <= size; ++pos) {
+			found += !memcmp (buf + pos, name, nlen);
+		}
+		ASSERT_EQ (found, 2);
+	}
+	remove ("xdb_api.arrow");
+
+	pRes = xdb_exec (pConn, "DROP TABLE wide");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
+
+UTEST_I(XdbTest, fetch_cols, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	XDB_API_TBL (pConn, "api");
+
+	int			ids[XDB_API_ROWS];
+	int64_t		i64s[XDB_API_ROWS];
+	double		ds[XDB_API_ROWS];
+	char		sdata[XDB_API_ROWS * 4];
+	uint32_t	soffs[XDB_API_ROWS + 1];
+	uint8_t		snull[XDB_API_ROWS];
+	xdb_colbuf_t bufs[5];
+
+	// c is skipped
+	memset (bufs, 0, sizeof (bufs));
+	bufs[0].pData = ids;
+	bufs[1].pData = i64s;
+	bufs[2].pData = ds;
+	bufs[3] = (xdb_colbuf_t){.pData = sdata, .pOffs = soffs, .pNull = snull, .data_cap = sizeof (sdata)};
+
+	pRes = xdb_exec (pConn, "SELECT id, i64, d, s, c FROM api ORDER BY id");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	int total = 0, n;
+	while ((n = xdb_fetch_cols (pRes, 30, bufs)) > 0) {
+		ASSERT_LE (n, 30);
+		ASSERT_EQ (soffs[0], 0);
+		for (int i = 0; i < n; ++i) {
+			int id = total + i;
+			char str[16];
+			ASSERT_EQ (ids[i], id);
+			ASSERT_EQ (i64s[i], id * 1000000000LL);
+			ASSERT_EQ (ds[i], id + 0.5);
+			ASSERT_EQ (snull[i], 5 == id % 10);
+			int len = snull[i] ? 0 : snprintf (str, sizeof (str), "s%d", id);
+			ASSERT_EQ (soffs[i + 1] - soffs[i], len);
+			ASSERT_EQ (memcmp (sdata + soffs[i], str, len), 0);
+		}
+		total += n;
+	}
+	ASSERT_EQ (n, 0);
+	ASSERT_EQ (total, XDB_API_ROWS);
+	xdb_free_result (pRes);
+
+	// var data buffer limits rows, first row must fit
+	bufs[3].data_cap = 5;
+	pRes = xdb_exec (pConn, "SELECT id, i64, d, s, c FROM api WHERE id<20 ORDER BY id");
+	ASSERT_EQ (xdb_fetch_cols (pRes, 0, bufs), 2);
+	ASSERT_EQ (soffs[2], 4);
+	ASSERT_EQ (xdb_fetch_cols (pRes, 0, bufs), 2);
+	ASSERT_EQ (ids[0], 2);
+	bufs[3].data_cap = 2;
+	ASSERT_EQ (xdb_fetch_cols (pRes, 0, bufs), 2);
+	ASSERT_EQ (ids[1], 5);
+	ASSERT_EQ (snull[1], 1);
+	for (int id = 6; id < 10; ++id) {
+		ASSERT_EQ (xdb_fetch_cols (pRes, 0, bufs), 1);
+		ASSERT_EQ (ids[0], id);
+	}
+	// "s10" doesn't fit
+	ASSERT_EQ (xdb_fetch_cols (pRes, 0, bufs), -XDB_E_MEMORY);
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "DROP TABLE api");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
+
+typedef struct {
+	int			id;
+	int64_t		i64;
+	float		d;		// converted from DOUBLE
+	const char	*s;
+	char		c[8];
+	bool		b;
+} xdb_api_row_t;
+
+static const xdb_struct_field_t s_xdb_api_fields[] = {
+	XDB_STRUCT_FIELD (xdb_api_row_t, id,  XDB_TYPE_INT,    "id"),
+	XDB_STRUCT_FIELD (xdb_api_row_t, i64, XDB_TYPE_BIGINT, "i64"),
+	XDB_STRUCT_FIELD (xdb_api_row_t, d,   XDB_TYPE_FLOAT,  "d"),
+	XDB_STRUCT_FIELD (xdb_api_row_t, s,   XDB_TYPE_VCHAR,  "s"),
+	XDB_STRUCT_FIELD (xdb_api_row_t, c,   XDB_TYPE_CHAR,   "c"),
+	XDB_STRUCT_FIELD (xdb_api_row_t, b,   XDB_TYPE_BOOL,   "b"),
+};
+
+UTEST_I(XdbTest, struct_map, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	xdb_api_row_t rows[XDB_API_ROWS];
+	char strs[XDB_API_ROWS][16];
+
+	pRes = xdb_exec (pConn, "CREATE TABLE api (id INT PRIMARY KEY, i64 BIGINT, d DOUBLE, s VARCHAR(16), c CHAR(8), b BOOL)");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	xdb_stmt_t *pStmt = xdb_stmt_prepare (pConn, "INSERT INTO api (id, i64, d, s, c, b) VALUES (?, ?, ?, ?, ?, ?)");
+	ASSERT_TRUE (pStmt!=NULL);
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, s_xdb_api_fields, 6, sizeof (xdb_api_row_t)), XDB_OK);
+	for (int i = 0; i < XDB_API_ROWS; ++i) {
+		snprintf (strs[i], sizeof (strs[i]), "s%d", i);
+		rows[i] = (xdb_api_row_t){.id = i, .i64 = i * 1000000000LL, .d = i + 0.5, .s = strs[i], .b = i % 2};
+		snprintf (rows[i].c, sizeof (rows[i].c), "c%d", i);
+	}
+	// CHAR array without NUL
+	memcpy (rows[7].c, "12345678", 8);
+	pRes = xdb_insert_struct (pStmt, rows, XDB_API_ROWS);
+	CHECK_AFFECT (pRes, XDB_API_ROWS);
+	// too long for VARCHAR(16)
+	rows[0].id = 1000;
+	rows[0].s = "01234567890123456789";
+	pRes = xdb_insert_struct (pStmt, rows, 1);
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_stmt_close (pStmt);
+
+	pRes = xdb_exec (pConn, "UPDATE api SET s=NULL WHERE id=5");
+	CHECK_AFFECT (pRes, 1);
+
+	pStmt = xdb_stmt_prepare (pConn, "SELECT * FROM api ORDER BY id");
+	ASSERT_TRUE (pStmt!=NULL);
+	// fields map by name in any order
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, s_xdb_api_fields, 6, sizeof (xdb_api_row_t)), XDB_OK);
+	pRes = xdb_stmt_exec (pStmt);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	memset (rows, 0xff, sizeof (rows));
+	ASSERT_EQ (xdb_fetch_struct (pRes, &rows[0]), 1);
+	ASSERT_EQ (xdb_fetch_structs (pRes, &rows[1], XDB_API_ROWS), XDB_API_ROWS - 1);
+	ASSERT_EQ (xdb_fetch_struct (pRes, &rows[0]), 0);
+	for (int i = 1; i < XDB_API_ROWS; ++i) {
+		char str[16];
+		ASSERT_EQ (rows[i].id, i);
+		ASSERT_EQ (rows[i].i64, i * 1000000000LL);
+		ASSERT_EQ (rows[i].d, i + 0.5f);
+		ASSERT_EQ (rows[i].b, i % 2);
+		snprintf (str, sizeof (str), "c%d", i);
+		ASSERT_STREQ (rows[i].c, 7 == i ? "1234567" : str);
+		if (5 == i) {
+			// NULL is fetched as zero
+			ASSERT_TRUE (NULL == rows[i].s);
+		} else {
+			snprintf (str, sizeof (str), "s%d", i);
+			ASSERT_STREQ (rows[i].s, str);
+		}
+	}
+	xdb_free_result (pRes);
+
+	// fetch needs mapping of this statement
+	pRes = xdb_exec (pConn, "SELECT * FROM api");
+	ASSERT_EQ (xdb_fetch_struct (pRes, &rows[0]), -XDB_E_PARAM);
+	xdb_free_result (pRes);
+
+	const xdb_struct_field_t bad_name[] = {XDB_STRUCT_FIELD (xdb_api_row_t, id, XDB_TYPE_INT, "nosuch")};
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, bad_name, 1, sizeof (xdb_api_row_t)), -XDB_E_NOTFOUND);
+	const xdb_struct_field_t bad_type[] = {XDB_STRUCT_FIELD (xdb_api_row_t, s, XDB_TYPE_VCHAR, "id")};
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, bad_type, 1, sizeof (xdb_api_row_t)), -XDB_E_PARAM);
+	xdb_stmt_close (pStmt);
+
+	pRes = xdb_exec (pConn, "DROP TABLE api");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
+
+typedef struct {
+	int			id;
+	int			age;
+	bool		age_null;
+	char		name[16];
+	bool		name_null;
+} xdb_api_null_t;
+
+static const xdb_struct_field_t s_xdb_api_null_fields[] = {
+	XDB_STRUCT_FIELD (xdb_api_null_t, id,   XDB_TYPE_INT,  "id"),
+	XDB_STRUCT_FIELD (xdb_api_null_t, age,  XDB_TYPE_INT,  "age"),
+	XDB_STRUCT_NULL  (xdb_api_null_t, age_null,            "age"),
+	XDB_STRUCT_FIELD (xdb_api_null_t, name, XDB_TYPE_CHAR, "name"),
+	XDB_STRUCT_NULL  (xdb_api_null_t, name_null,           "name"),
+};
+
+UTEST_I(XdbTest, struct_map_null, 2)
+{
+	xdb_res_t *pRes;
+	xdb_row_t *pRow;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	xdb_api_null_t rows[4];
+
+	pRes = xdb_exec (pConn, "CREATE TABLE apinull (id INT PRIMARY KEY, age INT, name CHAR(15))");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	xdb_stmt_t *pStmt = xdb_stmt_prepare (pConn, "INSERT INTO apinull (id, age, name) VALUES (?, ?, ?)");
+	ASSERT_TRUE (pStmt!=NULL);
+	// primary key is NOT NULL
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, &(xdb_struct_field_t)XDB_STRUCT_NULL (xdb_api_null_t, age_null, "id"), 1, sizeof (xdb_api_null_t)), -XDB_E_PARAM);
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, s_xdb_api_null_fields, 5, sizeof (xdb_api_null_t)), XDB_OK);
+	for (int i = 0; i < 4; ++i) {
+		rows[i] = (xdb_api_null_t){.id = i, .age = 20 + i, .age_null = (1 == i), .name_null = (i >= 2)};
+		snprintf (rows[i].name, sizeof (rows[i].name), "n%d", i);
+	}
+	pRes = xdb_insert_struct (pStmt, rows, 4);
+	CHECK_AFFECT (pRes, 4);
+	xdb_stmt_close (pStmt);
+
+	pRes = xdb_exec (pConn, "SELECT age, name FROM apinull ORDER BY id");
+	CHECK_EXP (pRes, 4, ASSERT_EQ (xdb_column_null (pRes, pRow, 0), 1 == count); ASSERT_EQ (xdb_column_null (pRes, pRow, 1), count >= 2));
+
+	pStmt = xdb_stmt_prepare (pConn, "SELECT * FROM apinull ORDER BY id");
+	ASSERT_TRUE (pStmt!=NULL);
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, s_xdb_api_null_fields, 5, sizeof (xdb_api_null_t)), XDB_OK);
+	pRes = xdb_stmt_exec (pStmt);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	// remap doesn't affect result already returned
+	ASSERT_EQ (xdb_stmt_map_struct (pStmt, s_xdb_api_null_fields, 1, sizeof (xdb_api_null_t)), XDB_OK);
+
+	memset (rows, 0xff, sizeof (rows));
+	ASSERT_EQ (xdb_fetch_structs (pRes, rows, 4), 4);
+	for (int i = 0; i < 4; ++i) {
+		char str[16];
+		ASSERT_EQ (rows[i].id, i);
+		ASSERT_EQ (rows[i].age_null, 1 == i);
+		ASSERT_EQ (rows[i].age, 1 == i ? 0 : 20 + i);
+		ASSERT_EQ (rows[i].name_null, i >= 2);
+		snprintf (str, sizeof (str), "n%d", i);
+		ASSERT_STREQ (rows[i].name, i >= 2 ? "" : str);
+	}
+	xdb_free_result (pRes);
+
+	// new mapping is used by next result
+	pRes = xdb_stmt_exec (pStmt);
+	memset (rows, 0xff, sizeof (rows));
+	ASSERT_EQ (xdb_fetch_struct (pRes, &rows[0]), 1);
+	ASSERT_EQ (rows[0].id, 0);
+	ASSERT_EQ (rows[0].age, -1);
+	xdb_free_result (pRes);
+	xdb_stmt_close (pStmt);
+
+	pRes = xdb_exec (pConn, "DROP TABLE apinull");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+}
@@ -0,0 +1,245 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#define XDB_CKPT_DB		"ckptdb"
+#define XDB_CKPT_ROWS	10000
+
+typedef struct {
+	int			id;
+	volatile int	*pDone;
+	int			errors;
+} xdb_ckpt_writer_t;
+
+static void* xdb_ckpt_writer (void *pArg)
+{
+	xdb_ckpt_writer_t *pWriter = pArg;
+	xdb_conn_t *pConn = xdb_open (XDB_CKPT_DB);
+	for (int i = 0; i < XDB_CKPT_ROWS; ++i) {
+		int id = pWriter->id * XDB_CKPT_ROWS + i;
+		xdb_res_t *pRes = xdb_pexec (pConn, "INSERT INTO ck (id, k, s) VALUES (%d, %d, 'v%d')", id, i % 10, id);
+		pWriter->errors += XDB_OK != xdb_errcode (pRes);
+		if (i % 4 == 0) {
+			pRes = xdb_pexec (pConn, "UPDATE ck SET k=k+10 WHERE id=%d", id);
+			pWriter->errors += XDB_OK != xdb_errcode (pRes);
+		}
+	}
+	__atomic_fetch_add (pWriter->pDone, 1, __ATOMIC_RELEASE);
+	xdb_close (pConn);
+	return NULL;
+}
+
+static int xdb_ckpt_count (xdb_conn_t *pConn, const char *sql)
+{
+	xdb_res_t *pRes = xdb_exec (pConn, sql);
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int count = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	xdb_free_result (pRes);
+	return count;
+}
+
+static void xdb_ckpt_clean ()
+{
+	xdb_conn_t *pConn = xdb_open (XDB_CKPT_DB);
+	xdb_exec (pConn, "DROP DATABASE " XDB_CKPT_DB);
+	xdb_close (pConn);
+}
+
+// writers commit while checkpoints flush tables
+UTEST(XdbCkpt, fuzzy_flush)
+{
+	xdb_ckpt_writer_t	writer[3];
+	pthread_t			tid[3];
+	volatile int		done = 0;
+	int					flush_count = 0;
+
+	xdb_ckpt_clean ();
+	xdb_conn_t *pConn = xdb_open (XDB_CKPT_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	xdb_res_t *pRes = xdb_exec (pConn, "CREATE TABLE ck (id INT PRIMARY KEY, k INT, s VARCHAR(32), KEY ik (k))");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	for (int i = 0; i < 3; ++i) {
+		writer[i] = (xdb_ckpt_writer_t){.id = i, .pDone = &done};
+		ASSERT_EQ (pthread_create (&tid[i], NULL, xdb_ckpt_writer, &writer[i]), 0);
+	}
+	while (__atomic_load_n (&done, __ATOMIC_ACQUIRE) < 3) {
+		pRes = xdb_exec (pConn, "FLUSH DATABASE");
+		ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+		flush_count++;
+	}
+	for (int i = 0; i < 3; ++i) {
+		pthread_join (tid[i], NULL);
+		ASSERT_EQ (writer[i].errors, 0);
+	}
+	ASSERT_GT (flush_count, 0);
+
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck"), 3 * XDB_CKPT_ROWS);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE k=10"), 3 * XDB_CKPT_ROWS / 20);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE k=1"), 3 * XDB_CKPT_ROWS / 10);
+
+	// reload from disk
+	pRes = xdb_exec (pConn, "CLOSE DATABASE " XDB_CKPT_DB);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	xdb_close (pConn);
+	pConn = xdb_open (XDB_CKPT_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck"), 3 * XDB_CKPT_ROWS);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE k=10"), 3 * XDB_CKPT_ROWS / 20);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE s='v4001'"), 1);
+	xdb_close (pConn);
+
+	xdb_ckpt_clean ();
+}
+
+// wait till background checkpoint of test DB runs by reason
+static bool xdb_ckpt_wait (xdb_conn_t *pConn, const char *reason, int count)
+{
+	for (int ms = 0; ms < 5000; ms += 20) {
+		xdb_res_t *pRes = xdb_exec (pConn, "SELECT ckpt_count, reason FROM system.checkpoints WHERE database='" XDB_CKPT_DB "'");
+		xdb_row_t *pRow = xdb_fetch_row (pRes);
+		bool bDone = (NULL != pRow) && (xdb_column_int (pRes, pRow, 0) >= count) && !strcmp (xdb_column_str (pRes, pRow, 1), reason);
+		xdb_free_result (pRes);
+		if (bDone) {
+			return true;
+		}
+		usleep (20000);
+	}
+	return false;
+}
+
+UTEST(XdbCkpt, triggers)
+{
+	xdb_ckpt_clean ();
+	xdb_conn_t *pConn = xdb_open (XDB_CKPT_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	xdb_res_t *pRes = xdb_exec (pConn, "CREATE TABLE ck (id INT PRIMARY KEY, k INT, s VARCHAR(32))");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	// 0 disables trigger, enable one at a time
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=0, CHECKPOINT_WAL_SIZE=0, CHECKPOINT_DIRTY_SIZE=1, CHECKPOINT_THREADS=2");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "INSERT INTO ck VALUES (1, 1, 'a')");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE (xdb_ckpt_wait (pConn, "DIRTY", 1));
+
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_DIRTY_SIZE=0, CHECKPOINT_WAL_SIZE=1");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "INSERT INTO ck VALUES (2, 2, 'b')");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE (xdb_ckpt_wait (pConn, "WAL", 2));
+
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_WAL_SIZE=0, CHECKPOINT_PERIOD=50, CHECKPOINT_IO_RATE=1000000");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "UPDATE ck SET s='c' WHERE id=1");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE (xdb_ckpt_wait (pConn, "AGE", 3));
+
+	// explicit flush of changes with all triggers off
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=0");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "DELETE FROM ck WHERE id=2");
+	CHECK_AFFECT (pRes, 1);
+	pRes = xdb_exec (pConn, "FLUSH DATABASE");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE (xdb_ckpt_wait (pConn, "FLUSH", 4));
+
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_THREADS=0");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_PARAM);
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=-1");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_WAL_SIZE=abc");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_PARAM);
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_DIRTY_SIZE=99999999999999999999");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_PARAM);
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=4294967296");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_PARAM);
+	// bad value leaves other settings of the statement unchanged
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_DIRTY_SIZE=1, CHECKPOINT_IO_RATE=abc");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_PARAM);
+	pRes = xdb_exec (pConn, "INSERT INTO ck VALUES (3, 3, 'c')");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	usleep (100000);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT ckpt_count FROM system.checkpoints WHERE database='" XDB_CKPT_DB "'"), 4);
+
+	// restore defaults for other tests
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=1000, CHECKPOINT_WAL_SIZE=67108864, CHECKPOINT_DIRTY_SIZE=67108864, CHECKPOINT_THREADS=4, CHECKPOINT_IO_RATE=0");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	xdb_close (pConn);
+
+	// stats are removed with DB
+	xdb_ckpt_clean ();
+	pConn = xdb_open (":memory:");
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM system.checkpoints WHERE database='" XDB_CKPT_DB "'"), 0);
+	xdb_close (pConn);
+}
+
+// bytes synced by last checkpoint, count is set to checkpoint count
+static int xdb_ckpt_bytes (xdb_conn_t *pConn, int *pCount)
+{
+	xdb_res_t *pRes = xdb_exec (pConn, "FLUSH DATABASE");
+	if (XDB_OK != xdb_errcode (pRes)) {
+		return -1;
+	}
+	pRes = xdb_exec (pConn, "SELECT last_bytes, ckpt_count FROM system.checkpoints WHERE database='" XDB_CKPT_DB "'");
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int bytes = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	*pCount = (NULL != pRow) ? xdb_column_int (pRes, pRow, 1) : -1;
+	xdb_free_result (pRes);
+	return bytes;
+}
+
+// flush syncs only pages changed since last checkpoint
+UTEST(XdbCkpt, dirty_pages)
+{
+	int count, count2;
+
+	xdb_ckpt_clean ();
+	xdb_conn_t *pConn = xdb_open (XDB_CKPT_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	xdb_res_t *pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=0, CHECKPOINT_WAL_SIZE=0, CHECKPOINT_DIRTY_SIZE=0");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "CREATE TABLE ck (id INT PRIMARY KEY, k INT, s INT, KEY ik USING RBTREE (k))");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+	pRes = xdb_exec (pConn, "BEGIN");
+	for (int i = 0; i < XDB_CKPT_ROWS * 2; ++i) {
+		pRes = xdb_pexec (pConn, "INSERT INTO ck VALUES (%d, %d, %d)", i, i * 7919 % (XDB_CKPT_ROWS * 2), i);
+		ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	}
+	pRes = xdb_exec (pConn, "COMMIT");
+	int full = xdb_ckpt_bytes (pConn, &count);
+	ASSERT_GT (full, 100 * 4096);
+
+	// no change, no checkpoint
+	xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE k>100");
+	xdb_ckpt_bytes (pConn, &count2);
+	ASSERT_EQ (count2, count);
+
+	// RBTREE remove and insert fixup only dirty nodes they rewrite
+	pRes = xdb_exec (pConn, "UPDATE ck SET k=k+1 WHERE id=77");
+	CHECK_AFFECT (pRes, 1);
+	int one = xdb_ckpt_bytes (pConn, &count2);
+	ASSERT_EQ (count2, count + 1);
+	ASSERT_GT (one, 0);
+	ASSERT_LE (one, 16 * 4096);
+	for (int i = 0; i < 16; ++i) {
+		pRes = xdb_pexec (pConn, "UPDATE ck SET k=k+1 WHERE id=%d", i * 1237 + 5);
+		CHECK_AFFECT (pRes, 1);
+	}
+	int bytes = xdb_ckpt_bytes (pConn, &count2);
+	ASSERT_LE (bytes, 16 * one);
+	ASSERT_LT (bytes, full / 4);
+
+	for (int i = 0; i < 16; ++i) {
+		pRes = xdb_pexec (pConn, "DELETE FROM ck WHERE id=%d", i * 1237 + 9);
+		CHECK_AFFECT (pRes, 1);
+	}
+	bytes = xdb_ckpt_bytes (pConn, &count2);
+	ASSERT_LE (bytes, 16 * one);
+	ASSERT_EQ (xdb_ckpt_count (pConn, "SELECT COUNT(*) FROM ck WHERE k>=0"), XDB_CKPT_ROWS * 2 - 16);
+
+	pRes = xdb_exec (pConn, "SET CHECKPOINT_PERIOD=1000, CHECKPOINT_WAL_SIZE=67108864, CHECKPOINT_DIRTY_SIZE=67108864");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	xdb_close (pConn);
+	xdb_ckpt_clean ();
+}
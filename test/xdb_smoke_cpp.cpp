@@ -0,0 +1,106 @@
+#include "utest.h"
+#include <crossdb.hpp>
+
+// error code of exception thrown by fn, 0 if nothing is thrown
+template <typename Fn>
+static int xdb_cpp_errcode (Fn fn)
+{
+	try {
+		fn ();
+	} catch (const crossdb::error &err) {
+		return err.code ();
+	}
+	return 0;
+}
+
+UTEST(XdbCpp, open_exec_query)
+{
+	crossdb::connection conn (":memory:");
+
+	conn.exec ("CREATE TABLE student (id INT PRIMARY KEY, name CHAR(16), age TINYINT, score FLOAT, class VARCHAR(16))");
+	auto res = conn.exec ("INSERT INTO student VALUES (1, 'jack', 10, 90.5, '6-1'), (2, 'rose', 11, 95, '6-2'), (3, 'tom', 12, 80, NULL)");
+	ASSERT_EQ (res.affected_rows (), 3);
+
+	// untyped rows
+	int count = 0, id_sum = 0;
+	for (auto row : conn.exec ("SELECT id, name FROM student")) {
+		id_sum += row.get_int (0);
+		ASSERT_FALSE (row.get_str (1).empty ());
+		count++;
+	}
+	ASSERT_EQ (count, 3);
+	ASSERT_EQ (id_sum, 6);
+
+	auto one = conn.exec ("SELECT name, class FROM student WHERE id=3");
+	ASSERT_EQ (one.column_count (), 2);
+	ASSERT_STREQ (one.column_name (1), "class");
+	auto row = one.fetch ();
+	ASSERT_TRUE (row.has_value ());
+	ASSERT_TRUE (row->get_str (0) == "tom");
+	ASSERT_TRUE (row->is_null (1));
+	ASSERT_FALSE (one.fetch ().has_value ());
+
+	// typed rows, NULL reads as empty optional
+	count = 0;
+	for (auto [id, name, age, score, cls] : conn.query<int, std::string, int8_t, float, std::optional<std::string_view>> ("SELECT * FROM student")) {
+		if (3 == id) {
+			ASSERT_TRUE (name == "tom");
+			ASSERT_EQ (age, 12);
+			ASSERT_FALSE (cls.has_value ());
+		} else {
+			ASSERT_TRUE (cls.has_value ());
+			ASSERT_EQ (score, 1 == id ? 90.5f : 95.0f);
+		}
+		count++;
+	}
+	ASSERT_EQ (count, 3);
+
+	// prepared statement, layout is checked once and reused
+	auto stmt = conn.prepare ("SELECT name, score FROM student WHERE id=?");
+	for (int id = 1; id <= 3; ++id) {
+		auto rows = stmt.query<std::string_view, float> (id);
+		auto val = rows.fetch ();
+		ASSERT_TRUE (val.has_value ());
+		ASSERT_EQ (std::get<0>(*val).size (), 3 == id ? 3u : 4u);
+		ASSERT_FALSE (rows.fetch ().has_value ());
+	}
+
+	auto ins = conn.prepare ("INSERT INTO student (id, name, age) VALUES (?, ?, ?)");
+	ASSERT_EQ (ins.exec (4, "mike", 13).affected_rows (), 1);
+	std::string name = "wendy";
+	ASSERT_EQ (ins.exec (5, name, (int8_t)14).affected_rows (), 1);
+
+	// statement is move-only, moved one keeps the handle
+	crossdb::statement moved = std::move (ins);
+	ASSERT_TRUE (nullptr == ins.handle ());
+	ASSERT_EQ (moved.exec (6, std::string_view ("lucy"), 15).affected_rows (), 1);
+
+	auto cnt = conn.query<int64_t> ("SELECT COUNT(*) FROM student").fetch ();
+	ASSERT_EQ (std::get<0>(*cnt), 6);
+}
+
+UTEST(XdbCpp, errors)
+{
+	crossdb::connection conn (":memory:");
+	conn.exec ("CREATE TABLE t (id INT PRIMARY KEY, s VARCHAR(8))");
+	conn.exec ("INSERT INTO t VALUES (1, 'a')");
+
+	// SQL error is thrown with its code
+	ASSERT_EQ (xdb_cpp_errcode ([&] { conn.exec ("SELECT * FROM nosuch"); }), XDB_E_NOTFOUND);
+	ASSERT_NE (xdb_cpp_errcode ([&] { conn.exec ("INSERT INTO t VALUES (2, '0123456789')"); }), 0);
+	ASSERT_EXCEPTION (conn.exec ("SELEC 1"), crossdb::error);
+	ASSERT_EXCEPTION (conn.prepare ("SELECT * FROM t WHERE"), crossdb::error);
+
+	// column type and count mismatch
+	ASSERT_EQ (xdb_cpp_errcode ([&] { conn.query<std::string> ("SELECT id FROM t"); }), XDB_E_PARAM);
+	ASSERT_EQ (xdb_cpp_errcode ([&] { conn.query<int, std::string, int> ("SELECT * FROM t"); }), XDB_E_PARAM);
+	auto stmt = conn.prepare ("SELECT s FROM t WHERE id=?");
+	ASSERT_EQ (xdb_cpp_errcode ([&] { stmt.query<double> (1); }), XDB_E_PARAM);
+	ASSERT_EQ (xdb_cpp_errcode ([&] { stmt.exec (1, 2); }), XDB_E_PARAM);
+
+	// connection still works after errors
+	auto val = stmt.query<std::string_view> (1).fetch ();
+	ASSERT_TRUE (std::get<0>(*val) == "a");
+}
+
+UTEST_MAIN()
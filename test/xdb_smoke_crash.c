@@ -0,0 +1,243 @@
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define XDB_CRASH_DB	"crashdb"
+
+typedef void (*xdb_crash_cb) (xdb_conn_t *pConn, int round);
+
+// run workload in child and exit without close, so next open has to recover
+static int xdb_crash_run (xdb_crash_cb cb, int round)
+{
+	pid_t pid = fork ();
+	if (0 == pid) {
+		xdb_conn_t *pConn = xdb_open (XDB_CRASH_DB);
+		if (NULL == pConn) {
+			_exit (1);
+		}
+		cb (pConn, round);
+		_exit (0);
+	}
+	int status = -1;
+	if ((pid < 0) || (waitpid (pid, &status, 0) != pid)) {
+		return -1;
+	}
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static int xdb_crash_count (xdb_conn_t *pConn, const char *sql)
+{
+	xdb_res_t *pRes = xdb_exec (pConn, sql);
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int count = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	xdb_free_result (pRes);
+	return count;
+}
+
+// only DB flushed before boot is repaired on open, so force repair of tables dirtied by crash
+static int xdb_crash_open (xdb_conn_t **ppConn)
+{
+	*ppConn = xdb_open (XDB_CRASH_DB);
+	if (NULL == *ppConn) {
+		return -1;
+	}
+	xdb_res_t *pRes = xdb_exec (*ppConn, "REPAIR DATABASE");
+	return xdb_errcode (pRes);
+}
+
+// close DB rather than connection only, so next open reloads from disk
+static int xdb_crash_close (xdb_conn_t *pConn)
+{
+	xdb_res_t *pRes = xdb_exec (pConn, "CLOSE DATABASE " XDB_CRASH_DB);
+	int rc = xdb_errcode (pRes);
+	xdb_close (pConn);
+	return rc;
+}
+
+static void xdb_crash_clean ()
+{
+	xdb_conn_t *pConn = xdb_open (XDB_CRASH_DB);
+	xdb_res_t *pRes = xdb_exec (pConn, "DROP DATABASE " XDB_CRASH_DB);
+	(void)pRes;
+	xdb_close (pConn);
+}
+
+static void xdb_crash_rbtree (xdb_conn_t *pConn, int round)
+{
+	if (0 == round) {
+		xdb_exec (pConn, "CREATE TABLE rb (id INT PRIMARY KEY, k INT, KEY ik USING RBTREE (k))");
+	}
+	for (int i = 0; i < 100; ++i) {
+		xdb_pexec (pConn, "INSERT INTO rb VALUES (%d, %d)", round * 100 + i, i % 10);
+	}
+	xdb_exec (pConn, "DELETE FROM rb WHERE k=9");
+}
+
+UTEST(XdbCrash, rbtree_reopen)
+{
+	xdb_crash_clean ();
+	for (int round = 0; round < 3; ++round) {
+		ASSERT_EQ (xdb_crash_run (xdb_crash_rbtree, round), 0);
+		xdb_conn_t *pConn;
+		ASSERT_EQ (xdb_crash_open (&pConn), XDB_OK);
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rb"), 90 * (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rb WHERE k=3"), 10 * (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rb WHERE k=9"), 0);
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rb WHERE k>=5"), 40 * (round + 1));
+		ASSERT_EQ (xdb_crash_close (pConn), XDB_OK);
+	}
+	xdb_crash_clean ();
+}
+
+static void xdb_crash_rbtree_build (xdb_conn_t *pConn, int round)
+{
+	if (0 == round) {
+		xdb_exec (pConn, "CREATE TABLE rbb (id INT PRIMARY KEY, k INT, s VARCHAR(16))");
+		for (int i = 0; i < 1000; ++i) {
+			xdb_pexec (pConn, "INSERT INTO rbb VALUES (%d, %d, 's%d')", i, i % 10, i);
+		}
+		// bulk build on populated table
+		xdb_exec (pConn, "CREATE INDEX ik ON rbb USING RBTREE (k)");
+		xdb_exec (pConn, "CREATE INDEX is ON rbb USING RBTREE (s)");
+	}
+	for (int i = 0; i < 100; ++i) {
+		xdb_pexec (pConn, "INSERT INTO rbb VALUES (%d, %d, 's%d')", 1000 * (round + 1) + i, i % 10, i);
+	}
+}
+
+UTEST(XdbCrash, rbtree_bulk_build)
+{
+	xdb_crash_clean ();
+	for (int round = 0; round < 3; ++round) {
+		ASSERT_EQ (xdb_crash_run (xdb_crash_rbtree_build, round), 0);
+		// repair rebuilds indexes in bulk
+		xdb_conn_t *pConn;
+		ASSERT_EQ (xdb_crash_open (&pConn), XDB_OK);
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rbb"), 1000 + 100 * (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rbb WHERE k=7"), 100 + 10 * (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rbb WHERE k<2"), 200 + 20 * (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rbb WHERE s='s42'"), 1 + (round + 1));
+		ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM rbb WHERE s='s999'"), 1);
+		ASSERT_EQ (xdb_crash_close (pConn), XDB_OK);
+	}
+	xdb_crash_clean ();
+}
+
+// data files at last checkpoint, restored after crash so that only WAL has later changes
+#define XDB_CRASH_SNAP	XDB_CRASH_DB ".snap"
+
+static void xdb_crash_redo_dml (xdb_conn_t *pConn, const char *tbl, int base, int from, int to, int kupd, int kdel, const char *val)
+{
+	for (int i = from; i < to; ++i) {
+		xdb_pexec (pConn, "INSERT INTO %s VALUES (%d, %d, 's%d')", tbl, base + i, i % 10, i);
+	}
+	xdb_pexec (pConn, "UPDATE %s SET s='%s' WHERE k=%d AND id>=%d", tbl, val, kupd, base);
+	xdb_pexec (pConn, "DELETE FROM %s WHERE k=%d AND id>=%d", tbl, kdel, base);
+}
+
+static void xdb_crash_redo (xdb_conn_t *pConn, int round)
+{
+	const char *tbls[] = {"th", "tr"};
+	char val[32];
+	if (0 == round) {
+		xdb_exec (pConn, "CREATE TABLE th (id INT PRIMARY KEY, k INT, s VARCHAR(64), KEY ik (k), KEY is (s))");
+		xdb_exec (pConn, "CREATE TABLE tr (id INT PRIMARY KEY, k INT, s VARCHAR(64), KEY ik USING RBTREE (k), KEY is USING RBTREE (s))");
+	}
+	for (int t = 0; t < 2; ++t) {
+		xdb_crash_redo_dml (pConn, tbls[t], round * 1000, 0, 100, 1, 9, "checkpointed-long-value");
+	}
+	xdb_exec (pConn, "FLUSH DATABASE");
+	if (system ("rm -rf " XDB_CRASH_SNAP " && mkdir " XDB_CRASH_SNAP " && cp -a " XDB_CRASH_DB "/T* " XDB_CRASH_DB "/xdb.db " XDB_CRASH_SNAP)) {
+		_exit (2);
+	}
+	snprintf (val, sizeof (val), "u%d", round);
+	for (int t = 0; t < 2; ++t) {
+		xdb_crash_redo_dml (pConn, tbls[t], round * 1000, 100, 200, 2, 8, val);
+	}
+}
+
+UTEST(XdbCrash, wal_redo)
+{
+	const char *tbls[] = {"th", "tr"};
+	xdb_crash_clean ();
+	for (int round = 0; round < 3; ++round) {
+		ASSERT_EQ (xdb_crash_run (xdb_crash_redo, round), 0);
+		ASSERT_EQ (system ("rm -rf " XDB_CRASH_DB "/T* && cp -a " XDB_CRASH_SNAP "/. " XDB_CRASH_DB), 0);
+		xdb_conn_t *pConn;
+		ASSERT_EQ (xdb_crash_open (&pConn), XDB_OK);
+		for (int t = 0; t < 2; ++t) {
+			char sql[128];
+			// each round adds 200 rows, then deletes 10 with k=9 and 20 with k=8
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 170 * (round + 1));
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE k=9", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 10 * (round + 1));
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE k=8", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 0);
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE k=1", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 20 * (round + 1));
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE s='checkpointed-long-value'", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 10 * (round + 1));
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE s='u%d'", tbls[t], round);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), 20);
+			snprintf (sql, sizeof (sql), "SELECT COUNT(*) FROM %s WHERE s='s123'", tbls[t]);
+			ASSERT_EQ (xdb_crash_count (pConn, sql), round + 1);
+		}
+		ASSERT_EQ (xdb_crash_close (pConn), XDB_OK);
+	}
+	xdb_crash_clean ();
+	ASSERT_EQ (system ("rm -rf " XDB_CRASH_SNAP), 0);
+}
+
+// checkpoint count changes only if FLUSH found DB changed
+#define XDB_CRASH_CKPT	"SELECT ckpt_count FROM system.checkpoints WHERE database='" XDB_CRASH_DB "'"
+#define XDB_CRASH_CKPT_BYTES	"SELECT last_bytes FROM system.checkpoints WHERE database='" XDB_CRASH_DB "'"
+
+static void xdb_crash_delta (xdb_conn_t *pConn, int round)
+{
+	xdb_exec (pConn, "SET CHECKPOINT_PERIOD=0, CHECKPOINT_WAL_SIZE=0, CHECKPOINT_DIRTY_SIZE=0");
+	xdb_exec (pConn, "CREATE TABLE du (id INT PRIMARY KEY, n INT, s VARCHAR(1024))");
+	xdb_exec (pConn, "CREATE TABLE dx (id INT PRIMARY KEY)");
+	for (int i = 0; i < 100; ++i) {
+		xdb_pexec (pConn, "INSERT INTO du VALUES (%d, 0, 'v%0400d')", i, i);
+	}
+	xdb_exec (pConn, "FLUSH DATABASE");
+	// delta records, old rows are freed when checkpoint recycles WAL
+	xdb_exec (pConn, "UPDATE du SET n=n+1 WHERE id<50");
+	xdb_exec (pConn, "FLUSH DATABASE");
+	int count = xdb_crash_count (pConn, XDB_CRASH_CKPT);
+	xdb_exec (pConn, "FLUSH DATABASE");
+	if (xdb_crash_count (pConn, XDB_CRASH_CKPT) != count) {
+		_exit (3);
+	}
+	// next checkpoint syncs only the other table, freed rows were synced already
+	xdb_exec (pConn, "INSERT INTO dx VALUES (1)");
+	xdb_exec (pConn, "FLUSH DATABASE");
+	if ((xdb_crash_count (pConn, XDB_CRASH_CKPT) != count + 1) || (xdb_crash_count (pConn, XDB_CRASH_CKPT_BYTES) > 4096)) {
+		_exit (4);
+	}
+	// only in WAL, redo applies delta on checkpointed rows
+	xdb_exec (pConn, "UPDATE du SET n=n+10 WHERE id>=90");
+}
+
+UTEST(XdbCrash, delta_update)
+{
+	xdb_crash_clean ();
+	ASSERT_EQ (xdb_crash_run (xdb_crash_delta, 0), 0);
+	xdb_conn_t *pConn;
+	ASSERT_EQ (xdb_crash_open (&pConn), XDB_OK);
+	ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM du"), 100);
+	ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM du WHERE n=1"), 50);
+	ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM du WHERE n=0"), 40);
+	ASSERT_EQ (xdb_crash_count (pConn, "SELECT COUNT(*) FROM du WHERE n=10"), 10);
+	for (int id = 7; id < 100; id += 45) {
+		char val[512];
+		snprintf (val, sizeof (val), "v%0400d", id);
+		xdb_res_t *pRes = xdb_pexec (pConn, "SELECT s FROM du WHERE id=%d", id);
+		xdb_row_t *pRow = xdb_fetch_row (pRes);
+		ASSERT_TRUE (pRow != NULL);
+		ASSERT_STREQ (xdb_column_str (pRes, pRow, 0), val);
+		xdb_free_result (pRes);
+	}
+	ASSERT_EQ (xdb_crash_close (pConn), XDB_OK);
+	xdb_crash_clean ();
+}
@@ -0,0 +1,428 @@
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// compare 2 tables row by row in id order, return count of different rows
+static int xdb_data_diff (xdb_conn_t *pConn, const char *tbl1, const char *tbl2)
+{
+	xdb_res_t *pRes1 = xdb_pexec (pConn, "SELECT * FROM %s ORDER BY id", tbl1);
+	xdb_res_t *pRes2 = xdb_pexec (pConn, "SELECT * FROM %s ORDER BY id", tbl2);
+	int diff = abs ((int)xdb_row_count(pRes1) - (int)xdb_row_count(pRes2));
+	xdb_row_t *pRow1, *pRow2;
+
+	while ((NULL != (pRow1 = xdb_fetch_row (pRes1))) && (NULL != (pRow2 = xdb_fetch_row (pRes2)))) {
+		bool bSame = true;
+		for (int i = 0; bSame && (i < xdb_column_count (pRes1)); ++i) {
+			int len1, len2;
+			const void *val1, *val2;
+			if (xdb_column_null (pRes1, pRow1, i) || xdb_column_null (pRes2, pRow2, i)) {
+				bSame = xdb_column_null (pRes1, pRow1, i) == xdb_column_null (pRes2, pRow2, i);
+				continue;
+			}
+			switch (xdb_column_type (pRes1, i)) {
+			case XDB_TYPE_CHAR:
+			case XDB_TYPE_VCHAR:
+				val1 = xdb_column_str2 (pRes1, pRow1, i, &len1);
+				val2 = xdb_column_str2 (pRes2, pRow2, i, &len2);
+				bSame = (len1 == len2) && !memcmp (val1, val2, len1);
+				break;
+			case XDB_TYPE_BINARY:
+			case XDB_TYPE_VBINARY:
+				val1 = xdb_column_blob (pRes1, pRow1, i, &len1);
+				val2 = xdb_column_blob (pRes2, pRow2, i, &len2);
+				bSame = (len1 == len2) && !memcmp (val1, val2, len1);
+				break;
+			default:
+				bSame = xdb_column_int64 (pRes1, pRow1, i) == xdb_column_int64 (pRes2, pRow2, i);
+				break;
+			}
+		}
+		diff += !bSame;
+	}
+
+	xdb_free_result (pRes1);
+	xdb_free_result (pRes2);
+	return diff;
+}
+
+#define XDB_DATA_TBL	"(id INT PRIMARY KEY, s VARCHAR(16), c CHAR(8), b VARBINARY(8), f BINARY(4))"
+#define XDB_DATA_ROWS	"(1, 'a\"b', 'x,y', X'', X'01020304'), (2, '', '', NULL, NULL), (3, NULL, NULL, X'00ff', X''), (4, 'line\nnext', 'z', X'0a0d', X'22222222')"
+
+UTEST_I(XdbTest, load_dump_csv, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+
+	pRes = xdb_exec (pConn, "CREATE TABLE dsrc " XDB_DATA_TBL);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "CREATE TABLE ddst " XDB_DATA_TBL);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "INSERT INTO dsrc VALUES " XDB_DATA_ROWS);
+	CHECK_AFFECT (pRes, 4);
+
+	// empty string and empty binary are quoted, NULL is empty field
+	pRes = xdb_exec (pConn, "DUMP TABLE dsrc INTO 'xdb_data.csv'");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.csv' INTO TABLE ddst");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_data_diff (pConn, "dsrc", "ddst"), 0);
+
+	pRes = xdb_exec (pConn, "DELETE FROM ddst");
+	CHECK_AFFECT (pRes, 4);
+	pRes = xdb_exec (pConn, "DUMP TABLE dsrc INTO 'xdb_data.csv' FIELDS TERMINATED BY '|'");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.csv' INTO TABLE ddst FIELDS TERMINATED BY '|'");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_data_diff (pConn, "dsrc", "ddst"), 0);
+
+	// not empty table is loaded row by row
+	pRes = xdb_exec (pConn, "DELETE FROM ddst WHERE id>2");
+	CHECK_AFFECT (pRes, 2);
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.csv' INTO TABLE ddst FIELDS TERMINATED BY '|'");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_data_diff (pConn, "dsrc", "ddst"), 0);
+
+	pRes = xdb_exec (pConn, "DROP TABLE dsrc");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "DROP TABLE ddst");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	remove ("xdb_data.csv");
+}
+
+UTEST_I(XdbTest, load_dump_binary, 2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+
+	pRes = xdb_exec (pConn, "CREATE TABLE dsrc " XDB_DATA_TBL);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "CREATE TABLE ddst " XDB_DATA_TBL);
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "INSERT INTO dsrc VALUES " XDB_DATA_ROWS);
+	CHECK_AFFECT (pRes, 4);
+
+	pRes = xdb_exec (pConn, "DUMP TABLE dsrc INTO 'xdb_data.bin' FORMAT BINARY");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.bin' INTO TABLE ddst FORMAT BINARY");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_data_diff (pConn, "dsrc", "ddst"), 0);
+
+	pRes = xdb_exec (pConn, "DROP TABLE dsrc");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "DROP TABLE ddst");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	remove ("xdb_data.bin");
+}
+
+static int xdb_data_count (xdb_conn_t *pConn, const char *sql)
+{
+	xdb_res_t *pRes = xdb_exec (pConn, sql);
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int count = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	xdb_free_result (pRes);
+	return count;
+}
+
+UTEST_I(XdbTest, load_bad_rows, 2)
+{
+	xdb_res_t *pRes;
+	xdb_row_t *pRow;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+	int len;
+
+	pRes = xdb_exec (pConn, "CREATE TABLE dbad (id INT PRIMARY KEY, t TINYINT, u SMALLINT UNSIGNED, i BIGINT, ub BIGINT UNSIGNED, f FLOAT, b VARBINARY(4), h BINARY(2))");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	FILE *pFile = fopen ("xdb_data.csv", "w");
+	ASSERT_TRUE (pFile!=NULL);
+	fputs ("1,127,65535,-9223372036854775808,18446744073709551615,1.5,0a0B,ff09\n"
+			"2,128,1,1,1,1,,\n"
+			"3,1,65536,1,1,1,,\n"
+			"4,1,1,9223372036854775808,1,1,,\n"
+			"5,1,1,1,-1,1,,\n"
+			"6,1x,1,1,1,1,,\n"
+			"7,1,1,1,1,1e39,,\n"
+			"8,1,1,1,1,1,0g,\n"
+			"9,1,1,1,1,1,abc,\n"
+			"10,1,1,1,1,1,,123456\n"
+			"11,-128,0,,0,-2.5,\"\",0000\n", pFile);
+	fclose (pFile);
+
+	// bad rows are skipped, result reports the first one
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.csv' INTO TABLE dbad");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE_MSG (NULL != strstr (xdb_errmsg(pRes), "Load 2 rows into table 'dbad', skip 9 rows, first bad line 2: Number out of range"), xdb_errmsg(pRes));
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM dbad"), 2);
+
+	pRes = xdb_exec (pConn, "SELECT * FROM dbad WHERE id=1");
+	pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_EQ (xdb_column_int (pRes, pRow, 1), 127);
+	ASSERT_EQ (xdb_column_int (pRes, pRow, 2), 65535);
+	ASSERT_EQ (xdb_column_int64 (pRes, pRow, 3), INT64_MIN);
+	ASSERT_EQ ((uint64_t)xdb_column_int64 (pRes, pRow, 4), UINT64_MAX);
+	ASSERT_EQ (memcmp (xdb_column_blob (pRes, pRow, 6, &len), "\x0a\x0b", 2), 0);
+	ASSERT_EQ (len, 2);
+	ASSERT_EQ (memcmp (xdb_column_blob (pRes, pRow, 7, &len), "\xff\x09", 2), 0);
+	ASSERT_EQ (len, 2);
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "SELECT * FROM dbad WHERE id=11");
+	pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_EQ (xdb_column_int (pRes, pRow, 1), -128);
+	ASSERT_TRUE (xdb_column_null (pRes, pRow, 3));
+	ASSERT_NEAR (xdb_column_float (pRes, pRow, 5), -2.5, 0.000001);
+	xdb_column_blob (pRes, pRow, 6, &len);
+	ASSERT_EQ (len, 0);
+	ASSERT_FALSE (xdb_column_null (pRes, pRow, 6));
+	ASSERT_EQ (memcmp (xdb_column_blob (pRes, pRow, 7, &len), "\0\0", 2), 0);
+	xdb_free_result (pRes);
+
+	// cut last record of row file
+	pRes = xdb_exec (pConn, "DUMP TABLE dbad INTO 'xdb_data.bin' FORMAT BINARY");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "DELETE FROM dbad");
+	CHECK_AFFECT (pRes, 2);
+	pFile = fopen ("xdb_data.bin", "r+");
+	ASSERT_TRUE (pFile!=NULL);
+	fseek (pFile, 0, SEEK_END);
+	ASSERT_EQ (ftruncate (fileno (pFile), ftell (pFile) - 1), 0);
+	fclose (pFile);
+	pRes = xdb_exec (pConn, "LOAD DATA INFILE 'xdb_data.bin' INTO TABLE dbad FORMAT BINARY");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	ASSERT_TRUE_MSG (NULL != strstr (xdb_errmsg(pRes), "Load 1 rows into table 'dbad', skip 1 rows, first bad record 2: Incomplete record"), xdb_errmsg(pRes));
+
+	pRes = xdb_exec (pConn, "DROP TABLE dbad");
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+	remove ("xdb_data.csv");
+	remove ("xdb_data.bin");
+}
+
+#define XDB_DATA_EXEC(pConn, sql...)	\
+	pRes = xdb_pexec (pConn, sql);	\
+	ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));
+
+UTEST(XdbData, wal_archive_pitr)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_open (":memory:");
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (system ("rm -rf pitr_arch pitr_base pitrdb pitr_all pitr_ts pitr_cid"), 0);
+
+	XDB_DATA_EXEC (pConn, "SET WAL_ARCHIVE='pitr_arch'");
+	XDB_DATA_EXEC (pConn, "CREATE DATABASE pitrdb");
+	XDB_DATA_EXEC (pConn, "USE pitrdb");
+	XDB_DATA_EXEC (pConn, "CREATE TABLE t (id INT PRIMARY KEY, s VARCHAR(16))");
+	// commit 1 ~ 10 are in base
+	for (int i = 0; i < 10; ++i) {
+		XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (%d, 'a')", i);
+	}
+	XDB_DATA_EXEC (pConn, "BACKUP DATABASE pitrdb TO 'pitr_base'");
+	// commit 11 ~ 20, then timestamp target, then commit 21 ~ 31
+	for (int i = 10; i < 20; ++i) {
+		XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (%d, 'b')", i);
+	}
+	XDB_DATA_EXEC (pConn, "FLUSH DATABASE");
+	usleep (10000);
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	uint64_t ts = tv.tv_sec * 1000000ULL + tv.tv_usec;
+	usleep (10000);
+	for (int i = 20; i < 30; ++i) {
+		XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (%d, 'c')", i);
+	}
+	XDB_DATA_EXEC (pConn, "UPDATE t SET s='u' WHERE id<5");
+	XDB_DATA_EXEC (pConn, "FLUSH DATABASE");
+
+	// ARCHIVE is segment dir of source DB
+	XDB_DATA_EXEC (pConn, "RESTORE DATABASE pitr_all FROM 'pitr_base' ARCHIVE 'pitr_arch/pitrdb'");
+	XDB_DATA_EXEC (pConn, "USE pitr_all");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t"), 30);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE s='u'"), 5);
+
+	XDB_DATA_EXEC (pConn, "RESTORE DATABASE pitr_ts FROM 'pitr_base' ARCHIVE 'pitr_arch/pitrdb' UNTIL TIMESTAMP %"PRIu64, ts);
+	XDB_DATA_EXEC (pConn, "USE pitr_ts");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t"), 20);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE s='u'"), 0);
+
+	XDB_DATA_EXEC (pConn, "RESTORE DATABASE pitr_cid FROM 'pitr_base' ARCHIVE 'pitr_arch/pitrdb' UNTIL COMMIT 15");
+	XDB_DATA_EXEC (pConn, "USE pitr_cid");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t"), 15);
+	pRes = xdb_exec (pConn, "RESTORE DATABASE pitr_bad FROM 'pitr_base' ARCHIVE 'pitr_arch/pitrdb' UNTIL COMMIT 5");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+
+	// lost DB is restored with its own archive, and new commits follow restored ones
+	XDB_DATA_EXEC (pConn, "DROP DATABASE pitrdb");
+	XDB_DATA_EXEC (pConn, "RESTORE DATABASE pitrdb FROM 'pitr_base'");
+	XDB_DATA_EXEC (pConn, "USE pitrdb");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t"), 30);
+	XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (100, 'n')");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE id>=20"), 11);
+
+	XDB_DATA_EXEC (pConn, "SET WAL_ARCHIVE=''");
+	XDB_DATA_EXEC (pConn, "USE memory");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE pitrdb");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE pitr_all");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE pitr_ts");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE pitr_cid");
+	xdb_close (pConn);
+	ASSERT_EQ (system ("rm -rf pitr_arch pitr_base pitr_bad"), 0);
+}
+
+#define XDB_BKUP_DB		"bkupdb"
+
+static void* xdb_bkup_writer (void *pArg)
+{
+	volatile int *pStop = pArg;
+	xdb_conn_t *pConn = xdb_open (XDB_BKUP_DB);
+	for (int i = 1; !*pStop; ++i) {
+		xdb_pexec (pConn, "INSERT INTO w VALUES (%d, 'w%d')", i, i);
+	}
+	xdb_close (pConn);
+	return NULL;
+}
+
+// backup reports "copy N tables, skip M tables"
+static bool xdb_bkup_check (xdb_res_t *pRes, int copy, int skip)
+{
+	char msg[64];
+	snprintf (msg, sizeof (msg), "copy %d tables, skip %d tables", copy, skip);
+	return (XDB_OK == xdb_errcode (pRes)) && (NULL != strstr (xdb_errmsg (pRes), msg));
+}
+
+UTEST(XdbData, backup_incremental)
+{
+	xdb_res_t *pRes;
+	pthread_t tid;
+	volatile int stop = 0;
+
+	ASSERT_EQ (system ("rm -rf " XDB_BKUP_DB " bkup_dir bkupdb2"), 0);
+	xdb_conn_t *pConn = xdb_open (XDB_BKUP_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_DATA_EXEC (pConn, "CREATE TABLE a (id INT PRIMARY KEY, k INT, s VARCHAR(32), KEY ik (k))");
+	XDB_DATA_EXEC (pConn, "CREATE TABLE b (id INT PRIMARY KEY, s VARCHAR(32))");
+	XDB_DATA_EXEC (pConn, "CREATE TABLE w (id INT PRIMARY KEY, s VARCHAR(32), KEY is (s))");
+	XDB_DATA_EXEC (pConn, "INSERT INTO w VALUES (0, 'w0')");
+	for (int i = 0; i < 1000; ++i) {
+		XDB_DATA_EXEC (pConn, "INSERT INTO a VALUES (%d, %d, 'a%d')", i, i % 10, i);
+		XDB_DATA_EXEC (pConn, "INSERT INTO b VALUES (%d, 'b%d')", i, i);
+	}
+
+	pRes = xdb_exec (pConn, "BACKUP DATABASE " XDB_BKUP_DB " TO 'bkup_dir'");
+	ASSERT_TRUE_MSG (xdb_bkup_check (pRes, 3, 0), xdb_errmsg(pRes));
+	pRes = xdb_exec (pConn, "BACKUP DATABASE " XDB_BKUP_DB " TO 'bkup_dir' INCREMENTAL");
+	ASSERT_TRUE_MSG (xdb_bkup_check (pRes, 0, 3), xdb_errmsg(pRes));
+	XDB_DATA_EXEC (pConn, "UPDATE a SET s='u' WHERE k=3");
+	pRes = xdb_exec (pConn, "BACKUP DATABASE " XDB_BKUP_DB " TO 'bkup_dir' INCREMENTAL");
+	ASSERT_TRUE_MSG (xdb_bkup_check (pRes, 1, 2), xdb_errmsg(pRes));
+
+	// online backup while writer commits
+	ASSERT_EQ (pthread_create (&tid, NULL, xdb_bkup_writer, (void*)&stop), 0);
+	usleep (20000);
+	pRes = xdb_exec (pConn, "BACKUP DATABASE " XDB_BKUP_DB " TO 'bkup_dir' INCREMENTAL");
+	ASSERT_TRUE_MSG (xdb_bkup_check (pRes, 1, 2), xdb_errmsg(pRes));
+	stop = 1;
+	pthread_join (tid, NULL);
+	ASSERT_GT (xdb_data_count (pConn, "SELECT COUNT(*) FROM w"), 1);
+
+	XDB_DATA_EXEC (pConn, "RESTORE DATABASE bkupdb2 FROM 'bkup_dir'");
+	XDB_DATA_EXEC (pConn, "USE bkupdb2");
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM a"), 1000);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM a WHERE k=3"), 100);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM a WHERE s='u'"), 100);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM b"), 1000);
+	// restored writer commits have no gap
+	int wcount = xdb_data_count (pConn, "SELECT COUNT(*) FROM w");
+	ASSERT_GT (wcount, 1);
+	ASSERT_EQ (xdb_data_count (pConn, "SELECT MAX(id) FROM w"), wcount - 1);
+	pRes = xdb_pexec (pConn, "SELECT COUNT(*) FROM w WHERE s='w%d'", wcount - 1);
+	ASSERT_EQ (xdb_column_int (pRes, xdb_fetch_row (pRes), 0), 1);
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "BACKUP DATABASE nodb TO 'bkup_dir'");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+
+	// path longer than copy buffer fails restore instead of skipping the entry
+	char cmd[1024] = "mkdir -p bkup_dir";
+	for (int i = 0; i < 3; ++i) {
+		strcat (cmd, "/");
+		memset (cmd + strlen (cmd), 'd', 200);
+	}
+	ASSERT_EQ (system (cmd), 0);
+	pRes = xdb_exec (pConn, "RESTORE DATABASE bkupdb3 FROM 'bkup_dir'");
+	ASSERT_EQ (xdb_errcode(pRes), XDB_E_FILE);
+	ASSERT_EQ (system ("rm -rf bkupdb3"), 0);
+
+	XDB_DATA_EXEC (pConn, "DROP DATABASE bkupdb2");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE " XDB_BKUP_DB);
+	xdb_close (pConn);
+	ASSERT_EQ (system ("rm -rf bkup_dir"), 0);
+}
+
+#define XDB_SRC_DB		"srcfastdb"
+
+// EXPECT_* report into caller test result
+static void xdb_source_check (int *utest_result, xdb_conn_t *pConn)
+{
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t"), 5000);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE k=3"), 500);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE s='it\\'s 42'"), 1);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE u=7"), 1);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT k FROM t WHERE u=7"), 7);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t2"), 2500);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t2 WHERE s='x4999'"), 1);
+}
+
+UTEST(XdbData, source_fast)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_open (":memory:");
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (system ("rm -rf " XDB_SRC_DB), 0);
+
+	XDB_DATA_EXEC (pConn, "CREATE DATABASE srcdb ENGINE=MEMORY");
+	XDB_DATA_EXEC (pConn, "USE srcdb");
+	XDB_DATA_EXEC (pConn, "CREATE TABLE t (id INT PRIMARY KEY, k INT, s VARCHAR(32), u INT, KEY ik (k), KEY USING RBTREE is (s), UNIQUE KEY iu (u))");
+	XDB_DATA_EXEC (pConn, "CREATE TABLE t2 (id INT PRIMARY KEY, s VARCHAR(32))");
+	for (int i = 0; i < 5000; ++i) {
+		XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (%d, %d, 'it\\'s %d', %d)", i, i % 10, i, i);
+		if (i % 2) {
+			XDB_DATA_EXEC (pConn, "INSERT INTO t2 VALUES (%d, 'x%d')", i, i);
+		}
+	}
+	XDB_DATA_EXEC (pConn, "DUMP DATABASE srcdb INTO 'xdb_source.sql'");
+	// duplicate of unique key is dropped like INSERT does
+	FILE *pFile = fopen ("xdb_source.sql", "a");
+	ASSERT_TRUE (pFile!=NULL);
+	fprintf (pFile, "INSERT INTO t VALUES (9000, 1, 'dup', 7);\n");
+	fclose (pFile);
+
+	XDB_DATA_EXEC (pConn, "CREATE DATABASE srcplain ENGINE=MEMORY");
+	XDB_DATA_EXEC (pConn, "USE srcplain");
+	xdb_exec (pConn, "SOURCE 'xdb_source.sql'");
+	xdb_source_check (utest_result, pConn);
+
+	// bulk load into disk DB, indexes are built at end and survive reload
+	XDB_DATA_EXEC (pConn, "CREATE DATABASE " XDB_SRC_DB);
+	XDB_DATA_EXEC (pConn, "USE " XDB_SRC_DB);
+	xdb_exec (pConn, "SOURCE 'xdb_source.sql' FAST");
+	xdb_source_check (utest_result, pConn);
+	XDB_DATA_EXEC (pConn, "INSERT INTO t VALUES (9001, 1, 'new', 9001)");
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (9002, 1, 'dup', 7)");
+	CHECK_AFFECT (pRes, 0);
+	// memory DBs go away with last connection
+	XDB_DATA_EXEC (pConn, "DROP DATABASE srcdb");
+	XDB_DATA_EXEC (pConn, "DROP DATABASE srcplain");
+	XDB_DATA_EXEC (pConn, "CLOSE DATABASE " XDB_SRC_DB);
+	xdb_close (pConn);
+
+	pConn = xdb_open (XDB_SRC_DB);
+	ASSERT_TRUE (pConn!=NULL);
+	EXPECT_EQ (xdb_data_count (pConn, "SELECT COUNT(*) FROM t WHERE k=1"), 501);
+	XDB_DATA_EXEC (pConn, "DELETE FROM t WHERE id=9001");
+	xdb_source_check (utest_result, pConn);
+
+	XDB_DATA_EXEC (pConn, "DROP DATABASE " XDB_SRC_DB);
+	xdb_close (pConn);
+	remove ("xdb_source.sql");
+}
@@ -73,6 +73,41 @@ UTEST_I(XdbTestRows, query_exp, 2)
 	CHECK_EXP (pRes, 7, ASSERT_EQ(xdb_column_int(pRes, pRow, 0), xdb_column_int(pRes, pRow, 1) + xdb_column_int(pRes, pRow, 2)));
 }
 
+UTEST_I(XdbTestRows, query_cols_order, 2)
+{
+	xdb_res_t *pRes;
+	xdb_row_t *pRow;
+	xdb_conn_t *pConn = utest_fixture->pConn;
+
+	pRes = xdb_exec (pConn, "UPDATE student SET age=NULL WHERE id=1001");
+	CHECK_AFFECT (pRes, 1);
+
+	// NULL of result column is not NULL of table field at same position
+	pRes = xdb_exec (pConn, "SELECT score,age,name FROM student WHERE id=1001");
+	CHECK_EXP (pRes, 1, 
+		ASSERT_FALSE (xdb_column_null (pRes, pRow, 0));
+		ASSERT_EQ (xdb_column_int (pRes, pRow, 0), 92);
+		ASSERT_TRUE (xdb_column_null (pRes, pRow, 1));
+		ASSERT_FALSE (xdb_column_null (pRes, pRow, 2));
+		ASSERT_STREQ (xdb_column_str (pRes, pRow, 2), "rose"));
+
+	pRes = xdb_exec (pConn, "SELECT id,age FROM student WHERE id=1001");
+	CHECK_EXP (pRes, 1, 
+		ASSERT_EQ (xdb_column_int (pRes, pRow, 0), 1001);
+		ASSERT_TRUE (xdb_column_null (pRes, pRow, 1)));
+
+	pRes = xdb_exec (pConn, "SELECT id,name,age FROM student WHERE id=1001");
+	CHECK_EXP (pRes, 1, 
+		ASSERT_EQ (xdb_column_int (pRes, pRow, 0), 1001);
+		ASSERT_FALSE (xdb_column_null (pRes, pRow, 1));
+		ASSERT_TRUE (xdb_column_null (pRes, pRow, 2)));
+
+	pRes = xdb_exec (pConn, "SELECT class,id FROM student WHERE age=12");
+	CHECK_EXP (pRes, 1, 
+		ASSERT_STREQ (xdb_column_str (pRes, pRow, 0), "6-1");
+		ASSERT_EQ (xdb_column_int (pRes, pRow, 1), 1002));
+}
+
 UTEST_I(XdbTestRows, query_many_id, 2)
 {
 	xdb_res_t *pRes;
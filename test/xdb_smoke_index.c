@@ -0,0 +1,705 @@
+#include <stdarg.h>
+
+#define XDB_IDX_DB		"idxdb"
+
+// indexed table t and table tscan without secondary index get same DML
+#define XDB_IDX_EXEC2(pConn, sql, args...)	\
+	{	\
+		pRes = xdb_pexec (pConn, sql, "t", ##args);	\
+		ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));	\
+		uint64_t affect = xdb_affected_rows (pRes);	\
+		pRes = xdb_pexec (pConn, sql, "tscan", ##args);	\
+		ASSERT_EQ_MSG (xdb_errcode(pRes), XDB_OK, xdb_errmsg(pRes));	\
+		ASSERT_EQ (xdb_affected_rows (pRes), affect);	\
+	}
+
+static int xdb_idx_query (xdb_conn_t *pConn, const char *tbl, const char *where, int64_t *pSum)
+{
+	xdb_res_t *pRes = xdb_pexec (pConn, "SELECT COUNT(*), SUM(id) FROM %s WHERE %s", tbl, where);
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int count = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	*pSum = ((NULL != pRow) && (count > 0)) ? xdb_column_int64 (pRes, pRow, 1) : 0;
+	xdb_free_result (pRes);
+	return count;
+}
+
+// count of rows matched by index on t, -1 if rows differ from scan on tscan
+static int xdb_idx_cmp (xdb_conn_t *pConn, const char *fmt, ...)
+{
+	char		where[256];
+	int64_t		sum1, sum2;
+	va_list		ap;
+
+	va_start (ap, fmt);
+	vsnprintf (where, sizeof (where), fmt, ap);
+	va_end (ap);
+
+	int count = xdb_idx_query (pConn, "t", where, &sum1);
+	return ((count == xdb_idx_query (pConn, "tscan", where, &sum2)) && (sum1 == sum2)) ? count : -1;
+}
+
+static int xdb_idx_sum (xdb_conn_t *pConn, const char *tbl, const char *cols, const char *where, double *pSum)
+{
+	xdb_res_t *pRes = xdb_pexec (pConn, "SELECT %s FROM %s WHERE %s", cols, tbl, where);
+	xdb_row_t *pRow;
+	int count = 0;
+	if (XDB_OK != xdb_errcode (pRes)) {
+		return -1;
+	}
+	*pSum = 0;
+	while (NULL != (pRow = xdb_fetch_row (pRes))) {
+		for (int i = 0; i < xdb_column_count (pRes); ++i) {
+			int type = xdb_column_type (pRes, i);
+			*pSum += (i + 1) * (((XDB_TYPE_DOUBLE == type) || (XDB_TYPE_FLOAT == type)) ? xdb_column_double (pRes, pRow, i) : xdb_column_int64 (pRes, pRow, i));
+		}
+		count++;
+	}
+	xdb_free_result (pRes);
+	return count;
+}
+
+// same as xdb_idx_cmp, but checks projected columns, which covering index may return without row
+static int xdb_idx_cmp_cols (xdb_conn_t *pConn, const char *cols, const char *where)
+{
+	double sum1, sum2;
+	int count = xdb_idx_sum (pConn, "t", cols, where, &sum1);
+	return ((count == xdb_idx_sum (pConn, "tscan", cols, where, &sum2)) && (sum1 == sum2)) ? count : -1;
+}
+
+// EXPLAIN message has str
+static bool xdb_idx_explain (xdb_conn_t *pConn, const char *sql, const char *str)
+{
+	xdb_res_t *pRes = xdb_pexec (pConn, "EXPLAIN %s", sql);
+	return (XDB_OK == xdb_errcode (pRes)) && (NULL != strstr (xdb_errmsg (pRes), str));
+}
+
+// first column of first row, -1 if no row
+static int xdb_idx_int (xdb_conn_t *pConn, const char *fmt, ...)
+{
+	char		sql[256];
+	va_list		ap;
+
+	va_start (ap, fmt);
+	vsnprintf (sql, sizeof (sql), fmt, ap);
+	va_end (ap);
+
+	xdb_res_t *pRes = xdb_exec (pConn, sql);
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	int val = (NULL != pRow) ? xdb_column_int (pRes, pRow, 0) : -1;
+	xdb_free_result (pRes);
+	return val;
+}
+
+#define XDB_IDX_EXPLAIN(pConn, sql, str)	\
+	ASSERT_TRUE_MSG (xdb_idx_explain (pConn, sql, str), xdb_errmsg(xdb_pexec (pConn, "EXPLAIN %s", sql)))
+
+// create tables in fresh disk DB, tscan has no secondary index
+static xdb_conn_t* xdb_idx_open (const char *cols, const char *idx)
+{
+	xdb_conn_t *pConn = xdb_open (XDB_IDX_DB);
+	xdb_exec (pConn, "DROP DATABASE " XDB_IDX_DB);
+	xdb_close (pConn);
+	pConn = xdb_open (XDB_IDX_DB);
+	if (NULL != pConn) {
+		xdb_pexec (pConn, "CREATE TABLE t (%s, %s)", cols, idx);
+		xdb_pexec (pConn, "CREATE TABLE tscan (%s)", cols);
+	}
+	return pConn;
+}
+
+// close DB and last connection, so indexes are loaded from disk again
+static xdb_conn_t* xdb_idx_reopen (xdb_conn_t *pConn)
+{
+	xdb_exec (pConn, "CLOSE DATABASE " XDB_IDX_DB);
+	xdb_close (pConn);
+	return xdb_open (XDB_IDX_DB);
+}
+
+static void xdb_idx_clean (xdb_conn_t *pConn)
+{
+	xdb_exec (pConn, "DROP DATABASE " XDB_IDX_DB);
+	xdb_close (pConn);
+}
+
+UTEST(XdbIndex, bitmap)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, g INT, h INT, s VARCHAR(16)", "KEY ig USING BITMAP (g), KEY ih USING BITMAP (h)");
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1"), 0);
+
+	for (int i = 0; i < 1000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d, 's%d')", i, i % 4, i % 7, i);
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE g=1", "ig(BITMAP eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE g=1 AND h=3", "intersect");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1"), 250);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=9"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g<>1"), 750);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 AND h=3"), 36);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 AND h=3 AND id<500"), 18);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 AND s='s85'"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 OR h=3"), 250 + 143 - 36);
+
+	// key changes move rows between bitmaps
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET g=9 WHERE h=3");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE g=2");
+	XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (2000, 1, 3, 'n')");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=9"), 143);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1"), 250 - 36 + 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=2"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 AND h=3"), 1);
+
+	// rolled back rows are not counted
+	XDB_IDX_EXEC2 (pConn, "BEGIN");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE g=1 AND id<100");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1"), 215 - 22);
+	XDB_IDX_EXEC2 (pConn, "ROLLBACK");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1"), 215);
+
+	// bitmaps are rebuilt on open
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=9"), 143);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "g=1 AND h=3"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "h=0"), 143 - 36);
+
+	pRes = xdb_exec (pConn, "CREATE UNIQUE INDEX ub ON t USING BITMAP (s)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+// id 0: 0.0.0.0/0, 1: 10.0.0.0/8, 100+x: 10.x.0.0/16, 1000+100x+y: 10.x.y.0/24, 10: 2001:db8::/32, 20+x: 2001:db8:x::/48
+UTEST(XdbIndex, lpm)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, p INET", "KEY il USING LPM (p)");
+	ASSERT_TRUE (pConn!=NULL);
+
+	XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (0, '0.0.0.0/0'), (1, '10.0.0.0/8'), (10, '2001:db8::/32')");
+	for (int x = 0; x < 50; ++x) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, '10.%d.0.0/16')", 100 + x, x);
+		for (int y = 0; y < 20; ++y) {
+			XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, '10.%d.%d.0/24')", 1000 + 100 * x + y, x, y);
+		}
+		if (x < 20) {
+			XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, '2001:db8:%x::/48')", 20 + x, x);
+		}
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE p >>= '10.3.7.9'", "il(LPM prefix");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE p <<= '10.3.0.0/16'", "il(LPM prefix");
+
+	// longest prefix first
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.3.7.9'"), 4);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.7.9' LIMIT 1"), 1307);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "'10.3.7.9' <<= p"), 4);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.3.7.0/24'"), 4);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.60.1.1'"), 2);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.60.1.1' LIMIT 1"), 1);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '11.0.0.1' LIMIT 1"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '10.3.0.0/16'"), 21);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "'10.3.0.0/16' >>= p"), 21);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '10.0.0.0/8'"), 1 + 50 + 1000);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '0.0.0.0/0'"), 2 + 50 + 1000);
+	// address families are apart
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '2001:db8:5::1'"), 2);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '2001:db8:5::1' LIMIT 1"), 25);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '2001:db8::/32'"), 21);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '2001:db9::1'"), 0);
+
+	// host route, removed and moved prefixes
+	XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (7, '10.3.7.9')");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.3.7.9'"), 5);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.7.9' LIMIT 1"), 7);
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE id=1307");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.3.7.10'"), 3);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.7.10' LIMIT 1"), 103);
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET p='10.3.128.0/17' WHERE id=103");
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.7.10' LIMIT 1"), 1);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.200.1' LIMIT 1"), 103);
+
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p >>= '10.3.7.9'"), 3);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.7.9' LIMIT 1"), 7);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE p >>= '10.3.200.1' LIMIT 1"), 103);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '10.3.0.0/16'"), 21);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "p <<= '2001:db8::/32'"), 21);
+
+	pRes = xdb_exec (pConn, "CREATE INDEX lid ON t USING LPM (id)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	pRes = xdb_exec (pConn, "CREATE UNIQUE INDEX lu ON t USING LPM (p)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+UTEST(XdbIndex, include)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, k INT, a INT, b DOUBLE, s VARCHAR(16)", "KEY ik (k) INCLUDE (a, b)");
+	ASSERT_TRUE (pConn!=NULL);
+
+	for (int i = 0; i < 1000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d, %d.25, 's%d')", i, i % 50, i, i, i);
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT a, b FROM t WHERE k=7", "covering");
+	XDB_IDX_EXPLAIN (pConn, "SELECT k, a FROM t WHERE k=7 AND b>500", "covering");
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT s FROM t WHERE k=7", "covering"));
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT a FROM t WHERE k=7 AND s='s7'", "covering"));
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=7"), 20);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "k, b, a", "k=7 AND a>500"), 10);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a", "k=99"), 0);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "s, a", "k=7"), 20);
+
+	// cover follows included and key columns
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET a=a+1, b=b*2 WHERE k=7");
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=7"), 20);
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET k=99 WHERE k=8 AND a<500");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k=9 AND a>500");
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=99"), 10);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=8"), 10);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=9"), 10);
+
+	XDB_IDX_EXEC2 (pConn, "BEGIN");
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET a=0 WHERE k=7");
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=7"), 20);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT COUNT(*) FROM t WHERE k=7 AND a=0"), 20);
+	XDB_IDX_EXEC2 (pConn, "ROLLBACK");
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=7"), 20);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT COUNT(*) FROM t WHERE k=7 AND a=0"), 0);
+
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT a, b FROM t WHERE k=7", "covering");
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "a, b", "k=7"), 20);
+	ASSERT_EQ (xdb_idx_cmp_cols (pConn, "b", "k=99"), 10);
+	pRes = xdb_exec (pConn, "SHOW CREATE TABLE t");
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_TRUE (NULL != strstr (xdb_column_str (pRes, pRow, 0), "INCLUDE (a,b)"));
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "CREATE INDEX is ON t (k) INCLUDE (s)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	pRes = xdb_exec (pConn, "CREATE INDEX ir ON t USING RBTREE (k) INCLUDE (a)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+// active rows id%10=0, s is shared by rows 2n and 2n+1
+UTEST(XdbIndex, partial)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, k INT, st INT, s VARCHAR(16)", "KEY ia (k) WHERE st=1, UNIQUE KEY iu (s) WHERE st=1");
+	ASSERT_TRUE (pConn!=NULL);
+
+	for (int i = 0; i < 1000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d, 's%d')", i, i % 50, i % 10 == 0, i / 2);
+	}
+	// only queries with same filter use index
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=10 AND st=1", "ia(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1 AND id>100 AND k=10", "ia(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE s='s5' AND st=1", "iu(HASH eq");
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT * FROM t WHERE k=10", "ia("));
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT * FROM t WHERE k=10 AND st=2", "ia("));
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT * FROM t WHERE k=10 AND st>=1", "ia("));
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT * FROM t WHERE k=10 OR st=1", "ia("));
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=10 AND st=1"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=10"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=5 AND st=1"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=5"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s5' AND st=1"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s5'"), 2);
+
+	// unique among matching rows only
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (2000, 99, 1, 's0')");
+	CHECK_AFFECT (pRes, 0);
+	XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (2000, 99, 0, 's0')");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s0' AND st=1"), 1);
+
+	// updates move rows in and out of index
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=1 WHERE k=5");
+	ASSERT_EQ (xdb_affected_rows (pRes), 20);
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=0 WHERE k=10 AND id<500");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=5 AND st=1"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=10 AND st=1"), 10);
+	pRes = xdb_exec (pConn, "UPDATE t SET st=1 WHERE id=1");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=0 WHERE id=0");
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=1 WHERE id=1");
+	ASSERT_EQ (xdb_affected_rows (pRes), 1);
+	ASSERT_EQ (xdb_idx_int (pConn, "SELECT id FROM t WHERE s='s0' AND st=1"), 1);
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET k=77 WHERE k=5 AND id<300");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k=10 AND st=1 AND id>800");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=77 AND st=1"), 6);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=5 AND st=1"), 14);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=10 AND st=1"), 6);
+
+	XDB_IDX_EXEC2 (pConn, "BEGIN");
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=0 WHERE k=77");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=77 AND st=1"), 0);
+	XDB_IDX_EXEC2 (pConn, "ROLLBACK");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=77 AND st=1"), 6);
+
+	// partial indexes are rebuilt on open
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=77 AND st=1", "ia(HASH eq");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=77 AND st=1"), 6);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=5 AND st=1"), 14);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=10 AND st=1"), 6);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s0' AND st=1"), 1);
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (3000, 1, 1, 's2')");
+	CHECK_AFFECT (pRes, 0);
+	pRes = xdb_exec (pConn, "SHOW CREATE TABLE t");
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_TRUE (NULL != strstr (xdb_column_str (pRes, pRow, 0), "UNIQUE  KEY iu USING HASH (s) WHERE st = 1"));
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "CREATE INDEX ib ON t (k) WHERE zz=1");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	pRes = xdb_exec (pConn, "CREATE INDEX ib ON t (k) WHERE st LIKE 1");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+// failed unique insert removes row only from indexes it entered
+UTEST(XdbIndex, unique_dup)
+{
+	const char *types[] = {"HASH", "RBTREE"};
+	for (int t = 0; t < 2; ++t) {
+		xdb_res_t *pRes;
+		char idx[256];
+		snprintf (idx, sizeof (idx), "KEY ia USING %s (k), KEY ip USING %s (k) WHERE st=0, UNIQUE KEY iu USING %s (s), UNIQUE KEY iup USING %s (k) WHERE st=1", 
+				types[t], types[t], types[t], types[t]);
+		xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, k INT, st INT, s VARCHAR(16)", idx);
+		ASSERT_TRUE (pConn!=NULL);
+
+		for (int i = 0; i < 100; ++i) {
+			XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d, 's%d')", i, i, i % 2, i);
+		}
+
+		// duplicate in UNIQUE secondary index, after PK, ia and ip took the row
+		pRes = xdb_exec (pConn, "INSERT INTO t VALUES (100, 100, 0, 's5')");
+		CHECK_AFFECT (pRes, 0);
+		// duplicate in UNIQUE partial index, ip never took the row
+		pRes = xdb_exec (pConn, "INSERT INTO t VALUES (101, 1, 1, 's101')");
+		CHECK_AFFECT (pRes, 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=100"), 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=1"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=1 AND st=1"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=0 AND st=0"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "s='s101'"), 0);
+
+		// same ids and keys can be inserted after failure
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (100, 100, 0, 's100')");
+		ASSERT_EQ (xdb_affected_rows (pRes), 1);
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (101, 101, 1, 's101')");
+		ASSERT_EQ (xdb_affected_rows (pRes), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=100 AND st=0"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=101 AND st=1"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "s='s101'"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "st=0"), 51);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k>=0"), 102);
+
+		XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE st=0");
+		ASSERT_EQ (xdb_affected_rows (pRes), 51);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=100"), 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k>=0"), 51);
+		xdb_idx_clean (pConn);
+	}
+}
+
+UTEST(XdbIndex, hash2)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, k INT, s VARCHAR(16)", "KEY ik USING HASH2 (k), UNIQUE KEY iu USING HASH2 (s)");
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 0);
+
+	// groups double many times
+	for (int i = 0; i < 5000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, 's%d')", i, i % 100, i);
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=7", "ik(HASH2 eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE s='s7'", "iu(HASH2 eq");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 50);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=100"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s4321'"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='x'"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=21 AND s='s4321'"), 1);
+
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (9000, 1, 's5')");
+	CHECK_AFFECT (pRes, 0);
+	pRes = xdb_exec (pConn, "UPDATE t SET s='s5' WHERE id=6");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+
+	// deleted entries are reused
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k<50");
+	ASSERT_EQ (xdb_affected_rows (pRes), 2500);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 50);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s5'"), 0);
+	for (int i = 0; i < 2500; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, 'n%d')", 10000 + i, i % 100, i);
+	}
+	for (int r = 0; r < 5; ++r) {
+		XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k=3");
+		for (int j = 0; j < 20; ++j) {
+			XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, 3, 'r%d_%d')", 20000 + r * 100 + j, r, j);
+		}
+	}
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 25);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 75);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=3"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='r2_5'"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='r4_5'"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='n5'"), 1);
+
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET k=k+1000 WHERE k=70 AND id<2500");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=1070"), 25);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 50);
+
+	XDB_IDX_EXEC2 (pConn, "BEGIN");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k=70");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 0);
+	XDB_IDX_EXEC2 (pConn, "ROLLBACK");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 50);
+
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=7", "ik(HASH2 eq");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 25);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=70"), 50);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=1070"), 25);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=3"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s4371'"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s4321'"), 0);
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (30000, 1, 's99')");
+	CHECK_AFFECT (pRes, 0);
+	pRes = xdb_exec (pConn, "SHOW CREATE TABLE t");
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_TRUE (NULL != strstr (xdb_column_str (pRes, pRow, 0), "KEY iu USING HASH2 (s)"));
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "CREATE INDEX ic ON t USING HASH2 (k) INCLUDE (s)");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+// false positive rate EXPLAIN reports for query, -1 if none
+static double xdb_idx_bloom_fpr (xdb_conn_t *pConn, const char *sql)
+{
+	xdb_res_t *pRes = xdb_pexec (pConn, "EXPLAIN %s", sql);
+	const char *pFpr = (XDB_OK == xdb_errcode (pRes)) ? strstr (xdb_errmsg (pRes), "bloom_fpr=") : NULL;
+	return (NULL != pFpr) ? atof (pFpr + strlen ("bloom_fpr=")) : -1;
+}
+
+UTEST(XdbIndex, bloom)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, k INT, s VARCHAR(16)", "KEY ik USING HASH (k) BLOOM, UNIQUE KEY iu (s) BLOOM");
+	ASSERT_TRUE (pConn!=NULL);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 0);
+
+	for (int i = 0; i < 2000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, 's%d')", i, i % 200, i);
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=7", "ik(HASH eq");
+	for (int k = 0; k < 200; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), 10);
+	}
+	for (int k = 1000; k < 2000; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), 0);
+	}
+	double fpr = xdb_idx_bloom_fpr (pConn, "SELECT * FROM t WHERE k=7");
+	ASSERT_GE (fpr, 0);
+	ASSERT_LT (fpr, 0.1);
+
+	// new keys skip chain walk, duplicates are still found
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (9000, 1, 's5')");
+	CHECK_AFFECT (pRes, 0);
+	pRes = xdb_exec (pConn, "UPDATE t SET s='s5' WHERE id=6");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s5'"), 1);
+
+	// deletes past 1/8 of capacity and growth rebuild filter
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE k<100");
+	ASSERT_EQ (xdb_affected_rows (pRes), 1000);
+	for (int i = 0; i < 5000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, 'n%d')", 10000 + i, 1000 + i % 500, i);
+	}
+	for (int k = 0; k < 200; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), k < 100 ? 0 : 10);
+	}
+	for (int k = 1000; k < 1500; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), 10);
+	}
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='s5'"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "s='n4999'"), 1);
+
+	// filter is rebuilt on open
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE k=7", "bloom_fpr=");
+	for (int k = 100; k < 200; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), 10);
+	}
+	for (int k = 1000; k < 1500; ++k) {
+		ASSERT_EQ (xdb_idx_cmp (pConn, "k=%d", k), 10);
+	}
+	ASSERT_EQ (xdb_idx_cmp (pConn, "k=7"), 0);
+	pRes = xdb_exec (pConn, "INSERT INTO t VALUES (30000, 1, 'n7')");
+	CHECK_AFFECT (pRes, 0);
+	pRes = xdb_exec (pConn, "SHOW CREATE TABLE t");
+	xdb_row_t *pRow = xdb_fetch_row (pRes);
+	ASSERT_TRUE (pRow!=NULL);
+	ASSERT_TRUE (NULL != strstr (xdb_column_str (pRes, pRow, 0), "ik USING HASH (k) BLOOM"));
+	xdb_free_result (pRes);
+
+	pRes = xdb_exec (pConn, "CREATE INDEX ib ON t USING RBTREE (k) BLOOM");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	pRes = xdb_exec (pConn, "CREATE INDEX ib ON t USING HASH2 (k) BLOOM");
+	ASSERT_NE (xdb_errcode(pRes), XDB_OK);
+	xdb_idx_clean (pConn);
+}
+
+// st has 2 values, tn has 100
+UTEST(XdbIndex, cost)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, tn INT, st INT", "KEY ist (st), KEY itn (tn)");
+	ASSERT_TRUE (pConn!=NULL);
+
+	for (int i = 0; i < 2000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d)", i, i % 100, i % 2);
+	}
+	// selective index wins over earlier one, scan wins over unselective one
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1 AND tn=5", "itn(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE tn=5 AND st=1", "itn(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1 AND tn=5 AND id=105", "PRIMARY(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1", "Scan table");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=1 AND tn=5"), 20);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=0 AND tn=5"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=1 AND tn=5 AND id=105"), 1);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=1"), 1000);
+
+	// statistics follow data
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET st=id WHERE id>=10");
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET tn=0");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1 AND tn=0", "ist(HASH eq");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=1 AND tn=0"), 5);
+
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE st=1 AND tn=0", "ist(HASH eq");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE tn=0", "Scan table");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "st=1 AND tn=0"), 5);
+	xdb_idx_clean (pConn);
+}
+
+UTEST(XdbIndex, intersect)
+{
+	xdb_res_t *pRes;
+	xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, a INT, b INT, c INT", "KEY ia (a), KEY ib USING RBTREE (b), KEY ic (c)");
+	ASSERT_TRUE (pConn!=NULL);
+
+	for (int i = 0; i < 3000; ++i) {
+		XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d, %d)", i, i % 20, i % 30, i % 7);
+	}
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE a=3 AND b=13", "intersect");
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE a=3 AND b=13 OR c=2", "intersect");
+	ASSERT_FALSE (xdb_idx_explain (pConn, "SELECT * FROM t WHERE a=3 AND b>13", "intersect"));
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13"), 50);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "b=13 AND a=3"), 50);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13 AND c=2"), 7);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=14"), 0);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13 AND id<1000"), 16);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13 OR c=2"), 50 + 429 - 7);
+
+	XDB_IDX_EXEC2 (pConn, "UPDATE %s SET b=14 WHERE a=3 AND b=13 AND id<1000");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE a=3 AND c=2");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13"), 29);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=14"), 14);
+
+	// rows changed in open transaction
+	XDB_IDX_EXEC2 (pConn, "BEGIN");
+	XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (5000, 3, 13, 0)");
+	XDB_IDX_EXEC2 (pConn, "DELETE FROM %s WHERE a=3 AND b=14 AND id<500");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13"), 30);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=14"), 7);
+	XDB_IDX_EXEC2 (pConn, "ROLLBACK");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13"), 29);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=14"), 14);
+
+	pConn = xdb_idx_reopen (pConn);
+	ASSERT_TRUE (pConn!=NULL);
+	XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE a=3 AND b=13", "intersect");
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13"), 29);
+	ASSERT_EQ (xdb_idx_cmp (pConn, "a=3 AND b=13 AND c=2"), 0);
+	xdb_idx_clean (pConn);
+}
+
+// each key type with its own comparators, as HASH and RBTREE
+UTEST(XdbIndex, key_types)
+{
+	const char *types[] = {"HASH", "RBTREE"};
+	for (int t = 0; t < 2; ++t) {
+		xdb_res_t *pRes;
+		char idx[512], sql[64];
+		snprintf (idx, sizeof (idx), "KEY ki USING %s (i), KEY kb USING %s (b), KEY kc USING %s (c), KEY kp USING %s (p), KEY km USING %s (m), UNIQUE KEY kxy USING %s (x, y)", 
+				types[t], types[t], types[t], types[t], types[t], types[t]);
+		xdb_conn_t *pConn = xdb_idx_open ("id INT PRIMARY KEY, i INT, b BIGINT, c CHAR(16), p INET, m MAC, x INT, y INT", idx);
+		ASSERT_TRUE (pConn!=NULL);
+
+		for (int i = 0; i < 1000; ++i) {
+			XDB_IDX_EXEC2 (pConn, "INSERT INTO %s VALUES (%d, %d, %d00000000, 'k%d', '10.0.%d.1', '00:11:22:33:44:%02x', %d, %d)", 
+							i, i % 100, i % 100, i % 100, i % 50, i % 40, i % 50, i / 50);
+		}
+		// negative keys keep signed order
+		XDB_IDX_EXEC2 (pConn, "UPDATE %s SET i=i - 50, b=b - 5000000000");
+		snprintf (sql, sizeof (sql), "ki(%s eq", types[t]);
+		XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE i=10", sql);
+		snprintf (sql, sizeof (sql), "kxy(%s eq", types[t]);
+		XDB_IDX_EXPLAIN (pConn, "SELECT * FROM t WHERE x=3 AND y=7", sql);
+
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i=10"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i=0"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i=99"), 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "b=0"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "b=100000000"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c='k5'"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c='k'"), 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "p='10.0.3.1'"), 20);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "m='00:11:22:33:44:0a'"), 25);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "x=3 AND y=7"), 1);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i<0"), 500);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i>=40"), 100);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "b<0"), 500);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "b>=4000000000"), 100);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c>='k50' AND c<'k60'"), 100);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "p>'10.0.40.1'"), 180);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "m<'00:11:22:33:44:05'"), 125);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "x=3 AND y>=10"), 10);
+
+		pRes = xdb_exec (pConn, "INSERT INTO t VALUES (5000, 1, 1, 'z', '1.1.1.1', '00:00:00:00:00:01', 3, 7)");
+		CHECK_AFFECT (pRes, 0);
+		XDB_IDX_EXEC2 (pConn, "UPDATE %s SET c='k5x', y=y+100 WHERE c='k5'");
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c='k5'"), 0);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c='k5x'"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "x=5 AND y=100"), 1);
+
+		pConn = xdb_idx_reopen (pConn);
+		ASSERT_TRUE (pConn!=NULL);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i=0"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "i<0"), 500);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "b<0"), 500);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "c='k5x'"), 10);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "p='10.0.3.1'"), 20);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "m='00:11:22:33:44:0a'"), 25);
+		ASSERT_EQ (xdb_idx_cmp (pConn, "x=3 AND y=7"), 1);
+		xdb_idx_clean (pConn);
+	}
+}
@@ -173,6 +173,11 @@ do {	\
 #include "xdb_smoke_func.c"
 #include "xdb_smoke_trans.c"
 #include "xdb_smoke_semantic.c"
+#include "xdb_smoke_crash.c"
+#include "xdb_smoke_data.c"
+#include "xdb_smoke_ckpt.c"
+#include "xdb_smoke_api.c"
+#include "xdb_smoke_index.c"
 
 UTEST_I(XdbTestRows, sysdb_check, 2)
 {